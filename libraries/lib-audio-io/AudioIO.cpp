@@ -103,6 +103,7 @@ time warp info and AudioIOListener and whether the playback is looped.
 #include "Meter.h"
 #include "Mix.h"
 #include "Resample.h"
+#include "MultiChannelRingBuffer.h"
 #include "RingBuffer.h"
 #include "Decibels.h"
 #include "Prefs.h"
@@ -923,7 +924,7 @@ int AudioIO::StartStream(const TransportSequences &sequences,
    mScratchBuffers.clear();
    mScratchPointers.clear();
    mPlaybackMixers.clear();
-   mCaptureBuffers.clear();
+   mCaptureBuffers.reset();
    mResample.clear();
    mPlaybackSchedule.mTimeQueue.Clear();
 
@@ -1235,9 +1236,13 @@ bool AudioIO::AllocateBuffers(
             mPlaybackBuffers.resize(0);
             mPlaybackBuffers.resize(
                std::max<size_t>(1, totalWidth));
-            // Number of scratch buffers depends on device playback channels
+            // Number of scratch buffers depends on device playback channels,
+            // and one set is needed for each thread processing effects
+            mNumScratchLanes = std::max<size_t>(1, std::min(
+               RealtimeEffectWorkers::Lanes(), mPlaybackSequences.size()));
             if (mNumPlaybackChannels > 0) {
-               mScratchBuffers.resize(mNumPlaybackChannels * 2 + 1);
+               mScratchBuffers.resize(
+                  mNumScratchLanes * (mNumPlaybackChannels * 2 + 1));
                mScratchPointers.clear();
                for (auto &buffer : mScratchBuffers) {
                   buffer.Allocate(playbackBufferSize, floatSample);
@@ -1340,15 +1345,14 @@ bool AudioIO::AllocateBuffers(
                return false;
             }
 
-            mCaptureBuffers.resize(0);
-            mCaptureBuffers.resize(mNumCaptureChannels);
+            mCaptureBuffers.reset();
+            mCaptureBuffers = std::make_unique<MultiChannelRingBuffer>(
+               mCaptureFormat, mNumCaptureChannels, captureBufferSize);
             mResample.resize(0);
             mResample.resize(mNumCaptureChannels);
             mFactor = sampleRate / mRate;
 
             for (unsigned int i = 0; i < mNumCaptureChannels; ++i) {
-               mCaptureBuffers[i] = std::make_unique<RingBuffer>(
-                  mCaptureFormat, captureBufferSize);
                mResample[i] =
                   std::make_unique<Resample>(true, mFactor, mFactor);
                   // constant rate resampling
@@ -1390,7 +1394,7 @@ void AudioIO::StartStreamCleanup(bool bOnlyBuffers)
    mScratchBuffers.clear();
    mScratchPointers.clear();
    mPlaybackMixers.clear();
-   mCaptureBuffers.clear();
+   mCaptureBuffers.reset();
    mResample.clear();
    mPlaybackSchedule.mTimeQueue.Clear();
 
@@ -1541,6 +1545,16 @@ void AudioIO::StopStream()
       ProcessOnceAndWait();
    }
 
+   if (auto pOwningProject = mOwningProject.lock()) {
+      // Leave a clue in the log when playback of effects was too slow
+      const auto missed =
+         RealtimeEffectManager::Get(*pOwningProject).GetMissedDeadlines();
+      if (missed > 0)
+         wxLogMessage(
+            wxT("Realtime effects missed the deadlines of %llu buffers"),
+            static_cast<unsigned long long>(missed));
+   }
+
    // No longer need effects processing. This must be done after the stream is stopped
    // to prevent the callback from being invoked after the effects are finalized.
    mpTransportState.reset();
@@ -1561,7 +1575,7 @@ void AudioIO::StopStream()
       // Offset all recorded sequences to account for latency
       //
       if (mCaptureSequences.size() > 0) {
-         mCaptureBuffers.clear();
+         mCaptureBuffers.reset();
          mResample.clear();
 
          //
@@ -1887,7 +1901,8 @@ size_t AudioIoCallback::GetCommonlyWrittenForPlayback()
 
 size_t AudioIO::GetCommonlyAvailCapture()
 {
-   return MinValue(mCaptureBuffers, &RingBuffer::AvailForGet);
+   // All channels are committed together
+   return mCaptureBuffers ? mCaptureBuffers->AvailForGet() : 0;
 }
 
 // This method is the data gateway between the audio thread (which
@@ -1975,6 +1990,14 @@ void AudioIO::FillPlayBuffers()
       // Might increase because the reader consumed some
       nAvailable = GetCommonlyFreePlayback();
    }
+
+   // Ask for what the mixers will read next to be decoded in other threads.
+   // Requests come from here, in the thread that fills buffers, and not from
+   // the reads of the sequences, which also happen elsewhere.
+   const auto backwards = mPlaybackSchedule.ReversedTime();
+   for (size_t ii = 0; ii < mPlaybackMixers.size(); ++ii)
+      mPlaybackSequences[ii]->Prefetch(
+         mPlaybackMixers[ii]->MixGetCurrentTime(), backwards);
 }
 
 bool AudioIO::ProcessPlaybackSlices(
@@ -2052,64 +2075,95 @@ void AudioIO::TransformPlayBuffers(
    std::optional<RealtimeEffects::ProcessingScope> &pScope)
 {
    // Transform written but un-flushed samples in the RingBuffers in-place.
-
-   // Avoiding std::vector
-   const auto pointers = stackAllocate(float*, mNumPlaybackChannels);
+   if (!pScope || mPlaybackBuffers.empty())
+      return;
 
    const auto numPlaybackSequences = mPlaybackSequences.size();
    // mPlaybackBuffers correspond many-to-one with mPlaybackSequences
+   // Avoiding std::vector
+   const auto firstBuffers = stackAllocate(size_t, numPlaybackSequences);
    size_t iBuffer = 0;
-   for (const auto vt : mPlaybackSequences) {
-      if (!vt)
-         continue;
-      const auto pGroup = vt->FindChannelGroup();
-      if (!pGroup)
-         continue;
-      // vt is mono, or is the first of its group of channels
-      const auto nChannels = std::min<size_t>(
-         mNumPlaybackChannels, vt->NChannels());
+   for (size_t iSequence = 0; iSequence < numPlaybackSequences; ++iSequence) {
+      firstBuffers[iSequence] = iBuffer;
+      if (const auto vt = mPlaybackSequences[iSequence])
+         iBuffer += vt->NChannels();
+   }
+
+   // The effects should take no longer than the new samples take to play
+   const auto &ringBuffer = *mPlaybackBuffers[0];
+   const auto len =
+      ringBuffer.GetUnflushed(0).second + ringBuffer.GetUnflushed(1).second;
+   const auto deadline = RealtimeEffectWorkers::Clock::now() +
+      std::chrono::duration_cast<RealtimeEffectWorkers::Clock::duration>(
+         std::chrono::duration<double>{ len / mRate });
+
+   // Sequences have separate effect stacks and ring buffers, so that they can
+   // be processed concurrently, each lane with its own scratch buffers
+   pScope->ForEachGroup(numPlaybackSequences, mNumScratchLanes, deadline,
+      [&](size_t iSequence, size_t iLane){
+         TransformSequenceBuffers(*pScope,
+            mPlaybackSequences[iSequence], firstBuffers[iSequence], iLane);
+      });
+}
+
+void AudioIO::TransformSequenceBuffers(
+   RealtimeEffects::ProcessingScope &scope,
+   const std::shared_ptr<const PlayableSequence> &vt,
+   size_t iBuffer, size_t iLane)
+{
+   if (!vt)
+      return;
+   const auto pGroup = vt->FindChannelGroup();
+   if (!pGroup)
+      return;
+   // vt is mono, or is the first of its group of channels
+   const auto nChannels = std::min<size_t>(
+      mNumPlaybackChannels, vt->NChannels());
 
-      // Loop over the blocks of unflushed data, at most two
-      for (unsigned iBlock : {0, 1}) {
-         size_t len = 0;
-         size_t iChannel = 0;
+   // Avoiding std::vector
+   const auto pointers = stackAllocate(float*, mNumPlaybackChannels);
+   float *const *const laneScratch =
+      &mScratchPointers[iLane * (mNumPlaybackChannels * 2 + 1)];
+
+   // Loop over the blocks of unflushed data, at most two
+   for (unsigned iBlock : {0, 1}) {
+      size_t len = 0;
+      size_t iChannel = 0;
+      for (; iChannel < nChannels; ++iChannel) {
+         auto &ringBuffer = *mPlaybackBuffers[iBuffer + iChannel];
+         const auto pair = ringBuffer.GetUnflushed(iBlock);
+         // Playback RingBuffers have float format: see AllocateBuffers
+         pointers[iChannel] = reinterpret_cast<float*>(pair.first);
+         // The lengths of corresponding unflushed blocks should be
+         // the same for all channels
+         if (len == 0)
+            len = pair.second;
+         else
+            assert(len == pair.second);
+      }
+
+      // Are there more output device channels than channels of vt?
+      // Such as when a mono sequence is processed for stereo play?
+      // Then supply some non-null fake input buffers, because the
+      // various ProcessBlock overrides of effects may crash without it.
+      // But it would be good to find the fixes to make this unnecessary.
+      auto scratch = &laneScratch[mNumPlaybackChannels + 1];
+      while (iChannel < mNumPlaybackChannels)
+         memset((pointers[iChannel++] = *scratch++), 0, len * sizeof(float));
+
+      if (len) {
+         auto discardable = scope.Process(*pGroup, &pointers[0],
+            laneScratch,
+            // The single dummy output buffer:
+            laneScratch[mNumPlaybackChannels],
+            mNumPlaybackChannels, len);
+         iChannel = 0;
          for (; iChannel < nChannels; ++iChannel) {
             auto &ringBuffer = *mPlaybackBuffers[iBuffer + iChannel];
-            const auto pair = ringBuffer.GetUnflushed(iBlock);
-            // Playback RingBuffers have float format: see AllocateBuffers
-            pointers[iChannel] = reinterpret_cast<float*>(pair.first);
-            // The lengths of corresponding unflushed blocks should be
-            // the same for all channels
-            if (len == 0)
-               len = pair.second;
-            else
-               assert(len == pair.second);
-         }
-
-         // Are there more output device channels than channels of vt?
-         // Such as when a mono sequence is processed for stereo play?
-         // Then supply some non-null fake input buffers, because the
-         // various ProcessBlock overrides of effects may crash without it.
-         // But it would be good to find the fixes to make this unnecessary.
-         float **scratch = &mScratchPointers[mNumPlaybackChannels + 1];
-         while (iChannel < mNumPlaybackChannels)
-            memset((pointers[iChannel++] = *scratch++), 0, len * sizeof(float));
-
-         if (len && pScope) {
-            auto discardable = pScope->Process(*pGroup, &pointers[0],
-               mScratchPointers.data(),
-               // The single dummy output buffer:
-               mScratchPointers[mNumPlaybackChannels],
-               mNumPlaybackChannels, len);
-            iChannel = 0;
-            for (; iChannel < nChannels; ++iChannel) {
-               auto &ringBuffer = *mPlaybackBuffers[iBuffer + iChannel];
-               auto discarded = ringBuffer.Unput(discardable);
-               // assert(discarded == discardable);
-            }
+            auto discarded = ringBuffer.Unput(discardable);
+            // assert(discarded == discardable);
          }
       }
-      iBuffer += vt->NChannels();
    }
 }
 
@@ -2191,7 +2245,8 @@ void AudioIO::DrainRecordBuffers()
 
                   // The ring buffer might have grown concurrently -- don't discard more
                   // than the "avail" value noted above.
-                  discarded = mCaptureBuffers[i]->Discard(std::min(avail, size));
+                  // The same for every channel; consumed after the loop
+                  discarded = std::min(avail, size);
 
                   if (discarded < size)
                      // We need to visit this again to complete the
@@ -2222,7 +2277,33 @@ void AudioIO::DrainRecordBuffers()
             SampleBuffer temp;
             size_t size;
             sampleFormat format;
-            if( mFactor == 1.0 )
+            if( mFactor == 1.0 && !pCrossfadeSrc )
+            {
+               // Append captured samples directly from the storage of the
+               // ring buffer, in at most two spans because of wrap-around
+               size = toGet;
+               if (double(size) > remainingSamples)
+                  size = floor(remainingSamples);
+               const auto sampleSize = SAMPLE_SIZE(mCaptureFormat);
+               auto skip = discarded;
+               for (unsigned iBlock = 0; iBlock < 2 && size > 0; ++iBlock) {
+                  const auto [ptr, len] =
+                     mCaptureBuffers->GetReadSpan(i, iBlock);
+                  const auto skipped = std::min(skip, len);
+                  skip -= skipped;
+                  const auto toAppend = std::min(len - skipped, size);
+                  if (toAppend == 0)
+                     continue;
+                  newBlocks = (*iter)->Append(
+                     ptr + skipped * sampleSize, mCaptureFormat, toAppend, 1,
+                     // Do not dither recordings
+                     narrowestSampleFormat, iChannel
+                  ) || newBlocks;
+                  size -= toAppend;
+               }
+               continue;
+            }
+            else if( mFactor == 1.0 )
             {
                // Take captured samples directly
                size = toGet;
@@ -2232,8 +2313,8 @@ void AudioIO::DrainRecordBuffers()
                else
                   format = mCaptureFormat;
                temp.Allocate(size, format);
-               const auto got =
-                  mCaptureBuffers[i]->Get(temp.ptr(), format, toGet);
+               const auto got = mCaptureBuffers->Get(
+                  i, temp.ptr(), format, toGet, discarded);
                // wxASSERT(got == toGet);
                // but we can't assert in this thread
                wxUnusedVar(got);
@@ -2246,8 +2327,8 @@ void AudioIO::DrainRecordBuffers()
                format = floatSample;
                SampleBuffer temp1(toGet, floatSample);
                temp.Allocate(size, format);
-               const auto got =
-                  mCaptureBuffers[i]->Get(temp1.ptr(), floatSample, toGet);
+               const auto got = mCaptureBuffers->Get(
+                  i, temp1.ptr(), floatSample, toGet, discarded);
                // wxASSERT(got == toGet);
                // but we can't assert in this thread
                wxUnusedVar(got);
@@ -2291,6 +2372,9 @@ void AudioIO::DrainRecordBuffers()
             ) || newBlocks;
          } // end loop over capture channels
 
+         // Let the callback reuse the space of all channels at once
+         mCaptureBuffers->Consume(avail);
+
          // Now update the recording schedule position
          mRecordingSchedule.mPosition += avail / mRate;
          mRecordingSchedule.mLatencyCorrected = latencyCorrected;
@@ -2794,8 +2878,7 @@ void AudioIoCallback::UpdateTimePosition(unsigned long framesPerBuffer)
 void AudioIoCallback::DrainInputBuffers(
    constSamplePtr inputBuffer,
    unsigned long framesPerBuffer,
-   const PaStreamCallbackFlags statusFlags,
-   float * tempFloats
+   const PaStreamCallbackFlags statusFlags
 )
 {
    const auto numPlaybackChannels = mNumPlaybackChannels;
@@ -2825,9 +2908,8 @@ void AudioIoCallback::DrainInputBuffers(
    // So we have not decided to enable this extra detection yet in
    // production
 
-   size_t len = framesPerBuffer;
-   for(unsigned t = 0; t < numCaptureChannels; t++)
-      len = std::min( len, mCaptureBuffers[t]->AvailForPut() );
+   auto &captureBuffers = *mCaptureBuffers;
+   size_t len = std::min<size_t>(framesPerBuffer, captureBuffers.AvailForPut());
 
    if (mSimulateRecordingErrors && 100LL * rand() < RAND_MAX)
       // Make spurious errors for purposes of testing the error
@@ -2866,53 +2948,26 @@ void AudioIoCallback::DrainInputBuffers(
    if (len <= 0)
       return;
 
-   // We have an ASSERT in the AudioIO constructor to alert us to
-   // possible issues with the (short*) cast.  We'd have a problem if
-   // sizeof(short) > sizeof(float) since our buffers are sized for floats.
-   for(unsigned t = 0; t < numCaptureChannels; t++) {
-
-      // dmazzoni:
-      // Un-interleave.  Ugly special-case code required because the
-      // capture channels could be in three different sample formats;
-      // it'd be nice to be able to call CopySamples, but it can't
-      // handle multiplying by the gain and then clipping.  Bummer.
-
-      switch(mCaptureFormat) {
-         case floatSample: {
-            auto inputFloats = (const float *)inputBuffer;
-            for(unsigned i = 0; i < len; i++)
-               tempFloats[i] =
-                  inputFloats[numCaptureChannels*i+t];
-         } break;
-         case int24Sample:
-            // We should never get here. Audacity's int24Sample format
-            // is different from PortAudio's sample format and so we
-            // make PortAudio return float samples when recording in
-            // 24-bit samples.
-            wxASSERT(false);
-            break;
-         case int16Sample: {
-            auto inputShorts = (const short *)inputBuffer;
-            short *tempShorts = (short *)tempFloats;
-            for( unsigned i = 0; i < len; i++) {
-               float tmp = inputShorts[numCaptureChannels*i+t];
-               tmp = std::clamp(tmp, -32768.0f, 32767.0f);
-               tempShorts[i] = (short)(tmp);
-            }
-         } break;
-      } // switch
-
-      // JKC: mCaptureFormat must be for samples with sizeof(float) or
-      // fewer bytes (because tempFloats is sized for floats).  All
-      // formats are 2 or 4 bytes, so we are OK.
-      const auto put =
-         mCaptureBuffers[t]->Put(
-            (samplePtr)tempFloats, mCaptureFormat, len);
+   // Un-interleave each channel directly into the storage of the ring
+   // buffer, then publish all channels at once
+   if (mCaptureFormat == int24Sample) {
+      // We should never get here. Audacity's int24Sample format
+      // is different from PortAudio's sample format and so we
+      // make PortAudio return float samples when recording in
+      // 24-bit samples.
+      wxASSERT(false);
+      return;
+   }
+   const auto sampleSize = SAMPLE_SIZE(mCaptureFormat);
+   for (unsigned t = 0; t < numCaptureChannels; t++) {
+      const auto put = captureBuffers.Put(t,
+         (constSamplePtr)inputBuffer + t * sampleSize, mCaptureFormat, len,
+         0, numCaptureChannels);
       // wxASSERT(put == len);
       // but we can't assert in this thread
       wxUnusedVar(put);
-      mCaptureBuffers[t]->Flush();
    }
+   captureBuffers.Commit(len);
 }
 
 
@@ -3194,8 +3249,7 @@ int AudioIoCallback::AudioCallback(
    DrainInputBuffers(
       inputBuffer,
       framesPerBuffer,
-      statusFlags,
-      tempFloats);
+      statusFlags);
 
    SendVuOutputMeterData( outputMeterFloats, framesPerBuffer);
 
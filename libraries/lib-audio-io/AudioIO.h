@@ -32,6 +32,7 @@
 class wxArrayString;
 class AudioIOBase;
 class AudioIO;
+class MultiChannelRingBuffer;
 class RingBuffer;
 class Mixer;
 class OtherPlayableSequence;
@@ -213,8 +214,7 @@ public:
    void DrainInputBuffers(
       constSamplePtr inputBuffer, 
       unsigned long framesPerBuffer,
-      const PaStreamCallbackFlags statusFlags,
-      float * tempFloats
+      const PaStreamCallbackFlags statusFlags
    );
    void UpdateTimePosition(
       unsigned long framesPerBuffer
@@ -269,7 +269,8 @@ public:
    std::vector<std::unique_ptr<Resample>> mResample;
 
    using RingBuffers = std::vector<std::unique_ptr<RingBuffer>>;
-   RingBuffers mCaptureBuffers;
+   //! One buffer for all capture channels, committed together
+   std::unique_ptr<MultiChannelRingBuffer> mCaptureBuffers;
    RecordableSequences mCaptureSequences;
    /*! Read by worker threads but unchanging during playback */
    RingBuffers mPlaybackBuffers;
@@ -280,6 +281,8 @@ public:
    // Temporary buffers, each as large as the playback buffers
    std::vector<SampleBuffer> mScratchBuffers;
    std::vector<float *> mScratchPointers; //!< pointing into mScratchBuffers
+   //! Sets of scratch buffers, one for each thread that may process effects
+   size_t mNumScratchLanes{ 1 };
 
    std::vector<std::unique_ptr<Mixer>> mPlaybackMixers;
 
@@ -623,6 +626,11 @@ private:
    void FillPlayBuffers();
    void TransformPlayBuffers(
       std::optional<RealtimeEffects::ProcessingScope> &scope);
+   //! Part of TransformPlayBuffers for one sequence, which may be called in
+   //! a worker thread, using the scratch buffers of the given lane
+   void TransformSequenceBuffers(RealtimeEffects::ProcessingScope &scope,
+      const std::shared_ptr<const PlayableSequence> &vt,
+      size_t iBuffer, size_t iLane);
    bool ProcessPlaybackSlices(
       std::optional<RealtimeEffects::ProcessingScope> &pScope,
       size_t available);
@@ -0,0 +1,162 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MultiChannelRingBuffer.cpp
+
+*******************************************************************//*!
+
+\class MultiChannelRingBuffer
+\brief Holds streamed audio samples of many channels.
+
+  Like RingBuffer, this is a lock-free bounded queue for exactly one writing
+  thread and one reading thread, but with one start and one end position for
+  all of the channels.  Neither side ever waits for the other.
+
+  AvailForPut and AvailForGet may underestimate but will never
+  overestimate.
+
+*//*******************************************************************/
+
+#include "MultiChannelRingBuffer.h"
+#include "Dither.h"
+#include <algorithm>
+
+MultiChannelRingBuffer::MultiChannelRingBuffer(
+   sampleFormat format, unsigned nChannels, size_t size)
+   : mnChannels{ std::max(1u, nChannels) }
+   , mBufferSize{ std::max<size_t>(size, 64) }
+   , mFormat{ format }
+   , mBuffer{ mnChannels * mBufferSize, mFormat }
+{
+}
+
+MultiChannelRingBuffer::~MultiChannelRingBuffer()
+{
+}
+
+size_t MultiChannelRingBuffer::Filled(size_t start, size_t end) const
+{
+   return (end + mBufferSize - start) % mBufferSize;
+}
+
+size_t MultiChannelRingBuffer::Free(size_t start, size_t end) const
+{
+   // One position stays empty, so that a full buffer is not mistaken for an
+   // empty one
+   return mBufferSize - 1 - Filled(start, end);
+}
+
+samplePtr MultiChannelRingBuffer::Address(unsigned iChannel, size_t pos) const
+{
+   return mBuffer.ptr() +
+      (iChannel * mBufferSize + pos) * SAMPLE_SIZE(mFormat);
+}
+
+//
+// For the writer only:
+// Only the writer writes the end, so it can read it again relaxed.
+// And it reads the start written by the reader, with acquire order,
+// so that any reading done before Consume() happens-before any reuse of the
+// space.
+//
+
+size_t MultiChannelRingBuffer::AvailForPut() const
+{
+   auto start = mStart.load(std::memory_order_acquire);
+   auto end = mEnd.load(std::memory_order_relaxed);
+   return Free(start, end);
+}
+
+size_t MultiChannelRingBuffer::Put(unsigned iChannel,
+   constSamplePtr buffer, sampleFormat format, size_t samples,
+   size_t offset, unsigned srcStride)
+{
+   auto start = mStart.load(std::memory_order_acquire);
+   auto end = mEnd.load(std::memory_order_relaxed);
+   const auto free = Free(start, end);
+   offset = std::min(offset, free);
+   samples = std::min(samples, free - offset);
+   auto pos = (end + offset) % mBufferSize;
+   auto src = buffer;
+   size_t copied = 0;
+
+   while (samples) {
+      const auto block = std::min(samples, mBufferSize - pos);
+      CopySamples(src, format, Address(iChannel, pos), mFormat, block,
+         DitherType::none, srcStride, 1);
+      src += block * srcStride * SAMPLE_SIZE(format);
+      pos = (pos + block) % mBufferSize;
+      samples -= block;
+      copied += block;
+   }
+   return copied;
+}
+
+void MultiChannelRingBuffer::Commit(size_t samples)
+{
+   auto end = mEnd.load(std::memory_order_relaxed);
+   // Atomically update the end pointer with release, so the nonatomic writes
+   // just done to all of the channels don't get reordered after
+   mEnd.store((end + samples) % mBufferSize, std::memory_order_release);
+}
+
+//
+// For the reader only:
+// Only the reader writes the start, so it can read it again relaxed.
+// But it reads the end written by the writer, who also sends sample data
+// with the changes of end; therefore that must be read with acquire order.
+//
+
+size_t MultiChannelRingBuffer::AvailForGet() const
+{
+   auto end = mEnd.load(std::memory_order_acquire);
+   auto start = mStart.load(std::memory_order_relaxed);
+   return Filled(start, end);
+}
+
+auto MultiChannelRingBuffer::GetReadSpan(
+   unsigned iChannel, unsigned iBlock) const -> ConstSpan
+{
+   auto end = mEnd.load(std::memory_order_acquire);
+   auto start = mStart.load(std::memory_order_relaxed);
+   const auto filled = Filled(start, end);
+   const auto size0 = std::min(filled, mBufferSize - start);
+   if (iBlock == 0)
+      return { size0 ? Address(iChannel, start) : nullptr, size0 };
+   const auto size1 = filled - size0;
+   return { size1 ? Address(iChannel, 0) : nullptr, size1 };
+}
+
+size_t MultiChannelRingBuffer::Get(unsigned iChannel,
+   samplePtr buffer, sampleFormat format, size_t samples, size_t offset) const
+{
+   auto end = mEnd.load(std::memory_order_acquire);
+   auto start = mStart.load(std::memory_order_relaxed);
+   const auto filled = Filled(start, end);
+   offset = std::min(offset, filled);
+   samples = std::min(samples, filled - offset);
+   auto pos = (start + offset) % mBufferSize;
+   auto dest = buffer;
+   size_t copied = 0;
+
+   while (samples) {
+      const auto block = std::min(samples, mBufferSize - pos);
+      CopySamples(Address(iChannel, pos), mFormat, dest, format, block,
+         DitherType::none);
+      dest += block * SAMPLE_SIZE(format);
+      pos = (pos + block) % mBufferSize;
+      samples -= block;
+      copied += block;
+   }
+   return copied;
+}
+
+void MultiChannelRingBuffer::Consume(size_t samples)
+{
+   auto end = mEnd.load(std::memory_order_relaxed);
+   auto start = mStart.load(std::memory_order_relaxed);
+   samples = std::min(samples, Filled(start, end));
+   // Communicate to the writer, with release, that it may reuse the space
+   mStart.store((start + samples) % mBufferSize, std::memory_order_release);
+}
@@ -0,0 +1,92 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MultiChannelRingBuffer.h
+
+*******************************************************************/
+
+#ifndef __AUDACITY_MULTI_CHANNEL_RING_BUFFER__
+#define __AUDACITY_MULTI_CHANNEL_RING_BUFFER__
+
+#include "SampleFormat.h"
+#include <atomic>
+#include <utility>
+
+//! A RingBuffer for many channels that advance together
+/*!
+ All channels share one pair of positions, so the writer publishes a period
+ of every channel with one atomic store, and the reader consumes with one
+ more.  Each channel is contiguous in the storage, and the reader may work
+ directly in it through spans, which are at most two per channel because of
+ wrap-around.
+ */
+class AUDIO_IO_API MultiChannelRingBuffer final : public NonInterferingBase {
+public:
+   //! A contiguous extent of storage in one channel
+   using ConstSpan = std::pair<constSamplePtr, size_t>;
+
+   MultiChannelRingBuffer(
+      sampleFormat format, unsigned nChannels, size_t size);
+   ~MultiChannelRingBuffer();
+
+   unsigned Channels() const { return mnChannels; }
+   sampleFormat Format() const { return mFormat; }
+
+   //
+   // For the writer only:
+   //
+
+   size_t AvailForPut() const;
+   //! Copy uncommitted samples into one channel, after `offset` samples
+   //! already written to it in the same period
+   /*!
+    Does not apply dithering
+    @return how many were copied, limited by AvailForPut()
+    */
+   size_t Put(unsigned iChannel, constSamplePtr buffer, sampleFormat format,
+      size_t samples, size_t offset = 0, unsigned srcStride = 1);
+   //! Let the reader see `samples` more in every channel
+   /*!
+    @pre `samples <= AvailForPut()`
+    */
+   void Commit(size_t samples);
+
+   //
+   // For the reader only:
+   //
+
+   size_t AvailForGet() const;
+   //! Committed samples of a channel, not yet consumed
+   /*!
+    @param iBlock 0 or 1; the second block is empty unless the samples wrap
+    around
+    */
+   ConstSpan GetReadSpan(unsigned iChannel, unsigned iBlock) const;
+   //! Copy samples from one channel, starting `offset` samples after the
+   //! first unconsumed one, without consuming them
+   /*!
+    Does not apply dithering
+    @return how many were copied, limited by AvailForGet()
+    */
+   size_t Get(unsigned iChannel, samplePtr buffer, sampleFormat format,
+      size_t samples, size_t offset = 0) const;
+   //! Discard `samples` from every channel, letting the writer reuse the space
+   void Consume(size_t samples);
+
+private:
+   size_t Filled(size_t start, size_t end) const;
+   size_t Free(size_t start, size_t end) const;
+   samplePtr Address(unsigned iChannel, size_t pos) const;
+
+   // Align the two atomics to avoid false sharing
+   NonInterfering< std::atomic<size_t> > mStart{ 0 }, mEnd{ 0 };
+
+   const unsigned mnChannels;
+   const size_t mBufferSize;
+   const sampleFormat mFormat;
+   //! All channels, each of mBufferSize samples, one after another
+   const SampleBuffer mBuffer;
+};
+
+#endif
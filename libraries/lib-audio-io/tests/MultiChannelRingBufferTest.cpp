@@ -0,0 +1,197 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MultiChannelRingBufferTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "MultiChannelRingBuffer.h"
+
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr unsigned nChannels = 3;
+
+//! Sample n of channel c, exact in float while less than 2^24
+float Value(size_t n, unsigned c)
+{
+   return n * nChannels + c;
+}
+
+//! Put samples first to first + len - 1 of each channel, without committing
+size_t Put(MultiChannelRingBuffer& buffer, size_t first, size_t len)
+{
+   size_t put = 0;
+   std::vector<float> samples(len);
+   for (unsigned c = 0; c < nChannels; ++c) {
+      for (size_t ii = 0; ii < len; ++ii)
+         samples[ii] = Value(first + ii, c);
+      put = buffer.Put(c, reinterpret_cast<constSamplePtr>(samples.data()),
+         floatSample, len);
+   }
+   return put;
+}
+
+//! Whether the reader sees samples first to first + len - 1 of each channel,
+//! both copied and in spans
+bool Check(const MultiChannelRingBuffer& buffer, size_t first, size_t len)
+{
+   std::vector<float> samples(len);
+   for (unsigned c = 0; c < nChannels; ++c) {
+      if (buffer.Get(c, reinterpret_cast<samplePtr>(samples.data()),
+         floatSample, len) != len)
+         return false;
+      for (size_t ii = 0; ii < len; ++ii)
+         if (samples[ii] != Value(first + ii, c))
+            return false;
+
+      size_t ii = 0;
+      for (unsigned iBlock = 0; iBlock < 2; ++iBlock) {
+         const auto [ptr, size] = buffer.GetReadSpan(c, iBlock);
+         const auto floats = reinterpret_cast<const float*>(ptr);
+         for (size_t jj = 0; jj < size && ii < len; ++jj, ++ii)
+            if (floats[jj] != Value(first + ii, c))
+               return false;
+      }
+      if (ii != len)
+         return false;
+   }
+   return true;
+}
+}
+
+TEST_CASE("MultiChannelRingBuffer", "[MultiChannelRingBuffer]")
+{
+   // The least size
+   constexpr size_t size = 64;
+   MultiChannelRingBuffer buffer{ floatSample, nChannels, size };
+   REQUIRE(buffer.Channels() == nChannels);
+   REQUIRE(buffer.AvailForPut() == size - 1);
+   REQUIRE(buffer.AvailForGet() == 0);
+   REQUIRE(buffer.GetReadSpan(0, 0).second == 0);
+   REQUIRE(buffer.GetReadSpan(0, 1).second == 0);
+
+   SECTION("Wraps around")
+   {
+      size_t first = 0;
+      for (size_t ii = 0; ii < 20; ++ii) {
+         // Coprime with the size, so that the wrap falls everywhere
+         constexpr size_t len = 37;
+         REQUIRE(Put(buffer, first, len) == len);
+         // Uncommitted samples are invisible
+         REQUIRE(buffer.AvailForGet() == 0);
+         buffer.Commit(len);
+         REQUIRE(buffer.AvailForGet() == len);
+         REQUIRE(buffer.AvailForPut() == size - 1 - len);
+         const auto span0 = buffer.GetReadSpan(1, 0).second;
+         const auto span1 = buffer.GetReadSpan(1, 1).second;
+         REQUIRE(span0 + span1 == len);
+         REQUIRE((span1 > 0) == (first % size + len > size));
+         REQUIRE(Check(buffer, first, len));
+         buffer.Consume(len);
+         REQUIRE(buffer.AvailForGet() == 0);
+         first += len;
+      }
+   }
+
+   SECTION("Puts no more than there is room for")
+   {
+      REQUIRE(Put(buffer, 0, 100) == size - 1);
+      buffer.Commit(size - 1);
+      REQUIRE(buffer.AvailForPut() == 0);
+      REQUIRE(Put(buffer, size - 1, 10) == 0);
+      REQUIRE(Check(buffer, 0, size - 1));
+   }
+
+   SECTION("Puts and gets in parts")
+   {
+      // Three puts in one period, at offsets
+      std::vector<float> samples(10);
+      for (unsigned c = 0; c < nChannels; ++c)
+         for (size_t offset = 0; offset < 30; offset += 10) {
+            for (size_t ii = 0; ii < 10; ++ii)
+               samples[ii] = Value(offset + ii, c);
+            REQUIRE(buffer.Put(c, reinterpret_cast<constSamplePtr>(
+               samples.data()), floatSample, 10, offset) == 10);
+         }
+      buffer.Commit(30);
+      REQUIRE(Check(buffer, 0, 30));
+
+      // Gets at an offset do not consume
+      REQUIRE(buffer.Get(2, reinterpret_cast<samplePtr>(samples.data()),
+         floatSample, 10, 25) == 5);
+      REQUIRE(samples[0] == Value(25, 2));
+      REQUIRE(samples[4] == Value(29, 2));
+      REQUIRE(buffer.AvailForGet() == 30);
+
+      // Partial consumption
+      buffer.Consume(12);
+      REQUIRE(buffer.AvailForGet() == 18);
+      REQUIRE(Check(buffer, 12, 18));
+      // Can't consume more than there is
+      buffer.Consume(100);
+      REQUIRE(buffer.AvailForGet() == 0);
+      REQUIRE(buffer.AvailForPut() == size - 1);
+   }
+
+   SECTION("Converts formats and strides")
+   {
+      // Interleaved 16 bit samples, as from a device
+      std::vector<short> interleaved(nChannels * 20);
+      for (size_t ii = 0; ii < 20; ++ii)
+         for (unsigned c = 0; c < nChannels; ++c)
+            interleaved[ii * nChannels + c] = Value(ii, c);
+      for (unsigned c = 0; c < nChannels; ++c)
+         REQUIRE(buffer.Put(c, reinterpret_cast<constSamplePtr>(
+            interleaved.data() + c), int16Sample, 20, 0, nChannels) == 20);
+      buffer.Commit(20);
+      std::vector<short> shorts(20);
+      for (unsigned c = 0; c < nChannels; ++c) {
+         REQUIRE(buffer.Get(c, reinterpret_cast<samplePtr>(shorts.data()),
+            int16Sample, 20) == 20);
+         for (size_t ii = 0; ii < 20; ++ii)
+            REQUIRE(shorts[ii] == Value(ii, c));
+      }
+   }
+}
+
+TEST_CASE("MultiChannelRingBuffer with one writer and one reader thread",
+   "[MultiChannelRingBuffer]")
+{
+   MultiChannelRingBuffer buffer{ floatSample, nChannels, 1000 };
+   constexpr size_t total = 1 << 20;
+
+   std::thread writer{ [&]{
+      for (size_t first = 0, ii = 0; first < total; ++ii) {
+         const auto len = std::min({ total - first, 1 + ii % 97,
+            buffer.AvailForPut() });
+         if (len == 0) {
+            std::this_thread::yield();
+            continue;
+         }
+         Put(buffer, first, len);
+         buffer.Commit(len);
+         first += len;
+      }
+   } };
+
+   bool good = true;
+   // Keep consuming after a failure, so that the writer finishes
+   for (size_t first = 0, ii = 0; first < total; ++ii) {
+      const auto len = std::min(1 + ii % 131, buffer.AvailForGet());
+      if (len == 0) {
+         std::this_thread::yield();
+         continue;
+      }
+      good = Check(buffer, first, len) && good;
+      buffer.Consume(len);
+      first += len;
+   }
+   writer.join();
+   REQUIRE(good);
+   REQUIRE(buffer.AvailForGet() == 0);
+}
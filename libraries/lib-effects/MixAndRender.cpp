@@ -117,7 +117,9 @@ TrackListHolder MixAndRender(const TrackIterRange<const WaveTrack> &trackRange,
       // Throw to abort mix-and-render if read fails:
       true, warpOptions,
       startTime, endTime, mono ? 1 : 2, maxBlockLen, false,
-      rate, format);
+      rate, format, true, nullptr, true,
+      // Fetch and process the tracks concurrently:
+      true);
 
    using namespace BasicUI;
    auto updateResult = ProgressResult::Success;
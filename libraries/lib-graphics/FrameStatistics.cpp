@@ -112,6 +112,44 @@ FrameStatistics::GetSection(SectionID section) noexcept
    return fakeSection;
 }
 
+size_t FrameStatistics::CacheCounter::GetHits() const noexcept
+{
+   return mHits.load(std::memory_order_relaxed);
+}
+
+size_t FrameStatistics::CacheCounter::GetMisses() const noexcept
+{
+   return mMisses.load(std::memory_order_relaxed);
+}
+
+double FrameStatistics::CacheCounter::GetHitRate() const noexcept
+{
+   const auto hits = GetHits();
+   const auto total = hits + GetMisses();
+   return total > 0 ? double(hits) / total : 0.0;
+}
+
+void FrameStatistics::AddCacheLookups(
+   CacheID cache, size_t hits, size_t misses) noexcept
+{
+   if (cache < CacheID::Count)
+   {
+      auto& counter = GetInstance().mCacheCounters[size_t(cache)];
+      counter.mHits.fetch_add(hits, std::memory_order_relaxed);
+      counter.mMisses.fetch_add(misses, std::memory_order_relaxed);
+   }
+}
+
+const FrameStatistics::CacheCounter&
+FrameStatistics::GetCacheCounter(CacheID cache) noexcept
+{
+   if (cache < CacheID::Count)
+      return GetInstance().mCacheCounters[size_t(cache)];
+
+   static CacheCounter fakeCounter;
+   return fakeCounter;
+}
+
 Observer::Subscription
 FrameStatistics::Subscribe(UpdatePublisher::Callback callback)
 {
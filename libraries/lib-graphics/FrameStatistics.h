@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <functional>
@@ -46,6 +47,15 @@ public:
       Count
    };
 
+   //! ID of a cache whose hit rate is measured
+   enum class CacheID
+   {
+      //! Columns of the waveform of a clip
+      WaveformCache,
+      //! Number of the caches
+      Count
+   };
+
    //! A helper that notifies the view that a specific section has changed
    struct GRAPHICS_API UpdatePublisher : Observer::Publisher<SectionID>
    {
@@ -100,16 +110,37 @@ public:
       friend class FrameStatistics;
    };
 
+   //! Lookups in a cache, accumulated since startup
+   class GRAPHICS_API CacheCounter final
+   {
+   public:
+      size_t GetHits() const noexcept;
+      size_t GetMisses() const noexcept;
+      //! Fraction of lookups that were hits, or 0 if there were none
+      double GetHitRate() const noexcept;
+   private:
+      std::atomic<size_t> mHits { 0 };
+      std::atomic<size_t> mMisses { 0 };
+
+      friend class FrameStatistics;
+   };
+
    //! Create a Stopwatch for the section specified
    static Stopwatch CreateStopwatch(SectionID section) noexcept;
    //! Get the section data
    static const Section& GetSection(SectionID section) noexcept;
+   //! Count hits and misses of a cache; may be called from any thread
+   static void AddCacheLookups(
+      CacheID cache, size_t hits, size_t misses) noexcept;
+   //! Get the counts of lookups in a cache
+   static const CacheCounter& GetCacheCounter(CacheID cache) noexcept;
    //! Subscribe to sections update
    static Observer::Subscription Subscribe(UpdatePublisher::Callback callback);
 private:
    void AddEvent(SectionID section, Duration duration);
 
    Section mSections[size_t(SectionID::Count)];
+   CacheCounter mCacheCounters[size_t(CacheID::Count)];
 
    UpdatePublisher mUpdatePublisher;
 };
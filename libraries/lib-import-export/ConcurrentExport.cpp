@@ -0,0 +1,107 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ConcurrentExport.cpp
+
+**********************************************************************/
+#include "ConcurrentExport.h"
+
+#include "TaskPool.h"
+
+#include <memory>
+
+namespace ConcurrentExport
+{
+namespace
+{
+struct Running
+{
+   size_t index;
+   std::unique_ptr<ExportTask> pTask;
+   std::future<ExportResult> result;
+   //! Ready when the worker no longer uses the task
+   std::future<void> done;
+};
+}
+
+std::vector<std::optional<ExportResult>> Run(
+   size_t count, size_t maxConcurrent,
+   const TaskFactory& makeTask, const DelegateFactory& getDelegate,
+   const Poller& poll, std::vector<std::exception_ptr>& errors,
+   std::chrono::milliseconds pollInterval)
+{
+   std::vector<std::optional<ExportResult>> results(count);
+   errors.assign(count, nullptr);
+
+   auto& pool = TaskPool::Get();
+   if (maxConcurrent == 0)
+      maxConcurrent = pool.Concurrency();
+
+   std::vector<Running> running;
+   size_t next = 0;
+   bool starting = true;
+   while (true)
+   {
+      while (starting && next < count && running.size() < maxConcurrent)
+      {
+         const auto index = next++;
+         auto pTask = std::make_unique<ExportTask>();
+         try
+         {
+            *pTask = makeTask(index);
+         }
+         catch (...)
+         {
+            errors[index] = std::current_exception();
+         }
+         if (!pTask->valid())
+         {
+            results[index] = ExportResult::Error;
+            starting = false;
+            break;
+         }
+         auto result = pTask->get_future();
+         auto done = pool.Submit(
+            [&task = *pTask, &delegate = getDelegate(index)] {
+               task(delegate);
+            },
+            TaskPriority::High);
+         running.push_back(
+            { index, std::move(pTask), std::move(result), std::move(done) });
+      }
+      if (running.empty())
+         break;
+
+      bool anyFinished = false;
+      for (auto iter = running.begin(); iter != running.end();)
+      {
+         if (iter->done.wait_for(std::chrono::seconds(0)) !=
+             std::future_status::ready)
+         {
+            ++iter;
+            continue;
+         }
+         try
+         {
+            results[iter->index] = iter->result.get();
+         }
+         catch (...)
+         {
+            results[iter->index] = ExportResult::Error;
+            errors[iter->index] = std::current_exception();
+         }
+         // Destroys the task, and with it the processor and its file
+         iter = running.erase(iter);
+         anyFinished = true;
+      }
+
+      if (!poll(results))
+         starting = false;
+      if (!anyFinished && !running.empty())
+         running.front().done.wait_for(pollInterval);
+   }
+   return results;
+}
+}
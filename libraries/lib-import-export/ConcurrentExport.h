@@ -0,0 +1,52 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ConcurrentExport.h
+
+  @brief Runs the export tasks of several files in worker threads
+
+**********************************************************************/
+#pragma once
+
+#include "ExportTypes.h"
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace ConcurrentExport
+{
+//! Makes the task of a file, or an invalid task if that failed
+using TaskFactory = std::function<ExportTask(size_t index)>;
+//! Gives the delegate of the task of a file, which must outlive Run()
+using DelegateFactory = std::function<ExportProcessorDelegate&(size_t index)>;
+//! Called between checks for finished tasks, with the results so far; false
+//! stops starting tasks
+using Poller =
+   std::function<bool(const std::vector<std::optional<ExportResult>>&)>;
+
+//! Run count tasks in TaskPool workers, at most maxConcurrent at once, or as
+//! many as there are workers if zero
+/*!
+ Each task is made only when it can start, and destroyed as soon as it
+ finishes, so at most maxConcurrent exist at once; files that its processor
+ opens are open only meanwhile.  Making and destroying tasks, and polling,
+ happen in the calling thread.
+
+ Tasks start in order.  A task that can't be made, which has the result
+ Error, or polling that returns false, stops the starts, and Run() returns
+ when the started tasks finish.
+
+ @param errors receives the exception of each task, or of its making
+ @return the result of each task, empty for those that did not start
+ */
+IMPORT_EXPORT_API std::vector<std::optional<ExportResult>> Run(
+   size_t count, size_t maxConcurrent,
+   const TaskFactory& makeTask, const DelegateFactory& getDelegate,
+   const Poller& poll, std::vector<std::exception_ptr>& errors,
+   std::chrono::milliseconds pollInterval = std::chrono::milliseconds(50));
+}
@@ -41,7 +41,10 @@ std::unique_ptr<Mixer> ExportPluginHelpers::CreateMixer(const TrackList &tracks,
                   startTime, stopTime,
                   numOutChannels, outBufferSize, outInterleaved,
                   outRate, outFormat,
-                  true, mixerSpec);
+                  true, mixerSpec,
+                  true,
+                  // Fetch and process the tracks concurrently:
+                  true);
 }
 
 namespace
@@ -483,46 +483,11 @@ std::unique_ptr<ExtImportItem> Importer::CreateDefaultImportItem()
    return new_item;
 }
 
-// returns number of tracks imported
-bool Importer::Import( AudacityProject &project,
-                     const FilePath &fName,
-                     ImportProgressListener* importProgressListener,
-                     WaveTrackFactory *trackFactory,
-                     TrackHolders &tracks,
-                     Tags *tags,
-                     TranslatableString &errorMessage)
+std::vector<ImportPlugin*> Importer::GetImportPlugins(const FilePath &fName)
 {
-   AudacityProject *pProj = &project;
-   auto cleanup = valueRestorer( pProj->mbBusyImporting, true );
-
    const FileExtension extension{ fName.AfterLast(wxT('.')) };
 
-   // Always refuse to import MIDI, even though the FFmpeg plugin pretends to know how (but makes very bad renderings)
-#ifdef USE_MIDI
-   // MIDI files must be imported, not opened
-   if (FileNames::IsMidi(fName)) {
-      errorMessage = XO(
-"\"%s\" \nis a MIDI file, not an audio file. \nAudacity cannot open this type of file for playing, but you can\nedit it by clicking File > Import > MIDI.")
-         .Format( fName );
-      return false;
-   }
-#endif
-
-   // Bug #2647: Peter has a Word 2000 .doc file that is recognized and imported by FFmpeg.
-   if (wxFileName(fName).GetExt() == wxT("doc")) {
-      errorMessage =
-         XO("\"%s\" \nis a not an audio file. \nAudacity cannot open this type of file.")
-         .Format( fName );
-      return false;
-   }
-
-   using ImportPluginPtrs = std::vector< ImportPlugin* >;
-
-   // This list is used to call plugins in correct order
-   ImportPluginPtrs importPlugins;
-
-   // This list is used to remember plugins that should have been compatible with the file.
-   ImportPluginPtrs compatiblePlugins;
+   std::vector<ImportPlugin*> importPlugins;
 
    // Not implemented (yet?)
    wxString mime_type = wxT("*");
@@ -635,6 +600,82 @@ bool Importer::Import( AudacityProject &project,
       }
    }
 
+   return importPlugins;
+}
+
+std::unique_ptr<ImportFileHandle> Importer::Open(AudacityProject &project,
+   const FilePath &fName, ImportProgressListener &importProgressListener,
+   bool &declined)
+{
+   declined = false;
+   auto cleanup = valueRestorer( project.mbBusyImporting, true );
+
+   // Leave the messages for refused files to Import()
+#ifdef USE_MIDI
+   if (FileNames::IsMidi(fName))
+      return {};
+#endif
+   if (wxFileName(fName).GetExt() == wxT("doc"))
+      return {};
+
+   for (const auto plugin : GetImportPlugins(fName))
+   {
+      wxLogMessage(wxT("Opening with %s"),plugin->GetPluginStringID());
+      auto inFile = plugin->Open(fName, &project);
+      if ( (inFile != NULL) && (inFile->GetStreamCount() > 0) )
+      {
+         wxLogMessage(wxT("Open(%s) succeeded"), fName);
+         if (!importProgressListener.OnImportFileOpened(*inFile)) {
+            declined = true;
+            return {};
+         }
+         return inFile;
+      }
+   }
+   return {};
+}
+
+// returns number of tracks imported
+bool Importer::Import( AudacityProject &project,
+                     const FilePath &fName,
+                     ImportProgressListener* importProgressListener,
+                     WaveTrackFactory *trackFactory,
+                     TrackHolders &tracks,
+                     Tags *tags,
+                     TranslatableString &errorMessage)
+{
+   AudacityProject *pProj = &project;
+   auto cleanup = valueRestorer( pProj->mbBusyImporting, true );
+
+   const FileExtension extension{ fName.AfterLast(wxT('.')) };
+
+   // Always refuse to import MIDI, even though the FFmpeg plugin pretends to know how (but makes very bad renderings)
+#ifdef USE_MIDI
+   // MIDI files must be imported, not opened
+   if (FileNames::IsMidi(fName)) {
+      errorMessage = XO(
+"\"%s\" \nis a MIDI file, not an audio file. \nAudacity cannot open this type of file for playing, but you can\nedit it by clicking File > Import > MIDI.")
+         .Format( fName );
+      return false;
+   }
+#endif
+
+   // Bug #2647: Peter has a Word 2000 .doc file that is recognized and imported by FFmpeg.
+   if (wxFileName(fName).GetExt() == wxT("doc")) {
+      errorMessage =
+         XO("\"%s\" \nis a not an audio file. \nAudacity cannot open this type of file.")
+         .Format( fName );
+      return false;
+   }
+
+   using ImportPluginPtrs = std::vector< ImportPlugin* >;
+
+   // This list is used to call plugins in correct order
+   const auto importPlugins = GetImportPlugins(fName);
+
+   // This list is used to remember plugins that should have been compatible with the file.
+   ImportPluginPtrs compatiblePlugins;
+
    ImportProgressResultProxy importResultProxy(importProgressListener);
    
    // Try the import plugins, in the permuted sequences just determined
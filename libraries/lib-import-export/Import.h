@@ -27,6 +27,7 @@ class WaveTrackFactory;
 class Track;
 class TrackList;
 class ImportPlugin;
+class ImportFileHandle;
 class ImportProgressListener;
 class UnusableImportPlugin;
 typedef bool (*progress_callback_t)( void *userData, float percent );
@@ -178,7 +179,25 @@ public:
               Tags *tags,
               TranslatableString &errorMessage);
 
+   //! Open a file with the first plug-in that accepts it, for import later
+   /*!
+    Call in the main thread:  the listener's OnImportFileOpened may ask the
+    user to choose streams.  The handle's Import may then run in another
+    thread, if the project's sample block factory allows concurrent creation
+    of blocks.
+    @param declined set if the listener declined to import the file
+    @return null if the listener declined or no plug-in opened the file;
+    Import() may then explain the failure
+    */
+   std::unique_ptr<ImportFileHandle> Open( AudacityProject &project,
+              const FilePath &fName,
+              ImportProgressListener &importProgressListener,
+              bool &declined);
+
 private:
+   //! Plug-ins to try for the file, in order of preference
+   std::vector<ImportPlugin*> GetImportPlugins(const FilePath &fName);
+
    struct Traits : Registry::DefaultTraits {
       using LeafTypes = List<ImporterItem>;
    };
@@ -47,6 +47,7 @@ but little else.
 
 
 
+#include <atomic>
 #include <memory>
 #include "Identifier.h"
 #include "Internat.h"
@@ -151,16 +152,21 @@ public:
                        TrackHolders &outTracks,
                        Tags *tags) = 0;
 
+   //! Request that Import() discard what it imported, and return soon
+   /*! May be called from another thread than the one importing; the import
+    loop checks the request between steps */
    virtual void Cancel() = 0;
    
+   //! Request that Import() keep what it imported so far, and return soon
+   /*! May be called from another thread than the one importing */
    virtual void Stop() = 0;
 };
 
 class IMPORT_EXPORT_API ImportFileHandleEx : public ImportFileHandle
 {
    FilePath mFilename;
-   bool mCancelled{false};
-   bool mStopped{false};
+   std::atomic<bool> mCancelled{false};
+   std::atomic<bool> mStopped{false};
 public:
    ImportFileHandleEx(const FilePath& filename);
    
@@ -16,10 +16,33 @@
 #include "QualitySettings.h"
 #include "BasicUI.h"
 
+#include <atomic>
+#include <type_traits>
+#include <wx/thread.h>
+
+namespace {
+//! The format read by the FormatPreferenceScope that exists, or zero
+std::atomic<std::underlying_type_t<sampleFormat>> sDefaultFormat{ 0 };
+}
+
+ImportUtils::FormatPreferenceScope::FormatPreferenceScope()
+{
+   sDefaultFormat = static_cast<std::underlying_type_t<sampleFormat>>(
+      QualitySettings::SampleFormatChoice());
+}
+
+ImportUtils::FormatPreferenceScope::~FormatPreferenceScope()
+{
+   sDefaultFormat = 0;
+}
+
 sampleFormat ImportUtils::ChooseFormat(sampleFormat effectiveFormat)
 {
    // Consult user preference
-   auto defaultFormat = QualitySettings::SampleFormatChoice();
+   const auto snapshot = sDefaultFormat.load();
+   auto defaultFormat = snapshot
+      ? static_cast<sampleFormat>(snapshot)
+      : QualitySettings::SampleFormatChoice();
 
    // Don't choose format narrower than effective or default
    auto format = std::max(effectiveFormat, defaultFormat);
@@ -42,6 +65,10 @@ ImportUtils::NewWaveTrack(WaveTrackFactory &trackFactory,
 
 void ImportUtils::ShowMessageBox(const TranslatableString &message, const TranslatableString& caption)
 {
+   if (!wxIsMainThread()) {
+      BasicUI::CallAfter([message, caption]{ ShowMessageBox(message, caption); });
+      return;
+   }
    BasicUI::ShowMessageBox(message,
                            BasicUI::MessageBoxOptions().Caption(caption));
 }
@@ -30,6 +30,18 @@ class WaveChannel;
 class IMPORT_EXPORT_API ImportUtils final
 {
 public:
+
+   //! While it exists, ChooseFormat() uses the preference as it was read at
+   //! construction, so that import handles may run in worker threads, which
+   //! must not read preferences
+   class IMPORT_EXPORT_API FormatPreferenceScope final
+   {
+   public:
+      FormatPreferenceScope();
+      ~FormatPreferenceScope();
+      FormatPreferenceScope(const FormatPreferenceScope&) = delete;
+      FormatPreferenceScope &operator=(const FormatPreferenceScope&) = delete;
+   };
    
    //! Choose appropriate format, which will not be narrower than the specified one
    static sampleFormat ChooseFormat(sampleFormat effectiveFormat);
@@ -39,6 +51,8 @@ public:
    static TrackListHolder NewWaveTrack(WaveTrackFactory &trackFactory, unsigned nChannels,
       sampleFormat effectiveFormat, double rate);
    
+   //! If called in another thread, the message is shown later in the main
+   //! thread
    static void ShowMessageBox(const TranslatableString& message, const TranslatableString& caption = XO("Import Project"));
 
    //! Iterates over channels in each wave track from the list
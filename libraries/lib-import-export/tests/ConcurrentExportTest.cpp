@@ -0,0 +1,156 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ConcurrentExportTest.cpp
+
+**********************************************************************/
+#include "ConcurrentExport.h"
+#include "ExportPlugin.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+//! Stands for an initialized processor, with its open file
+struct Processor
+{
+   Processor(std::atomic<int>& alive, std::atomic<int>& maxAlive)
+       : mAlive { alive }
+       , mOwner { std::this_thread::get_id() }
+   {
+      const auto now = ++mAlive;
+      auto max = maxAlive.load();
+      while (now > max && !maxAlive.compare_exchange_weak(max, now))
+         ;
+   }
+   ~Processor()
+   {
+      --mAlive;
+      if (std::this_thread::get_id() != mOwner)
+         destroyedElsewhere = true;
+   }
+
+   std::atomic<int>& mAlive;
+   const std::thread::id mOwner;
+   static std::atomic<bool> destroyedElsewhere;
+};
+std::atomic<bool> Processor::destroyedElsewhere { false };
+
+class NullDelegate final : public ExportProcessorDelegate
+{
+public:
+   bool IsCancelled() const override { return false; }
+   bool IsStopped() const override { return false; }
+   void SetStatusString(const TranslatableString&) override { }
+   void OnProgress(double) override { }
+};
+
+constexpr auto pollInterval = std::chrono::milliseconds(1);
+} // namespace
+
+TEST_CASE("ConcurrentExport")
+{
+   NullDelegate delegate;
+   const auto getDelegate = [&](size_t) -> ExportProcessorDelegate& {
+      return delegate;
+   };
+   std::atomic<int> alive { 0 };
+   std::atomic<int> maxAlive { 0 };
+   const auto makeTask = [&](size_t) {
+      auto pProcessor = std::make_shared<Processor>(alive, maxAlive);
+      return ExportTask([pProcessor](ExportProcessorDelegate&) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(2));
+         return ExportResult::Success;
+      });
+   };
+   const auto always = [](const auto&) { return true; };
+   std::vector<std::exception_ptr> errors;
+
+   SECTION("makes at most so many tasks at once")
+   {
+      for (const size_t maxConcurrent : { 1u, 2u, 5u })
+      {
+         alive = 0;
+         maxAlive = 0;
+         Processor::destroyedElsewhere = false;
+         constexpr size_t count = 20;
+         const auto results = ConcurrentExport::Run(
+            count, maxConcurrent, makeTask, getDelegate, always, errors,
+            pollInterval);
+         REQUIRE(results.size() == count);
+         for (const auto& result : results)
+            REQUIRE(result == ExportResult::Success);
+         // The calling thread makes up to the limit before any task runs
+         REQUIRE(maxAlive == maxConcurrent);
+         REQUIRE(alive == 0);
+         REQUIRE(!Processor::destroyedElsewhere);
+      }
+   }
+
+   SECTION("never makes more tasks than files")
+   {
+      const auto results = ConcurrentExport::Run(
+         3, 8, makeTask, getDelegate, always, errors, pollInterval);
+      REQUIRE(maxAlive == 3);
+      REQUIRE(alive == 0);
+   }
+
+   SECTION("polling that fails stops the starts")
+   {
+      const auto results = ConcurrentExport::Run(
+         20, 2, makeTask, getDelegate, [](const auto&) { return false; },
+         errors, pollInterval);
+      // Those made before the first poll run to the end, in order
+      REQUIRE(results[0] == ExportResult::Success);
+      REQUIRE(results[1] == ExportResult::Success);
+      for (size_t i = 2; i < results.size(); ++i)
+         REQUIRE(!results[i]);
+      REQUIRE(alive == 0);
+   }
+
+   SECTION("a task that can't be made stops the starts")
+   {
+      const auto results = ConcurrentExport::Run(
+         10, 2,
+         [&](size_t index) {
+            if (index == 3)
+               throw std::runtime_error { "can't open the file" };
+            return makeTask(index);
+         },
+         getDelegate, always, errors, pollInterval);
+      for (size_t i = 0; i < 3; ++i)
+         REQUIRE(results[i] == ExportResult::Success);
+      REQUIRE(results[3] == ExportResult::Error);
+      REQUIRE(errors[3] != nullptr);
+      for (size_t i = 4; i < results.size(); ++i)
+         REQUIRE(!results[i]);
+      REQUIRE(alive == 0);
+   }
+
+   SECTION("exceptions of tasks are errors")
+   {
+      const auto results = ConcurrentExport::Run(
+         4, 2,
+         [](size_t index) {
+            return ExportTask([index](ExportProcessorDelegate&) {
+               if (index == 1)
+                  throw std::runtime_error { "disk full" };
+               return ExportResult::Success;
+            });
+         },
+         getDelegate, always, errors, pollInterval);
+      REQUIRE(results[0] == ExportResult::Success);
+      REQUIRE(results[1] == ExportResult::Error);
+      REQUIRE(errors[1] != nullptr);
+      REQUIRE(errors[0] == nullptr);
+      REQUIRE(results[2] == ExportResult::Success);
+      REQUIRE(results[3] == ExportResult::Success);
+   }
+}
@@ -39,12 +39,14 @@ and get deterministic behaviour.
 
 #include "Internat.h"
 #include "Prefs.h"
+#include "SampleConversion.h"
 
 // Erik de Castro Lopo's header file that
 // makes sure that we have lrint and lrintf
 // (Note: this file should be included first)
 #include "float_cast.h"
 
+#include <algorithm>
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
@@ -63,12 +65,8 @@ constexpr int BUF_MASK = 7;
 // Lipshitz's minimally audible FIR
 const float SHAPED_BS[] = { 2.033f, -2.165f, 1.959f, -1.590f, 0.6149f };
 
-// Dither state
-struct State {
-    int mPhase;
-    float mTriangleState;
-    float mBuffer[8 /* = BUF_SIZE */];
-} mState;
+using State = Dither::State;
+static_assert(sizeof(State::mBuffer) == BUF_SIZE * sizeof(float));
 
 using Ditherer = float (*)(State &, float);
 
@@ -138,6 +136,11 @@ static inline void DITHER_TO_INT24(Ditherer dither, State &state,
 
 // Implement one single dither step
 
+static inline float NoDither(State &, float sample);
+static inline float RectangleDither(State &, float sample);
+static inline float TriangleDither(State &state, float sample);
+static inline float ShapedDither(State &state, float sample);
+
 // Implement a dithering loop
 template<typename srcType, typename dstType>
 static inline void DITHER_LOOP( Ditherer dither, State &state,
@@ -157,13 +160,53 @@ static inline void DITHER_LOOP( Ditherer dither, State &state,
         }
 }
 
+// Implement a dither of non-interleaved buffers, a block at a time through
+// a scratch buffer, so that loading, scaling and storing are vectorized, and
+// only the ditherer itself runs sample by sample.  The results are the same
+// as from DITHER_LOOP.
+static void DITHER_CONTIGUOUS( Ditherer dither, State &state,
+   samplePtr dst, sampleFormat dstFormat,
+   constSamplePtr src, sampleFormat srcFormat, size_t len)
+{
+    constexpr size_t blockSize = 256;
+    float buffer[blockSize];
+    const auto scale =
+        (dstFormat == int16Sample) ? CONVERT_DIV16 : CONVERT_DIV24;
+    for (size_t done = 0; done < len;) {
+        const auto n = std::min(blockSize, len - done);
+        if (srcFormat == int24Sample)
+            // Scaling by a power of two is exact, so one multiplication
+            // agrees with FROM_INT24 followed by another
+            SampleConversion::Int24ToFloat(
+                reinterpret_cast<const int *>(src) + done, buffer, n,
+                scale / CONVERT_DIV24);
+        else
+            SampleConversion::ClipAndScale(
+                reinterpret_cast<const float *>(src) + done, buffer, n, scale);
+        if (dither != NoDither)
+            for (size_t ii = 0; ii < n; ++ii)
+                buffer[ii] = dither(state, buffer[ii]);
+        if (dstFormat == int16Sample)
+            SampleConversion::FloatToInt16(
+                buffer, reinterpret_cast<short *>(dst) + done, n);
+        else
+            SampleConversion::FloatToInt24(
+                buffer, reinterpret_cast<int *>(dst) + done, n);
+        done += n;
+    }
+}
+
 // Implement a dither. There are only 3 cases where we must dither,
 // in all other cases, no dithering is necessary.
 static inline void DITHER( Ditherer dither, State &state,
    samplePtr dst, sampleFormat dstFormat, size_t dstStride,
    constSamplePtr src, sampleFormat srcFormat, size_t srcStride, size_t len)
 {
-    if (srcFormat == int24Sample && dstFormat == int16Sample)
+    const bool supported = (srcFormat == int24Sample && dstFormat == int16Sample)
+        || (srcFormat == floatSample && dstFormat != floatSample);
+    if (supported && srcStride == 1 && dstStride == 1)
+        DITHER_CONTIGUOUS(dither, state, dst, dstFormat, src, srcFormat, len);
+    else if (srcFormat == int24Sample && dstFormat == int16Sample)
         DITHER_LOOP<int, short>(dither, state,
             DITHER_TO_INT16, FROM_INT24, dst,
             int16Sample, dstStride, src, int24Sample, srcStride, len);
@@ -179,11 +222,6 @@ static inline void DITHER( Ditherer dither, State &state,
 }
 
 
-static inline float NoDither(State &, float sample);
-static inline float RectangleDither(State &, float sample);
-static inline float TriangleDither(State &state, float sample);
-static inline float ShapedDither(State &state, float sample);
-
 Dither::Dither()
 {
     // On startup, initialize dither by resetting values
@@ -246,11 +284,8 @@ void Dither::Apply(enum DitherType ditherType,
         {
             if (sourceFormat == floatSample)
             {
-                auto d = (float*)dest;
-                auto s = (const float*)source;
-
-                for (i = 0; i < len; i++, d += destStride, s += sourceStride)
-                    *d = *s;
+                SampleConversion::CopyFloats((const float*)source,
+                    sourceStride, (float*)dest, destStride, len);
             } else
             if (sourceFormat == int24Sample)
             {
@@ -278,12 +313,23 @@ void Dither::Apply(enum DitherType ditherType,
         // No clipping should be necessary.
         auto d = (float*)dest;
 
+        if (sourceFormat == int16Sample && sourceStride == 1 && destStride == 1)
+        {
+            // Multiplying by the inverse power of two is exact, as is FROM_INT16
+            SampleConversion::Int16ToFloat(
+                (const short*)source, d, len, 1.0f / CONVERT_DIV16);
+        } else
         if (sourceFormat == int16Sample)
         {
             auto s = (const short*)source;
             for (i = 0; i < len; i++, d += destStride, s += sourceStride)
                 *d = FROM_INT16(s);
         } else
+        if (sourceFormat == int24Sample && sourceStride == 1 && destStride == 1)
+        {
+            SampleConversion::Int24ToFloat(
+                (const int*)source, d, len, 1.0f / CONVERT_DIV24);
+        } else
         if (sourceFormat == int24Sample)
         {
             auto s = (const int*)source;
@@ -298,8 +344,11 @@ void Dither::Apply(enum DitherType ditherType,
         // Special case when promoting 16 bit to 24 bit
         auto d = (int*)dest;
         auto s = (const short*)source;
-        for (i = 0; i < len; i++, d += destStride, s += sourceStride)
-            *d = ((int)*s) << 8;
+        if (sourceStride == 1 && destStride == 1)
+            SampleConversion::Int16ToInt24(s, d, len);
+        else
+            for (i = 0; i < len; i++, d += destStride, s += sourceStride)
+                *d = ((int)*s) << 8;
     } else
     {
         // We must do dithering
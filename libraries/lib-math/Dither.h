@@ -44,6 +44,16 @@ public:
                unsigned int len,
                unsigned int sourceStride = 1,
                unsigned int destStride = 1);
+
+    //! Dither state, carried from sample to sample and call to call
+    struct State {
+        int mPhase;
+        float mTriangleState;
+        float mBuffer[8];
+    };
+
+private:
+    State mState;
 };
 
 #endif /* __AUDACITY_DITHER_H__ */
@@ -0,0 +1,593 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  NoiseReducer.cpp
+
+  Dominic Mazzoni
+
+  detailed rewriting by
+  Paul Licameli
+
+  split from src/effects/NoiseReduction.cpp
+
+**********************************************************************/
+
+#include "NoiseReducer.h"
+
+#include "FFT.h"
+#include "MemoryX.h"
+#include "SpectrumTransformer.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <future>
+
+namespace {
+// magic number used only in the old statistics
+// and the old discrimination
+const float minSignalTime = 0.05f;
+
+//! Samples read at once from a Reader
+constexpr size_t bufferSize = 65536;
+}
+
+struct NoiseReducer::Transformer final : SpectrumTransformer {
+   Transformer(NoiseReducer &reducer, bool needsOutput,
+      bool leadingPadding, bool trailingPadding
+   )  : SpectrumTransformer{ needsOutput,
+         reducer.mInWindowType, reducer.mOutWindowType,
+         reducer.mSettings.WindowSize(), reducer.mSettings.StepsPerWindow(),
+         leadingPadding, trailingPadding
+      }
+      , mReducer{ reducer }
+      , mFreqSmoothingScratch(reducer.mSettings.SpectrumSize())
+   {
+   }
+   struct MyWindow : public Window
+   {
+      explicit MyWindow(size_t windowSize)
+         : Window{ windowSize }
+         , mSpectrums(windowSize / 2 + 1)
+         , mGains(windowSize / 2 + 1)
+      {}
+      ~MyWindow() override;
+
+      FloatVector mSpectrums;
+      FloatVector mGains;
+   };
+
+   MyWindow &NthWindow(int nn) { return static_cast<MyWindow&>(Nth(nn)); }
+   std::unique_ptr<Window> NewWindow(size_t windowSize) override;
+   bool DoStart() override;
+   void DoOutput(const float *outBuffer, size_t mStepSize) override;
+   bool DoFinish() override;
+
+   //! Invokes Start(), ProcessSamples(), and Finish()
+   bool Process(size_t queueLength, const Reader &reader,
+      sampleCount start, sampleCount len);
+
+   NoiseReducer &mReducer;
+   FloatVector mFreqSmoothingScratch;
+
+   //! If not null, gather statistics, and report each window here
+   std::function<bool()> mOnProfileWindow;
+
+   // Following are for segments of a selection, processed in parallel:
+
+   Writer mWriter;
+   //! Output samples that only primed the history, to discard
+   sampleCount mSkip = 0;
+   //! Output samples to keep after those; the rest belong to the next segment
+   sampleCount mKeep = sampleCount::max();
+   //! Count windows here, and the caller updates the progress
+   std::atomic<size_t> *mpWindowCount = nullptr;
+   const std::atomic<bool> *mpCancelled = nullptr;
+};
+
+auto NoiseReducer::Transformer::NewWindow(size_t windowSize)
+   -> std::unique_ptr<Window>
+{
+   return std::make_unique<MyWindow>(windowSize);
+}
+
+NoiseReducer::Transformer::MyWindow::~MyWindow()
+{
+}
+
+bool NoiseReducer::Transformer::DoStart()
+{
+   for (size_t ii = 0, nn = TotalQueueSize(); ii < nn; ++ii) {
+      MyWindow &record = NthWindow(ii);
+      std::fill(record.mSpectrums.begin(), record.mSpectrums.end(), 0.0);
+      std::fill(record.mGains.begin(), record.mGains.end(),
+         mReducer.mNoiseAttenFactor);
+   }
+   return SpectrumTransformer::DoStart();
+}
+
+void NoiseReducer::Transformer::DoOutput(
+   const float *outBuffer, size_t mStepSize)
+{
+   // Segments start and end at multiples of the step size
+   if (mSkip > 0) {
+      mSkip -= mStepSize;
+      return;
+   }
+   const auto len = limitSampleBufferSize(mStepSize, mKeep);
+   if (len > 0) {
+      mKeep -= len;
+      mWriter(outBuffer, len);
+   }
+}
+
+bool NoiseReducer::Transformer::DoFinish()
+{
+   if (mOnProfileWindow)
+      mReducer.FinishTrackStatistics();
+   return SpectrumTransformer::DoFinish();
+}
+
+bool NoiseReducer::Transformer::Process(size_t queueLength,
+   const Reader &reader, sampleCount start, sampleCount len)
+{
+   if (!Start(queueLength))
+      return false;
+
+   FloatVector buffer(bufferSize);
+   bool bLoopSuccess = true;
+   for (sampleCount pos = 0; bLoopSuccess && pos < len;) {
+      const auto blockSize = limitSampleBufferSize(bufferSize, len - pos);
+      reader(buffer.data(), start + pos, blockSize);
+      pos += blockSize;
+      bLoopSuccess = ProcessSamples(Processor, buffer.data(), blockSize);
+   }
+
+   if (!Finish(Processor))
+      return false;
+
+   return bLoopSuccess;
+}
+
+NoiseReducer::NoiseReducer(const Settings &settings, Statistics &statistics,
+   eWindowFunctions inWindowType, eWindowFunctions outWindowType)
+: mSettings{ settings }
+, mStatistics{ statistics }
+, mInWindowType{ inWindowType }
+, mOutWindowType{ outWindowType }
+
+, mFreqSmoothingBins{ size_t(std::max(0.0, settings.mFreqSmoothingBands)) }
+
+// Sensitivity setting is a base 10 log, turn it into a natural log
+, mNewSensitivity{ settings.mNewSensitivity * log(10.0) }
+{
+   assert(mSettings.WindowSize() == mStatistics.mWindowSize);
+   const auto sampleRate = mStatistics.mRate;
+
+   const double noiseGain = -settings.mNoiseGain;
+   const unsigned nAttackBlocks =
+      1 + (int)(settings.mAttackTime * sampleRate / mSettings.StepSize());
+   const unsigned nReleaseBlocks = mNReleaseBlocks =
+      1 + (int)(settings.mReleaseTime * sampleRate / mSettings.StepSize());
+   // Applies to amplitudes, divide by 20:
+   mNoiseAttenFactor = DB_TO_LINEAR(noiseGain);
+   // Apply to gain factors which apply to amplitudes, divide by 20:
+   mOneBlockAttack = DB_TO_LINEAR(noiseGain / nAttackBlocks);
+   mOneBlockRelease = DB_TO_LINEAR(noiseGain / nReleaseBlocks);
+
+   mNWindowsToExamine = (mSettings.mMethod == DM_OLD_METHOD)
+      ? std::max(2, (int)(minSignalTime * sampleRate / mSettings.StepSize()))
+      : 1 + mSettings.StepsPerWindow();
+
+   mCenter = mNWindowsToExamine / 2;
+   assert(mCenter >= 1); // release depends on this assumption
+
+   // Allow long enough queue for sufficient inspection of the middle
+   // and for attack processing
+   // See ReduceNoise()
+   mHistoryLen = std::max(mNWindowsToExamine, mCenter + nAttackBlocks);
+}
+
+NoiseReducer::~NoiseReducer()
+{
+}
+
+bool NoiseReducer::Profile(const Reader &reader, sampleCount len,
+   const ProgressReporter &progress)
+{
+   // Without padding, fewer windows than steps in the data are visited
+   const auto extra =
+      (mSettings.StepsPerWindow() - 1) * mSettings.SpectrumSize();
+   const auto denominator = (len - extra).as_double();
+   sampleCount windowCount = 0;
+
+   // Gathering statistics makes no output
+   Transformer transformer{ *this, false, false, false };
+   transformer.mOnProfileWindow = [&]{
+      return progress(std::min(1.0,
+         ((++windowCount).as_double() * mSettings.StepSize()) / denominator));
+   };
+   return transformer.Process(1, reader, 0, len);
+}
+
+bool NoiseReducer::Reduce(const std::vector<Reader> &readers,
+   sampleCount len, const WriterFactory &makeWriter,
+   const ProgressReporter &progress, size_t nSegments)
+{
+   // Gains of a window depend on windows that follow it by no more than the
+   // history length, and on windows that precede it, through the release
+   // curve, by no more than the release time, after which that curve falls
+   // below mNoiseAttenFactor.  So a segment that begins that many windows
+   // early, and ends that many late, computes the same gains as one pass
+   // over the whole selection.  Overlap-add of each output step sums the
+   // same windows in the same order, so the output samples are identical.
+   const auto stepSize = mSettings.StepSize();
+   const auto stepsPerWindow = mSettings.StepsPerWindow();
+   const sampleCount leadSteps = mHistoryLen + mNWindowsToExamine
+      + mNReleaseBlocks + 2 * stepsPerWindow;
+   const sampleCount trailSteps = mHistoryLen + stepsPerWindow + 1;
+
+   auto &pool = TaskPool::Get();
+   const auto nChannels = readers.size();
+   const auto nSteps = (len + stepSize - 1) / stepSize;
+   if (nSegments == 0) {
+      // Keep the overhead of the extra windows small
+      const auto minSegmentSteps = 8 * (leadSteps + trailSteps);
+      const auto maxSegments = std::max<size_t>(1,
+         (2 * pool.Concurrency() + nChannels - 1) / std::max<size_t>(1, nChannels));
+      nSegments = std::clamp<sampleCount>(
+         nSteps / minSegmentSteps, 1, maxSegments).as_size_t();
+   }
+   const auto segmentLen = ((nSteps + nSegments - 1) / nSegments) * stepSize;
+
+   struct Segment {
+      const Reader *pReader;
+      Writer writer;
+      sampleCount begin, end;
+   };
+   std::vector<Segment> segments;
+   for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
+      for (size_t ii = 0; ii < nSegments; ++ii) {
+         const auto begin = segmentLen * ii;
+         if (begin >= len)
+            break;
+         segments.push_back({ &readers[iChannel], makeWriter(iChannel, ii),
+            begin, std::min(len, begin + segmentLen) });
+      }
+   }
+
+   const auto inputStart = [&](const Segment &segment) {
+      return std::max<sampleCount>(0, segment.begin - leadSteps * stepSize);
+   };
+   const auto inputEnd = [&](const Segment &segment) {
+      return std::min(len, segment.end + trailSteps * stepSize);
+   };
+   sampleCount totalInput = 0;
+   for (auto &segment : segments)
+      totalInput += inputEnd(segment) - inputStart(segment);
+
+   std::atomic<size_t> windowCount{ 0 };
+   std::atomic<bool> cancelled{ false };
+   std::vector<std::future<bool>> results;
+   auto wait = finally([&]{
+      // Don't leave workers using the segments, even if this thread throws
+      cancelled = true;
+      for (auto &result : results)
+         if (result.valid())
+            result.wait();
+   });
+   for (auto &segment : segments)
+      results.push_back(pool.Submit([&, &segment = segment]{
+         const auto start = inputStart(segment);
+         const auto end = inputEnd(segment);
+         Transformer transformer{ *this, true, true, end == len };
+         transformer.mWriter = segment.writer;
+         transformer.mSkip = segment.begin - start;
+         // Drop the tail of the padding too, after the last segment
+         transformer.mKeep = segment.end - segment.begin;
+         transformer.mpWindowCount = &windowCount;
+         transformer.mpCancelled = &cancelled;
+         return transformer.Process(
+            mHistoryLen, *segment.pReader, start, end - start);
+      }, TaskPriority::High));
+
+   for (auto &result : results) {
+      while (result.wait_for(std::chrono::milliseconds(50)) !=
+         std::future_status::ready) {
+         const auto fraction = std::min(1.0,
+            (windowCount * stepSize) / totalInput.as_double());
+         if (!progress(fraction))
+            cancelled = true;
+      }
+   }
+   bool success = !cancelled;
+   for (auto &result : results)
+      // Rethrow any exception
+      success = result.get() && success;
+   return success;
+}
+
+void NoiseReducer::ApplyFreqSmoothing(
+   FloatVector &gains, FloatVector &scratch) const
+{
+   // Given an array of gain mutipliers, average them
+   // GEOMETRICALLY.  Don't multiply and take nth root --
+   // that may quickly cause underflows.  Instead, average the logs.
+
+   if (mFreqSmoothingBins == 0)
+      return;
+
+   const auto spectrumSize = mSettings.SpectrumSize();
+
+   {
+      auto pScratch = scratch.data();
+      std::fill(pScratch, pScratch + spectrumSize, 0.0f);
+   }
+
+   for (size_t ii = 0; ii < spectrumSize; ++ii)
+      gains[ii] = log(gains[ii]);
+
+   // ii must be signed
+   for (int ii = 0; ii < (int)spectrumSize; ++ii) {
+      const int j0 = std::max(0, ii - (int)mFreqSmoothingBins);
+      const int j1 = std::min(spectrumSize - 1, ii + mFreqSmoothingBins);
+      for(int jj = j0; jj <= j1; ++jj) {
+         scratch[ii] += gains[jj];
+      }
+      scratch[ii] /= (j1 - j0 + 1);
+   }
+
+   for (size_t ii = 0; ii < spectrumSize; ++ii)
+      gains[ii] = exp(scratch[ii]);
+}
+
+bool NoiseReducer::Processor(SpectrumTransformer &trans)
+{
+   auto &transformer = static_cast<Transformer &>(trans);
+   auto &reducer = transformer.mReducer;
+   // Compute power spectrum in the newest window
+   {
+      auto &record = transformer.NthWindow(0);
+      float *pSpectrum = &record.mSpectrums[0];
+      const double dc = record.mRealFFTs[0];
+      *pSpectrum++ = dc * dc;
+      float *pReal = &record.mRealFFTs[1], *pImag = &record.mImagFFTs[1];
+      for (size_t nn = reducer.mSettings.SpectrumSize() - 2; nn--;) {
+         const double re = *pReal++, im = *pImag++;
+         *pSpectrum++ = re * re + im * im;
+      }
+      const double nyquist = record.mImagFFTs[0];
+      *pSpectrum = nyquist * nyquist;
+   }
+
+   if (transformer.mOnProfileWindow) {
+      reducer.GatherStatistics(transformer);
+      // Update the Progress meter, let user cancel
+      return transformer.mOnProfileWindow();
+   }
+
+   reducer.ReduceNoise(transformer);
+   // In a worker thread; leave the progress meter to the caller
+   ++*transformer.mpWindowCount;
+   return !*transformer.mpCancelled;
+}
+
+void NoiseReducer::FinishTrackStatistics()
+{
+   const auto windows = mStatistics.mTrackWindows;
+
+   // Combine averages in case of multiple profile tracks.
+   if (windows) {
+      const auto multiplier = mStatistics.mTotalWindows;
+      const auto denom = windows + multiplier;
+      for (size_t ii = 0, nn = mStatistics.mMeans.size(); ii < nn; ++ii) {
+         auto &mean = mStatistics.mMeans[ii];
+         auto &sum = mStatistics.mSums[ii];
+         mean = (mean * multiplier + sum) / denom;
+         // Reset for next track
+         sum = 0;
+      }
+      // Reset for next track
+      mStatistics.mTrackWindows = 0;
+      mStatistics.mTotalWindows = denom;
+   }
+}
+
+void NoiseReducer::GatherStatistics(Transformer &transformer)
+{
+   ++mStatistics.mTrackWindows;
+
+   auto pPower = transformer.NthWindow(0).mSpectrums.data();
+   auto pSum = mStatistics.mSums.data();
+   for (size_t jj = 0; jj < mSettings.SpectrumSize(); ++jj) {
+      *pSum++ += *pPower++;
+   }
+}
+
+// Return true iff the given band of the "center" window looks like noise.
+// Examine the band in a few neighboring windows to decide.
+inline
+bool NoiseReducer::Classify(
+   Transformer &transformer, unsigned nWindows, int band) const
+{
+   switch (mSettings.mMethod) {
+   // New methods suppose an exponential distribution of power values
+   // in the noise; NEW sensitivity (which is nonnegative) is meant to be
+   // the negative of a log of probability (so the log is nonpositive)
+   // that noise strays above the threshold.  Call that probability
+   // 1 - F.  The quantile function of an exponential distribution is
+   // - log (1 - F) * mean.  Thus simply multiply mean by sensitivity
+   // to get the threshold.
+   case DM_MEDIAN:
+      // This method examines the window and all other windows
+      // whose centers lie on or between its boundaries, and takes a median, to
+      // avoid being fooled by up and down excursions into
+      // either the mistake of classifying noise as not noise
+      // (leaving a musical noise chime), or the opposite
+      // (distorting the signal with a drop out).
+      if (nWindows <= 3)
+         // No different from second greatest.
+         goto secondGreatest;
+      else if (nWindows <= 5)
+      {
+         float greatest = 0.0, second = 0.0, third = 0.0;
+         for (unsigned ii = 0; ii < nWindows; ++ii) {
+            const float power = transformer.NthWindow(ii).mSpectrums[band];
+            if (power >= greatest)
+               third = second, second = greatest, greatest = power;
+            else if (power >= second)
+               third = second, second = power;
+            else if (power >= third)
+               third = power;
+         }
+         return third <= mNewSensitivity * mStatistics.mMeans[band];
+      }
+      else {
+         // not implemented
+         assert(false);
+         return true;
+      }
+   secondGreatest:
+   case DM_SECOND_GREATEST:
+      {
+         // This method just throws out the high outlier.  It
+         // should be less prone to distortions and more prone to
+         // chimes.
+         float greatest = 0.0, second = 0.0;
+         for (unsigned ii = 0; ii < nWindows; ++ii) {
+            const float power = transformer.NthWindow(ii).mSpectrums[band];
+            if (power >= greatest)
+               second = greatest, greatest = power;
+            else if (power >= second)
+               second = power;
+         }
+         return second <= mNewSensitivity * mStatistics.mMeans[band];
+      }
+   default:
+      assert(false);
+      return true;
+   }
+}
+
+void NoiseReducer::ReduceNoise(Transformer &transformer) const
+{
+   auto historyLen = transformer.CurrentQueueSize();
+   auto nWindows = std::min<unsigned>(mNWindowsToExamine, historyLen);
+
+   const auto spectrumSize = mSettings.SpectrumSize();
+   const auto choice = mSettings.mNoiseReductionChoice;
+
+   if (choice != NRC_ISOLATE_NOISE)
+   {
+      auto &record = transformer.NthWindow(0);
+      // Default all gains to the reduction factor,
+      // until we decide to raise some of them later
+      float *pGain = &record.mGains[0];
+      std::fill(pGain, pGain + spectrumSize, mNoiseAttenFactor);
+   }
+
+   // Raise the gain for elements in the center of the sliding history
+   // or, if isolating noise, zero out the non-noise
+   if (nWindows > mCenter)
+   {
+      auto pGain = transformer.NthWindow(mCenter).mGains.data();
+      if (choice == NRC_ISOLATE_NOISE) {
+         for (size_t jj = 0; jj < spectrumSize; ++jj) {
+            const bool isNoise = Classify(transformer, nWindows, jj);
+            *pGain++ = isNoise ? 1.0 : 0.0;
+         }
+      }
+      else {
+         for (size_t jj = 0; jj < spectrumSize; ++jj) {
+            const bool isNoise = Classify(transformer, nWindows, jj);
+            if (!isNoise)
+               *pGain = 1.0;
+            ++pGain;
+         }
+      }
+   }
+
+   if (choice != NRC_ISOLATE_NOISE)
+   {
+      // In each direction, define an exponential decay of gain from the
+      // center; make actual gains the maximum of mNoiseAttenFactor, and
+      // the decay curve, and their prior values.
+
+      // First, the attack, which goes backward in time, which is,
+      // toward higher indices in the queue.
+      for (size_t jj = 0; jj < spectrumSize; ++jj) {
+         for (unsigned ii = mCenter + 1; ii < historyLen; ++ii) {
+            const float minimum =
+               std::max(mNoiseAttenFactor,
+                  transformer.NthWindow(ii - 1).mGains[jj] * mOneBlockAttack);
+            float &gain = transformer.NthWindow(ii).mGains[jj];
+            if (gain < minimum)
+               gain = minimum;
+            else
+               // We can stop now, our attack curve is intersecting
+               // the release curve of some window previously processed.
+               break;
+         }
+      }
+
+      // Now, release.  We need only look one window ahead.  This part will
+      // be visited again when we examine the next window, and
+      // carry the decay further.
+      {
+         auto pNextGain = transformer.NthWindow(mCenter - 1).mGains.data();
+         auto pThisGain = transformer.NthWindow(mCenter).mGains.data();
+         for (auto nn = mSettings.SpectrumSize(); nn--;) {
+            *pNextGain =
+               std::max(*pNextGain,
+                        std::max(mNoiseAttenFactor,
+                                 *pThisGain++ * mOneBlockRelease));
+            ++pNextGain;
+         }
+      }
+   }
+
+
+   if (transformer.QueueIsFull()) {
+      auto &record = transformer.NthWindow(historyLen - 1);  // end of the queue
+      const auto last = mSettings.SpectrumSize() - 1;
+
+      if (choice != NRC_ISOLATE_NOISE)
+         // Apply frequency smoothing to output gain
+         // Gains are not less than mNoiseAttenFactor
+         ApplyFreqSmoothing(record.mGains, transformer.mFreqSmoothingScratch);
+
+      // Apply gain to FFT
+      {
+         const float *pGain = &record.mGains[1];
+         float *pReal = &record.mRealFFTs[1];
+         float *pImag = &record.mImagFFTs[1];
+         auto nn = mSettings.SpectrumSize() - 2;
+         if (choice == NRC_LEAVE_RESIDUE) {
+            for (; nn--;) {
+               // Subtract the gain we would otherwise apply from 1, and
+               // negate that to flip the phase.
+               const double gain = *pGain++ - 1.0;
+               *pReal++ *= gain;
+               *pImag++ *= gain;
+            }
+            record.mRealFFTs[0] *= (record.mGains[0] - 1.0);
+            // The Fs/2 component is stored as the imaginary part of the DC component
+            record.mImagFFTs[0] *= (record.mGains[last] - 1.0);
+         }
+         else {
+            for (; nn--;) {
+               const double gain = *pGain++;
+               *pReal++ *= gain;
+               *pImag++ *= gain;
+            }
+            record.mRealFFTs[0] *= record.mGains[0];
+            // The Fs/2 component is stored as the imaginary part of the DC component
+            record.mImagFFTs[0] *= record.mGains[last];
+         }
+      }
+   }
+}
@@ -0,0 +1,163 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  NoiseReducer.h
+
+  Dominic Mazzoni
+
+  detailed rewriting by
+  Paul Licameli
+
+  split from src/effects/NoiseReduction.cpp
+
+**********************************************************************/
+
+#ifndef __AUDACITY_NOISE_REDUCER__
+#define __AUDACITY_NOISE_REDUCER__
+
+#include <functional>
+#include <vector>
+#include "SampleCount.h"
+
+class SpectrumTransformer;
+enum eWindowFunctions : int;
+
+enum DiscriminationMethod : size_t {
+   DM_MEDIAN,
+   DM_SECOND_GREATEST,
+   DM_OLD_METHOD,
+
+   DM_N_METHODS,
+   DM_DEFAULT_METHOD = DM_SECOND_GREATEST,
+};
+
+enum NoiseReductionChoice {
+   NRC_REDUCE_NOISE,
+   NRC_ISOLATE_NOISE,
+   NRC_LEAVE_RESIDUE,
+};
+
+//! The spectral noise gate of the Noise Reduction effect
+/*!
+ A first pass over just noise tabulates, for each frequency band, statistics
+ of the power in windows of the sound.  Noise reduction then lowers the gain
+ of each band of each window that those statistics classify as noise, with
+ smoothing of the gains in time and in frequency.
+ */
+class MATH_API NoiseReducer final
+{
+public:
+   using FloatVector = std::vector<float>;
+
+   struct Settings
+   {
+      size_t WindowSize() const { return 1u << (3 + mWindowSizeChoice); }
+      unsigned StepsPerWindow() const
+      { return 1u << (1 + mStepsPerWindowChoice); }
+      size_t SpectrumSize() const { return 1 + WindowSize() / 2; }
+      size_t StepSize() const { return WindowSize() / StepsPerWindow(); }
+
+      double mNewSensitivity{ 6.0 };   // - log10 of a probability... yeah.
+      double mFreqSmoothingBands{ 6.0 }; // really an integer
+      double mNoiseGain{ 6.0 };         // in dB, positive
+      double mAttackTime{ 0.02 };       // in secs
+      double mReleaseTime{ 0.10 };      // in secs
+
+      int mNoiseReductionChoice{ NRC_REDUCE_NOISE };
+
+      int mWindowSizeChoice{ 8 }; // corresponds to 2048
+      int mStepsPerWindowChoice{ 1 }; // corresponds to 4
+      int mMethod{ DM_DEFAULT_METHOD };
+   };
+
+   //! Noise profile statistics, accumulated by Profile() over channels
+   struct Statistics
+   {
+      Statistics(size_t spectrumSize, double rate)
+         : mRate{ rate }
+         , mWindowSize{ (spectrumSize - 1) * 2 }
+         , mSums( spectrumSize )
+         , mMeans( spectrumSize )
+      {}
+
+      double mRate; // Rate of profile track(s) -- processed tracks must match
+      size_t mWindowSize;
+
+      unsigned mTotalWindows{ 0 };
+      unsigned mTrackWindows{ 0 };
+      FloatVector mSums;
+      FloatVector mMeans;
+   };
+
+   //! Fills the buffer with len samples of input, from sample start of the
+   //! selection; called from worker threads at once, by Reduce()
+   using Reader =
+      std::function<void(float *buffer, sampleCount start, size_t len)>;
+   //! Receives output samples in order
+   using Writer = std::function<void(const float *buffer, size_t len)>;
+   //! Gives the writer of a segment of a channel; called in the calling
+   //! thread, before any segment starts
+   using WriterFactory =
+      std::function<Writer(size_t iChannel, size_t iSegment)>;
+   //! Called in the calling thread with the fraction of work done; returns
+   //! false to cancel
+   using ProgressReporter = std::function<bool(double fraction)>;
+
+   //! @pre `settings.WindowSize() == statistics.mWindowSize`
+   NoiseReducer(const Settings &settings, Statistics &statistics,
+      eWindowFunctions inWindowType, eWindowFunctions outWindowType);
+   ~NoiseReducer();
+
+   //! Add the statistics of len samples of one channel of noise
+   /*! @return false if cancelled */
+   bool Profile(const Reader &reader, sampleCount len,
+      const ProgressReporter &progress);
+
+   //! Reduce noise in len samples of each channel
+   /*!
+    The selection is cut into segments, processed in parallel in TaskPool
+    workers.  Each begins and ends enough windows early and late that its
+    gains, and so its output samples, are identical to those of one pass
+    over the whole selection.
+
+    @param nSegments segments of each channel; zero chooses as many as keep
+    the workers busy, but not so many that the extra windows cost much
+    @return false if cancelled; the writers may have got some output
+    */
+   bool Reduce(const std::vector<Reader> &readers, sampleCount len,
+      const WriterFactory &makeWriter, const ProgressReporter &progress,
+      size_t nSegments = 0);
+
+private:
+   struct Transformer;
+
+   static bool Processor(SpectrumTransformer &transformer);
+
+   void ApplyFreqSmoothing(FloatVector &gains, FloatVector &scratch) const;
+   void GatherStatistics(Transformer &transformer);
+   inline bool Classify(
+      Transformer &transformer, unsigned nWindows, int band) const;
+   void ReduceNoise(Transformer &transformer) const;
+   void FinishTrackStatistics();
+
+   const Settings mSettings;
+   Statistics &mStatistics;
+   const eWindowFunctions mInWindowType;
+   const eWindowFunctions mOutWindowType;
+
+   const size_t mFreqSmoothingBins;
+   const double mNewSensitivity;
+
+   float     mOneBlockAttack;
+   float     mOneBlockRelease;
+   float     mNoiseAttenFactor;
+
+   unsigned  mNWindowsToExamine;
+   unsigned  mCenter;
+   //! Queue length for noise reduction; profiling needs just one window
+   unsigned  mHistoryLen;
+   unsigned  mNReleaseBlocks;
+};
+
+#endif
@@ -38,21 +38,64 @@
 
 #include "RealFFTf.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <vector>
 #include <stdlib.h>
 #include <math.h>
 
-#include <wx/thread.h>
+// PFFFT is vendored with StaffPad
+#include "pffft.h"
 
 #ifndef M_PI
 #define	M_PI		3.14159265358979323846  /* pi */
 #endif
 
+void PffftSetupDeleter::operator () (PFFFT_Setup *p) const
+{
+   pffft_destroy_setup(p);
+}
+
+bool IsFFTBackendAvailable(FFTBackend backend, size_t fftlen)
+{
+   const auto isPowerOfTwo = fftlen >= 2 && (fftlen & (fftlen - 1)) == 0;
+   switch (backend) {
+   case FFTBackend::Radix2:
+      return isPowerOfTwo;
+   case FFTBackend::Pffft:
+#ifdef EXPERIMENTAL_EQ_SSE_THREADED
+      // The 4x routines of Equalization48x need the tables of Radix2
+      return false;
+#else
+      return isPowerOfTwo && fftlen >= 32;
+#endif
+   default:
+      return false;
+   }
+}
+
+namespace {
+std::atomic<FFTBackend> sBackend{
+   pffft_simd_size() > 1 ? FFTBackend::Pffft : FFTBackend::Radix2 };
+}
+
+FFTBackend GetFFTBackend()
+{
+   return sBackend;
+}
+
+void SetFFTBackend(FFTBackend backend)
+{
+   sBackend = backend;
+}
+
 /*
 *  Initialize the Sine table and Twiddle pointers (bit-reversed pointers)
 *  for the FFT routine.
 */
-HFFT InitializeFFT(size_t fftlen)
+HFFT InitializeFFT(size_t fftlen, FFTBackend backend)
 {
    int temp;
    HFFT h{ safenew FFTParam };
@@ -63,6 +106,16 @@ HFFT InitializeFFT(size_t fftlen)
    *  (This optimization can be made since the data is real.)
    */
    h->Points = fftlen / 2;
+   h->backend = backend;
+
+   if (backend == FFTBackend::Pffft) {
+      // PFFFT orders its output; its twiddle factors are in the setup
+      h->BitReversed.reinit(h->Points);
+      for(size_t i = 0; i < h->Points; i++)
+         h->BitReversed[i] = 2 * i;
+      h->pSetup.reset(pffft_new_setup(fftlen, PFFFT_REAL));
+      return h;
+   }
 
    h->SinTable.reinit(2*h->Points);
 
@@ -97,39 +150,47 @@ enum : size_t { MAX_HFFT = 10 };
 
 // Maintain a pool:
 static std::vector< std::unique_ptr<FFTParam> > hFFTArray(MAX_HFFT);
-wxCriticalSection getFFTMutex;
+static std::mutex getFFTMutex;
+
+HFFT GetFFT(size_t fftlen)
+{
+   const auto backend = GetFFTBackend();
+   return GetFFT(fftlen, IsFFTBackendAvailable(backend, fftlen)
+      ? backend : FFTBackend::Radix2);
+}
 
 /* Get a handle to the FFT tables of the desired length */
 /* This version keeps common tables rather than allocating a NEW table every time */
-HFFT GetFFT(size_t fftlen)
+HFFT GetFFT(size_t fftlen, FFTBackend backend)
 {
    // To do:  smarter policy about when to retain in the pool and when to
    // allocate a unique instance.
 
-   wxCriticalSectionLocker locker{ getFFTMutex };
+   std::lock_guard<std::mutex> locker{ getFFTMutex };
    
    size_t h = 0;
    auto n = fftlen/2;
    auto size = hFFTArray.size();
    for(;
-       (h < size) && hFFTArray[h] && (n != hFFTArray[h]->Points);
+       (h < size) && hFFTArray[h] &&
+          (n != hFFTArray[h]->Points || backend != hFFTArray[h]->backend);
        h++)
       ;
    if(h < size) {
       if(hFFTArray[h] == NULL) {
-         hFFTArray[h].reset( InitializeFFT(fftlen).release() );
+         hFFTArray[h].reset( InitializeFFT(fftlen, backend).release() );
       }
       return HFFT{ hFFTArray[h].get() };
    } else {
       // All buffers used, so fall back to allocating a NEW set of tables
-      return InitializeFFT(fftlen);
+      return InitializeFFT(fftlen, backend);
    }
 }
 
 /* Release a previously requested handle to the FFT tables */
 void FFTDeleter::operator() (FFTParam *hFFT) const
 {
-   wxCriticalSectionLocker locker{ getFFTMutex };
+   std::lock_guard<std::mutex> locker{ getFFTMutex };
 
    auto it = hFFTArray.begin(), end = hFFTArray.end();
    while (it != end && it->get() != hFFT)
@@ -140,6 +201,48 @@ void FFTDeleter::operator() (FFTParam *hFFT) const
       delete hFFT;
 }
 
+namespace {
+//! Aligned buffers for PFFFT, kept for each thread
+struct PffftScratch {
+   ~PffftScratch()
+   {
+      pffft_aligned_free(data);
+      pffft_aligned_free(work);
+   }
+   void Reserve(size_t size)
+   {
+      if (size <= capacity)
+         return;
+      pffft_aligned_free(data);
+      pffft_aligned_free(work);
+      data = static_cast<float*>(pffft_aligned_malloc(size * sizeof(float)));
+      work = static_cast<float*>(pffft_aligned_malloc(size * sizeof(float)));
+      capacity = size;
+   }
+   float *data{};
+   float *work{};
+   size_t capacity{ 0 };
+};
+thread_local PffftScratch tlScratch;
+
+// Without the work area, PFFFT would put it on the stack
+void PffftTransform(
+   const FFTParam *h, fft_type *buffer, pffft_direction_t direction)
+{
+   const auto fftlen = 2 * h->Points;
+   auto &scratch = tlScratch;
+   scratch.Reserve(fftlen);
+   // PFFFT needs 16-byte alignment for its vector instructions
+   const auto aligned = reinterpret_cast<std::uintptr_t>(buffer) % 16 == 0;
+   const auto data = aligned ? buffer : scratch.data;
+   if (!aligned)
+      std::copy(buffer, buffer + fftlen, data);
+   pffft_transform_ordered(h->pSetup.get(), data, data, scratch.work, direction);
+   if (!aligned)
+      std::copy(data, data + fftlen, buffer);
+}
+}
+
 /*
 *  Forward FFT routine.  Must call GetFFT(fftlen) first!
 *
@@ -160,6 +263,12 @@ void FFTDeleter::operator() (FFTParam *hFFT) const
 */
 void RealFFTf(fft_type *buffer, const FFTParam *h)
 {
+   if (h->pSetup) {
+      // PFFFT also puts the Fs/2 bin in buffer[1]
+      PffftTransform(h, buffer, PFFFT_FORWARD);
+      return;
+   }
+
    fft_type *A,*B;
    const fft_type *sptr;
    const fft_type *endptr1,*endptr2;
@@ -262,6 +371,15 @@ void RealFFTf(fft_type *buffer, const FFTParam *h)
 */
 void InverseRealFFTf(fft_type *buffer, const FFTParam *h)
 {
+   if (h->pSetup) {
+      PffftTransform(h, buffer, PFFFT_BACKWARD);
+      // Scale as the radix-2 code does
+      const auto scale = (fft_type)1 / (2 * h->Points);
+      std::transform(buffer, buffer + 2 * h->Points, buffer,
+         [scale](fft_type x){ return x * scale; });
+      return;
+   }
+
    fft_type *A,*B;
    const fft_type *sptr;
    const fft_type *endptr1,*endptr2;
@@ -4,10 +4,28 @@
 #include "MemoryX.h"
 
 using fft_type = float;
+
+//! Implementations of RealFFTf and InverseRealFFTf
+enum class FFTBackend : unsigned char {
+   Radix2, //!< Portable scalar code, for any power of two
+   Pffft, //!< PFFFT, vectorized where it was compiled for SSE or NEON;
+          //!< for powers of two from 32
+};
+
+struct PFFFT_Setup;
+struct MATH_API PffftSetupDeleter {
+   void operator () (PFFFT_Setup *p) const;
+};
+
 struct FFTParam {
+   //! Bin i of the transform is at buffer[BitReversed[i]] (real part) and
+   //! buffer[BitReversed[i] + 1] (imaginary part); with Pffft, that is
+   //! simply 2 * i
    ArrayOf<int> BitReversed;
    ArrayOf<fft_type> SinTable;
    size_t Points;
+   FFTBackend backend{ FFTBackend::Radix2 };
+   std::unique_ptr<PFFFT_Setup, PffftSetupDeleter> pSetup;
 #ifdef EXPERIMENTAL_EQ_SSE_THREADED
    int pow2Bits;
 #endif
@@ -21,7 +39,16 @@ using HFFT = std::unique_ptr<
    FFTParam, FFTDeleter
 >;
 
+//! Whether the backend can transform fftlen points in this build
+MATH_API bool IsFFTBackendAvailable(FFTBackend backend, size_t fftlen);
+//! The backend that GetFFT(size_t) uses when available, else Radix2
+/*! Initially Pffft, if it was compiled with vector instructions */
+MATH_API FFTBackend GetFFTBackend();
+MATH_API void SetFFTBackend(FFTBackend backend);
+
 MATH_API HFFT GetFFT(size_t);
+//! @pre `IsFFTBackendAvailable(backend, fftlen)`
+MATH_API HFFT GetFFT(size_t fftlen, FFTBackend backend);
 MATH_API void RealFFTf(fft_type *, const FFTParam *);
 MATH_API void InverseRealFFTf(fft_type *, const FFTParam *);
 MATH_API void ReorderToTime(const FFTParam *hFFT, const fft_type *buffer, fft_type *TimeOut);
@@ -0,0 +1,231 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleConversion.cpp
+
+**********************************************************************/
+#include "SampleConversion.h"
+#include "SimdSelection.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SampleConversion {
+
+namespace {
+// Clamp before rounding, which agrees with rounding before clamping because
+// the bounds are integers.  NaN compares false, so it takes the lower bound.
+template<typename Int>
+inline Int RoundAndClamp(float sample, float lower, float upper)
+{
+   const auto clamped = !(sample >= lower) ? lower
+      : sample > upper ? upper
+      : sample;
+   return static_cast<Int>(lrintf(clamped));
+}
+
+inline float Clip(float sample)
+{
+   return sample > 1.0f ? 1.0f : sample < -1.0f ? -1.0f : sample;
+}
+}
+
+void Int16ToFloat(const short *src, float *dst, size_t len, float scale)
+{
+   size_t ii = 0;
+#if defined(MATH_SIMD_SSE2)
+   const auto vScale = _mm_set1_ps(scale);
+   for (; ii + 8 <= len; ii += 8) {
+      const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + ii));
+      // Sign-extend by unpacking into the high halves, then shifting down
+      const auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+      const auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+      _mm_storeu_ps(dst + ii, _mm_mul_ps(_mm_cvtepi32_ps(lo), vScale));
+      _mm_storeu_ps(dst + ii + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vScale));
+   }
+#elif defined(MATH_SIMD_NEON)
+   const auto vScale = vdupq_n_f32(scale);
+   for (; ii + 8 <= len; ii += 8) {
+      const auto x = vld1q_s16(src + ii);
+      const auto lo = vmovl_s16(vget_low_s16(x));
+      const auto hi = vmovl_s16(vget_high_s16(x));
+      vst1q_f32(dst + ii, vmulq_f32(vcvtq_f32_s32(lo), vScale));
+      vst1q_f32(dst + ii + 4, vmulq_f32(vcvtq_f32_s32(hi), vScale));
+   }
+#endif
+   for (; ii < len; ++ii)
+      dst[ii] = src[ii] * scale;
+}
+
+void Int24ToFloat(const int *src, float *dst, size_t len, float scale)
+{
+   size_t ii = 0;
+#if defined(MATH_SIMD_SSE2)
+   const auto vScale = _mm_set1_ps(scale);
+   for (; ii + 4 <= len; ii += 4) {
+      const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + ii));
+      _mm_storeu_ps(dst + ii, _mm_mul_ps(_mm_cvtepi32_ps(x), vScale));
+   }
+#elif defined(MATH_SIMD_NEON)
+   const auto vScale = vdupq_n_f32(scale);
+   for (; ii + 4 <= len; ii += 4)
+      vst1q_f32(dst + ii, vmulq_f32(vcvtq_f32_s32(vld1q_s32(src + ii)), vScale));
+#endif
+   for (; ii < len; ++ii)
+      dst[ii] = src[ii] * scale;
+}
+
+void Int16ToInt24(const short *src, int *dst, size_t len)
+{
+   size_t ii = 0;
+#if defined(MATH_SIMD_SSE2)
+   for (; ii + 8 <= len; ii += 8) {
+      const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + ii));
+      // Place the samples in the high halves, then sign-extend and shift
+      // left by 8 in one arithmetic shift
+      const auto zero = _mm_setzero_si128();
+      const auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(zero, x), 8);
+      const auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(zero, x), 8);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + ii), lo);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + ii + 4), hi);
+   }
+#elif defined(MATH_SIMD_NEON)
+   for (; ii + 8 <= len; ii += 8) {
+      const auto x = vld1q_s16(src + ii);
+      vst1q_s32(dst + ii, vshll_n_s16(vget_low_s16(x), 8));
+      vst1q_s32(dst + ii + 4, vshll_n_s16(vget_high_s16(x), 8));
+   }
+#endif
+   for (; ii < len; ++ii)
+      dst[ii] = ((int)src[ii]) << 8;
+}
+
+void ClipAndScale(const float *src, float *dst, size_t len, float scale)
+{
+   size_t ii = 0;
+#if defined(MATH_SIMD_SSE2)
+   const auto vScale = _mm_set1_ps(scale);
+   const auto one = _mm_set1_ps(1.0f);
+   const auto minusOne = _mm_set1_ps(-1.0f);
+   for (; ii + 4 <= len; ii += 4) {
+      // The operand order makes NaN propagate, as in the scalar Clip
+      const auto x = _mm_loadu_ps(src + ii);
+      const auto clipped = _mm_min_ps(one, _mm_max_ps(minusOne, x));
+      _mm_storeu_ps(dst + ii, _mm_mul_ps(clipped, vScale));
+   }
+#elif defined(MATH_SIMD_NEON)
+   const auto vScale = vdupq_n_f32(scale);
+   const auto one = vdupq_n_f32(1.0f);
+   const auto minusOne = vdupq_n_f32(-1.0f);
+   for (; ii + 4 <= len; ii += 4) {
+      // These NEON instructions propagate NaN
+      const auto clipped = vminq_f32(one, vmaxq_f32(minusOne, vld1q_f32(src + ii)));
+      vst1q_f32(dst + ii, vmulq_f32(clipped, vScale));
+   }
+#endif
+   for (; ii < len; ++ii)
+      dst[ii] = Clip(src[ii]) * scale;
+}
+
+void FloatToInt16(const float *src, short *dst, size_t len)
+{
+   constexpr float lower = -32768.0f, upper = 32767.0f;
+   size_t ii = 0;
+#if defined(MATH_SIMD_SSE2)
+   const auto vLower = _mm_set1_ps(lower);
+   const auto vUpper = _mm_set1_ps(upper);
+   for (; ii + 8 <= len; ii += 8) {
+      // _mm_max_ps returns the second operand for NaN
+      const auto x0 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + ii), vLower), vUpper);
+      const auto x1 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + ii + 4), vLower), vUpper);
+      // Conversion rounds to nearest even, like lrintf in the default mode
+      const auto packed = _mm_packs_epi32(_mm_cvtps_epi32(x0), _mm_cvtps_epi32(x1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + ii), packed);
+   }
+#elif defined(MATH_SIMD_NEON)
+   const auto vLower = vdupq_n_f32(lower);
+   const auto vUpper = vdupq_n_f32(upper);
+   for (; ii + 8 <= len; ii += 8) {
+      // vmaxnmq_f32 returns the number for NaN
+      const auto x0 = vminq_f32(vmaxnmq_f32(vld1q_f32(src + ii), vLower), vUpper);
+      const auto x1 = vminq_f32(vmaxnmq_f32(vld1q_f32(src + ii + 4), vLower), vUpper);
+      vst1q_s16(dst + ii, vcombine_s16(
+         vqmovn_s32(vcvtnq_s32_f32(x0)), vqmovn_s32(vcvtnq_s32_f32(x1))));
+   }
+#endif
+   for (; ii < len; ++ii)
+      dst[ii] = RoundAndClamp<short>(src[ii], lower, upper);
+}
+
+void FloatToInt24(const float *src, int *dst, size_t len)
+{
+   constexpr float lower = -8388608.0f, upper = 8388607.0f;
+   size_t ii = 0;
+#if defined(MATH_SIMD_SSE2)
+   const auto vLower = _mm_set1_ps(lower);
+   const auto vUpper = _mm_set1_ps(upper);
+   for (; ii + 4 <= len; ii += 4) {
+      const auto x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + ii), vLower), vUpper);
+      _mm_storeu_si128(
+         reinterpret_cast<__m128i*>(dst + ii), _mm_cvtps_epi32(x));
+   }
+#elif defined(MATH_SIMD_NEON)
+   const auto vLower = vdupq_n_f32(lower);
+   const auto vUpper = vdupq_n_f32(upper);
+   for (; ii + 4 <= len; ii += 4) {
+      const auto x = vminq_f32(vmaxnmq_f32(vld1q_f32(src + ii), vLower), vUpper);
+      vst1q_s32(dst + ii, vcvtnq_s32_f32(x));
+   }
+#endif
+   for (; ii < len; ++ii)
+      dst[ii] = RoundAndClamp<int>(src[ii], lower, upper);
+}
+
+void CopyFloats(const float *src, size_t srcStride,
+   float *dst, size_t dstStride, size_t len)
+{
+   size_t ii = 0;
+   // Vector loops stop one short, so that they never touch the element past
+   // the last of an interleaved buffer
+#if defined(MATH_SIMD_SSE2)
+   if (srcStride == 2 && dstStride == 1) {
+      // Deinterleave one channel of stereo
+      for (; ii + 4 < len; ii += 4) {
+         const auto a = _mm_loadu_ps(src + 2 * ii);
+         const auto b = _mm_loadu_ps(src + 2 * ii + 4);
+         _mm_storeu_ps(dst + ii, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      }
+   }
+   else if (srcStride == 1 && dstStride == 2) {
+      // Interleave into one channel of stereo, preserving the other
+      for (; ii + 4 < len; ii += 4) {
+         const auto x = _mm_loadu_ps(src + ii);
+         const auto a = _mm_loadu_ps(dst + 2 * ii);
+         const auto b = _mm_loadu_ps(dst + 2 * ii + 4);
+         // (a1, a3, b1, b3), then (x0, a1, x1, a3) and (x2, b1, x3, b3)
+         const auto odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+         const auto lo = _mm_unpacklo_ps(x, odd);
+         const auto hi = _mm_unpackhi_ps(x, odd);
+         _mm_storeu_ps(dst + 2 * ii, lo);
+         _mm_storeu_ps(dst + 2 * ii + 4, hi);
+      }
+   }
+#elif defined(MATH_SIMD_NEON)
+   if (srcStride == 2 && dstStride == 1) {
+      for (; ii + 4 < len; ii += 4)
+         vst1q_f32(dst + ii, vld2q_f32(src + 2 * ii).val[0]);
+   }
+   else if (srcStride == 1 && dstStride == 2) {
+      for (; ii + 4 < len; ii += 4) {
+         auto pair = vld2q_f32(dst + 2 * ii);
+         pair.val[0] = vld1q_f32(src + ii);
+         vst2q_f32(dst + 2 * ii, pair);
+      }
+   }
+#endif
+   for (; ii < len; ++ii)
+      dst[ii * dstStride] = src[ii * srcStride];
+}
+
+}
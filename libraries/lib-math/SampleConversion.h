@@ -0,0 +1,47 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleConversion.h
+  @brief Vectorized kernels for conversion among sample formats
+
+  These are the building blocks of Dither::Apply for contiguous buffers.
+  Each gives exactly the results of the scalar conversion it replaces.
+
+**********************************************************************/
+#ifndef __AUDACITY_SAMPLE_CONVERSION__
+#define __AUDACITY_SAMPLE_CONVERSION__
+
+#include <cstddef>
+
+namespace SampleConversion {
+
+//! dst[i] = src[i] * scale
+MATH_API void Int16ToFloat(
+   const short *src, float *dst, size_t len, float scale);
+
+//! dst[i] = src[i] * scale, for 24 bit samples in 32 bit integers
+MATH_API void Int24ToFloat(
+   const int *src, float *dst, size_t len, float scale);
+
+//! dst[i] = src[i] << 8
+MATH_API void Int16ToInt24(const short *src, int *dst, size_t len);
+
+//! Clip to [-1, 1], then multiply by scale; NaN remains NaN
+MATH_API void ClipAndScale(
+   const float *src, float *dst, size_t len, float scale);
+
+//! Round to nearest and saturate to the 16 bit range; NaN becomes the minimum
+MATH_API void FloatToInt16(const float *src, short *dst, size_t len);
+
+//! Round to nearest and saturate to the 24 bit range; NaN becomes the minimum
+MATH_API void FloatToInt24(const float *src, int *dst, size_t len);
+
+//! Copy floats between buffers that may be interleaved
+/*! Stereo interleaving and deinterleaving are vectorized */
+MATH_API void CopyFloats(const float *src, size_t srcStride,
+   float *dst, size_t dstStride, size_t len);
+
+}
+
+#endif
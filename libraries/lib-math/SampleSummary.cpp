@@ -0,0 +1,128 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleSummary.cpp
+
+**********************************************************************/
+#include "SampleSummary.h"
+#include "SimdSelection.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+// Reduce the remainder after the vectorized part, and the whole of very
+// short runs
+inline void ScalarSummary(
+   const float *samples, size_t len, float &min, float &max, float &sumsq)
+{
+   for (size_t ii = 0; ii < len; ++ii) {
+      const auto sample = samples[ii];
+      min = std::min(min, sample);
+      max = std::max(max, sample);
+      sumsq += sample * sample;
+   }
+}
+}
+
+SampleSummary ComputeSampleSummary(const float *samples, size_t len)
+{
+   float min = FLT_MAX;
+   float max = -FLT_MAX;
+   float sumsq = 0;
+
+   // Two vectors per iteration, to hide the latency of the accumulations
+   constexpr size_t step = 8;
+   const auto nVectorized = len - len % step;
+
+#if defined(MATH_SIMD_SSE2)
+   if (nVectorized > 0) {
+      auto min0 = _mm_set1_ps(FLT_MAX), min1 = min0;
+      auto max0 = _mm_set1_ps(-FLT_MAX), max1 = max0;
+      auto sum0 = _mm_setzero_ps(), sum1 = sum0;
+      for (size_t ii = 0; ii < nVectorized; ii += step) {
+         const auto x0 = _mm_loadu_ps(samples + ii);
+         const auto x1 = _mm_loadu_ps(samples + ii + 4);
+         min0 = _mm_min_ps(min0, x0);
+         min1 = _mm_min_ps(min1, x1);
+         max0 = _mm_max_ps(max0, x0);
+         max1 = _mm_max_ps(max1, x1);
+         sum0 = _mm_add_ps(sum0, _mm_mul_ps(x0, x0));
+         sum1 = _mm_add_ps(sum1, _mm_mul_ps(x1, x1));
+      }
+      alignas(16) float lanes[3][4];
+      _mm_store_ps(lanes[0], _mm_min_ps(min0, min1));
+      _mm_store_ps(lanes[1], _mm_max_ps(max0, max1));
+      _mm_store_ps(lanes[2], _mm_add_ps(sum0, sum1));
+      for (size_t lane = 0; lane < 4; ++lane) {
+         min = std::min(min, lanes[0][lane]);
+         max = std::max(max, lanes[1][lane]);
+         sumsq += lanes[2][lane];
+      }
+   }
+#elif defined(MATH_SIMD_NEON)
+   if (nVectorized > 0) {
+      auto min0 = vdupq_n_f32(FLT_MAX), min1 = min0;
+      auto max0 = vdupq_n_f32(-FLT_MAX), max1 = max0;
+      auto sum0 = vdupq_n_f32(0), sum1 = sum0;
+      for (size_t ii = 0; ii < nVectorized; ii += step) {
+         const auto x0 = vld1q_f32(samples + ii);
+         const auto x1 = vld1q_f32(samples + ii + 4);
+         min0 = vminq_f32(min0, x0);
+         min1 = vminq_f32(min1, x1);
+         max0 = vmaxq_f32(max0, x0);
+         max1 = vmaxq_f32(max1, x1);
+         sum0 = vmlaq_f32(sum0, x0, x0);
+         sum1 = vmlaq_f32(sum1, x1, x1);
+      }
+      float lanes[3][4];
+      vst1q_f32(lanes[0], vminq_f32(min0, min1));
+      vst1q_f32(lanes[1], vmaxq_f32(max0, max1));
+      vst1q_f32(lanes[2], vaddq_f32(sum0, sum1));
+      for (size_t lane = 0; lane < 4; ++lane) {
+         min = std::min(min, lanes[0][lane]);
+         max = std::max(max, lanes[1][lane]);
+         sumsq += lanes[2][lane];
+      }
+   }
+#else
+   ScalarSummary(samples, nVectorized, min, max, sumsq);
+#endif
+
+   ScalarSummary(samples + nVectorized, len - nVectorized, min, max, sumsq);
+   return { min, max, sumsq };
+}
+
+double ComputeWindowedSummaries(const float *samples, size_t len,
+   size_t windowSize, float *dest)
+{
+   double totalSquares = 0.0;
+   for (size_t start = 0; start < len; start += windowSize, dest += 3) {
+      const auto count = std::min(windowSize, len - start);
+      const auto summary = ComputeSampleSummary(samples + start, count);
+      totalSquares += summary.sumsq;
+      dest[0] = summary.min;
+      dest[1] = summary.max;
+      // The rms is correct, but this may be for less than windowSize samples
+      // in the last window
+      dest[2] = (float) sqrt(summary.sumsq / count);
+   }
+   return totalSquares;
+}
+
+SampleSummary CombineWindowedSummaries(
+   const float *summaries, size_t nWindows, size_t windowSize)
+{
+   float min = FLT_MAX;
+   float max = -FLT_MAX;
+   double sumsq = 0;
+   for (size_t ii = 0; ii < nWindows; ++ii, summaries += 3) {
+      min = std::min(min, summaries[0]);
+      max = std::max(max, summaries[1]);
+      const double rms = summaries[2];
+      sumsq += rms * rms;
+   }
+   return { min, max, static_cast<float>(sumsq * windowSize) };
+}
@@ -0,0 +1,50 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleSummary.h
+  @brief Vectorized minimum, maximum, and sum of squares of float samples
+
+**********************************************************************/
+#ifndef __AUDACITY_SAMPLE_SUMMARY__
+#define __AUDACITY_SAMPLE_SUMMARY__
+
+#include <cstddef>
+
+//! Extremes and energy of a run of samples
+struct SampleSummary
+{
+   //! FLT_MAX for an empty run
+   float min;
+   //! -FLT_MAX for an empty run
+   float max;
+   float sumsq;
+};
+
+//! Compute the summary of `len` samples
+/*!
+ Uses SSE2 or NEON where available, at compile time.  Extremes are exactly
+ those of a scalar loop; the sum of squares is accumulated in several lanes,
+ so it may differ from a sequential float sum in the last bits.
+ */
+MATH_API SampleSummary ComputeSampleSummary(const float *samples, size_t len);
+
+//! Compute summaries of consecutive windows of `windowSize` samples
+/*!
+ Writes (min, max, rms) triples to `dest`, one for each window, the last of
+ which may be partial.
+ @return the sum of the squares of all of the samples, accumulated in double
+ @pre `windowSize > 0`
+ */
+MATH_API double ComputeWindowedSummaries(const float *samples, size_t len,
+   size_t windowSize, float *dest);
+
+//! Combine (min, max, rms) triples of consecutive full windows of
+//! `windowSize` samples, as written by ComputeWindowedSummaries
+/*!
+ The sum of squares is accumulated in double, then rounded
+ */
+MATH_API SampleSummary CombineWindowedSummaries(
+   const float *summaries, size_t nWindows, size_t windowSize);
+
+#endif
@@ -0,0 +1,25 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SimdSelection.h
+  @brief Choose vector instructions for lib-math kernels at compile time
+
+  Defines MATH_SIMD_SSE2 on x86 processors that have SSE2, which is all
+  64-bit ones, or MATH_SIMD_NEON on 64-bit ARM, and includes the intrinsics.
+  Otherwise defines neither, and kernels fall back to scalar code.
+
+**********************************************************************/
+#ifndef __AUDACITY_SIMD_SELECTION__
+#define __AUDACITY_SIMD_SELECTION__
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MATH_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#endif
@@ -11,8 +11,9 @@ Edward Hui
 #include "SpectrumTransformer.h"
 
 #include <algorithm>
+#include <cassert>
+#include <cstring>
 #include "FFT.h"
-#include "WaveTrack.h"
 
 SpectrumTransformer::SpectrumTransformer( bool needsOutput,
    eWindowFunctions inWindowType,
@@ -34,12 +35,12 @@ SpectrumTransformer::SpectrumTransformer( bool needsOutput,
    // Check preconditions
 
    // Powers of 2 only!
-   wxASSERT(mWindowSize > 0 &&
+   assert(mWindowSize > 0 &&
       0 == (mWindowSize & (mWindowSize - 1)));
 
-   wxASSERT(mWindowSize % mStepsPerWindow == 0);
+   assert(mWindowSize % mStepsPerWindow == 0);
 
-   wxASSERT(!(inWindowType == eWinFuncRectangular && outWindowType == eWinFuncRectangular));
+   assert(!(inWindowType == eWinFuncRectangular && outWindowType == eWinFuncRectangular));
 
    // To do:  check that inWindowType, outWindowType, and mStepsPerWindow
    // are compatible for correct overlap-add reconstruction.
@@ -79,7 +80,7 @@ SpectrumTransformer::SpectrumTransformer( bool needsOutput,
       pWindow = mOutWindow.data();
    else
       // Can only happen if both window types were rectangular
-      wxASSERT(false);
+      assert(false);
    for (size_t ii = 0; ii < mWindowSize; ++ii)
       *pWindow++ /= denom;
 }
@@ -100,12 +101,6 @@ bool SpectrumTransformer::DoFinish()
    return true;
 }
 
-void
-TrackSpectrumTransformer::DoOutput(const float *outBuffer, size_t mStepSize)
-{
-   mOutputTrack->Append((constSamplePtr)outBuffer, floatSample, mStepSize);
-}
-
 bool SpectrumTransformer::Start(size_t queueLength)
 {
    // Prepare clean queue
@@ -338,62 +333,6 @@ bool SpectrumTransformer::QueueIsFull() const
       return (mOutStepCount >= 0);
 }
 
-bool TrackSpectrumTransformer::Process(const WindowProcessor &processor,
-   const WaveChannel &channel, size_t queueLength, sampleCount start,
-   sampleCount len)
-{
-   mpChannel = &channel;
-
-   if (!Start(queueLength))
-      return false;
-
-   auto bufferSize = channel.GetMaxBlockSize();
-   FloatVector buffer(bufferSize);
-
-   bool bLoopSuccess = true;
-   auto samplePos = start;
-   while (bLoopSuccess && samplePos < start + len) {
-      //Get a blockSize of samples (smaller than the size of the buffer)
-      const auto blockSize = limitSampleBufferSize(
-         std::min(bufferSize, channel.GetBestBlockSize(samplePos)),
-         start + len - samplePos);
-
-      //Get the samples from the track and put them in the buffer
-      channel.GetFloats(buffer.data(), samplePos, blockSize);
-      samplePos += blockSize;
-      bLoopSuccess = ProcessSamples(processor, buffer.data(), blockSize);
-   }
-
-   if (!Finish(processor))
-      return false;
-
-   return bLoopSuccess;
-}
-
-bool TrackSpectrumTransformer::DoFinish()
-{
-   return SpectrumTransformer::DoFinish();
-}
-
-bool TrackSpectrumTransformer::PostProcess(
-   WaveTrack &outputTrack, sampleCount len)
-{
-   assert(outputTrack.IsLeader());
-   outputTrack.Flush();
-   auto tLen = outputTrack.LongSamplesToTime(len);
-   // Filtering effects always end up with more data than they started with.
-   // Delete this 'tail'.
-   outputTrack.Clear(tLen, outputTrack.GetEndTime());
-   return true;
-}
-
 SpectrumTransformer::~SpectrumTransformer() = default;
 
 SpectrumTransformer::Window::~Window() = default;
-
-TrackSpectrumTransformer::~TrackSpectrumTransformer() = default;
-
-bool TrackSpectrumTransformer::DoStart()
-{
-   return SpectrumTransformer::DoStart();
-}
@@ -15,16 +15,13 @@ Paul Licameli
 #include <functional>
 #include <memory>
 #include <vector>
-#include "audacity/Types.h"
 #include "RealFFTf.h"
 #include "SampleCount.h"
 
 enum eWindowFunctions : int;
 
-class WaveChannel;
-
 /*!
- @brief A class that transforms a portion of a wave track (preserving duration)
+ @brief A class that transforms a sequence of samples (preserving duration)
  by applying Fourier transform, then modifying coefficients, then inverse
  Fourier transform and overlap-add to reconstruct.
  
@@ -32,7 +29,7 @@ class WaveChannel;
  and -behind to nearby windows.  May also be used just to gather information
  without producing output.
 */
-class SpectrumTransformer /* not final */
+class MATH_API SpectrumTransformer /* not final */
 {
 public:
    // Public interface
@@ -180,47 +177,4 @@ private:
    const bool mNeedsOutput;
 };
 
-class WaveTrack;
-
-//! Subclass of SpectrumTransformer that rewrites a track
-class TrackSpectrumTransformer /* not final */ : public SpectrumTransformer {
-public:
-   /*!
-    @copydoc SpectrumTransformer::SpectrumTransformer(bool,
-       eWindowFunctions, eWindowFunctions, size_t, unsigned, bool, bool)
-    @pre `!needsOutput || pOutputTrack != nullptr`
-    */
-   TrackSpectrumTransformer(WaveChannel *pOutputTrack,
-      bool needsOutput, eWindowFunctions inWindowType,
-      eWindowFunctions outWindowType, size_t windowSize,
-      unsigned stepsPerWindow, bool leadingPadding, bool trailingPadding
-   )  : SpectrumTransformer{ needsOutput, inWindowType, outWindowType,
-         windowSize, stepsPerWindow, leadingPadding, trailingPadding
-      }
-      , mOutputTrack{ pOutputTrack }
-   {
-      assert(!needsOutput || pOutputTrack != nullptr);
-   }
-   ~TrackSpectrumTransformer() override;
-
-   //! Invokes Start(), ProcessSamples(), and Finish()
-   bool Process(const WindowProcessor &processor, const WaveChannel &channel,
-      size_t queueLength, sampleCount start, sampleCount len);
-
-   //! Final flush and trimming of tail samples
-   /*!
-    @pre `outputTrack.IsLeader()`
-    */
-   static bool PostProcess(WaveTrack &outputTrack, sampleCount len);
-
-protected:
-   bool DoStart() override;
-   void DoOutput(const float *outBuffer, size_t mStepSize) override;
-   bool DoFinish() override;
-
-private:
-   WaveChannel *const mOutputTrack;
-   const WaveChannel *mpChannel = nullptr;
-};
-
 #endif
@@ -0,0 +1,134 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  NoiseReducerTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "FFT.h"
+#include "NoiseReducer.h"
+
+#include <cmath>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr double rate = 44100;
+
+std::vector<float> MakeNoise(size_t len, unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::uniform_real_distribution<float> distribution { -0.1f, 0.1f };
+   std::vector<float> result(len);
+   for (auto& sample : result)
+      sample = distribution(engine);
+   return result;
+}
+
+//! Noise, under a tone that comes and goes, so that gains change
+std::vector<float> MakeSignal(size_t len, unsigned seed, double frequency)
+{
+   auto result = MakeNoise(len, seed);
+   for (size_t ii = 0; ii < len; ++ii)
+      if ((ii / 7000) % 2)
+         result[ii] += 0.5 * std::sin(2 * M_PI * frequency * ii / rate);
+   return result;
+}
+
+NoiseReducer::Reader MakeReader(const std::vector<float>& samples)
+{
+   return [&samples](float* buffer, sampleCount start, size_t len) {
+      std::copy_n(samples.begin() + start.as_long_long(), len, buffer);
+   };
+}
+
+//! The output of each channel, with its segments appended in order
+std::vector<std::vector<float>> Reduce(NoiseReducer& reducer,
+   const std::vector<std::vector<float>>& channels, size_t nSegments)
+{
+   std::vector<NoiseReducer::Reader> readers;
+   for (auto& channel : channels)
+      readers.push_back(MakeReader(channel));
+   // Writers keep references to the segments, which must not move
+   std::vector<std::deque<std::vector<float>>> segments(channels.size());
+   REQUIRE(reducer.Reduce(readers, channels[0].size(),
+      [&](size_t iChannel, size_t iSegment) {
+         REQUIRE(iSegment == segments[iChannel].size());
+         auto& segment = segments[iChannel].emplace_back();
+         return [&segment](const float* buffer, size_t len) {
+            segment.insert(segment.end(), buffer, buffer + len);
+         };
+      },
+      [](double) { return true; }, nSegments));
+
+   std::vector<std::vector<float>> result;
+   for (auto& channel : segments) {
+      auto& output = result.emplace_back();
+      for (auto& segment : channel)
+         output.insert(output.end(), segment.begin(), segment.end());
+   }
+   return result;
+}
+}
+
+TEST_CASE("NoiseReducer output does not depend on segments",
+   "[NoiseReducer]")
+{
+   NoiseReducer::Settings settings;
+   settings.mNoiseReductionChoice = GENERATE(
+      NRC_REDUCE_NOISE, NRC_ISOLATE_NOISE, NRC_LEAVE_RESIDUE);
+   settings.mMethod = GENERATE(DM_SECOND_GREATEST, DM_MEDIAN);
+
+   NoiseReducer::Statistics statistics{ settings.SpectrumSize(), rate };
+   {
+      NoiseReducer profiler{ settings, statistics,
+         eWinFuncHann, eWinFuncHann };
+      const auto noise = MakeNoise(rate, 1);
+      REQUIRE(profiler.Profile(MakeReader(noise), noise.size(),
+         [](double) { return true; }));
+      REQUIRE(statistics.mTotalWindows > 0);
+   }
+
+   NoiseReducer reducer{ settings, statistics, eWinFuncHann, eWinFuncHann };
+   // Not a whole number of steps; about 200 of them
+   const size_t len = 200 * settings.StepSize() + 333;
+   const std::vector<std::vector<float>> channels{
+      MakeSignal(len, 2, 440), MakeSignal(len, 3, 1000) };
+
+   const auto serial = Reduce(reducer, channels, 1);
+   REQUIRE(serial.size() == channels.size());
+   for (auto& channel : serial)
+      REQUIRE(channel.size() == len);
+   // The gate lets the tone through, but not all the noise
+   REQUIRE(serial[0] != channels[0]);
+
+   // Segments start at steps, which are inside windows.  With 16 segments,
+   // the windows of lead-in of some reach back to the start of the
+   // selection.
+   const auto nSegments = GENERATE(size_t{ 2 }, 3, 7, 16);
+   CAPTURE(nSegments);
+   const auto parallel = Reduce(reducer, channels, nSegments);
+   REQUIRE(parallel.size() == serial.size());
+   for (size_t iChannel = 0; iChannel < serial.size(); ++iChannel) {
+      REQUIRE(parallel[iChannel].size() == len);
+      for (size_t ii = 0; ii < len; ++ii)
+         if (parallel[iChannel][ii] != serial[iChannel][ii]) {
+            CAPTURE(iChannel, ii);
+            FAIL("Segmented output differs");
+         }
+   }
+}
+
+TEST_CASE("NoiseReducer cancels profiling", "[NoiseReducer]")
+{
+   NoiseReducer::Settings settings;
+   NoiseReducer::Statistics statistics{ settings.SpectrumSize(), rate };
+   NoiseReducer reducer{ settings, statistics, eWinFuncHann, eWinFuncHann };
+   const auto noise = MakeNoise(rate, 1);
+   REQUIRE(!reducer.Profile(MakeReader(noise), noise.size(),
+      [](double fraction) { return fraction < 0.5; }));
+}
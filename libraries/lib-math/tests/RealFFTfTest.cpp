@@ -0,0 +1,129 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RealFFTfTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "RealFFTf.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+std::vector<float> MakeNoise(size_t len)
+{
+   std::mt19937 engine { 42 };
+   std::uniform_real_distribution<float> distribution { -1.f, 1.f };
+   std::vector<float> result(len);
+   for (auto& sample : result)
+      sample = distribution(engine);
+   return result;
+}
+
+//! Bins in order, DC and Fs/2 first, as InverseRealFFTf takes them
+std::vector<float> Spectrum(const std::vector<float>& input, FFTBackend backend)
+{
+   const auto hFFT = GetFFT(input.size(), backend);
+   auto buffer = input;
+   RealFFTf(buffer.data(), hFFT.get());
+   std::vector<float> result(input.size());
+   result[0] = buffer[0];
+   result[1] = buffer[1];
+   for (size_t ii = 1; ii < hFFT->Points; ++ii)
+   {
+      result[2 * ii] = buffer[hFFT->BitReversed[ii]];
+      result[2 * ii + 1] = buffer[hFFT->BitReversed[ii] + 1];
+   }
+   return result;
+}
+} // namespace
+
+TEST_CASE("RealFFTf backends agree")
+{
+   REQUIRE(IsFFTBackendAvailable(FFTBackend::Radix2, 2));
+   REQUIRE(!IsFFTBackendAvailable(FFTBackend::Radix2, 48));
+
+   for (size_t size = 32; size <= 65536; size *= 4)
+   {
+      if (!IsFFTBackendAvailable(FFTBackend::Pffft, size))
+         continue;
+      const auto noise = MakeNoise(size);
+      const auto expected = Spectrum(noise, FFTBackend::Radix2);
+      const auto actual = Spectrum(noise, FFTBackend::Pffft);
+      // Errors of both grow with the size of the transform
+      const auto tolerance = 1e-5f * std::sqrt(static_cast<float>(size));
+      for (size_t ii = 0; ii < size; ++ii)
+         REQUIRE(actual[ii] == Approx(expected[ii]).margin(tolerance));
+
+      // Each inverse undoes its forward transform, with the same scaling,
+      // even for buffers without the alignment of PFFFT
+      for (const auto backend : { FFTBackend::Radix2, FFTBackend::Pffft })
+      {
+         const auto hFFT = GetFFT(size, backend);
+         std::vector<float> storage(size + 1);
+         const auto buffer = storage.data() + 1;
+         std::copy(expected.begin(), expected.end(), buffer);
+         InverseRealFFTf(buffer, hFFT.get());
+         std::vector<float> output(size);
+         ReorderToTime(hFFT.get(), buffer, output.data());
+         for (size_t ii = 0; ii < size; ++ii)
+            REQUIRE(output[ii] == Approx(noise[ii]).margin(1e-5));
+      }
+   }
+}
+
+TEST_CASE("GetFFT uses the chosen backend when it can")
+{
+   const auto previous = GetFFTBackend();
+   SetFFTBackend(FFTBackend::Pffft);
+   const auto expected = IsFFTBackendAvailable(FFTBackend::Pffft, 1024)
+      ? FFTBackend::Pffft : FFTBackend::Radix2;
+   REQUIRE(GetFFT(1024)->backend == expected);
+   // Too small for PFFFT
+   REQUIRE(GetFFT(16)->backend == FFTBackend::Radix2);
+   SetFFTBackend(FFTBackend::Radix2);
+   REQUIRE(GetFFT(1024)->backend == FFTBackend::Radix2);
+   SetFFTBackend(previous);
+}
+
+// Hidden by default; run with the tag to see timings
+TEST_CASE("RealFFTf benchmark", "[.benchmark]")
+{
+   for (size_t size = 256; size <= 65536; size *= 2)
+   {
+      const auto noise = MakeNoise(size);
+      // About the same number of samples for each size
+      const auto repetitions = (1 << 24) / size;
+
+      const auto time = [&](FFTBackend backend) {
+         const auto hFFT = GetFFT(size, backend);
+         auto buffer = noise;
+         const auto start = std::chrono::steady_clock::now();
+         for (size_t ii = 0; ii < repetitions; ++ii)
+         {
+            RealFFTf(buffer.data(), hFFT.get());
+            InverseRealFFTf(buffer.data(), hFFT.get());
+         }
+         return std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+      };
+
+      const auto radix2 = time(FFTBackend::Radix2);
+      std::cout << "Size " << size << ", radix 2: " << radix2 << " s";
+      if (IsFFTBackendAvailable(FFTBackend::Pffft, size))
+      {
+         const auto pffft = time(FFTBackend::Pffft);
+         std::cout << ", PFFFT: " << pffft
+                   << " s, speedup: " << radix2 / pffft;
+      }
+      std::cout << "\n";
+   }
+}
@@ -0,0 +1,215 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleConversionTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "Dither.h"
+#include "SampleFormat.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr size_t len = 4099; // Not a multiple of any vector size
+
+std::vector<float> MakeNoise(size_t count, float amplitude)
+{
+   std::mt19937 engine { 7 };
+   std::uniform_real_distribution<float> distribution { -amplitude, amplitude };
+   std::vector<float> result(count);
+   for (auto& sample : result)
+      sample = distribution(engine);
+   return result;
+}
+
+// The scalar store of Dither.cpp
+template<typename Int> Int Store(float sample, Int lower, Int upper)
+{
+   const long x = lrintf(sample);
+   return x > upper ? upper : x < lower ? lower : static_cast<Int>(x);
+}
+
+float Clip(float sample)
+{
+   return sample > 1.0f ? 1.0f : sample < -1.0f ? -1.0f : sample;
+}
+
+template<typename Src, typename Dst>
+std::vector<Dst> Convert(
+   const std::vector<Src>& src, sampleFormat srcFormat, sampleFormat dstFormat,
+   DitherType dither = DitherType::none)
+{
+   std::vector<Dst> dst(src.size());
+   CopySamples(
+      reinterpret_cast<constSamplePtr>(src.data()), srcFormat,
+      reinterpret_cast<samplePtr>(dst.data()), dstFormat, src.size(), dither);
+   return dst;
+}
+} // namespace
+
+TEST_CASE("Vectorized sample conversions agree with scalar ones")
+{
+   const auto noise = MakeNoise(len, 1.2f);
+   std::vector<short> int16s(len);
+   std::vector<int> int24s(len);
+   for (size_t ii = 0; ii < len; ++ii)
+   {
+      int16s[ii] = Store<short>(Clip(noise[ii]) * 32768.f, -32768, 32767);
+      int24s[ii] = Store<int>(Clip(noise[ii]) * 8388608.f, -8388608, 8388607);
+   }
+
+   SECTION("int16 to float")
+   {
+      const auto result = Convert<short, float>(int16s, int16Sample, floatSample);
+      for (size_t ii = 0; ii < len; ++ii)
+         REQUIRE(result[ii] == int16s[ii] / 32768.f);
+   }
+
+   SECTION("int24 to float")
+   {
+      const auto result = Convert<int, float>(int24s, int24Sample, floatSample);
+      for (size_t ii = 0; ii < len; ++ii)
+         REQUIRE(result[ii] == int24s[ii] / 8388608.f);
+   }
+
+   SECTION("int16 to int24")
+   {
+      const auto result = Convert<short, int>(int16s, int16Sample, int24Sample);
+      for (size_t ii = 0; ii < len; ++ii)
+         REQUIRE(result[ii] == int16s[ii] * 256);
+   }
+
+   SECTION("float to int16 and int24 without dither")
+   {
+      const auto result16 = Convert<float, short>(noise, floatSample, int16Sample);
+      const auto result24 = Convert<float, int>(noise, floatSample, int24Sample);
+      for (size_t ii = 0; ii < len; ++ii)
+      {
+         REQUIRE(
+            result16[ii] ==
+            Store<short>(Clip(noise[ii]) * 32768.f, -32768, 32767));
+         REQUIRE(
+            result24[ii] ==
+            Store<int>(Clip(noise[ii]) * 8388608.f, -8388608, 8388607));
+      }
+   }
+
+   SECTION("int24 to int16 without dither")
+   {
+      const auto result = Convert<int, short>(int24s, int24Sample, int16Sample);
+      for (size_t ii = 0; ii < len; ++ii)
+         REQUIRE(
+            result[ii] ==
+            Store<short>(int24s[ii] / 8388608.f * 32768.f, -32768, 32767));
+   }
+
+   SECTION("float to int16 with triangle dither")
+   {
+      // The noise comes from rand(); seed it the same for the expectation
+      // and for each conversion
+      constexpr unsigned seed = 1;
+      std::srand(seed);
+      std::vector<short> expected(len);
+      float previous = 0;
+      for (size_t ii = 0; ii < len; ++ii)
+      {
+         const float r = std::rand() / (float)RAND_MAX - 0.5f;
+         const float sample = Clip(noise[ii]) * 32768.f;
+         expected[ii] = Store<short>(sample + r - previous, -32768, 32767);
+         previous = r;
+      }
+
+      // Not the ditherer that CopySamples shares
+      Dither dither;
+      std::vector<short> result(len);
+      const auto apply = [&] {
+         std::srand(seed);
+         dither.Apply(
+            DitherType::triangle, reinterpret_cast<constSamplePtr>(noise.data()),
+            floatSample, reinterpret_cast<samplePtr>(result.data()),
+            int16Sample, len);
+      };
+      apply();
+      REQUIRE(result == expected);
+
+      // Each conversion starts from reset state
+      std::fill(result.begin(), result.end(), 0);
+      apply();
+      REQUIRE(result == expected);
+   }
+
+   SECTION("stereo interleaving")
+   {
+      std::vector<float> interleaved(2 * len);
+      for (auto channel : { 0, 1 })
+         CopySamples(
+            reinterpret_cast<constSamplePtr>(noise.data()), floatSample,
+            reinterpret_cast<samplePtr>(interleaved.data() + channel),
+            floatSample, len, DitherType::none, 1, 2);
+      for (size_t ii = 0; ii < len; ++ii)
+      {
+         REQUIRE(interleaved[2 * ii] == noise[ii]);
+         REQUIRE(interleaved[2 * ii + 1] == noise[ii]);
+      }
+
+      std::vector<float> channel(len);
+      SamplesToFloats(
+         reinterpret_cast<constSamplePtr>(interleaved.data() + 1), floatSample,
+         channel.data(), len, 2, 1);
+      REQUIRE(channel == noise);
+   }
+}
+
+// Hidden by default; run with the tag to see throughput
+TEST_CASE("Sample conversion benchmark", "[.benchmark]")
+{
+   constexpr size_t count = 1 << 20;
+   constexpr auto repetitions = 50;
+   const auto noise = MakeNoise(2 * count, 1.0f);
+   std::vector<char> src(2 * count * sizeof(float));
+   std::vector<char> dst(2 * count * sizeof(float));
+
+   const auto report = [&](const char* name, sampleFormat srcFormat,
+                           sampleFormat dstFormat, DitherType dither,
+                           unsigned srcStride, unsigned dstStride) {
+      CopySamples(
+         reinterpret_cast<constSamplePtr>(noise.data()), floatSample,
+         src.data(), srcFormat, 2 * count, DitherType::none);
+      const auto start = std::chrono::steady_clock::now();
+      for (auto ii = 0; ii < repetitions; ++ii)
+         CopySamples(
+            src.data(), srcFormat, dst.data(), dstFormat, count, dither,
+            srcStride, dstStride);
+      const std::chrono::duration<double> elapsed =
+         std::chrono::steady_clock::now() - start;
+      std::cout << name << ": "
+                << count * repetitions / elapsed.count() / 1e6
+                << " Msamples/s\n";
+   };
+
+   report("int16 to float", int16Sample, floatSample, DitherType::none, 1, 1);
+   report("int24 to float", int24Sample, floatSample, DitherType::none, 1, 1);
+   report("int16 to int24", int16Sample, int24Sample, DitherType::none, 1, 1);
+   report("float to int16", floatSample, int16Sample, DitherType::none, 1, 1);
+   report("float to int24", floatSample, int24Sample, DitherType::none, 1, 1);
+   report(
+      "float to int16, triangle dither", floatSample, int16Sample,
+      DitherType::triangle, 1, 1);
+   report(
+      "float to int16, shaped dither", floatSample, int16Sample,
+      DitherType::shaped, 1, 1);
+   report("deinterleave float", floatSample, floatSample, DitherType::none, 2, 1);
+   report("interleave float", floatSample, floatSample, DitherType::none, 1, 2);
+   report("deinterleave int16 to float", int16Sample, floatSample,
+      DitherType::none, 2, 1);
+}
@@ -0,0 +1,143 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleSummaryTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "SampleSummary.h"
+
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+std::vector<float> MakeNoise(size_t len)
+{
+   std::mt19937 engine { 42 };
+   std::uniform_real_distribution<float> distribution { -1.f, 1.f };
+   std::vector<float> result(len);
+   for (auto& sample : result)
+      sample = distribution(engine);
+   return result;
+}
+
+// The loop that SqliteSampleBlock used before vectorization
+SampleSummary ReferenceSummary(const float* samples, size_t len)
+{
+   float min = FLT_MAX, max = -FLT_MAX, sumsq = 0;
+   for (size_t ii = 0; ii < len; ++ii)
+   {
+      min = std::min(min, samples[ii]);
+      max = std::max(max, samples[ii]);
+      sumsq += samples[ii] * samples[ii];
+   }
+   return { min, max, sumsq };
+}
+} // namespace
+
+TEST_CASE("ComputeSampleSummary")
+{
+   const auto noise = MakeNoise(65536 + 13);
+
+   SECTION("matches the scalar loop")
+   {
+      for (const size_t len : { 0, 1, 7, 8, 9, 255, 256, 257, 65536 + 13 })
+      {
+         const auto expected = ReferenceSummary(noise.data(), len);
+         const auto actual = ComputeSampleSummary(noise.data(), len);
+         // Extremes are exact, whatever the order of evaluation
+         REQUIRE(actual.min == expected.min);
+         REQUIRE(actual.max == expected.max);
+         REQUIRE(
+            actual.sumsq ==
+            Approx(expected.sumsq).epsilon(1e-5).margin(1e-6));
+      }
+   }
+
+   SECTION("works at any alignment")
+   {
+      for (size_t offset = 0; offset < 4; ++offset)
+      {
+         const auto expected = ReferenceSummary(noise.data() + offset, 100);
+         const auto actual = ComputeSampleSummary(noise.data() + offset, 100);
+         REQUIRE(actual.min == expected.min);
+         REQUIRE(actual.max == expected.max);
+      }
+   }
+}
+
+TEST_CASE("ComputeWindowedSummaries")
+{
+   constexpr size_t len = 1000;
+   const auto noise = MakeNoise(len);
+   std::vector<float> summaries(3 * ((len + 255) / 256));
+   const auto totalSquares =
+      ComputeWindowedSummaries(noise.data(), len, 256, summaries.data());
+
+   double expectedTotal = 0;
+   for (size_t start = 0, ii = 0; start < len; start += 256, ++ii)
+   {
+      const auto count = std::min<size_t>(256, len - start);
+      const auto expected = ReferenceSummary(noise.data() + start, count);
+      expectedTotal += expected.sumsq;
+      REQUIRE(summaries[3 * ii] == expected.min);
+      REQUIRE(summaries[3 * ii + 1] == expected.max);
+      REQUIRE(
+         summaries[3 * ii + 2] ==
+         Approx(std::sqrt(expected.sumsq / count)).epsilon(1e-5));
+   }
+   REQUIRE(totalSquares == Approx(expectedTotal).epsilon(1e-6));
+}
+
+TEST_CASE("CombineWindowedSummaries")
+{
+   constexpr size_t len = 65536 * 2;
+   const auto noise = MakeNoise(len);
+   std::vector<float> summaries(3 * (len / 256));
+   ComputeWindowedSummaries(noise.data(), len, 256, summaries.data());
+
+   // Windows 3 to 300 inclusive
+   const auto expected = ReferenceSummary(noise.data() + 3 * 256, 298 * 256);
+   const auto actual =
+      CombineWindowedSummaries(summaries.data() + 3 * 3, 298, 256);
+   REQUIRE(actual.min == expected.min);
+   REQUIRE(actual.max == expected.max);
+   REQUIRE(actual.sumsq == Approx(expected.sumsq).epsilon(1e-4));
+
+   const auto none = CombineWindowedSummaries(summaries.data(), 0, 256);
+   REQUIRE(none.min == FLT_MAX);
+   REQUIRE(none.max == -FLT_MAX);
+   REQUIRE(none.sumsq == 0);
+}
+
+// Hidden by default; run with the tag to see timings
+TEST_CASE("ComputeSampleSummary benchmark", "[.benchmark]")
+{
+   // One block of the default size
+   const auto noise = MakeNoise(262144);
+   constexpr auto repetitions = 1000;
+
+   const auto time = [&](auto&& function) {
+      volatile float sink = 0;
+      const auto start = std::chrono::steady_clock::now();
+      for (auto ii = 0; ii < repetitions; ++ii)
+         for (size_t offset = 0; offset < noise.size(); offset += 256)
+            sink = sink + function(noise.data() + offset, 256).sumsq;
+      return std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start)
+         .count();
+   };
+
+   const auto scalar = time(ReferenceSummary);
+   const auto vectorized = time(ComputeSampleSummary);
+   std::cout << "Summaries of 256 samples, scalar: " << scalar
+             << " s, vectorized: " << vectorized
+             << " s, speedup: " << scalar / vectorized << "\n";
+}
@@ -11,6 +11,10 @@
 
 PlayableSequence::~PlayableSequence() = default;
 
+void PlayableSequence::Prefetch(double, bool) const
+{
+}
+
 RecordableSequence::~RecordableSequence() = default;
 
 OtherPlayableSequence::~OtherPlayableSequence() = default;
@@ -33,6 +33,15 @@ struct MIXER_API PlayableSequence
 
    //! May vary asynchronously
    virtual bool GetMute() const = 0;
+
+   //! Request, without waiting, that samples near time t be made faster to
+   //! fetch
+   /*!
+    Called by the thread that fills playback buffers, ahead of its reads.
+    Default does nothing.
+    @param backwards whether the reads go toward earlier times
+    */
+   virtual void Prefetch(double t, bool backwards) const;
 };
 
 using ConstPlayableSequences =
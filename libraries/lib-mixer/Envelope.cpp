@@ -29,6 +29,7 @@ a draggable point type.
 
 #include "Envelope.h"
 
+#include <algorithm>
 #include <float.h>
 #include <math.h>
 
@@ -271,6 +272,21 @@ Envelope::Envelope(const Envelope &orig)
    CopyRange(orig, 0, orig.GetNumberOfPoints());
 }
 
+bool Envelope::IsSameAs(const Envelope &other) const
+{
+   // Compare what the copy constructor copies
+   return mDB == other.mDB &&
+      mMinValue == other.mMinValue &&
+      mMaxValue == other.mMaxValue &&
+      mDefaultValue == other.mDefaultValue &&
+      mOffset == other.mOffset &&
+      mTrackLen == other.mTrackLen &&
+      std::equal(mEnv.begin(), mEnv.end(), other.mEnv.begin(), other.mEnv.end(),
+         [](const EnvPoint &a, const EnvPoint &b){
+            return a.GetT() == b.GetT() && a.GetVal() == b.GetVal();
+         });
+}
+
 void Envelope::CopyRange(const Envelope &orig, size_t begin, size_t end)
 {
    size_t len = orig.mEnv.size();
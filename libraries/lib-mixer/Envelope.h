@@ -85,6 +85,9 @@ public:
 
    bool IsTrivial() const;
 
+   //! Whether a copy of this envelope would equal a copy of the other
+   bool IsSameAs(const Envelope &other) const;
+
    // Return true if violations of point ordering invariants were detected
    // and repaired
    bool ConsistencyCheck();
@@ -23,7 +23,11 @@
 #include "Resample.h"
 #include "WideSampleSequence.h"
 #include "float_cast.h"
+#include "TaskPool.h"
+#include <algorithm>
+#include <functional>
 #include <numeric>
+#include <utility>
 
 namespace {
 template<typename T, typename F> std::vector<T>
@@ -76,7 +80,7 @@ Mixer::Mixer(Inputs inputs,
    const size_t outBufferSize, const bool outInterleaved,
    double outRate, sampleFormat outFormat,
    const bool highQuality, MixerSpec *const mixerSpec,
-   const bool applyTrackGains
+   const bool applyTrackGains, const bool parallel
 )  : mNumChannels{ numOutChannels }
    , mInputs{ move(inputs) }
    , mBufferSize{ FindBufferSize(mInputs, outBufferSize) }
@@ -180,6 +184,18 @@ Mixer::Mixer(Inputs inputs,
 
    // Decide once at construction time
    std::tie(mNeedsDither, mEffectiveFormat) = NeedsDither(needsDither, outRate);
+
+   // The calling thread takes a share of the sources too
+   const auto nSources = mDecoratedSources.size();
+   if (parallel && nSources > 1) {
+      // Like mFloatBuffers
+      mSourceBuffers.reserve(nSources);
+      for (size_t ii = 0; ii < nSources; ++ii)
+         mSourceBuffers.emplace_back(3, mBufferSize, 1, 1);
+      mResults.resize(nSources);
+      mErrors.resize(nSources);
+      mParallel = true;
+   }
 }
 
 Mixer::~Mixer()
@@ -268,6 +284,71 @@ static void MixBuffers(unsigned numChannels,
 
 #define stackAllocate(T, count) static_cast<T*>(alloca(count * sizeof(T)))
 
+namespace {
+// Decides which output buffers an input channel accumulates into
+unsigned char *FindChannelFlags(unsigned char *channelFlags,
+   unsigned numChannels,
+   const bool *map, const WideSampleSequence &sequence, size_t iChannel)
+{
+   const auto end = channelFlags + numChannels;
+   std::fill(channelFlags, end, 0);
+   if (map)
+      // ignore left and right when downmixing is customized
+      std::copy(map, map + numChannels, channelFlags);
+   else if (IsMono(sequence))
+      std::fill(channelFlags, end, 1);
+   else if (iChannel == 0)
+      channelFlags[0] = 1;
+   else if (iChannel == 1) {
+      if (numChannels >= 2)
+         channelFlags[1] = 1;
+      else
+         channelFlags[0] = 1;
+   }
+   return channelFlags;
+}
+}
+
+void Mixer::MixSource(Source &source, AudioGraph::Buffers &buffers,
+   size_t result, unsigned char *channelFlags, float *gains)
+{
+   auto &[ upstream, downstream ] = source;
+   // TODO: more-than-two-channels
+   const auto maxChannels = std::max(2u, buffers.Channels());
+   const auto limit = std::min<size_t>(upstream.Channels(), maxChannels);
+   for (size_t j = 0; j < limit; ++j) {
+      const auto pFloat = (const float *)buffers.GetReadPosition(j);
+      auto &sequence = upstream.GetSequence();
+      if (mApplyTrackGains) {
+         for (size_t c = 0; c < mNumChannels; ++c) {
+            if (mNumChannels > 1)
+               gains[c] = sequence.GetChannelGain(c);
+            else
+               gains[c] = sequence.GetChannelGain(j);
+         }
+      }
+      const auto flags = FindChannelFlags(channelFlags, mNumChannels,
+         upstream.MixerSpec(j), sequence, j);
+      MixBuffers(mNumChannels, flags, gains, *pFloat, mTemp, result);
+   }
+
+   downstream.Release();
+   buffers.Advance(result);
+   buffers.Rotate();
+}
+
+void Mixer::UpdateTime(MixerSource &source)
+{
+   const auto lastTime = source.TakeLastTime();
+   if (!lastTime)
+      return;
+   auto &[mT0, mT1, _, mTime] = *mTimesAndSpeed;
+   if (mT1 < mT0)
+      mTime = std::min(mTime, *lastTime);
+   else
+      mTime = std::max(mTime, *lastTime);
+}
+
 size_t Mixer::Process(const size_t maxToProcess)
 {
    assert(maxToProcess <= BufferSize());
@@ -283,38 +364,43 @@ size_t Mixer::Process(const size_t maxToProcess)
    if (!mApplyTrackGains)
       std::fill(gains, gains + mNumChannels, 1.0f);
 
-   // Decides which output buffers an input channel accumulates into
-   auto findChannelFlags = [&channelFlags, numChannels = mNumChannels]
-   (const bool *map, const WideSampleSequence &sequence, size_t iChannel){
-      const auto end = channelFlags + numChannels;
-      std::fill(channelFlags, end, 0);
-      if (map)
-         // ignore left and right when downmixing is customized
-         std::copy(map, map + numChannels, channelFlags);
-      else if (IsMono(sequence))
-         std::fill(channelFlags, end, 1);
-      else if (iChannel == 0)
-         channelFlags[0] = 1;
-      else if (iChannel == 1) {
-         if (numChannels >= 2)
-            channelFlags[1] = 1;
-         else
-            channelFlags[0] = 1;
-      }
-      return channelFlags;
-   };
-
    auto &[mT0, mT1, _, mTime] = *mTimesAndSpeed;
    auto oldTime = mTime;
    // backwards (as possibly in scrubbing)
    const auto backwards = (mT0 > mT1);
 
    Clear();
-   // TODO: more-than-two-channels
-   auto maxChannels = std::max(2u, mFloatBuffers.Channels());
 
-   for (auto &[ upstream, downstream ] : mDecoratedSources) {
-      auto oResult = downstream.Acquire(mFloatBuffers, maxToProcess);
+   if (mParallel) {
+      // Fetch, resample, and apply effect stages to all sources concurrently,
+      // each into its own buffers; then accumulate in the same order as
+      // below, so that the sums are the same to the bit
+      const auto nSources = mDecoratedSources.size();
+      TaskPool::Get().ForEach(nSources, [this, maxToProcess](size_t ii){
+         try {
+            mResults[ii] = mDecoratedSources[ii].downstream
+               .Acquire(mSourceBuffers[ii], maxToProcess);
+         }
+         catch (...) {
+            mErrors[ii] = std::current_exception();
+         }
+      });
+      for (size_t ii = 0; ii < nSources; ++ii)
+         if (auto pError = std::exchange(mErrors[ii], nullptr))
+            std::rethrow_exception(pError);
+      for (size_t ii = 0; ii < nSources; ++ii) {
+         auto &source = mDecoratedSources[ii];
+         UpdateTime(source.upstream);
+         if (!mResults[ii])
+            return 0;
+         auto result = *mResults[ii];
+         maxOut = std::max(maxOut, result);
+         MixSource(source, mSourceBuffers[ii], result, channelFlags, gains);
+      }
+   }
+   else for (auto &source : mDecoratedSources) {
+      auto oResult = source.downstream.Acquire(mFloatBuffers, maxToProcess);
+      UpdateTime(source.upstream);
       // One of MixVariableRates or MixSameRate assigns into mTemp[*][*] which
       // are the sources for the CopySamples calls, and they copy into
       // mBuffer[*][*]
@@ -324,27 +410,7 @@ size_t Mixer::Process(const size_t maxToProcess)
       maxOut = std::max(maxOut, result);
 
       // Insert effect stages here!  Passing them all channels of the track
-
-      const auto limit = std::min<size_t>(upstream.Channels(), maxChannels);
-      for (size_t j = 0; j < limit; ++j) {
-         const auto pFloat = (const float *)mFloatBuffers.GetReadPosition(j);
-         auto &sequence = upstream.GetSequence();
-         if (mApplyTrackGains) {
-            for (size_t c = 0; c < mNumChannels; ++c) {
-               if (mNumChannels > 1)
-                  gains[c] = sequence.GetChannelGain(c);
-               else
-                  gains[c] = sequence.GetChannelGain(j);
-            }
-         }
-         const auto flags =
-            findChannelFlags(upstream.MixerSpec(j), sequence, j);
-         MixBuffers(mNumChannels, flags, gains, *pFloat, mTemp, result);
-      }
-
-      downstream.Release();
-      mFloatBuffers.Advance(result);
-      mFloatBuffers.Rotate();
+      MixSource(source, mFloatBuffers, result, channelFlags, gains);
    }
 
    if (backwards)
@@ -15,6 +15,9 @@
 #include "AudioGraphBuffers.h"
 #include "MixerOptions.h"
 #include "SampleFormat.h"
+#include <exception>
+#include <memory>
+#include <optional>
 
 class sampleCount;
 class BoundedEnvelope;
@@ -62,7 +65,10 @@ class MIXER_API Mixer {
          bool highQuality = true,
          //! Null or else must have a lifetime enclosing this object's
          MixerSpec *mixerSpec = nullptr,
-         bool applytTrackGains = true);
+         bool applytTrackGains = true,
+         //! Whether to fetch, resample, and apply stages to the inputs on
+         //! threads of the TaskPool; the output is the same either way
+         bool parallel = false);
 
    Mixer(const Mixer&) = delete;
    Mixer &operator=(const Mixer&) = delete;
@@ -115,6 +121,14 @@ class MIXER_API Mixer {
 
    void Clear();
 
+   struct Source;
+   //! Accumulate one acquired source into mTemp, then release it
+   void MixSource(Source &source, AudioGraph::Buffers &buffers, size_t result,
+      unsigned char *channelFlags, float *gains);
+   //! Fold the time reached by one source into mTimesAndSpeed, if it was
+   //! acquired since the last update; effect stages may not have pulled it
+   void UpdateTime(MixerSource &source);
+
  private:
 
    // Input
@@ -161,5 +175,12 @@ class MIXER_API Mixer {
 
    struct Source { MixerSource &upstream; AudioGraph::Source &downstream; };
    std::vector<Source> mDecoratedSources;
+
+   // For parallel processing only: one buffer and result for each source,
+   // in place of the shared mFloatBuffers
+   bool mParallel{ false };
+   std::vector<AudioGraph::Buffers> mSourceBuffers;
+   std::vector<std::optional<size_t>> mResults;
+   std::vector<std::exception_ptr> mErrors;
 };
 #endif
@@ -18,6 +18,8 @@
 #include "MixerOptions.h"
 #include "SampleCount.h"
 #include <memory>
+#include <optional>
+#include <utility>
 
 class Resample;
 class SampleTrack;
@@ -64,6 +66,15 @@ public:
 
    bool VariableRates() const { return mResampleParameters.mVariableRates; }
 
+   //! Time reached by Acquire(), if it was called since the last call of
+   //! this function; then forget it
+   /*!
+    The shared TimesAndSpeed is not written here, so that sources may be
+    acquired concurrently; the Mixer updates it
+    */
+   std::optional<double> TakeLastTime()
+   { return std::exchange(mLastTime, std::nullopt); }
+
 private:
    void MakeResamplers();
 
@@ -137,5 +148,6 @@ private:
    //! Remember how many channels were passed to Acquire()
    unsigned mMaxChannels{};
    size_t mLastProduced{};
+   std::optional<double> mLastTime;
 };
 #endif
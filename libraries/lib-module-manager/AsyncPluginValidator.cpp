@@ -24,7 +24,9 @@
 #include "PluginIPCUtils.h"
 #include "PluginDescriptor.h"
 #include "PluginHost.h"
+#include "PluginValidationCache.h"
 #include "XMLFileReader.h"
+#include "XMLWriter.h"
 
 AsyncPluginValidator::Delegate::~Delegate() = default;
 
@@ -79,11 +81,13 @@ class AsyncPluginValidator::Impl final :
       }
    }
 
-   void HandleResult(detail::PluginValidationResult&& result) noexcept
+   ///@param fromHost whether the result is a response of the host, which
+   ///is then remembered in PluginValidationCache
+   void HandleResult(detail::PluginValidationResult&& result, bool fromHost) noexcept
    {
       try
       {
-         BasicUI::CallAfter([wptr = weak_from_this(), result = detail::PluginValidationResult { result }]
+         BasicUI::CallAfter([wptr = weak_from_this(), result = detail::PluginValidationResult { result }, fromHost]
          {
             if(auto self = wptr.lock())
             {
@@ -105,6 +109,18 @@ class AsyncPluginValidator::Impl final :
                   return;
                }
 
+               if(fromHost)
+               {
+                  wxString providerId;
+                  wxString pluginPath;
+                  if(detail::ParseRequestString(*request, providerId, pluginPath))
+                  {
+                     XMLStringWriter xmlWriter;
+                     result.WriteXML(xmlWriter);
+                     PluginValidationCache::Get().Store(providerId, pluginPath, xmlWriter);
+                  }
+               }
+
                if(result.IsValid())
                {
                   for(auto& desc : result.GetDescriptors())
@@ -183,7 +199,7 @@ public:
       }
       detail::PluginValidationResult result;
       result.SetError("Disconnect");
-      HandleResult(std::move(result));
+      HandleResult(std::move(result), false);
    }
 
    void OnConnectionError() noexcept override
@@ -207,7 +223,7 @@ public:
             XMLFileReader xmlReader;
             xmlReader.ParseString(&result, message);
 
-            HandleResult(std::move(result));
+            HandleResult(std::move(result), true);
          }
       }
       catch(...)
@@ -216,7 +232,7 @@ public:
       }
    }
 
-   void Validate(const wxString& providerId, const wxString& pluginPath)
+   void Validate(const wxString& providerId, const wxString& pluginPath, bool useCache)
    {
       std::lock_guard lck(mSync);
 
@@ -224,6 +240,23 @@ public:
       assert(!mRequest.has_value());
 
       mRequest = detail::MakeRequestString(providerId, pluginPath);
+
+      //skip modules that did not change since the last validation
+      auto response = useCache
+         ? PluginValidationCache::Get().Find(providerId, pluginPath)
+         : std::optional<wxString>{};
+      if(response)
+      {
+         detail::PluginValidationResult result;
+         XMLFileReader xmlReader;
+         if(xmlReader.ParseString(&result, *response))
+         {
+            mLastTimeActive = std::chrono::system_clock::now().time_since_epoch().count();
+            HandleResult(std::move(result), false);
+            return;
+         }
+      }
+
       if(mChannel)
          detail::PutMessage(*mChannel, *mRequest);
       else
@@ -239,9 +272,9 @@ AsyncPluginValidator::AsyncPluginValidator(Delegate& delegate)
 
 AsyncPluginValidator::~AsyncPluginValidator() = default;
 
-void AsyncPluginValidator::Validate(const wxString& providerId, const wxString& pluginPath)
+void AsyncPluginValidator::Validate(const wxString& providerId, const wxString& pluginPath, bool useCache)
 {
-   mImpl->Validate(providerId, pluginPath);
+   mImpl->Validate(providerId, pluginPath, useCache);
 }
 
 void AsyncPluginValidator::SetDelegate(Delegate* delegate)
@@ -66,8 +66,11 @@ public:
     * \brief Each call to Validate should result in appropriate call
     * OnValidationFinished, until then it's not allowed to call this
     * method again. May fail with exception.
+    * Responses of the host are kept in PluginValidationCache.
     * \param providerId ID of the provider that should be used for validation
     * \param pluginPath path to the plugin module
+    * \param useCache if true, modules that did not change since their last
+    * validation are answered from the cache, instead of the host
     */
-   void Validate(const wxString& providerId, const wxString& pluginPath);
+   void Validate(const wxString& providerId, const wxString& pluginPath, bool useCache);
 };
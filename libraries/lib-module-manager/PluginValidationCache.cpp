@@ -0,0 +1,178 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginValidationCache.cpp
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#include "PluginValidationCache.h"
+
+#include <wx/filename.h>
+
+#include "FileNames.h"
+#include "PluginIPCUtils.h"
+#include "XMLFileReader.h"
+#include "XMLWriter.h"
+
+namespace
+{
+   constexpr auto NodeCache = "PluginValidationCache";
+   constexpr auto NodeModule = "Module";
+   constexpr auto AttrProviderId = "ProviderId";
+   constexpr auto AttrPath = "Path";
+   constexpr auto AttrModificationTime = "ModificationTime";
+   constexpr auto AttrSize = "Size";
+   constexpr auto AttrResponse = "Response";
+
+   FilePath CacheFilePath()
+   {
+      return wxFileName(FileNames::ConfigDir(), wxT("pluginvalidation.xml")).GetFullPath();
+   }
+
+   ///Module paths may name bundle directories, which are compared by
+   ///modification time only
+   bool GetFileStamp(const wxString& path, long long& modificationTime, long long& size)
+   {
+      wxFileName fileName { path };
+      if(wxFileName::DirExists(path))
+         size = 0;
+      else if(fileName.FileExists())
+      {
+         const auto fileSize = fileName.GetSize();
+         if(fileSize == wxInvalidSize)
+            return false;
+         size = fileSize.GetValue();
+      }
+      else
+         return false;
+
+      const auto dateTime = fileName.GetModificationTime();
+      if(!dateTime.IsValid())
+         return false;
+      modificationTime = dateTime.GetValue().GetValue();
+      return true;
+   }
+}
+
+PluginValidationCache& PluginValidationCache::Get()
+{
+   static PluginValidationCache instance;
+   return instance;
+}
+
+void PluginValidationCache::Load()
+{
+   if(mLoaded)
+      return;
+   mLoaded = true;
+
+   const auto path = CacheFilePath();
+   if(!wxFileName::FileExists(path))
+      return;
+
+   XMLFileReader reader;
+   if(!reader.Parse(this, path))
+      //Start over, rather than trust a part of it
+      mEntries.clear();
+}
+
+bool PluginValidationCache::HandleXMLTag(const std::string_view& tag, const AttributesList& attrs)
+{
+   if(tag == NodeCache)
+      return true;
+   if(tag != NodeModule)
+      return false;
+
+   wxString providerId;
+   wxString pluginPath;
+   Entry entry;
+   for(auto& p : attrs)
+   {
+      const auto& key = p.first;
+      const auto& value = p.second;
+      if(key == AttrProviderId)
+         providerId = value.ToWString();
+      else if(key == AttrPath)
+         pluginPath = value.ToWString();
+      else if(key == AttrModificationTime)
+         value.TryGet(entry.modificationTime);
+      else if(key == AttrSize)
+         value.TryGet(entry.size);
+      else if(key == AttrResponse)
+         entry.response = value.ToWString();
+   }
+   mEntries[detail::MakeRequestString(providerId, pluginPath)] = std::move(entry);
+   return true;
+}
+
+XMLTagHandler* PluginValidationCache::HandleXMLChild(const std::string_view& tag)
+{
+   if(tag == NodeModule)
+      return this;
+   return nullptr;
+}
+
+std::optional<wxString> PluginValidationCache::Find(const wxString& providerId, const wxString& pluginPath)
+{
+   Load();
+
+   const auto it = mEntries.find(detail::MakeRequestString(providerId, pluginPath));
+   if(it == mEntries.end())
+      return {};
+
+   long long modificationTime{};
+   long long size{};
+   if(!GetFileStamp(pluginPath, modificationTime, size) ||
+      it->second.modificationTime != modificationTime ||
+      it->second.size != size)
+      return {};
+
+   return it->second.response;
+}
+
+void PluginValidationCache::Store(const wxString& providerId, const wxString& pluginPath, const wxString& response)
+{
+   Load();
+
+   Entry entry;
+   if(!GetFileStamp(pluginPath, entry.modificationTime, entry.size))
+      return;
+   entry.response = response;
+   mEntries[detail::MakeRequestString(providerId, pluginPath)] = std::move(entry);
+   mModified = true;
+}
+
+void PluginValidationCache::Save()
+{
+   if(!mModified)
+      return;
+
+   try
+   {
+      XMLFileWriter writer { CacheFilePath(), XO("Error Saving Plugin Validation Cache") };
+      writer.StartTag(NodeCache);
+      for(auto& [request, entry] : mEntries)
+      {
+         wxString providerId;
+         wxString pluginPath;
+         if(!detail::ParseRequestString(request, providerId, pluginPath))
+            continue;
+         writer.StartTag(NodeModule);
+         writer.WriteAttr(AttrProviderId, providerId);
+         writer.WriteAttr(AttrPath, pluginPath);
+         writer.WriteAttr(AttrModificationTime, entry.modificationTime);
+         writer.WriteAttr(AttrSize, entry.size);
+         writer.WriteAttr(AttrResponse, entry.response);
+         writer.EndTag(NodeModule);
+      }
+      writer.EndTag(NodeCache);
+      writer.Commit();
+      mModified = false;
+   }
+   catch(...)
+   {
+   }
+}
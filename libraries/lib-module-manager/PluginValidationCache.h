@@ -0,0 +1,60 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginValidationCache.h
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#pragma once
+
+#include <optional>
+#include <unordered_map>
+
+#include <wx/string.h>
+
+#include "XMLTagHandler.h"
+
+/**
+ * \brief Remembers the responses of the plugin host, for each plugin
+ * provider and module path, together with the modification time and size
+ * of the module file, so that modules that did not change since are not
+ * validated again. Kept in a file in the configuration directory.
+ * To be used from the main thread only.
+ */
+class MODULE_MANAGER_API PluginValidationCache final : public XMLTagHandler
+{
+   struct Entry
+   {
+      long long modificationTime{};
+      long long size{};
+      ///Serialized detail::PluginValidationResult, as sent by the host
+      wxString response;
+   };
+
+   std::unordered_map<wxString, Entry> mEntries;
+   bool mLoaded{false};
+   bool mModified{false};
+
+   void Load();
+
+   bool HandleXMLTag(const std::string_view& tag, const AttributesList& attrs) override;
+   XMLTagHandler* HandleXMLChild(const std::string_view& tag) override;
+
+public:
+   static PluginValidationCache& Get();
+
+   ///@returns the response stored for the module, if its file has the same
+   ///modification time and size as then
+   std::optional<wxString> Find(const wxString& providerId, const wxString& pluginPath);
+
+   ///Replaces the response stored for the module, unless its file cannot be
+   ///examined
+   void Store(const wxString& providerId, const wxString& pluginPath, const wxString& response);
+
+   ///Writes the file, if anything changed. Failures are ignored, they only
+   ///cost validations on the next start
+   void Save();
+};
@@ -0,0 +1,40 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AutoSaveDelta.cpp
+
+**********************************************************************/
+#include "AutoSaveDelta.h"
+
+#include <algorithm>
+
+namespace AutoSaveDelta
+{
+Change Compute(
+   const unsigned char *base, size_t baseSize,
+   const unsigned char *doc, size_t size)
+{
+   const auto common = std::min(size, baseSize);
+   const size_t prefix = std::mismatch(doc, doc + common, base).first - doc;
+   size_t suffix = 0;
+   while (suffix < common - prefix &&
+      doc[size - 1 - suffix] == base[baseSize - 1 - suffix])
+      ++suffix;
+   return { prefix, baseSize - prefix - suffix, size - prefix - suffix };
+}
+
+bool Apply(std::vector<unsigned char> &doc,
+   long long position, long long removed,
+   const unsigned char *data, size_t size)
+{
+   if (position < 0 || removed < 0 ||
+       static_cast<unsigned long long>(position) > doc.size() ||
+       static_cast<unsigned long long>(removed) > doc.size() - position)
+      return false;
+   const auto first = doc.begin() + position;
+   doc.insert(doc.erase(first, first + removed), data, data + size);
+   return true;
+}
+}
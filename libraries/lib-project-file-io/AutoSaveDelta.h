@@ -0,0 +1,39 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AutoSaveDelta.h
+
+  @brief Changes of the autosave document, as appended to the project file
+
+**********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace AutoSaveDelta
+{
+//! Replacement of one range of a document
+struct Change final
+{
+   //! Where the range starts, in both the old and the new document
+   size_t position{ 0 };
+   //! Bytes of the old document that are replaced
+   size_t removed{ 0 };
+   //! Bytes of the new document, starting at position, that replace them
+   size_t inserted{ 0 };
+};
+
+//! Find the smallest range of base whose replacement gives doc
+PROJECT_FILE_IO_API Change Compute(
+   const unsigned char *base, size_t baseSize,
+   const unsigned char *doc, size_t size);
+
+//! Replace removed bytes of doc at position with data
+/*! @return false, leaving doc unchanged, if the range is not within doc */
+PROJECT_FILE_IO_API bool Apply(std::vector<unsigned char> &doc,
+   long long position, long long removed,
+   const unsigned char *data, size_t size);
+}
@@ -81,6 +81,33 @@ bool DBConnection::ShouldBypass()
    return mBypass;
 }
 
+void DBConnection::EnableTiles(int64_t budget, int64_t bytes)
+{
+   mHasTiles = true;
+   mTileBudget = budget;
+   mTileBytes = bytes;
+}
+
+bool DBConnection::HasTiles() const
+{
+   return mHasTiles;
+}
+
+int64_t DBConnection::GetTileBudget() const
+{
+   return mTileBudget;
+}
+
+int64_t DBConnection::AddTileBytes(int64_t bytes)
+{
+   return mTileBytes += bytes;
+}
+
+void DBConnection::SetTileBytes(int64_t bytes)
+{
+   mTileBytes = bytes;
+}
+
 void DBConnection::SetError(
    const TranslatableString &msg, const TranslatableString &libraryError, int errorCode)
 {
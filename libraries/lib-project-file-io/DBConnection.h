@@ -80,13 +80,26 @@ public:
       InsertSampleBlock,
       DeleteSampleBlock,
       GetSampleBlockSize,
-      GetAllSampleBlocksSize
+      GetAllSampleBlocksSize,
+      GetSamplesBatch,
+      GetTile,
+      PutTile
    };
    sqlite3_stmt *Prepare(enum StatementID id, const char *sql);
 
    void SetBypass( bool bypass );
    bool ShouldBypass();
 
+   //! Allow use of the tiles table, which must exist, and record its size
+   /*! Decided when the connection is opened; see ProjectTileCache */
+   void EnableTiles(int64_t budget, int64_t bytes);
+   bool HasTiles() const;
+   //! Bytes of tile data allowed before the oldest tiles are pruned
+   int64_t GetTileBudget() const;
+   //! Bytes of tile data, approximately, after writing or pruning
+   int64_t AddTileBytes(int64_t bytes);
+   void SetTileBytes(int64_t bytes);
+
    //! Just set stored errors
    void SetError(
       const TranslatableString &msg,
@@ -127,6 +140,10 @@ private:
 
    // Bypass transactions if database will be deleted after close
    bool mBypass;
+
+   bool mHasTiles{ false };
+   int64_t mTileBudget{ 0 };
+   std::atomic<int64_t> mTileBytes{ 0 };
 };
 
 using Connection = std::unique_ptr<DBConnection>;
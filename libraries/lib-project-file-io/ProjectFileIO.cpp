@@ -10,10 +10,13 @@ Paul Licameli split from AudacityProject.cpp
 
 #include "ProjectFileIO.h"
 
+#include <algorithm>
 #include <atomic>
 #include <sqlite3.h>
 #include <optional>
 #include <cstring>
+#include <utility>
+#include <vector>
 
 #include <wx/crt.h>
 #include <wx/log.h>
@@ -21,6 +24,7 @@ Paul Licameli split from AudacityProject.cpp
 #include <wx/utils.h>
 
 #include "ActiveProjects.h"
+#include "AutoSaveDelta.h"
 #include "CodeConversions.h"
 #include "DBConnection.h"
 #include "FileNames.h"
@@ -161,6 +165,82 @@ static const char *ProjectFileSchema =
    "  samples              BLOB"
    ");";
 
+// CREATE SQL tiles
+// Optional cache of data derived from sample blocks, such as spectra, so
+// that views need not compute them again when the project is reopened.
+//
+// settings is a hash of what the data depend on, and level is a zoom level.
+//
+// data is an array of float32 numbers.
+//
+// Rowids follow the order of writing, so the oldest tiles are pruned first
+// when the table grows beyond its budget.
+//
+// The trigger deletes the tiles of a sample block with the block, however
+// that happens.  Older versions of Audacity ignore the table but still run
+// the trigger.
+static const char *TileSchema =
+   "CREATE TABLE IF NOT EXISTS <schema>.tiles"
+   "("
+   "  blockid              INTEGER,"
+   "  kind                 INTEGER,"
+   "  settings             INTEGER,"
+   "  level                INTEGER,"
+   "  data                 BLOB,"
+   "  PRIMARY KEY (blockid, kind, settings, level)"
+   ");"
+   ""
+   "CREATE TRIGGER IF NOT EXISTS <schema>.tiles_delete"
+   "  AFTER DELETE ON sampleblocks"
+   "  BEGIN"
+   "    DELETE FROM tiles WHERE blockid = OLD.blockid;"
+   "  END;";
+
+BoolSetting ProjectTileCache{ L"/ProjectFile/TileCache", false };
+IntSetting ProjectTileCacheSize{ L"/ProjectFile/TileCacheSize", 256 };
+
+// autosavedelta holds changes of the autosave doc, in the order of id.
+// Each replaces removed bytes of the doc at position with data, and replaces
+// the whole dict, which is small.
+// The table is created at the first change, and emptied whenever the whole
+// autosave doc is written again.
+static const char *AutoSaveDeltaSchema =
+   "CREATE TABLE IF NOT EXISTS main.autosavedelta"
+   "("
+   "  id                   INTEGER PRIMARY KEY,"
+   "  dict                 BLOB,"
+   "  position             INTEGER,"
+   "  removed              INTEGER,"
+   "  data                 BLOB"
+   ");";
+
+// Write the whole autosave doc again after so many changes
+static constexpr size_t MaxAutoSaveDeltas = 100;
+
+static bool HasAutoSaveDeltaTable(sqlite3 *db)
+{
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]{ sqlite3_finalize(stmt); });
+   return
+      sqlite3_prepare_v2(db,
+         "SELECT 1 FROM main.sqlite_master"
+         " WHERE type = 'table' AND name = 'autosavedelta';",
+         -1, &stmt, nullptr) == SQLITE_OK &&
+      sqlite3_step(stmt) == SQLITE_ROW;
+}
+
+namespace {
+// While changes are appended to the autosave doc, don't allow older versions
+// to open the project.  They would recover the doc without the changes.
+ProjectFormatExtensionsRegistry::Extension autoSaveDeltasExtension(
+   [](const AudacityProject& project) -> ProjectFormatVersion {
+      if (ProjectFileIO::Get(project).HasAutoSaveDeltas())
+         return { 3, 5, 0, 0 };
+      return BaseProjectFormatVersion;
+   }
+);
+}
+
 // This singleton handles initialization/shutdown of the SQLite library.
 // It is needed because our local SQLite is built with SQLITE_OMIT_AUTOINIT
 // defined.
@@ -417,6 +497,35 @@ protected:
 
 constexpr std::array<const char*, 2> BufferedProjectBlobStream::Columns;
 
+//! Reads a dict and doc assembled in memory
+class BufferedMemoryStream final : public BufferedStreamReader
+{
+public:
+   explicit BufferedMemoryStream(std::vector<unsigned char> data)
+      : BufferedStreamReader(32 * 1024)
+      , mData{ std::move(data) }
+   {
+   }
+
+protected:
+   bool HasMoreData() const override
+   {
+      return mOffset < mData.size();
+   }
+
+   size_t ReadData(void* buffer, size_t maxBytes) override
+   {
+      maxBytes = std::min(maxBytes, mData.size() - mOffset);
+      memcpy(buffer, mData.data() + mOffset, maxBytes);
+      mOffset += maxBytes;
+      return maxBytes;
+   }
+
+private:
+   const std::vector<unsigned char> mData;
+   size_t mOffset { 0 };
+};
+
 bool ProjectFileIO::InitializeSQL()
 {
    static SQLiteIniter sqliteIniter;
@@ -572,6 +681,9 @@ bool ProjectFileIO::OpenConnection(FilePath fileName /* = {}  */)
       return false;
    }
 
+   if (ProjectTileCache.Read())
+      EnableTiles(*curConn);
+
    mTemporary = isTemp;
 
    SetFileName(fileName);
@@ -590,6 +702,7 @@ bool ProjectFileIO::CloseConnection()
       return false;
    }
    curConn.reset();
+   ResetAutoSaveBase();
 
    SetFileName({});
 
@@ -606,6 +719,7 @@ void ProjectFileIO::SaveConnection()
    mPrevConn = std::move(CurrConn());
    mPrevFileName = mFileName;
    mPrevTemporary = mTemporary;
+   ResetAutoSaveBase();
 
    SetFileName({});
 }
@@ -641,6 +755,7 @@ void ProjectFileIO::DiscardConnection()
       }
       mPrevConn = nullptr;
       mPrevFileName.clear();
+      ResetAutoSaveBase();
    }
 }
 
@@ -662,6 +777,7 @@ void ProjectFileIO::RestoreConnection()
    curConn = std::move(mPrevConn);
    SetFileName(mPrevFileName);
    mTemporary = mPrevTemporary;
+   ResetAutoSaveBase();
 
    mPrevFileName.clear();
 }
@@ -673,6 +789,7 @@ void ProjectFileIO::UseConnection(Connection &&conn, const FilePath &filePath)
 
    curConn = std::move(conn);
    SetFileName(filePath);
+   ResetAutoSaveBase();
 }
 
 static int ExecCallback(void *data, int cols, char **vals, char **names)
@@ -846,6 +963,55 @@ bool ProjectFileIO::InstallSchema(sqlite3 *db, const char *schema /* = "main" */
    return true;
 }
 
+// Total bytes of tile data, or -1 on failure
+static int64_t GetTileBytes(sqlite3 *db)
+{
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]
+   {
+      if (stmt)
+      {
+         sqlite3_finalize(stmt);
+      }
+   });
+
+   if (sqlite3_prepare_v2(db,
+         "SELECT COALESCE(SUM(length(data)), 0) FROM main.tiles;",
+         -1, &stmt, nullptr) != SQLITE_OK ||
+      sqlite3_step(stmt) != SQLITE_ROW)
+      return -1;
+   return sqlite3_column_int64(stmt, 0);
+}
+
+void ProjectFileIO::EnableTiles(DBConnection &conn)
+{
+   // The tiles are only a cache, so go on without them if this fails
+   if (!InstallTileSchema(conn.DB()))
+      return;
+   const auto bytes = GetTileBytes(conn.DB());
+   if (bytes < 0)
+      return;
+   conn.EnableTiles(
+      std::max(0, ProjectTileCacheSize.Read()) * int64_t{ 1024 * 1024 },
+      bytes);
+}
+
+bool ProjectFileIO::InstallTileSchema(sqlite3 *db, const char *schema /* = "main" */)
+{
+   wxString sql{ TileSchema };
+   sql.Replace("<schema>", schema);
+
+   int rc = sqlite3_exec(db, sql, nullptr, nullptr, nullptr);
+   if (rc != SQLITE_OK)
+   {
+      wxLogDebug(wxT("Unable to install the tile cache: %s"),
+         sqlite3_errmsg(db));
+      return false;
+   }
+
+   return true;
+}
+
 // The orphan block handling should be removed once autosave and related
 // blocks become part of the same transaction.
 
@@ -948,6 +1114,11 @@ bool ProjectFileIO::CopyTo(const FilePath &destpath,
    if (!pConn)
       return false;
 
+   // The copy gets no changes of the autosave doc, and the version that is
+   // written with the doc must not require them
+   if (!FoldAutoSaveDeltas())
+      return false;
+
    // Get access to the active tracklist
    auto pProject = &mProject;
 
@@ -1164,6 +1335,23 @@ bool ProjectFileIO::CopyTo(const FilePath &destpath,
          }
       }
 
+      // Copy the tiles of the copied blocks, if there are any.  They are only
+      // a cache, so ignore failure.
+      int64_t hasTiles = 0;
+      if (GetValue("SELECT Count(*) FROM main.sqlite_master"
+            " WHERE type = 'table' AND name = 'tiles';", hasTiles, true) &&
+         hasTiles > 0 && InstallTileSchema(db, "outbound"))
+      {
+         rc = sqlite3_exec(db,
+            "INSERT INTO outbound.tiles"
+            "  SELECT * FROM main.tiles"
+            "  WHERE blockid IN (SELECT blockid FROM outbound.sampleblocks)"
+            "  ORDER BY rowid;",
+            nullptr, nullptr, nullptr);
+         if (rc != SQLITE_OK)
+            wxLogDebug(wxT("Tiles were not copied: %s"), sqlite3_errmsg(db));
+      }
+
       // Write the doc.
       //
       // If we're compacting a temporary project (user initiated from the File
@@ -1803,7 +1991,7 @@ bool ProjectFileIO::AutoSave(bool recording)
    WriteXMLHeader(autosave);
    WriteXML(autosave, recording);
 
-   if (WriteDoc("autosave", autosave))
+   if (WriteAutoSave(autosave))
    {
       mModified = true;
       return true;
@@ -1812,6 +2000,336 @@ bool ProjectFileIO::AutoSave(bool recording)
    return false;
 }
 
+bool ProjectFileIO::WriteAutoSave(const ProjectSerializer &autosave)
+{
+   auto db = DB();
+
+   const MemoryStream &dict = autosave.GetDict();
+   const MemoryStream &data = autosave.GetData();
+   const auto pDict = static_cast<const unsigned char *>(dict.GetData());
+   const auto dictSize = dict.GetSize();
+   const auto pDoc = static_cast<const unsigned char *>(data.GetData());
+   const auto size = data.GetSize();
+
+   // Find the one range of the doc that changed since the last autosave
+   const auto change = AutoSaveDelta::Compute(
+      mAutoSaveDoc.data(), mAutoSaveDoc.size(), pDoc, size);
+   const auto prefix = change.position;
+   const auto removed = change.removed;
+   const auto inserted = change.inserted;
+
+   const auto remember = [&]{
+      mAutoSaveDict.assign(pDict, pDict + dictSize);
+      mAutoSaveDoc.assign(pDoc, pDoc + size);
+      mAutoSaveDB = db;
+   };
+
+   if (mAutoSaveDB != db ||
+       mAutoSaveDeltas >= MaxAutoSaveDeltas ||
+       // Replaying should not cost more than reading the doc again
+       2 * (mAutoSaveDeltaBytes + inserted) > size)
+   {
+      ResetAutoSaveBase();
+      // Delete the changes first, so that the doc is written with the
+      // version it requires without them
+      TransactionScope transaction(mProject, "AutoSave");
+      if (!DeleteAutoSaveDeltas(db) ||
+          !WriteDoc("autosave", autosave) ||
+          !transaction.Commit())
+         return false;
+      remember();
+      return true;
+   }
+
+   if (removed == 0 && inserted == 0 &&
+       std::equal(pDict, pDict + dictSize,
+          mAutoSaveDict.begin(), mAutoSaveDict.end()))
+      // Nothing changed
+      return true;
+
+   TransactionScope transaction(mProject, "AutoSave");
+
+   const auto reportError = [this](const char *sql) {
+      SetDBError(
+         XO("Failed to update the project file.\nThe following command failed:\n\n%s")
+            .Format(sql));
+   };
+
+   int rc = sqlite3_exec(db, AutoSaveDeltaSchema, nullptr, nullptr, nullptr);
+   if (rc != SQLITE_OK)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::WriteAutoSave::create");
+
+      reportError(AutoSaveDeltaSchema);
+      return false;
+   }
+
+   const char *sql =
+      "INSERT INTO main.autosavedelta(dict, position, removed, data)"
+      "  VALUES(?1, ?2, ?3, ?4);";
+
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]
+   {
+      if (stmt)
+      {
+         sqlite3_finalize(stmt);
+      }
+   });
+
+   rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+   if (rc != SQLITE_OK)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.query", sql);
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::WriteAutoSave::prepare");
+
+      SetDBError(
+         XO("Unable to prepare project file command:\n\n%s").Format(sql)
+      );
+      return false;
+   }
+
+   // SQLite does not accept null for an empty blob
+   static const unsigned char empty = 0;
+   if (
+      sqlite3_bind_blob64(stmt, 1, pDict ? pDict : &empty, dictSize, SQLITE_STATIC) ||
+      sqlite3_bind_int64(stmt, 2, prefix) ||
+      sqlite3_bind_int64(stmt, 3, removed) ||
+      sqlite3_bind_blob64(stmt, 4,
+         inserted ? pDoc + prefix : &empty, inserted, SQLITE_STATIC))
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.query", sql);
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::WriteAutoSave::bind");
+
+      SetDBError(XO("Unable to bind to blob"));
+      return false;
+   }
+
+   rc = sqlite3_step(stmt);
+   if (rc != SQLITE_DONE)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.query", sql);
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::WriteAutoSave::step");
+
+      reportError(sql);
+      return false;
+   }
+
+   // Finalize the statement before committing the transaction
+   sqlite3_finalize(stmt);
+   stmt = nullptr;
+
+   // The first change must raise the required version in the same
+   // transaction
+   ++mAutoSaveDeltas;
+   if (!WriteRequiredVersion() || !transaction.Commit())
+   {
+      --mAutoSaveDeltas;
+      return false;
+   }
+
+   remember();
+   mAutoSaveDeltaBytes += inserted + dictSize;
+   return true;
+}
+
+bool ProjectFileIO::DeleteAutoSaveDeltas(sqlite3 *db)
+{
+   if (!HasAutoSaveDeltaTable(db))
+      return true;
+
+   int rc =
+      sqlite3_exec(db, "DELETE FROM main.autosavedelta;", nullptr, nullptr, nullptr);
+   if (rc != SQLITE_OK)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::DeleteAutoSaveDeltas");
+
+      SetDBError(
+         XO("Failed to remove the autosave information from the project file.")
+      );
+      return false;
+   }
+
+   return true;
+}
+
+// Read the autosave doc, and replay the changes appended to it
+static bool ReadAutoSave(sqlite3 *db, std::vector<unsigned char> &dict,
+   std::vector<unsigned char> &doc, size_t &changes)
+{
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]{ sqlite3_finalize(stmt); });
+
+   const auto column = [&](int iCol) {
+      const auto p = static_cast<const unsigned char *>(
+         sqlite3_column_blob(stmt, iCol));
+      return std::vector<unsigned char>(
+         p, p + (p ? sqlite3_column_bytes(stmt, iCol) : 0));
+   };
+
+   if (sqlite3_prepare_v2(db,
+         "SELECT dict, doc FROM main.autosave WHERE id = 1;",
+         -1, &stmt, nullptr) != SQLITE_OK ||
+       sqlite3_step(stmt) != SQLITE_ROW)
+      return false;
+   dict = column(0);
+   doc = column(1);
+   sqlite3_finalize(stmt);
+   stmt = nullptr;
+
+   changes = 0;
+   if (!HasAutoSaveDeltaTable(db))
+      return true;
+
+   if (sqlite3_prepare_v2(db,
+         "SELECT dict, position, removed, data FROM main.autosavedelta"
+         "  ORDER BY id;",
+         -1, &stmt, nullptr) != SQLITE_OK)
+      return false;
+   int rc;
+   while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+      const auto data = column(3);
+      if (!AutoSaveDelta::Apply(doc,
+            sqlite3_column_int64(stmt, 1), sqlite3_column_int64(stmt, 2),
+            data.data(), data.size()))
+         return false;
+      dict = column(0);
+      ++changes;
+   }
+   return rc == SQLITE_DONE;
+}
+
+bool ProjectFileIO::DecodeAutoSave()
+{
+   std::vector<unsigned char> dict, doc;
+   size_t changes = 0;
+   if (!ReadAutoSave(DB(), dict, doc, changes))
+      return false;
+
+   // The changes stay in the file until the next whole autosave
+   ResetAutoSaveBase();
+   mAutoSaveDeltas = changes;
+
+   // Decode the dict and doc in one stream, as if read from the blobs
+   dict.insert(dict.end(), doc.begin(), doc.end());
+   BufferedMemoryStream stream{ std::move(dict) };
+   return ProjectSerializer::Decode(stream, this);
+}
+
+bool ProjectFileIO::FoldAutoSaveDeltas()
+{
+   auto db = DB();
+
+   int64_t count = 0;
+   if (!HasAutoSaveDeltaTable(db) ||
+       (GetValue("SELECT Count(*) FROM main.autosavedelta;", count, true) &&
+        count == 0))
+      return true;
+
+   std::vector<unsigned char> dict, doc;
+   size_t changes = 0;
+   if (!ReadAutoSave(db, dict, doc, changes))
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(sqlite3_errcode(db)));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::FoldAutoSaveDeltas::read");
+
+      SetDBError(
+         XO("Failed to update the project file.\nThe following command failed:\n\n%s")
+            .Format("SELECT dict, position, removed, data FROM main.autosavedelta"));
+      return false;
+   }
+
+   TransactionScope transaction(mProject, "AutoSave");
+
+   const char *sql = "UPDATE main.autosave SET dict = ?1, doc = ?2 WHERE id = 1;";
+
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]
+   {
+      if (stmt)
+      {
+         sqlite3_finalize(stmt);
+      }
+   });
+
+   int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+   if (rc != SQLITE_OK)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.query", sql);
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::FoldAutoSaveDeltas::prepare");
+
+      SetDBError(
+         XO("Unable to prepare project file command:\n\n%s").Format(sql)
+      );
+      return false;
+   }
+
+   // SQLite does not accept null for an empty blob
+   static const unsigned char empty = 0;
+   if (
+      sqlite3_bind_blob64(stmt, 1,
+         dict.empty() ? &empty : dict.data(), dict.size(), SQLITE_STATIC) ||
+      sqlite3_bind_blob64(stmt, 2,
+         doc.empty() ? &empty : doc.data(), doc.size(), SQLITE_STATIC))
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.query", sql);
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::FoldAutoSaveDeltas::bind");
+
+      SetDBError(XO("Unable to bind to blob"));
+      return false;
+   }
+
+   rc = sqlite3_step(stmt);
+   if (rc != SQLITE_DONE)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.query", sql);
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::FoldAutoSaveDeltas::step");
+
+      SetDBError(
+         XO("Failed to update the project file.\nThe following command failed:\n\n%s")
+            .Format(sql));
+      return false;
+   }
+
+   // Finalize the statement before committing the transaction
+   sqlite3_finalize(stmt);
+   stmt = nullptr;
+
+   // The last autosaved doc, if remembered, is still the same
+   const auto deltas = std::exchange(mAutoSaveDeltas, 0);
+   const auto deltaBytes = std::exchange(mAutoSaveDeltaBytes, 0);
+   if (!DeleteAutoSaveDeltas(db) ||
+       !WriteRequiredVersion() ||
+       !transaction.Commit())
+   {
+      mAutoSaveDeltas = deltas;
+      mAutoSaveDeltaBytes = deltaBytes;
+      return false;
+   }
+
+   return true;
+}
+
+void ProjectFileIO::ResetAutoSaveBase()
+{
+   mAutoSaveDB = nullptr;
+   mAutoSaveDict.clear();
+   mAutoSaveDoc.clear();
+   mAutoSaveDeltas = 0;
+   mAutoSaveDeltaBytes = 0;
+}
+
+bool ProjectFileIO::HasAutoSaveDeltas() const
+{
+   return mAutoSaveDeltas > 0;
+}
+
 bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
 {
    int rc;
@@ -1833,6 +2351,19 @@ bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
       return false;
    }
 
+   // Without the doc the changes of it are meaningless, and would not be
+   // replayed
+   if (!DeleteAutoSaveDeltas(db))
+      return false;
+   if (db == DB())
+   {
+      // Older versions may open the file again
+      const bool hadDeltas = HasAutoSaveDeltas();
+      ResetAutoSaveBase();
+      if (hadDeltas && !WriteRequiredVersion())
+         return false;
+   }
+
    mModified = false;
 
    return true;
@@ -1985,6 +2516,14 @@ bool ProjectFileIO::WriteDoc(const char *table,
    if (!writeStream("doc", data))
       return false;
 
+   if (!WriteRequiredVersion())
+      return false;
+
+   return transaction.Commit();
+}
+
+bool ProjectFileIO::WriteRequiredVersion()
+{
    const auto requiredVersion =
       ProjectFormatExtensionsRegistry::Get().GetRequiredVersion(mProject);
 
@@ -1996,11 +2535,13 @@ bool ProjectFileIO::WriteDoc(const char *table,
       // DV: Very unlikely case.
       // Since we need to improve the error messages in the future, let's use
       // the generic message for now, so no new strings are needed
-      reportError(setVersionSql);
+      SetDBError(
+         XO("Failed to update the project file.\nThe following command failed:\n\n%s")
+            .Format(setVersionSql));
       return false;
    }
 
-   return transaction.Commit();
+   return true;
 }
 
 ProjectFileIO::
@@ -2078,10 +2619,14 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
    else
    {
       // Load 'er up
-      BufferedProjectBlobStream stream(
-         DB(), "main", useAutosave ? "autosave" : "project", rowId);
+      if (useAutosave && HasAutoSaveDeltaTable(DB()))
+         success = DecodeAutoSave();
+      else {
+         BufferedProjectBlobStream stream(
+            DB(), "main", useAutosave ? "autosave" : "project", rowId);
 
-      success = ProjectSerializer::Decode(stream, this);
+         success = ProjectSerializer::Decode(stream, this);
+      }
 
       if (!success)
       {
@@ -2294,6 +2839,10 @@ bool ProjectFileIO::SaveProject(
          }
       }
 
+      // The tiles, if any, were copied with the blocks
+      if (CurrConn() && CurrConn()->HasTiles())
+         EnableTiles(*newConn);
+
       // Autosave no longer needed in original project file.
       if (!AutoSaveDelete())
       {
@@ -2655,6 +3204,132 @@ FROM sampleblocks WHERE blockid = ?1;)";
    return size;
 }
 
+bool ProjectFileIO::ReadTile(DBConnection &conn, SampleBlockID blockid,
+   const SampleBlockTileKey &key, std::vector<float> &data)
+{
+   // Prepare and cache statement...automatically finalized at DB close
+   auto stmt = conn.Prepare(DBConnection::GetTile,
+      "SELECT data FROM tiles"
+      "  WHERE blockid = ?1 AND kind = ?2 AND settings = ?3 AND level = ?4;");
+
+   auto cleanup = finally([stmt] {
+      // Clear statement bindings and rewind statement
+      sqlite3_clear_bindings(stmt);
+      sqlite3_reset(stmt);
+   });
+
+   // BIND SQL tiles
+   if (sqlite3_bind_int64(stmt, 1, blockid) ||
+       sqlite3_bind_int(stmt, 2, key.kind) ||
+       sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(key.settings)) ||
+       sqlite3_bind_int(stmt, 4, key.level))
+   {
+      ADD_EXCEPTION_CONTEXT(
+         "sqlite3.rc", std::to_string(sqlite3_errcode(conn.DB())));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectFileIO::ReadTile::bind");
+      return false;
+   }
+
+   if (sqlite3_step(stmt) != SQLITE_ROW)
+      return false;
+
+   const auto bytes = sqlite3_column_bytes(stmt, 0);
+   const auto blob = sqlite3_column_blob(stmt, 0);
+   data.resize(bytes / sizeof(float));
+   if (blob)
+      memcpy(data.data(), blob, data.size() * sizeof(float));
+   return true;
+}
+
+bool ProjectFileIO::WriteTile(DBConnection &conn, SampleBlockID blockid,
+   const SampleBlockTileKey &key, const std::vector<float> &data)
+{
+   // Prepare and cache statement...automatically finalized at DB close
+   auto stmt = conn.Prepare(DBConnection::PutTile,
+      "INSERT OR REPLACE INTO tiles (blockid, kind, settings, level, data)"
+      "  VALUES(?1, ?2, ?3, ?4, ?5);");
+
+   auto cleanup = finally([stmt] {
+      // Clear statement bindings and rewind statement
+      sqlite3_clear_bindings(stmt);
+      sqlite3_reset(stmt);
+   });
+
+   // BIND SQL tiles
+   if (sqlite3_bind_int64(stmt, 1, blockid) ||
+       sqlite3_bind_int(stmt, 2, key.kind) ||
+       sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(key.settings)) ||
+       sqlite3_bind_int(stmt, 4, key.level) ||
+       sqlite3_bind_blob(stmt, 5, data.data(), data.size() * sizeof(float),
+          SQLITE_STATIC))
+   {
+      ADD_EXCEPTION_CONTEXT(
+         "sqlite3.rc", std::to_string(sqlite3_errcode(conn.DB())));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectFileIO::WriteTile::bind");
+      return false;
+   }
+
+   if (sqlite3_step(stmt) != SQLITE_DONE)
+      return false;
+
+   if (conn.AddTileBytes(data.size() * sizeof(float)) > conn.GetTileBudget())
+      PruneTiles(conn);
+   return true;
+}
+
+void ProjectFileIO::PruneTiles(DBConnection &conn)
+{
+   // Leave room, so that pruning is not done for every tile
+   const auto target = conn.GetTileBudget() / 4 * 3;
+   auto db = conn.DB();
+
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]
+   {
+      if (stmt)
+      {
+         sqlite3_finalize(stmt);
+      }
+   });
+
+   // Find the newest of the oldest tiles that must go, counting
+   // exactly, because replaced tiles were counted twice
+   auto total = GetTileBytes(db);
+   if (total < 0)
+      return;
+
+   sqlite3_int64 last = -1;
+   if (total > target)
+   {
+      if (sqlite3_prepare_v2(db,
+            "SELECT rowid, length(data) FROM main.tiles ORDER BY rowid;",
+            -1, &stmt, nullptr) != SQLITE_OK)
+         return;
+      while (total > target && sqlite3_step(stmt) == SQLITE_ROW)
+      {
+         last = sqlite3_column_int64(stmt, 0);
+         total -= sqlite3_column_int64(stmt, 1);
+      }
+      sqlite3_finalize(stmt);
+      stmt = nullptr;
+   }
+
+   if (last >= 0)
+   {
+      if (sqlite3_prepare_v2(db,
+            "DELETE FROM main.tiles WHERE rowid <= ?1;",
+            -1, &stmt, nullptr) != SQLITE_OK ||
+         sqlite3_bind_int64(stmt, 1, last) ||
+         sqlite3_step(stmt) != SQLITE_DONE)
+      {
+         wxLogDebug(wxT("Tiles were not pruned: %s"), sqlite3_errmsg(db));
+         return;
+      }
+   }
+
+   conn.SetTileBytes(total);
+}
+
 InvisibleTemporaryProject::InvisibleTemporaryProject()
    : mpProject{ AudacityProject::Create() }
 {
@@ -14,6 +14,7 @@ Paul Licameli split from AudacityProject.h
 #include <memory>
 #include <optional>
 #include <unordered_set>
+#include <vector>
 
 #include <wx/event.h>
 
@@ -32,6 +33,7 @@ class DBConnection;
 struct DBConnectionErrors;
 class ProjectSerializer;
 class SqliteSampleBlock;
+struct SampleBlockTileKey;
 class TrackList;
 class WaveTrack;
 
@@ -109,6 +111,9 @@ public:
 
    bool AutoSave(bool recording = false);
    bool AutoSaveDelete(sqlite3 *db = nullptr);
+   //! Whether changes are appended to the autosave doc, which older versions
+   //! would not replay
+   bool HasAutoSaveDeltas() const;
 
    bool OpenProject();
    bool CloseProject();
@@ -140,6 +145,14 @@ public:
    // specific database. This is the workhorse for the above 3 methods.
    static int64_t GetDiskUsage(DBConnection &conn, SampleBlockID blockid);
 
+   //! Read data derived from a sample block, if stored; see ProjectTileCache
+   static bool ReadTile(DBConnection &conn, SampleBlockID blockid,
+      const SampleBlockTileKey &key, std::vector<float> &data);
+   //! Store data derived from a sample block, to be deleted with the block
+   //! or when the tiles exceed their budget
+   static bool WriteTile(DBConnection &conn, SampleBlockID blockid,
+      const SampleBlockTileKey &key, const std::vector<float> &data);
+
    // Displays an error dialog with a button that offers help
    void ShowError(const BasicUI::WindowPlacement &placement,
                   const TranslatableString &dlogTitle,
@@ -268,9 +281,31 @@ private:
 
    bool CheckVersion();
    bool InstallSchema(sqlite3 *db, const char *schema = "main");
+   //! Create the table for ReadTile and WriteTile, if absent
+   bool InstallTileSchema(sqlite3 *db, const char *schema = "main");
+   //! Create the tiles table if absent, and let the connection use it,
+   //! within the budget in ProjectTileCacheSize
+   void EnableTiles(DBConnection &conn);
+   //! Delete the oldest tiles, to bring them well within budget
+   static void PruneTiles(DBConnection &conn);
 
    // Write project or autosave XML (binary) documents
    bool WriteDoc(const char *table, const ProjectSerializer &autosave, const char *schema = "main");
+   //! Store the version of Audacity required to read the document
+   bool WriteRequiredVersion();
+
+   //! Write only the change of the document since the last autosave, if
+   //! that is small, else the whole document
+   bool WriteAutoSave(const ProjectSerializer &autosave);
+   //! Remove the changes appended to the autosave doc
+   bool DeleteAutoSaveDeltas(sqlite3 *db);
+   //! Decode the autosave doc after replaying the changes appended to it
+   bool DecodeAutoSave();
+   //! Replace the autosave doc and the changes appended to it with the
+   //! whole changed doc
+   bool FoldAutoSaveDeltas();
+   //! Forget the last autosaved doc, so that the next autosave is whole
+   void ResetAutoSaveBase();
 
    // Application defined function to verify blockid exists is in set of blockids
    static void InSet(sqlite3_context *context, int argc, sqlite3_value **argv);
@@ -334,8 +369,25 @@ private:
    Connection mPrevConn;
    FilePath mPrevFileName;
    bool mPrevTemporary;
+
+   // The last autosaved document, against which the next is compared
+   std::vector<unsigned char> mAutoSaveDict;
+   std::vector<unsigned char> mAutoSaveDoc;
+   // The connection that holds it, or null if the next autosave must be whole
+   sqlite3 *mAutoSaveDB{};
+   // Changes appended since the whole document was written, in the
+   // database of the current connection
+   size_t mAutoSaveDeltas{ 0 };
+   size_t mAutoSaveDeltaBytes{ 0 };
 };
 
+//! Whether projects keep data derived from sample blocks, such as spectra,
+//! for views to reuse after reopening; takes effect when a project is opened
+extern PROJECT_FILE_IO_API BoolSetting ProjectTileCache;
+//! Megabytes of tiles each project may keep; takes effect when a project is
+//! opened
+extern PROJECT_FILE_IO_API IntSetting ProjectTileCacheSize;
+
 //! Makes a temporary project that doesn't display on the screen
 class PROJECT_FILE_IO_API InvisibleTemporaryProject
 {
@@ -147,11 +147,15 @@ template <typename Number> void WriteBigEndian(MemoryStream& out, Number value)
    out.AppendData(&value, sizeof(value));
 }
 
+// Exception type for short-range try/catch in Decode
+struct DecodeError final {};
+
 // Read little-endian file format to native little-endian
 template <typename Number> Number ReadLittleEndian(BufferedStreamReader& in)
 {
    Number result;
-   in.ReadValue(result);
+   if (!in.ReadValue(result))
+      throw DecodeError{};
    return result;
 }
 
@@ -159,7 +163,8 @@ template <typename Number> Number ReadLittleEndian(BufferedStreamReader& in)
 template <typename Number> Number ReadBigEndian(BufferedStreamReader& in)
 {
    Number result;
-   in.ReadValue(result);
+   if (!in.ReadValue(result))
+      throw DecodeError{};
    auto begin = static_cast<unsigned char*>(static_cast<void*>(&result));
    std::reverse(begin, begin + sizeof(result));
    return result;
@@ -221,42 +226,47 @@ public:
       if (mInTag)
          EmitStartTag();
 
+      // An end tag without a start tag
+      if (mHandlers.empty())
+         throw DecodeError{};
+
       if (XMLTagHandler* const handler = mHandlers.back())
          handler->HandleXMLEndTag(name);
 
       mHandlers.pop_back();
    }
 
-   void WriteAttr(const std::string_view& name, std::string value)
+   void WriteAttr(const std::string_view& name, const std::string& value)
    {
-      assert(mInTag);
-
+      // An attribute outside of a start tag
       if (!mInTag)
-         return;
+         throw DecodeError{};
 
-      mAttributes.emplace_back(name, CacheString(std::move(value)));
+      mAttributes.emplace_back(
+         name, XMLAttributeValueView(std::string_view(value)));
    }
 
    template <typename T> void WriteAttr(const std::string_view& name, T value)
    {
-      assert(mInTag);
-
       if (!mInTag)
-         return;
+         throw DecodeError{};
 
       mAttributes.emplace_back(name, XMLAttributeValueView(value));
    }
 
-   void WriteData(std::string value)
+   void WriteData(const std::string& value)
    {
       if (mInTag)
          EmitStartTag();
 
+      if (mHandlers.empty())
+         throw DecodeError{};
+
       if (XMLTagHandler* const handler = mHandlers.back())
-         handler->HandleXMLContent(CacheString(std::move(value)));
+         handler->HandleXMLContent(value);
    }
 
-   void WriteRaw(std::string)
+   void WriteRaw(const std::string&)
    {
       // This method is intentionally left empty.
       // The only data that is serialized by FT_Raw
@@ -264,6 +274,16 @@ public:
       // which are ignored
    }
 
+   //! Storage for a decoded string, valid until the next start tag is
+   //! emitted
+   /*! Storage is reused, so that decoding does not allocate for each string */
+   std::string& AllocateString()
+   {
+      if (mStringsUsed == mStringsCache.size())
+         mStringsCache.emplace_back();
+      return mStringsCache[mStringsUsed++];
+   }
+
    bool Finalize()
    {
       if (mInTag)
@@ -301,37 +321,27 @@ private:
          }
       }
 
-      mStringsCache.clear();
+      mStringsUsed = 0;
       mAttributes.clear();
       mInTag = false;
    }
 
-   std::string_view CacheString(std::string string)
-   {
-      mStringsCache.emplace_back(std::move(string));
-      return mStringsCache.back();
-   }
-
    XMLTagHandler* mBaseHandler;
 
    std::vector<XMLTagHandler*> mHandlers;
 
    std::string_view mCurrentTagName;
 
+   //! Elements don't move as it grows, so views of them stay valid
    std::deque<std::string> mStringsCache;
+   size_t mStringsUsed { 0 };
    AttributesList mAttributes;
 
    bool mInTag { false };
 };
 
-// template<typename BaseCharType>
-// std::string FastStringConvertFromAscii(const BaseCharType* begin, const BaseCharType* end)
-// {
-// 
-// }
-
 template<typename BaseCharType>
-std::string FastStringConvert(const void* bytes, int bytesCount)
+void FastStringConvert(const void* bytes, int bytesCount, std::string& result)
 {
    constexpr int charSize = sizeof(BaseCharType);
 
@@ -340,16 +350,21 @@ std::string FastStringConvert(const void* bytes, int bytesCount)
    const auto begin = static_cast<const BaseCharType*>(bytes);
    const auto end = begin + bytesCount / charSize;
 
-   const bool isAscii = std::all_of(
-      begin, end,
-      [](BaseCharType c)
-      { return static_cast<std::make_unsigned_t<BaseCharType>>(c) < 0x7f; });
-
-   if (isAscii)
-      return std::string(begin, end);
-   
-   return std::wstring_convert<std::codecvt_utf8<BaseCharType>, BaseCharType>()
-      .to_bytes(begin, end);
+   // Names and most values are ASCII; narrow them in one pass
+   result.resize(end - begin);
+   auto out = result.begin();
+   for (auto iter = begin; iter != end; ++iter, ++out)
+   {
+      const auto c = static_cast<std::make_unsigned_t<BaseCharType>>(*iter);
+      if (c >= 0x80)
+      {
+         result = std::wstring_convert<
+            std::codecvt_utf8<BaseCharType>, BaseCharType>()
+               .to_bytes(begin, end);
+         return;
+      }
+      *out = static_cast<char>(c);
+   }
 }
 } // namespace
 
@@ -534,53 +549,75 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
    XMLTagHandlerAdapter adapter(handler);
 
    std::vector<char> bytes;
-   IdMap mIds;
-   std::vector<IdMap> mIdStack;
+   // Names of the active dictionary, indexed by id, and of the dictionaries
+   // saved by FT_Push.  Elements of deques don't move as they grow, or when
+   // the deques move, so that views of the names stay valid.  Dictionaries
+   // that FT_Pop discards are kept for the same reason.
+   using Names = std::deque<std::string>;
+   Names mIds;
+   std::vector<Names> mIdStack;
+   std::vector<Names> mPopped;
    char mCharSize = 0;
 
-   mIds.clear();
-
-   struct Error{}; // exception type for short-range try/catch
+   using Error = DecodeError;
    auto Lookup = [&mIds]( UShort id ) -> std::string_view
    {
-      auto iter = mIds.find( id );
-      if (iter == mIds.end())
+      // No name is empty, so an empty one was never defined
+      if (id >= mIds.size() || mIds[id].empty())
       {
          throw Error{};
       }
 
-      return iter->second;
+      return mIds[id];
    };
 
    int64_t stringsCount = 0;
    int64_t stringsLength = 0;
 
-   auto ReadString = [&mCharSize, &in, &bytes, &stringsCount, &stringsLength](int len) -> std::string
+   auto ReadString = [&mCharSize, &in, &bytes, &stringsCount, &stringsLength](
+      int len, std::string& result)
    {
-      bytes.reserve( len );
-      auto data = bytes.data();
-      in.Read( data, len );
+      // The length must be of whole characters, of a size given before
+      if (len < 0 || mCharSize == 0 || len % mCharSize != 0)
+         throw Error{};
 
       stringsCount++;
       stringsLength += len;
-      
+
+      const auto read = [&](void *buffer) {
+         if (in.Read(buffer, len) != static_cast<size_t>(len))
+            throw Error{};
+      };
+
       switch (mCharSize)
       {
          case 1:
-            return std::string(bytes.data(), len);
+            result.resize(len);
+            read(result.data());
+            return;
 
          case 2:
-            return FastStringConvert<char16_t>(bytes.data(), len);
+            bytes.resize(len);
+            read(bytes.data());
+            FastStringConvert<char16_t>(bytes.data(), len, result);
+            return;
 
          case 4:
-            return FastStringConvert<char32_t>(bytes.data(), len);
+            bytes.resize(len);
+            read(bytes.data());
+            FastStringConvert<char32_t>(bytes.data(), len, result);
+            return;
 
          default:
-            wxASSERT_MSG(false, wxT("Characters size not 1, 2, or 4"));
-         break;
+            throw Error{};
       }
+   };
 
-      return {};
+   // Read fixed-width values through the fast path of the reader
+   auto ReadValue = [&in](auto& value)
+   {
+      if (!in.ReadValue(value))
+         throw Error{};
    };
 
    try
@@ -593,14 +630,17 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
          {
             case FT_Push:
             {
-               mIdStack.push_back(mIds);
+               mIdStack.push_back(std::move(mIds));
                mIds.clear();
             }
             break;
 
             case FT_Pop:
             {
-               mIds = mIdStack.back();
+               if (mIdStack.empty())
+                  throw Error{};
+               mPopped.push_back(std::move(mIds));
+               mIds = std::move(mIdStack.back());
                mIdStack.pop_back();
             }
             break;
@@ -609,7 +649,13 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
             {
                id = ReadUShort( in );
                auto len = ReadUShort( in );
-               mIds[id] = ReadString(len);
+               if (id >= mIds.size())
+                  mIds.resize(id + 1);
+               // Each dictionary defines a name once, and views of it
+               // may be in use
+               else if (!mIds[id].empty())
+                  throw Error{};
+               ReadString(len, mIds[id]);
             }
             break;
 
@@ -633,8 +679,10 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
             {
                id = ReadUShort( in );
                int len = ReadLength( in );
-               
-               adapter.WriteAttr(Lookup(id), ReadString(len));
+
+               auto& value = adapter.AllocateString();
+               ReadString(len, value);
+               adapter.WriteAttr(Lookup(id), value);
             }
             break;
 
@@ -643,7 +691,7 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
                float val;
 
                id = ReadUShort( in );
-               in.Read(&val, sizeof(val));
+               ReadValue(val);
                /* int dig = */ReadDigits(in);
 
                adapter.WriteAttr(Lookup(id), val);
@@ -655,7 +703,7 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
                double val;
 
                id = ReadUShort( in );
-               in.Read(&val, sizeof(val));
+               ReadValue(val);
                /*int dig = */ReadDigits(in);
 
                adapter.WriteAttr(Lookup(id), val);
@@ -676,7 +724,7 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
                unsigned char val;
 
                id = ReadUShort( in );
-               in.Read(&val, 1);
+               ReadValue(val);
 
                adapter.WriteAttr(Lookup(id), val);
             }
@@ -711,26 +759,32 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
             case FT_Data:
             {
                int len = ReadLength( in );
-               adapter.WriteData(ReadString(len));
+               auto& value = adapter.AllocateString();
+               ReadString(len, value);
+               adapter.WriteData(value);
             }
             break;
 
             case FT_Raw:
             {
                int len = ReadLength( in );
-               adapter.WriteRaw(ReadString(len));
+               auto& value = adapter.AllocateString();
+               ReadString(len, value);
+               adapter.WriteRaw(value);
             }
             break;
 
             case FT_CharSize:
             {
-               in.Read(&mCharSize, 1);
+               ReadValue(mCharSize);
+               if (mCharSize != 1 && mCharSize != 2 && mCharSize != 4)
+                  throw Error{};
             }
             break;
 
             default:
-               wxASSERT(true);
-            break;
+               // Not a field type
+               throw Error{};
          }
       }
    }
@@ -15,16 +15,20 @@ Paul Licameli -- split from SampleBlock.cpp and SampleBlock.h
 #include "DBConnection.h"
 #include "ProjectFileIO.h"
 #include "SampleFormat.h"
+#include "SampleSummary.h"
 #include "AudioSegmentSampleView.h"
 #include "XMLTagHandler.h"
 
 #include "SampleBlock.h" // to inherit
+#include "SampleBlockCache.h"
 #include "UndoManager.h"
 #include "WaveTrack.h"
 
 #include "SentryHelper.h"
 #include <wx/log.h>
 
+#include <algorithm>
+#include <array>
 #include <mutex>
 
 class SqliteSampleBlockFactory;
@@ -76,11 +80,29 @@ public:
    /// Gets extreme values for the entire block
    MinMaxRMS DoGetMinMaxRMS() const override;
 
+   bool GetTile(
+      const SampleBlockTileKey &key, std::vector<float> &data) override;
+   void PutTile(
+      const SampleBlockTileKey &key, const std::vector<float> &data) override;
+
    size_t GetSpaceUsage() const override;
    void SaveXML(XMLWriter &xmlFile) override;
 
 private:
    bool IsSilent() const { return mBlockID <= 0; }
+   //! @return null for silent blocks or if the factory's cache is disabled
+   SampleBlockCache *Cache() const;
+   //! @return decoded samples if already in memory, without reading the
+   //! database
+   BlockSampleView FindCached();
+   //! Read all samples from the database into this block's own cache, and
+   //! the shared cache if enabled, unless another thread just did
+   BlockSampleView Decode(bool mayThrow);
+   //! Read from the database, bypassing any cache
+   size_t DoGetSamplesFromDB(samplePtr dest,
+                       sampleFormat destformat,
+                       size_t sampleoffset,
+                       size_t numsamples);
    void Load(SampleBlockID sbid);
    bool GetSummary(float *dest,
                    size_t frameoffset,
@@ -139,6 +161,7 @@ private:
 // used length values
 static std::map< SampleBlockID, std::shared_ptr<SqliteSampleBlock> >
    sSilentBlocks;
+static std::mutex sSilentBlocksMutex;
 
 ///\brief Implementation of @ref SampleBlockFactory using Sqlite database
 class SqliteSampleBlockFactory final
@@ -152,6 +175,9 @@ public:
 
    SampleBlockIDs GetActiveBlockIDs() override;
 
+   SampleBlockCache *GetCache() override;
+   bool HasTiles() override;
+
    SampleBlockPtr DoCreate(constSamplePtr src,
       size_t numsamples,
       sampleFormat srcformat) override;
@@ -164,7 +190,19 @@ public:
       sampleFormat srcformat,
       const AttributesList &attrs) override;
 
+   void DoGetSamples(
+      const SampleBlockReadRequest *requests, size_t nRequests,
+      sampleFormat destformat) override;
+
 private:
+   //! Number of ids bound in one query of a batched read
+   static constexpr size_t BatchSize = 16;
+   using BatchBlocks = std::array<SqliteSampleBlock*, BatchSize>;
+   using BatchRequests = std::array<const SampleBlockReadRequest*, BatchSize>;
+   //! Read all of the pending requests with one step of one statement
+   void GetBatchFromDB(const BatchBlocks &blocks,
+      const BatchRequests &pending, size_t nPending, sampleFormat destformat);
+
    void OnBeginPurge(size_t begin, size_t end);
    void OnEndPurge();
 
@@ -182,11 +220,18 @@ private:
    using AllBlocksMap =
       std::map< SampleBlockID, std::weak_ptr< SqliteSampleBlock > >;
    AllBlocksMap mAllBlocks;
+   //! Guards mAllBlocks, because imports may create blocks in several threads
+   std::mutex mAllBlocksMutex;
+
+   //! Decoded samples shared by all blocks of the project, which bounds
+   //! memory use independently of the lifetimes of BlockSampleViews
+   SampleBlockCache mCache;
 };
 
 SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
    : mProject{ project }
    , mppConnection{ ConnectionPtr::Get(project).shared_from_this() }
+   , mCache{ SampleBlockCache::CapacityFromPreference() }
 {
    mUndoSubscription = UndoManager::Get(project)
       .Subscribe([this](UndoRedoMessage message){
@@ -209,6 +254,7 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreate(
    auto sb = std::make_shared<SqliteSampleBlock>(shared_from_this());
    sb->SetSamples(src, numsamples, srcformat);
    // block id has now been assigned
+   std::lock_guard<std::mutex> lock{ mAllBlocksMutex };
    mAllBlocks[ sb->GetBlockID() ] = sb;
    return sb;
 }
@@ -216,6 +262,7 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreate(
 auto SqliteSampleBlockFactory::GetActiveBlockIDs() -> SampleBlockIDs
 {
    SampleBlockIDs result;
+   std::lock_guard<std::mutex> lock{ mAllBlocksMutex };
    for (auto end = mAllBlocks.end(), it = mAllBlocks.begin(); it != end;) {
       if (it->second.expired())
          // Tighten up the map
@@ -228,10 +275,22 @@ auto SqliteSampleBlockFactory::GetActiveBlockIDs() -> SampleBlockIDs
    return result;
 }
 
+SampleBlockCache *SqliteSampleBlockFactory::GetCache()
+{
+   return &mCache;
+}
+
+bool SqliteSampleBlockFactory::HasTiles()
+{
+   const auto &pConnection = mppConnection->mpConnection;
+   return pConnection && pConnection->HasTiles();
+}
+
 SampleBlockPtr SqliteSampleBlockFactory::DoCreateSilent(
    size_t numsamples, sampleFormat )
 {
    auto id = -static_cast< SampleBlockID >(numsamples);
+   std::lock_guard<std::mutex> lock{ sSilentBlocksMutex };
    auto &result = sSilentBlocks[ id ];
    if ( !result ) {
       result = std::make_shared<SqliteSampleBlock>(nullptr);
@@ -268,6 +327,7 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromXML(
          }
          else {
             // First see if this block id was previously loaded
+            std::lock_guard<std::mutex> lock{ mAllBlocksMutex };
             auto &wb = mAllBlocks[ nValue ];
             auto pb = wb.lock();
             if (pb)
@@ -298,25 +358,175 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromXML(
    return sb;
 }
 
+//! Copy part of a blob of samples, zero-filling past its end
+static void CopyFromBlob(void *dest,
+                         sampleFormat destformat,
+                         constSamplePtr src,
+                         size_t blobbytes,
+                         sampleFormat srcformat,
+                         size_t srcoffset,
+                         size_t srcbytes)
+{
+   srcoffset = std::min(srcoffset, blobbytes);
+   const auto minbytes = std::min(srcbytes, blobbytes - srcoffset);
+
+   CopySamples(src + srcoffset,
+               srcformat,
+               (samplePtr) dest,
+               destformat,
+               minbytes / SAMPLE_SIZE(srcformat));
+
+   dest = ((samplePtr) dest) + minbytes;
+
+   if (srcbytes - minbytes)
+   {
+      memset(dest, 0, srcbytes - minbytes);
+   }
+}
+
+void SqliteSampleBlockFactory::DoGetSamples(
+   const SampleBlockReadRequest *requests, size_t nRequests,
+   sampleFormat destformat)
+{
+   BatchBlocks blocks;
+   BatchRequests pending;
+   size_t nPending = 0;
+   for (size_t ii = 0; ii < nRequests; ++ii) {
+      auto &request = requests[ii];
+      const auto pBlock = dynamic_cast<SqliteSampleBlock*>(request.pBlock);
+      if (!pBlock || pBlock->mpFactory.get() != this || pBlock->IsSilent()) {
+         request.pBlock->GetSamples(request.dest, destformat,
+            request.sampleoffset, request.numsamples);
+         continue;
+      }
+      if (destformat == floatSample) {
+         if (const auto cached = pBlock->FindCached()) {
+            const auto offset = std::min(request.sampleoffset, cached->size());
+            const auto count =
+               std::min(request.numsamples, cached->size() - offset);
+            const auto dest = reinterpret_cast<float*>(request.dest);
+            std::copy_n(cached->data() + offset, count, dest);
+            std::fill_n(dest + count, request.numsamples - count, 0.f);
+            continue;
+         }
+      }
+      blocks[nPending] = pBlock;
+      pending[nPending] = &request;
+      if (++nPending == BatchSize) {
+         GetBatchFromDB(blocks, pending, nPending, destformat);
+         nPending = 0;
+      }
+   }
+   if (nPending > 0)
+      GetBatchFromDB(blocks, pending, nPending, destformat);
+}
+
+void SqliteSampleBlockFactory::GetBatchFromDB(const BatchBlocks &blocks,
+   const BatchRequests &pending, size_t nPending, sampleFormat destformat)
+{
+   const auto conn = blocks[0]->Conn();
+   auto db = conn->DB();
+   int rc;
+
+   // Prepare and cache statement...automatically finalized at DB close
+   sqlite3_stmt *stmt = conn->Prepare(DBConnection::GetSamplesBatch,
+      "SELECT blockid, samples FROM sampleblocks WHERE blockid IN"
+      " (?1,?2,?3,?4,?5,?6,?7,?8,?9,?10,?11,?12,?13,?14,?15,?16);");
+   static_assert(BatchSize == 16);
+
+   // Bind statement parameters; a zero id matches no row
+   for (size_t ii = 0; ii < BatchSize; ++ii) {
+      SampleBlockID id = 0;
+      if (ii < nPending) {
+         if (!blocks[ii]->mValid)
+            blocks[ii]->Load(blocks[ii]->mBlockID);
+         id = blocks[ii]->mBlockID;
+      }
+      if (sqlite3_bind_int64(stmt, ii + 1, id))
+      {
+         ADD_EXCEPTION_CONTEXT(
+            "sqlite3.rc", std::to_string(sqlite3_errcode(db)));
+         ADD_EXCEPTION_CONTEXT("sqlite3.context",
+            "SqliteSampleBlockFactory::GetBatchFromDB::bind");
+
+         wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+      }
+   }
+
+   // Execute the statement, visiting rows in any order
+   std::array<bool, BatchSize> done{};
+   size_t nDone = 0;
+   while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+      const SampleBlockID id = sqlite3_column_int64(stmt, 0);
+      const auto src = (constSamplePtr) sqlite3_column_blob(stmt, 1);
+      const auto blobbytes = (size_t) sqlite3_column_bytes(stmt, 1);
+      // The same block might be requested more than once
+      for (size_t ii = 0; ii < nPending; ++ii) {
+         if (done[ii] || blocks[ii]->mBlockID != id)
+            continue;
+         const auto &request = *pending[ii];
+         const auto srcformat = blocks[ii]->mSampleFormat;
+         wxASSERT(destformat == floatSample || destformat == srcformat);
+         CopyFromBlob(request.dest, destformat, src, blobbytes, srcformat,
+            request.sampleoffset * SAMPLE_SIZE(srcformat),
+            request.numsamples * SAMPLE_SIZE(srcformat));
+         done[ii] = true;
+         ++nDone;
+      }
+   }
+
+   // Clear statement bindings and rewind statement
+   sqlite3_clear_bindings(stmt);
+   sqlite3_reset(stmt);
+
+   if (rc != SQLITE_DONE || nDone != nPending)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context",
+         "SqliteSampleBlockFactory::GetBatchFromDB::step");
+
+      wxLogDebug(wxT("SqliteSampleBlockFactory::GetBatchFromDB - SQLITE error %s"),
+         sqlite3_errmsg(db));
+
+      // Just showing the user a simple message, not the library error too
+      // which isn't internationalized
+      conn->ThrowException( false );
+   }
+}
+
+BlockSampleView SqliteSampleBlock::FindCached()
+{
+   if (auto cache = mCache.lock())
+      return cache;
+   if (const auto pSharedCache = Cache())
+      return pSharedCache->Find(mBlockID);
+   return {};
+}
+
 BlockSampleView SqliteSampleBlock::GetFloatSampleView(bool mayThrow)
 {
    assert(mSampleCount > 0);
 
+   // The cache shared by all blocks of the project may hold the samples
+   // after all views of this block were released
+   if (auto cache = FindCached())
+      return cache;
+   return Decode(mayThrow);
+}
+
+BlockSampleView SqliteSampleBlock::Decode(bool mayThrow)
+{
    // Double-checked locking.
    // `weak_ptr::lock()` guarantees atomicity, which is important to make this
    // work without races.
-   auto cache = mCache.lock();
-   if (cache)
-      return cache;
    std::lock_guard<std::mutex> lock(mCacheMutex);
-   cache = mCache.lock();
-   if (cache)
+   if (auto cache = mCache.lock())
       return cache;
 
    const auto newCache =
       std::make_shared<std::vector<float>>(mSampleCount);
    try {
-      const auto cachedSize = DoGetSamples(
+      const auto cachedSize = DoGetSamplesFromDB(
          reinterpret_cast<samplePtr>(newCache->data()), floatSample, 0,
          mSampleCount);
       assert(cachedSize == mSampleCount);
@@ -326,8 +536,13 @@ BlockSampleView SqliteSampleBlock::GetFloatSampleView(bool mayThrow)
       if (mayThrow)
          std::rethrow_exception(std::current_exception());
       std::fill(newCache->begin(), newCache->end(), 0.f);
+      // Don't let the shared cache remember the failure
+      mCache = newCache;
+      return newCache;
    }
    mCache = newCache;
+   if (const auto pSharedCache = Cache())
+      pSharedCache->Insert(mBlockID, newCache);
    return newCache;
 }
 
@@ -348,6 +563,10 @@ SqliteSampleBlock::~SqliteSampleBlock()
 {
    DeletionCallback::Call(*this);
 
+   // The database may reuse the id for another block
+   if (!IsSilent() && mpFactory)
+      mpFactory->mCache.Erase(mBlockID);
+
    if (IsSilent()) {
       // The block object was constructed but failed to Load() or Commit().
       // Or it's a silent block with no row in the database.
@@ -372,6 +591,13 @@ SqliteSampleBlock::~SqliteSampleBlock()
    } );
 }
 
+SampleBlockCache *SqliteSampleBlock::Cache() const
+{
+   if (IsSilent() || !mpFactory || !mpFactory->mCache.IsEnabled())
+      return nullptr;
+   return &mpFactory->mCache;
+}
+
 DBConnection *SqliteSampleBlock::Conn() const
 {
    if (!mpFactory)
@@ -414,6 +640,33 @@ size_t SqliteSampleBlock::DoGetSamples(samplePtr dest,
                                      sampleFormat destformat,
                                      size_t sampleoffset,
                                      size_t numsamples)
+{
+   // Reads of other formats are for editing and must preserve the stored
+   // format exactly; only float reads go through the decoded-sample cache
+   if (destformat != floatSample || !Cache())
+      return DoGetSamplesFromDB(dest, destformat, sampleoffset, numsamples);
+
+   if (!mValid)
+      Load(mBlockID);
+
+   auto view = FindCached();
+   if (!view) {
+      if (!SampleBlockCache::ShouldFill(numsamples, mSampleCount))
+         return DoGetSamplesFromDB(dest, destformat, sampleoffset, numsamples);
+      view = Decode(true);
+   }
+   const auto offset = std::min(sampleoffset, view->size());
+   const auto count = std::min(numsamples, view->size() - offset);
+   std::copy_n(view->data() + offset, count, reinterpret_cast<float*>(dest));
+   // Imitate GetBlob, which zero-fills past the end of the stored samples
+   std::fill_n(reinterpret_cast<float*>(dest) + count, numsamples - count, 0.f);
+   return numsamples;
+}
+
+size_t SqliteSampleBlock::DoGetSamplesFromDB(samplePtr dest,
+                                     sampleFormat destformat,
+                                     size_t sampleoffset,
+                                     size_t numsamples)
 {
    if (IsSilent()) {
       auto size = SAMPLE_SIZE(destformat);
@@ -454,6 +707,34 @@ bool SqliteSampleBlock::GetSummary256(float *dest,
       "SELECT summary256 FROM sampleblocks WHERE blockid = ?1;");
 }
 
+bool SqliteSampleBlock::GetTile(
+   const SampleBlockTileKey &key, std::vector<float> &data)
+{
+   if (IsSilent())
+      return false;
+   // Tiles are only a cache; failure to read one is not reported
+   return GuardedCall<bool>(
+      [&]{
+         const auto conn = Conn();
+         return conn->HasTiles() &&
+            ProjectFileIO::ReadTile(*conn, mBlockID, key, data);
+      },
+      MakeSimpleGuard(false), [](AudacityException *){});
+}
+
+void SqliteSampleBlock::PutTile(
+   const SampleBlockTileKey &key, const std::vector<float> &data)
+{
+   if (IsSilent())
+      return;
+   GuardedCall(
+      [&]{
+         if (const auto conn = Conn(); conn->HasTiles())
+            ProjectFileIO::WriteTile(*conn, mBlockID, key, data);
+      },
+      MakeSimpleGuard(), [](AudacityException *){});
+}
+
 bool SqliteSampleBlock::GetSummary64k(float *dest,
                                       size_t frameoffset,
                                       size_t numframes)
@@ -530,27 +811,65 @@ MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
    if (start < mSampleCount)
    {
       len = std::min(len, mSampleCount - start);
+      const auto end = start + len;
 
-      // TODO: actually use summaries
-      SampleBuffer blockData(len, floatSample);
-      float *samples = (float *) blockData.ptr();
-
-      size_t copied = DoGetSamples((samplePtr) samples, floatSample, start, len);
-      for (size_t i = 0; i < copied; ++i, ++samples)
+      const auto accumulate = [&](const SampleSummary &summary) {
+         min = std::min(min, summary.min);
+         max = std::max(max, summary.max);
+         sumsq += summary.sumsq;
+      };
+      const auto readSamples = [&](size_t from, size_t to) {
+         if (from >= to)
+            return;
+         SampleBuffer blockData(to - from, floatSample);
+         float *samples = (float *) blockData.ptr();
+         size_t copied =
+            DoGetSamples((samplePtr) samples, floatSample, from, to - from);
+         accumulate(ComputeSampleSummary(samples, copied));
+      };
+      // Use the summaries of windows wholly inside the range; they are much
+      // smaller than the samples.  Summaries of silent blocks are zeroes
+      // anyway, and not worth a query.
+      const auto readSummaries = [&](size_t from, size_t to, size_t windowSize,
+         bool (SqliteSampleBlock::*getSummary)(float*, size_t, size_t))
       {
-         float sample = *samples;
-
-         if (sample > max)
-         {
-            max = sample;
-         }
-
-         if (sample < min)
-         {
-            min = sample;
-         }
+         if (from >= to)
+            return true;
+         const auto nWindows = (to - from) / windowSize;
+         Floats summaries{ fields * nWindows };
+         if (!(this->*getSummary)(
+            summaries.get(), from / windowSize, nWindows))
+            return false;
+         accumulate(
+            CombineWindowedSummaries(summaries.get(), nWindows, windowSize));
+         return true;
+      };
 
-         sumsq += (sample * sample);
+      constexpr size_t small = 256, large = 65536;
+      const auto roundUp = [](size_t value, size_t size) {
+         return (value + size - 1) / size * size; };
+      const auto roundDown = [](size_t value, size_t size) {
+         return value / size * size; };
+      const auto smallBegin = roundUp(start, small);
+      const auto smallEnd = std::max(smallBegin, roundDown(end, small));
+      const auto largeBegin = std::min(smallEnd, roundUp(smallBegin, large));
+      const auto largeEnd = std::max(largeBegin, roundDown(smallEnd, large));
+
+      if (smallBegin >= smallEnd)
+         readSamples(start, end);
+      else {
+         readSamples(start, smallBegin);
+         // Summaries that fail to read are replaced with samples
+         if (!readSummaries(largeBegin, largeEnd, large,
+               &SqliteSampleBlock::GetSummary64k))
+            readSamples(largeBegin, largeEnd);
+         if (!readSummaries(smallBegin, largeBegin, small,
+               &SqliteSampleBlock::GetSummary256))
+            readSamples(smallBegin, largeBegin);
+         if (!readSummaries(largeEnd, smallEnd, small,
+               &SqliteSampleBlock::GetSummary256))
+            readSamples(largeEnd, smallEnd);
+         readSamples(smallEnd, end);
       }
    }
 
@@ -590,7 +909,6 @@ size_t SqliteSampleBlock::GetBlob(void *dest,
    }
 
    int rc;
-   size_t minbytes = 0;
 
    // Bind statement parameters
    // Might return SQLITE_MISUSE which means it's our mistake that we violated
@@ -633,14 +951,6 @@ size_t SqliteSampleBlock::GetBlob(void *dest,
    samplePtr src = (samplePtr) sqlite3_column_blob(stmt, 0);
    size_t blobbytes = (size_t) sqlite3_column_bytes(stmt, 0);
 
-   srcoffset = std::min(srcoffset, blobbytes);
-   minbytes = std::min(srcbytes, blobbytes - srcoffset);
-
-   if (srcoffset != 0)
-   {
-      srcoffset += 0;
-   }
-
    /*
     Will dithering happen in CopySamples?  Answering this as of 3.0.3 by
     examining all uses.
@@ -677,18 +987,8 @@ size_t SqliteSampleBlock::GetBlob(void *dest,
     */
    wxASSERT(destformat == floatSample || destformat == srcformat);
 
-   CopySamples(src + srcoffset,
-               srcformat,
-               (samplePtr) dest,
-               destformat,
-               minbytes / SAMPLE_SIZE(srcformat));
-
-   dest = ((samplePtr) dest) + minbytes;
-
-   if (srcbytes - minbytes)
-   {
-      memset(dest, 0, srcbytes - minbytes);
-   }
+   CopyFromBlob(dest, destformat, src, blobbytes, srcformat,
+                srcoffset, srcbytes);
 
    // Clear statement bindings and rewind statement
    sqlite3_clear_bindings(stmt);
@@ -799,6 +1099,14 @@ void SqliteSampleBlock::Commit(Sizes sizes)
       wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
    }
 
+   // Blocks may be committed by other threads at once, as by concurrent
+   // imports; hold the connection's mutex so that the row id retrieved is
+   // this insertion's
+   const auto mutex = sqlite3_db_mutex(db);
+   sqlite3_mutex_enter(mutex);
+   std::unique_ptr<sqlite3_mutex, decltype(&sqlite3_mutex_leave)>
+      leave{ mutex, sqlite3_mutex_leave };
+
    // Execute the statement
    rc = sqlite3_step(stmt);
    if (rc != SQLITE_DONE)
@@ -819,6 +1127,7 @@ void SqliteSampleBlock::Commit(Sizes sizes)
 
    // Retrieve returned data
    mBlockID = sqlite3_last_insert_rowid(db);
+   leave.reset();
 
    // Reset local arrays
    mSamples.reset();
@@ -933,48 +1242,16 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
    float min;
    float max;
    float sumsq;
-   double totalSquares = 0.0;
    double fraction = 0.0;
 
    // Recalc 256 summaries
    int sumLen = (mSampleCount + 255) / 256;
    int summaries = 256;
 
-   for (int i = 0; i < sumLen; ++i)
-   {
-      min = samples[i * 256];
-      max = samples[i * 256];
-      sumsq = min * min;
-
-      int jcount = 256;
-      if (jcount > mSampleCount - i * 256)
-      {
-         jcount = mSampleCount - i * 256;
-         fraction = 1.0 - (jcount / 256.0);
-      }
-
-      for (int j = 1; j < jcount; ++j)
-      {
-         float f1 = samples[i * 256 + j];
-         sumsq += f1 * f1;
-
-         if (f1 < min)
-         {
-            min = f1;
-         }
-         else if (f1 > max)
-         {
-            max = f1;
-         }
-      }
-
-      totalSquares += sumsq;
-
-      summary256[i * fields] = min;
-      summary256[i * fields + 1] = max;
-      // The rms is correct, but this may be for less than 256 samples in last loop.
-      summary256[i * fields + 2] = (float) sqrt(sumsq / jcount);
-   }
+   const double totalSquares =
+      ComputeWindowedSummaries(samples, mSampleCount, 256, summary256);
+   if (const auto jcount = mSampleCount % 256)
+      fraction = 1.0 - (jcount / 256.0);
 
    for (int i = sumLen, frames256 = mSummary256Bytes / bytesPerFrame;
         i < frames256; ++i)
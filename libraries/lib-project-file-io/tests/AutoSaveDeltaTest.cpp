@@ -0,0 +1,149 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  AutoSaveDeltaTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "AutoSaveDelta.h"
+
+#include <string>
+
+namespace
+{
+using Bytes = std::vector<unsigned char>;
+
+Bytes MakeBytes(const std::string &str)
+{
+   return { str.begin(), str.end() };
+}
+
+//! A row of the autosavedelta table
+struct Row
+{
+   size_t position;
+   size_t removed;
+   Bytes data;
+};
+
+Row MakeRow(const Bytes &base, const Bytes &doc)
+{
+   const auto change =
+      AutoSaveDelta::Compute(base.data(), base.size(), doc.data(), doc.size());
+   return { change.position, change.removed,
+      { doc.begin() + change.position,
+        doc.begin() + change.position + change.inserted } };
+}
+}
+
+TEST_CASE("AutoSaveDelta::Compute", "[AutoSaveDelta]")
+{
+   SECTION("Finds the one changed range")
+   {
+      const auto base = MakeBytes("<project><track name=a/></project>");
+      const auto doc = MakeBytes("<project><track name=bcd/></project>");
+      const auto change = AutoSaveDelta::Compute(
+         base.data(), base.size(), doc.data(), doc.size());
+      REQUIRE(change.position == 21);
+      REQUIRE(change.removed == 1);
+      REQUIRE(change.inserted == 3);
+   }
+
+   SECTION("Finds no change of equal documents")
+   {
+      const auto doc = MakeBytes("<project/>");
+      const auto change = AutoSaveDelta::Compute(
+         doc.data(), doc.size(), doc.data(), doc.size());
+      REQUIRE(change.removed == 0);
+      REQUIRE(change.inserted == 0);
+   }
+
+   SECTION("Prefix and suffix do not overlap in repeated bytes")
+   {
+      const auto base = MakeBytes("aaaa");
+      const auto doc = MakeBytes("aaaaaa");
+      const auto change = AutoSaveDelta::Compute(
+         base.data(), base.size(), doc.data(), doc.size());
+      REQUIRE(change.removed == 0);
+      REQUIRE(change.inserted == 2);
+   }
+
+   SECTION("Compares with an empty base")
+   {
+      const auto doc = MakeBytes("<project/>");
+      const auto change =
+         AutoSaveDelta::Compute(nullptr, 0, doc.data(), doc.size());
+      REQUIRE(change.position == 0);
+      REQUIRE(change.removed == 0);
+      REQUIRE(change.inserted == doc.size());
+   }
+}
+
+TEST_CASE("AutoSaveDelta::Apply", "[AutoSaveDelta]")
+{
+   SECTION("Rejects ranges outside of the document")
+   {
+      const auto original = MakeBytes("<project/>");
+      auto doc = original;
+      const auto data = MakeBytes("x");
+      REQUIRE(!AutoSaveDelta::Apply(doc, -1, 0, data.data(), data.size()));
+      REQUIRE(!AutoSaveDelta::Apply(doc, 0, -1, data.data(), data.size()));
+      REQUIRE(!AutoSaveDelta::Apply(doc, 11, 0, data.data(), data.size()));
+      REQUIRE(!AutoSaveDelta::Apply(doc, 5, 6, data.data(), data.size()));
+      REQUIRE(doc == original);
+   }
+
+   SECTION("Appends at the end")
+   {
+      auto doc = MakeBytes("<project/>");
+      const auto data = MakeBytes("<x/>");
+      REQUIRE(AutoSaveDelta::Apply(doc, 10, 0, data.data(), data.size()));
+      REQUIRE(doc == MakeBytes("<project/><x/>"));
+   }
+}
+
+TEST_CASE(
+   "Recovery after a crash replays the changes of the autosave doc",
+   "[AutoSaveDelta]")
+{
+   // The whole doc written by the first autosave
+   const auto whole = MakeBytes("<project rate=44100><tracks/></project>");
+
+   // Later autosaves append only their changes
+   const std::vector<Bytes> autosaves {
+      MakeBytes("<project rate=44100><tracks><a/></tracks></project>"),
+      MakeBytes("<project rate=44100><tracks><a/><b/></tracks></project>"),
+      MakeBytes("<project rate=48000><tracks><a/><b/></tracks></project>"),
+      MakeBytes("<project rate=48000><tracks><b/></tracks></project>"),
+      MakeBytes("<project rate=48000><tracks><b/></tracks></project>"),
+      MakeBytes("<project/>"),
+      MakeBytes("<project rate=8000><tracks><c/></tracks></project>"),
+   };
+
+   std::vector<Row> rows;
+   auto last = whole;
+   for (const auto &autosave : autosaves)
+   {
+      rows.push_back(MakeRow(last, autosave));
+      last = autosave;
+   }
+
+   // Nothing is remembered after the crash but the whole doc and the rows
+   auto recovered = whole;
+   for (const auto &row : rows)
+      REQUIRE(AutoSaveDelta::Apply(recovered,
+         row.position, row.removed, row.data.data(), row.data.size()));
+   REQUIRE(recovered == autosaves.back());
+
+   SECTION("Replaying stops at a row that does not fit the doc")
+   {
+      auto doc = whole;
+      const auto &row = rows.back();
+      REQUIRE(!AutoSaveDelta::Apply(doc,
+         whole.size() + 1, row.removed, row.data.data(), row.data.size()));
+      REQUIRE(doc == whole);
+   }
+}
@@ -0,0 +1,244 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ProjectSerializerTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "ProjectSerializer.h"
+
+#include "BufferedStreamReader.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+// Field types of the binary document, as written to files
+enum : unsigned char
+{
+   FT_CharSize = 0,
+   FT_StartTag = 1,
+   FT_EndTag = 2,
+   FT_String = 3,
+   FT_Int = 4,
+   FT_Pop = 14,
+   FT_Name = 15,
+};
+
+//! Bytes of a document, with numbers in the little-endian file format
+struct Document
+{
+   std::vector<unsigned char> bytes;
+
+   Document& Byte(unsigned char value)
+   {
+      bytes.push_back(value);
+      return *this;
+   }
+
+   Document& Number(long long value, size_t size)
+   {
+      for (size_t ii = 0; ii < size; ++ii)
+         Byte(static_cast<unsigned char>(value >> (8 * ii)));
+      return *this;
+   }
+
+   Document& Chars(const std::string& chars)
+   {
+      bytes.insert(bytes.end(), chars.begin(), chars.end());
+      return *this;
+   }
+
+   Document& CharSize() { return Byte(FT_CharSize).Byte(1); }
+
+   Document& Name(unsigned short id, const std::string& name)
+   {
+      return Byte(FT_Name).Number(id, 2).Number(name.size(), 2).Chars(name);
+   }
+
+   Document& StartTag(unsigned short id)
+   {
+      return Byte(FT_StartTag).Number(id, 2);
+   }
+
+   Document& EndTag(unsigned short id)
+   {
+      return Byte(FT_EndTag).Number(id, 2);
+   }
+
+   Document& String(unsigned short id, const std::string& value)
+   {
+      return Byte(FT_String).Number(id, 2).Number(value.size(), 4)
+         .Chars(value);
+   }
+
+   Document& Int(unsigned short id, int value)
+   {
+      return Byte(FT_Int).Number(id, 2).Number(value, 4);
+   }
+};
+
+class MemoryReader final : public BufferedStreamReader
+{
+public:
+   explicit MemoryReader(std::vector<unsigned char> data)
+      : mData{ std::move(data) }
+   {
+   }
+
+protected:
+   bool HasMoreData() const override
+   {
+      return mOffset < mData.size();
+   }
+
+   size_t ReadData(void* buffer, size_t maxBytes) override
+   {
+      maxBytes = std::min(maxBytes, mData.size() - mOffset);
+      memcpy(buffer, mData.data() + mOffset, maxBytes);
+      mOffset += maxBytes;
+      return maxBytes;
+   }
+
+private:
+   const std::vector<unsigned char> mData;
+   size_t mOffset { 0 };
+};
+
+//! Records the tags and attributes that it is given
+struct Recorder final : XMLTagHandler
+{
+   bool HandleXMLTag(
+      const std::string_view& tag, const AttributesList& attrs) override
+   {
+      events.push_back("<" + std::string(tag));
+      for (auto& [name, value] : attrs)
+         events.push_back(std::string(name) + "=" + value.ToString());
+      return true;
+   }
+
+   void HandleXMLEndTag(const std::string_view& tag) override
+   {
+      events.push_back("/" + std::string(tag));
+   }
+
+   XMLTagHandler* HandleXMLChild(const std::string_view&) override
+   {
+      return this;
+   }
+
+   std::vector<std::string> events;
+};
+
+bool Decode(const Document& document, Recorder& recorder)
+{
+   MemoryReader reader{ document.bytes };
+   return ProjectSerializer::Decode(reader, &recorder);
+}
+
+Document WellFormed()
+{
+   return Document{}.CharSize()
+      .Name(0, "project").Name(1, "rate").Name(2, "label").Name(3, "title")
+      .StartTag(0).Int(1, 44100)
+         .StartTag(2).String(3, "intro").EndTag(2)
+      .EndTag(0);
+}
+}
+
+TEST_CASE("ProjectSerializer::Decode of a well formed document")
+{
+   Recorder recorder;
+   REQUIRE(Decode(WellFormed(), recorder));
+   REQUIRE(recorder.events == std::vector<std::string>{
+      "<project", "rate=44100", "<label", "title=intro", "/label", "/project"
+   });
+}
+
+TEST_CASE("ProjectSerializer::Decode rejects malformed documents")
+{
+   Recorder recorder;
+
+   SECTION("Undefined name")
+   {
+      REQUIRE(!Decode(Document{}.CharSize().StartTag(7), recorder));
+   }
+
+   SECTION("Name defined twice")
+   {
+      REQUIRE(!Decode(Document{}.CharSize().Name(0, "project").Name(0, "x"),
+         recorder));
+   }
+
+   SECTION("Pop without a push")
+   {
+      REQUIRE(!Decode(Document{}.CharSize().Byte(FT_Pop), recorder));
+   }
+
+   SECTION("String before the character size")
+   {
+      REQUIRE(!Decode(Document{}.Name(0, "project"), recorder));
+   }
+
+   SECTION("Character size that is not 1, 2 or 4")
+   {
+      REQUIRE(!Decode(Document{}.Byte(FT_CharSize).Byte(3), recorder));
+   }
+
+   SECTION("Negative string length")
+   {
+      auto document = Document{}.CharSize().Name(0, "project").StartTag(0)
+         .Name(1, "title").Byte(FT_String).Number(1, 2).Number(-1, 4);
+      REQUIRE(!Decode(document, recorder));
+   }
+
+   SECTION("String longer than the document")
+   {
+      auto document = Document{}.CharSize().Name(0, "project").StartTag(0)
+         .Name(1, "title").Byte(FT_String).Number(1, 2).Number(100, 4)
+         .Chars("short");
+      REQUIRE(!Decode(document, recorder));
+   }
+
+   SECTION("Truncated number")
+   {
+      auto document = Document{}.CharSize().Name(0, "project").StartTag(0)
+         .Name(1, "rate").Byte(FT_Int).Number(1, 2).Number(0, 2);
+      REQUIRE(!Decode(document, recorder));
+   }
+
+   SECTION("Unknown field type")
+   {
+      REQUIRE(!Decode(Document{}.CharSize().Byte(0x7f), recorder));
+   }
+
+   SECTION("End tag without a start tag")
+   {
+      REQUIRE(!Decode(Document{}.CharSize().Name(0, "project").EndTag(0),
+         recorder));
+   }
+
+   SECTION("Attribute outside of a start tag")
+   {
+      REQUIRE(!Decode(Document{}.CharSize().Name(0, "rate").Int(0, 1),
+         recorder));
+   }
+}
+
+TEST_CASE("ProjectSerializer::Decode of truncated documents")
+{
+   // Every prefix either decodes or is rejected, without reading past it
+   const auto whole = WellFormed();
+   for (size_t size = 0; size < whole.bytes.size(); ++size)
+   {
+      Document document;
+      document.bytes.assign(whole.bytes.begin(), whole.bytes.begin() + size);
+      Recorder recorder;
+      CHECK_NOTHROW(Decode(document, recorder));
+   }
+}
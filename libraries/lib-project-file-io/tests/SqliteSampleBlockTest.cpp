@@ -0,0 +1,191 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SqliteSampleBlockTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "DBConnection.h"
+#include "MockedPrefs.h"
+#include "Project.h"
+#include "ProjectFileIO.h"
+#include "SampleBlock.h"
+#include "SampleBlockCache.h"
+
+#include <sqlite3.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+MockedPrefs prefs;
+
+constexpr size_t blockSize = 64;
+
+//! A project with an open database, whose factory reads blocks only from
+//! the database
+struct Project
+{
+   Project()
+   {
+      REQUIRE(ProjectFileIO::InitializeSQL());
+      path = wxFileName::GetTempDir() + wxFILE_SEP_PATH +
+         "SqliteSampleBlockTest.aup3";
+      wxRemoveFile(path);
+      pProject = AudacityProject::Create();
+      auto &io = ProjectFileIO::Get(*pProject);
+      io.SetFileName(path);
+      REQUIRE(io.OpenProject());
+      pFactory = SampleBlockFactory::New(*pProject);
+      pFactory->GetCache()->SetCapacity(0);
+   }
+
+   ~Project()
+   {
+      // Blocks delete their rows, so they go before the connection
+      blocks.clear();
+      pFactory.reset();
+      ProjectFileIO::Get(*pProject).CloseProject();
+      pProject.reset();
+      wxRemoveFile(path);
+   }
+
+   //! Sample ii of block bb is (bb + 1) / 64 + ii / 8192, which is exact in
+   //! both formats
+   static float Value(size_t bb, size_t ii)
+   {
+      return (bb + 1) / 64.f + ii / 8192.f;
+   }
+
+   //! Odd blocks are 16 bit, the others float
+   void AddBlocks(size_t count)
+   {
+      for (size_t bb = blocks.size(), end = bb + count; bb < end; ++bb) {
+         std::vector<float> floats(blockSize);
+         std::vector<short> shorts(blockSize);
+         for (size_t ii = 0; ii < blockSize; ++ii) {
+            floats[ii] = Value(bb, ii);
+            shorts[ii] = static_cast<short>(floats[ii] * 32768);
+         }
+         blocks.push_back(bb % 2
+            ? pFactory->Create(reinterpret_cast<constSamplePtr>(
+                  shorts.data()), blockSize, int16Sample)
+            : pFactory->Create(reinterpret_cast<constSamplePtr>(
+                  floats.data()), blockSize, floatSample));
+      }
+   }
+
+   void DeleteRow(const SampleBlock &block)
+   {
+      const auto sql = "DELETE FROM sampleblocks WHERE blockid = " +
+         std::to_string(block.GetBlockID()) + ";";
+      REQUIRE(sqlite3_exec(ConnectionPtr::Get(*pProject).mpConnection->DB(),
+         sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK);
+   }
+
+   wxString path;
+   std::shared_ptr<AudacityProject> pProject;
+   SampleBlockFactoryPtr pFactory;
+   std::vector<SampleBlockPtr> blocks;
+};
+
+//! Read samples offset to offset + length of each of the blocks, in order
+struct Reads
+{
+   Reads(const std::vector<size_t> &which, size_t offset, size_t length)
+      : which{ which }, offset{ offset }, length{ length }
+      , buffer(which.size() * length, -1.f)
+   {}
+
+   bool Read(Project &project, bool mayThrow)
+   {
+      std::vector<SampleBlockReadRequest> requests;
+      for (size_t rr = 0; rr < which.size(); ++rr)
+         requests.push_back({ project.blocks[which[rr]].get(),
+            reinterpret_cast<samplePtr>(&buffer[rr * length]),
+            offset, length });
+      return project.pFactory->GetSamples(
+         requests.data(), requests.size(), floatSample, mayThrow);
+   }
+
+   //! Whether read rr has the block's samples, or zeroes if it failed
+   bool Check(size_t rr, bool failed) const
+   {
+      for (size_t ii = 0; ii < length; ++ii) {
+         const auto expected =
+            failed ? 0.f : Project::Value(which[rr], offset + ii);
+         if (buffer[rr * length + ii] != expected)
+            return false;
+      }
+      return true;
+   }
+
+   const std::vector<size_t> which;
+   const size_t offset;
+   const size_t length;
+   std::vector<float> buffer;
+};
+}
+
+TEST_CASE("SqliteSampleBlockFactory batched reads", "[SqliteSampleBlock]")
+{
+   Project project;
+
+   SECTION("Converts blocks of mixed formats")
+   {
+      project.AddBlocks(4);
+      Reads reads{ { 0, 1, 2, 3 }, 10, 20 };
+      REQUIRE(reads.Read(project, true));
+      for (size_t rr = 0; rr < 4; ++rr)
+         REQUIRE(reads.Check(rr, false));
+   }
+
+   SECTION("Fills every request for the same block")
+   {
+      project.AddBlocks(3);
+      Reads reads{ { 1, 0, 1, 2, 1 }, 0, blockSize };
+      REQUIRE(reads.Read(project, true));
+      for (size_t rr = 0; rr < 5; ++rr)
+         REQUIRE(reads.Check(rr, false));
+   }
+
+   SECTION("Reads more blocks than one query binds")
+   {
+      project.AddBlocks(40);
+      std::vector<size_t> which(40);
+      for (size_t bb = 0; bb < which.size(); ++bb)
+         which[bb] = which.size() - 1 - bb;
+      Reads reads{ which, 5, blockSize - 5 };
+      REQUIRE(reads.Read(project, true));
+      for (size_t rr = 0; rr < which.size(); ++rr)
+         REQUIRE(reads.Check(rr, false));
+   }
+
+   SECTION("A missing row")
+   {
+      project.AddBlocks(20);
+      project.DeleteRow(*project.blocks[3]);
+      std::vector<size_t> which(20);
+      for (size_t bb = 0; bb < which.size(); ++bb)
+         which[bb] = bb;
+      Reads reads{ which, 0, blockSize };
+
+      SECTION("throws if it may")
+      {
+         REQUIRE_THROWS(reads.Read(project, true));
+      }
+
+      SECTION("zeroes only its own destination if it may not throw")
+      {
+         REQUIRE(!reads.Read(project, false));
+         for (size_t rr = 0; rr < which.size(); ++rr)
+            REQUIRE(reads.Check(rr, rr == 3));
+      }
+   }
+}
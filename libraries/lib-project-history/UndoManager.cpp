@@ -25,7 +25,11 @@ UndoManager
 
 #include <wx/hashset.h>
 
+#include <unordered_map>
+#include <unordered_set>
+
 #include "BasicUI.h"
+#include "Prefs.h"
 #include "Project.h"
 #include "TransactionScope.h"
 //#include "NoteTrack.h"  // for Sonify* function declarations
@@ -38,6 +42,118 @@ bool UndoStateExtension::CanUndoOrRedo(const AudacityProject &)
    return true;
 }
 
+void UndoStateExtension::VisitSpaceUsage(UndoSpaceUsageVisitor &) const
+{
+}
+
+UndoSpaceUsageVisitor::~UndoSpaceUsageVisitor() = default;
+
+IntSetting UndoSpaceBudget{ L"/History/SpaceBudget", 0 };
+
+//! Counts of the states holding each part of storage, and of the parts
+//! holding each unit, so that pushing a state visits only its new parts
+struct UndoManager::SpaceLedger final : UndoSpaceUsageVisitor {
+   struct Part {
+      size_t count{}; //!< How many times states hold it
+      std::vector<long long> units;
+   };
+   struct Unit {
+      size_t count{}; //!< How many times parts hold it
+      unsigned long long bytes{};
+      //! Null after bytes is computed
+      std::function<unsigned long long()> getBytes;
+   };
+
+   //! (Re)count the parts of a state, then release what it held before
+   void Count(const UndoStackElem &elem)
+   {
+      auto &parts = mStates[&elem];
+      auto old = std::move(parts);
+      parts.clear();
+      mpParts = &parts;
+      for (auto &pExt : elem.state.extensions)
+         if (pExt)
+            pExt->VisitSpaceUsage(*this);
+      mpParts = nullptr;
+      Release(old);
+   }
+
+   void Remove(const UndoStackElem &elem)
+   {
+      if (auto iter = mStates.find(&elem); iter != mStates.end()) {
+         const auto parts = std::move(iter->second);
+         mStates.erase(iter);
+         Release(parts);
+      }
+   }
+
+   bool BeginPart(const void *pPart) override
+   {
+      mpParts->push_back(pPart);
+      auto &part = mParts[pPart];
+      mpPart = (part.count++ == 0) ? &part : nullptr;
+      return mpPart != nullptr;
+   }
+
+   void AddUnit(
+      long long id, std::function<unsigned long long()> getBytes) override
+   {
+      if (!mpPart)
+         return;
+      mpPart->units.push_back(id);
+      if (auto &unit = mUnits[id]; unit.count++ == 0) {
+         unit.getBytes = std::move(getBytes);
+         mUnresolved.push_back(id);
+      }
+   }
+
+   //! Compute sizes of units added since the last call
+   /*! Deferred, because that may be slow, as for blocks in a database */
+   void Resolve()
+   {
+      for (auto id : mUnresolved)
+         if (auto iter = mUnits.find(id); iter != mUnits.end()) {
+            auto &unit = iter->second;
+            if (unit.getBytes) {
+               unit.bytes = unit.getBytes();
+               unit.getBytes = nullptr;
+               mTotal += unit.bytes;
+            }
+         }
+      mUnresolved.clear();
+   }
+
+   void Release(const std::vector<const void*> &parts)
+   {
+      for (auto pPart : parts) {
+         const auto iter = mParts.find(pPart);
+         if (iter == mParts.end() || --iter->second.count > 0)
+            continue;
+         for (auto id : iter->second.units) {
+            const auto unitIter = mUnits.find(id);
+            if (unitIter == mUnits.end() || --unitIter->second.count > 0)
+               continue;
+            if (!unitIter->second.getBytes)
+               mTotal -= unitIter->second.bytes;
+            mUnits.erase(unitIter);
+         }
+         mParts.erase(iter);
+      }
+   }
+
+   std::unordered_map<const UndoStackElem*, std::vector<const void*>>
+      mStates;
+   std::unordered_map<const void*, Part> mParts;
+   std::unordered_map<long long, Unit> mUnits;
+   std::vector<long long> mUnresolved;
+   unsigned long long mTotal{ 0 };
+
+   //! Parts of the state being counted
+   std::vector<const void*> *mpParts{};
+   //! Part whose units are being reported, or null if counted already
+   Part *mpPart{};
+};
+
 namespace {
    using Savers = std::vector<UndoRedoExtensionRegistry::Saver>;
    static Savers &GetSavers()
@@ -80,6 +196,7 @@ const UndoManager &UndoManager::Get( const AudacityProject &project )
 
 UndoManager::UndoManager( AudacityProject &project )
    : mProject{ project }
+   , mpLedger{ std::make_unique<SpaceLedger>() }
 {
    current = -1;
    saved = -1;
@@ -117,6 +234,7 @@ void UndoManager::RemoveStateAt(int n)
    auto iter = stack.begin() + n;
    auto state = std::move(*iter);
    stack.erase(iter);
+   mpLedger->Remove(*state);
 }
 
 void UndoManager::EnqueueMessage(UndoRedoMessage message)
@@ -179,6 +297,34 @@ bool UndoManager::RedoAvailable()
    return CheckAvailable(current + 1);
 }
 
+unsigned long long UndoManager::GetSpaceUsage()
+{
+   mpLedger->Resolve();
+   return mpLedger->mTotal;
+}
+
+std::vector<unsigned long long> UndoManager::GetStateSpaceUsages()
+{
+   auto &ledger = *mpLedger;
+   ledger.Resolve();
+   std::vector<unsigned long long> result(stack.size());
+   std::unordered_set<const void*> seenParts;
+   std::unordered_set<long long> seenUnits;
+   for (auto ii = stack.size(); ii--;) {
+      const auto iter = ledger.mStates.find(stack[ii].get());
+      if (iter == ledger.mStates.end())
+         continue;
+      for (auto pPart : iter->second) {
+         if (!seenParts.insert(pPart).second)
+            continue;
+         for (auto id : ledger.mParts[pPart].units)
+            if (seenUnits.insert(id).second)
+               result[ii] += ledger.mUnits[id].bytes;
+      }
+   }
+   return result;
+}
+
 bool UndoManager::CheckAvailable(int index)
 {
    if (index < 0 || index >= (int)stack.size())
@@ -200,6 +346,7 @@ void UndoManager::ModifyState()
 
    // Re-create all captured project state
    state.extensions = GetExtensions(mProject);
+   mpLedger->Count(*stack[current]);
 
 //   SonifyEndModifyState();
 
@@ -233,6 +380,7 @@ void UndoManager::PushState(const TranslatableString &longDescription,
       if (current == saved) {
          saved = -1;
       }
+      EnforceSpaceBudget();
       return;
    }
 
@@ -246,12 +394,43 @@ void UndoManager::PushState(const TranslatableString &longDescription,
    );
 
    current++;
+   mpLedger->Count(*stack.back());
 
    lastAction = longDescription;
 
+   EnforceSpaceBudget();
+
    EnqueueMessage({ UndoRedoMessage::Pushed });
 }
 
+void UndoManager::EnforceSpaceBudget()
+{
+   const auto megabytes = UndoSpaceBudget.Read();
+   if (megabytes <= 0)
+      return;
+   const auto budget = static_cast<unsigned long long>(megabytes) << 20;
+   const auto kept = [this](size_t ii){
+      return ii == static_cast<size_t>(current) ||
+         ii == static_cast<size_t>(saved);
+   };
+   while (GetSpaceUsage() > budget) {
+      // Discard a range of the oldest states, just long enough to free the
+      // excess, if a kept state doesn't end it first
+      size_t begin = 0;
+      while (begin < stack.size() && kept(begin))
+         ++begin;
+      if (begin == stack.size())
+         break;
+      const auto excess = GetSpaceUsage() - budget;
+      const auto usages = GetStateSpaceUsages();
+      auto end = begin;
+      unsigned long long freed = 0;
+      while (end < stack.size() && !kept(end) && freed < excess)
+         freed += usages[end++];
+      RemoveStates(begin, end);
+   }
+}
+
 void UndoManager::AbandonRedo()
 {
    if (saved > current) {
@@ -78,6 +78,34 @@ struct UndoRedoMessage {
 };
 
 class AudacityProject;
+class IntSetting;
+
+//! Megabytes of storage that undo history may hold; 0 for no limit
+/*! When exceeded, the oldest states are discarded, but never the current or
+ saved state */
+extern PROJECT_HISTORY_API IntSetting UndoSpaceBudget;
+
+//! Receives reports of storage from UndoStateExtension::VisitSpaceUsage()
+class PROJECT_HISTORY_API UndoSpaceUsageVisitor {
+public:
+   virtual ~UndoSpaceUsageVisitor();
+
+   //! Begin the report of an immutable part of a state, such as a clip
+   /*!
+    @return whether to report the units of the part, which is false if
+    another state already reported it
+    */
+   virtual bool BeginPart(const void *pPart) = 0;
+
+   //! Report a unit of storage, such as a sample block, of the part last begun
+   /*!
+    Units shared by parts count once.
+    @param getBytes may be called later, but only while some state holds the
+    part
+    */
+   virtual void AddUnit(
+      long long id, std::function<unsigned long long()> getBytes) = 0;
+};
 
 //! Base class for extra information attached to undo/redo states
 class PROJECT_HISTORY_API UndoStateExtension {
@@ -89,6 +117,9 @@ public:
 
    //! Whether undo or redo is now permitted; default returns true
    virtual bool CanUndoOrRedo(const AudacityProject &project);
+
+   //! Report storage that the state holds; default reports nothing
+   virtual void VisitSpaceUsage(UndoSpaceUsageVisitor &visitor) const;
 };
 
 class PROJECT_HISTORY_API UndoRedoExtensionRegistry {
@@ -203,6 +234,18 @@ class PROJECT_HISTORY_API UndoManager final
    bool UndoAvailable();
    bool RedoAvailable();
 
+   //! Bytes of storage held by all states, counting shared storage once
+   /*! Kept up to date as states are pushed and removed, without visiting
+    all states */
+   unsigned long long GetSpaceUsage();
+   //! Bytes of storage held by each state, oldest first, and by no newer state
+   /*!
+    The user may discard states, oldest first, and storage is reclaimed only
+    when no state holds it, so each unit counts only in the newest state
+    holding it.
+    */
+   std::vector<unsigned long long> GetStateSpaceUsages();
+
    void MarkUnsaved();
    bool UnsavedChanges() const;
    int GetSavedState() const;
@@ -215,8 +258,12 @@ class PROJECT_HISTORY_API UndoManager final
 
    void EnqueueMessage(UndoRedoMessage message);
    void RemoveStateAt(int n);
+   void EnforceSpaceBudget();
+
+   struct SpaceLedger;
 
    AudacityProject &mProject;
+   const std::unique_ptr<SpaceLedger> mpLedger;
  
    int current;
    int saved;
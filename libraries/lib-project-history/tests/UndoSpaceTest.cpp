@@ -0,0 +1,249 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  UndoSpaceTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "MockedPrefs.h"
+#include "Prefs.h"
+#include "Project.h"
+#include "UndoManager.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+MockedPrefs prefs;
+
+constexpr unsigned long long MB = 1 << 20;
+
+//! An immutable part of the fake project's storage, like a clip
+struct Part
+{
+   //! Ids and sizes of the units, like sample blocks
+   std::vector<std::pair<long long, unsigned long long>> units;
+};
+using Parts = std::vector<std::shared_ptr<const Part>>;
+
+//! The contents of the fake project, saved and restored by State
+Parts sProjectParts;
+
+struct State final : UndoStateExtension
+{
+   explicit State(Parts parts) : parts{ std::move(parts) } {}
+
+   void RestoreUndoRedoState(AudacityProject&) override
+   {
+      sProjectParts = parts;
+   }
+
+   void VisitSpaceUsage(UndoSpaceUsageVisitor& visitor) const override
+   {
+      for (auto& pPart : parts)
+         if (visitor.BeginPart(pPart.get()))
+            for (auto [id, bytes] : pPart->units)
+               visitor.AddUnit(id, [bytes = bytes] { return bytes; });
+   }
+
+   const Parts parts;
+};
+
+UndoRedoExtensionRegistry::Entry sEntry { [](AudacityProject&) {
+   return std::make_shared<State>(sProjectParts);
+} };
+
+std::shared_ptr<const Part>
+MakePart(std::vector<std::pair<long long, unsigned long long>> units)
+{
+   return std::make_shared<const Part>(Part { std::move(units) });
+}
+
+struct History
+{
+   History()
+       : pProject { AudacityProject::Create() }
+       , manager { UndoManager::Get(*pProject) }
+   {
+   }
+
+   ~History()
+   {
+      manager.ClearStates();
+      UndoSpaceBudget.Reset();
+      sProjectParts.clear();
+   }
+
+   void Push(const std::string& name, Parts parts)
+   {
+      sProjectParts = std::move(parts);
+      manager.PushState(Verbatim(name), Verbatim(name));
+   }
+
+   void Restore(const UndoStackElem& elem)
+   {
+      for (auto& pExt : elem.state.extensions)
+         pExt->RestoreUndoRedoState(*pProject);
+   }
+
+   //! Short descriptions of the states, oldest first
+   std::vector<std::string> Names()
+   {
+      std::vector<std::string> result;
+      for (unsigned ii = 0; ii < manager.GetNumStates(); ++ii) {
+         TranslatableString desc;
+         manager.GetShortDescription(ii, &desc);
+         result.push_back(desc.MSGID().GET().ToStdString());
+      }
+      return result;
+   }
+
+   using Usages = std::vector<unsigned long long>;
+
+   const std::shared_ptr<AudacityProject> pProject;
+   UndoManager& manager;
+};
+} // namespace
+
+TEST_CASE("UndoManager counts shared storage once", "[UndoManager]")
+{
+   History history;
+   auto& manager = history.manager;
+   const auto a = MakePart({ { 1, 100 }, { 2, 100 } });
+   const auto b = MakePart({ { 2, 100 }, { 3, 100 } });
+   const auto c = MakePart({ { 4, 100 } });
+
+   history.Push("0", { a });
+   REQUIRE(manager.GetSpaceUsage() == 200);
+   REQUIRE(manager.GetStateSpaceUsages() == History::Usages { 200 });
+
+   // Unit 2 is in both parts
+   history.Push("1", { a, b });
+   REQUIRE(manager.GetSpaceUsage() == 300);
+   // Each unit counts in the newest state holding it
+   REQUIRE(manager.GetStateSpaceUsages() == History::Usages { 0, 300 });
+
+   history.Push("2", { b, c });
+   REQUIRE(manager.GetSpaceUsage() == 400);
+   REQUIRE(
+      manager.GetStateSpaceUsages() == History::Usages { 0, 100, 300 });
+
+   SECTION("Undo and redo change nothing")
+   {
+      const auto restore = [&](auto& elem) { history.Restore(elem); };
+      manager.Undo(restore);
+      manager.Undo(restore);
+      REQUIRE(sProjectParts == Parts { a });
+      REQUIRE(manager.GetSpaceUsage() == 400);
+      manager.Redo(restore);
+      REQUIRE(sProjectParts == Parts { a, b });
+      REQUIRE(manager.GetSpaceUsage() == 400);
+      REQUIRE(
+         manager.GetStateSpaceUsages() == History::Usages { 0, 100, 300 });
+
+      // Pushing abandons state 2, the only one holding c
+      history.Push("3", { a });
+      REQUIRE(history.Names() == std::vector<std::string> { "0", "1", "3" });
+      REQUIRE(manager.GetSpaceUsage() == 300);
+      REQUIRE(
+         manager.GetStateSpaceUsages() == History::Usages { 0, 100, 200 });
+   }
+
+   SECTION("Purge releases what no remaining state holds")
+   {
+      manager.RemoveStates(0, 2);
+      REQUIRE(history.Names() == std::vector<std::string> { "2" });
+      REQUIRE(manager.GetCurrentState() == 0);
+      REQUIRE(manager.GetSpaceUsage() == 300);
+      REQUIRE(manager.GetStateSpaceUsages() == History::Usages { 300 });
+   }
+
+   SECTION("Modifying a state recounts it")
+   {
+      sProjectParts = { c };
+      manager.ModifyState();
+      // State 1 still holds a and b
+      REQUIRE(manager.GetSpaceUsage() == 400);
+      REQUIRE(
+         manager.GetStateSpaceUsages() == History::Usages { 0, 300, 100 });
+   }
+
+   SECTION("Clearing releases everything")
+   {
+      manager.ClearStates();
+      REQUIRE(manager.GetSpaceUsage() == 0);
+      REQUIRE(manager.GetStateSpaceUsages().empty());
+   }
+}
+
+TEST_CASE("UndoManager discards the oldest states over budget", "[UndoManager]")
+{
+   History history;
+   auto& manager = history.manager;
+   REQUIRE(UndoSpaceBudget.Write(1));
+   std::vector<std::shared_ptr<const Part>> parts;
+   for (long long id = 0; id < 5; ++id)
+      parts.push_back(MakePart({ { id, MB / 2 } }));
+
+   SECTION("No more than needed")
+   {
+      history.Push("0", { parts[0] });
+      history.Push("1", { parts[1] });
+      // Exactly the budget
+      REQUIRE(history.Names() == std::vector<std::string> { "0", "1" });
+      history.Push("2", { parts[2] });
+      REQUIRE(history.Names() == std::vector<std::string> { "1", "2" });
+      REQUIRE(manager.GetSpaceUsage() == MB);
+      history.Push("3", { parts[3] });
+      REQUIRE(history.Names() == std::vector<std::string> { "2", "3" });
+      REQUIRE(manager.GetSpaceUsage() == MB);
+   }
+
+   SECTION("Not states whose storage a newer state holds")
+   {
+      history.Push("0", { parts[0], parts[1] });
+      history.Push("1", { parts[1] });
+      history.Push("2", { parts[1], parts[2] });
+      // Discarding 0 frees enough
+      REQUIRE(history.Names() == std::vector<std::string> { "1", "2" });
+      REQUIRE(manager.GetSpaceUsage() == MB);
+   }
+
+   SECTION("Never the saved state")
+   {
+      history.Push("0", { parts[0] });
+      manager.StateSaved();
+      history.Push("1", { parts[1] });
+      history.Push("2", { parts[2] });
+      REQUIRE(history.Names() == std::vector<std::string> { "0", "2" });
+      history.Push("3", { parts[3] });
+      REQUIRE(history.Names() == std::vector<std::string> { "0", "3" });
+      REQUIRE(manager.GetSavedState() == 0);
+      REQUIRE(manager.GetSpaceUsage() == MB);
+   }
+
+   SECTION("Never the current state")
+   {
+      const auto big = MakePart({ { 10, 2 * MB } });
+      history.Push("0", { big });
+      REQUIRE(history.Names() == std::vector<std::string> { "0" });
+      REQUIRE(manager.GetSpaceUsage() == 2 * MB);
+      history.Push("1", { parts[0] });
+      REQUIRE(history.Names() == std::vector<std::string> { "1" });
+      REQUIRE(manager.GetSpaceUsage() == MB / 2);
+   }
+
+   SECTION("Not with no budget")
+   {
+      REQUIRE(UndoSpaceBudget.Write(0));
+      for (size_t ii = 0; ii < parts.size(); ++ii)
+         history.Push(std::to_string(ii), { parts[ii] });
+      REQUIRE(manager.GetNumStates() == parts.size());
+      REQUIRE(manager.GetSpaceUsage() == parts.size() * MB / 2);
+   }
+}
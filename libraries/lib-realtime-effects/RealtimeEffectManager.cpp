@@ -61,6 +61,10 @@ void RealtimeEffectManager::Initialize(
    // initialize newly added effects
    mActive = true;
 
+   mMissedDeadlines = 0;
+   if (RealtimeEffectWorkers::Lanes() > 1)
+      mpWorkers = std::make_unique<RealtimeEffectWorkers>();
+
    // Tell each state to get ready for action
    VisitAll([&scope, sampleRate](RealtimeEffectState &state, bool) {
       scope.mInstances.push_back(state.Initialize(sampleRate));
@@ -93,6 +97,9 @@ void RealtimeEffectManager::Finalize() noexcept
    // Assume it is now safe to clean up
    mLatency = std::chrono::microseconds(0);
 
+   // Join the workers
+   mpWorkers.reset();
+
    VisitAll([](RealtimeEffectState &state, bool){ state.Finalize(); });
 
    // Reset processor parameters
@@ -180,6 +187,24 @@ size_t RealtimeEffectManager::Process(bool suspended,
    return discardable;
 }
 
+//
+// This will be called in a thread other than the main GUI thread.
+//
+void RealtimeEffectManager::ForEachGroup(size_t nGroups, size_t lanes,
+   RealtimeEffectWorkers::Clock::time_point deadline,
+   RealtimeEffectWorkers::Task task, void *context)
+{
+   if (mpWorkers) {
+      if (!mpWorkers->Run(task, context, nGroups, lanes, deadline))
+         ++mMissedDeadlines;
+      return;
+   }
+   for (size_t iGroup = 0; iGroup < nGroups; ++iGroup)
+      task(context, iGroup, 0);
+   if (RealtimeEffectWorkers::Clock::now() > deadline)
+      ++mMissedDeadlines;
+}
+
 //
 // This will be called in a different thread than the main GUI thread.
 //
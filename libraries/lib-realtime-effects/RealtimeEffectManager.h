@@ -23,6 +23,7 @@
 #include "Observer.h"
 #include "PluginProvider.h" // for PluginID
 #include "RealtimeEffectList.h"
+#include "RealtimeEffectWorkers.h"
 
 class ChannelGroup;
 class EffectInstance;
@@ -123,6 +124,11 @@ public:
    void SetSuspended(bool value)
       { mSuspended.store(value, std::memory_order_relaxed); }
 
+   //! How many buffers took longer to process than their deadlines, since
+   //! processing was last initialized
+   size_t GetMissedDeadlines() const
+      { return mMissedDeadlines.load(std::memory_order_relaxed); }
+
 private:
    friend RealtimeEffects::InitializationScope;
 
@@ -164,6 +170,10 @@ private:
       float *const *buffers, float *const *scratch, float *dummy,
       unsigned nBuffers, size_t numSamples);
    void ProcessEnd(bool suspended) noexcept;
+   /*! @copydoc ProcessingScope::ForEachGroup */
+   void ForEachGroup(size_t nGroups, size_t lanes,
+      RealtimeEffectWorkers::Clock::time_point deadline,
+      RealtimeEffectWorkers::Task task, void *context);
 
    RealtimeEffectManager(const RealtimeEffectManager&) = delete;
    RealtimeEffectManager &operator=(const RealtimeEffectManager&) = delete;
@@ -209,7 +219,9 @@ private:
    }
 
    AudacityProject &mProject;
-   Latency mLatency{ 0 };
+   //! Written by concurrent calls of Process()
+   std::atomic<Latency> mLatency{ Latency{ 0 } };
+   std::atomic<size_t> mMissedDeadlines{ 0 };
 
    std::atomic<bool> mSuspended{ true };
 
@@ -220,6 +232,9 @@ private:
    std::vector<const ChannelGroup *> mGroups; //!< all are non-null
 
    std::unordered_map<const ChannelGroup *, double> mRates;
+
+   //! Made by Initialize() when parallel processing is enabled
+   std::unique_ptr<RealtimeEffectWorkers> mpWorkers;
 };
 
 namespace RealtimeEffects {
@@ -308,6 +323,29 @@ public:
          return 0; // consider them trivially processed
    }
 
+   //! Call f(i, lane) for each i less than nGroups, maybe concurrently
+   /*!
+    Each call of f may call Process() for a group that no other call
+    processes.  Concurrent calls have different lanes, less than `lanes`, which
+    may choose among sets of scratch buffers.
+    @param deadline when the results are needed
+    */
+   template<typename Function>
+   void ForEachGroup(size_t nGroups, size_t lanes,
+      RealtimeEffectWorkers::Clock::time_point deadline, const Function &f)
+   {
+      const auto task = [](void *context, size_t iGroup, size_t iLane){
+         (*static_cast<const Function*>(context))(iGroup, iLane);
+      };
+      const auto context = const_cast<void*>(static_cast<const void*>(&f));
+      if (auto pProject = mwProject.lock())
+         RealtimeEffectManager::Get(*pProject)
+            .ForEachGroup(nGroups, lanes, deadline, task, context);
+      else
+         for (size_t iGroup = 0; iGroup < nGroups; ++iGroup)
+            task(context, iGroup, 0);
+   }
+
 private:
    RealtimeEffectManager::AllListsLock mLocks;
    std::weak_ptr<AudacityProject> mwProject;
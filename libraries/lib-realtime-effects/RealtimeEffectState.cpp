@@ -422,7 +422,7 @@ RealtimeEffectState::Initialize(double sampleRate)
 
    mCurrentProcessor = 0;
    mGroups.clear();
-   mLatency = {};
+   mLatencies.clear();
    return EnsureInstance(sampleRate);
 }
 
@@ -483,6 +483,7 @@ RealtimeEffectState::AddGroup(
       // Remember the sampleRate of the group, so latency can be computed
       // later
       mGroups[&group] = { first, sampleRate };
+      mLatencies[&group] = {};
       return pInstance;
    }
    return {};
@@ -539,7 +540,11 @@ size_t RealtimeEffectState::Process(
    size_t numSamples)
 {
    auto pInstance = mwInstance.lock();
-   if (!mPlugin || !pInstance || !mLastActive) {
+   // Look up without insertion, as other groups may be processed concurrently
+   const auto iterGroup = mGroups.find(&group);
+   const auto iterLatency = mLatencies.find(&group);
+   if (!mPlugin || !pInstance || !mLastActive ||
+      iterGroup == mGroups.end() || iterLatency == mLatencies.end()) {
       // Process trivially
       for (size_t ii = 0; ii < chans; ++ii)
          memcpy(outbuf[ii], inbuf[ii], numSamples * sizeof(float));
@@ -550,7 +555,8 @@ size_t RealtimeEffectState::Process(
    const auto clientIn = stackAllocate(const float *, numAudioIn);
    const auto clientOut = stackAllocate(float *, numAudioOut);
    size_t len = 0;
-   const auto &pair = mGroups[&group];
+   const auto &pair = iterGroup->second;
+   auto &latency = iterLatency->second;
    auto processor = pair.first;
    // Outer loop over processors
    AllocateChannelsToProcessors(chans, numAudioIn, numAudioOut,
@@ -581,10 +587,10 @@ size_t RealtimeEffectState::Process(
          // Assuming we are in a processing scope, use the worker settings
          auto processed = pInstance->RealtimeProcess(processor,
             mWorkerSettings.settings, clientIn, clientOut, cnt);
-         if (!mLatency)
-            // Find latency once only per initialization scope,
+         if (!latency)
+            // Find latency once only per initialization scope and group,
             // after processing one block
-            mLatency.emplace(
+            latency.emplace(
                pInstance->GetLatency(mWorkerSettings.settings, pair.second));
          for (size_t i = 0 ; i < numAudioIn; i++)
             if (clientIn[i])
@@ -595,9 +601,9 @@ size_t RealtimeEffectState::Process(
          if (ondx == 0) {
             // For the first processor only
             len += processed;
-            auto discard = limitSampleBufferSize(len, *mLatency);
+            auto discard = limitSampleBufferSize(len, *latency);
             len -= discard;
-            *mLatency -= discard;
+            *latency -= discard;
          }
       }
       ++processor;
@@ -667,7 +673,7 @@ bool RealtimeEffectState::Finalize() noexcept
    }
 
    auto result = pInstance->RealtimeFinalize(mMainSettings.settings);
-   mLatency = {};
+   mLatencies.clear();
    mInitialized = false;
    return result;
 }
@@ -177,8 +177,11 @@ private:
    std::unique_ptr<EffectInstance::Message> mMovedMessage;
    std::unique_ptr<EffectOutputs> mOutputs;
 
-   //! How many samples must be discarded
-   std::optional<EffectInstance::SampleCount> mLatency;
+   //! How many samples must be discarded, for each group
+   /*! Entries are made by AddGroup(), so that Process() for different groups
+    may run concurrently */
+   std::unordered_map<const ChannelGroup *,
+      std::optional<EffectInstance::SampleCount>> mLatencies;
    //! Assigned in the worker thread at the start of each processing scope
    bool mLastActive{};
 
@@ -0,0 +1,152 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file RealtimeEffectWorkers.cpp
+
+**********************************************************************/
+#include "RealtimeEffectWorkers.h"
+
+#include "Prefs.h"
+
+#include <algorithm>
+
+namespace {
+std::atomic<bool> sEnabled{ false };
+
+// How long a worker looks for more work after a buffer before it sleeps
+constexpr auto SpinDuration = std::chrono::microseconds{ 200 };
+// How long a sleeping worker may miss a wake-up
+constexpr auto SleepTimeout = std::chrono::milliseconds{ 1 };
+}
+
+void RealtimeEffectWorkers::SetEnabled(bool enabled)
+{
+   sEnabled = enabled;
+}
+
+size_t RealtimeEffectWorkers::Lanes()
+{
+   if (!sEnabled)
+      return 1;
+   return std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MaxLanes);
+}
+
+RealtimeEffectWorkers::RealtimeEffectWorkers(
+   size_t lanes, uint32_t firstGeneration)
+   : mGeneration{ firstGeneration & ((1u << GenerationBits) - 1) }
+   , mCursor{ Pack(mGeneration, 0, 0, 0) }
+{
+   lanes = std::min(lanes, MaxLanes);
+   for (size_t iLane = 1; iLane < lanes; ++iLane)
+      mThreads.emplace_back([this, iLane]{ Work(iLane); });
+}
+
+RealtimeEffectWorkers::~RealtimeEffectWorkers()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mStop = true;
+   }
+   mCondition.notify_all();
+   for (auto &thread : mThreads)
+      thread.join();
+}
+
+bool RealtimeEffectWorkers::Run(Task task, void *context, size_t nTasks,
+   size_t lanes, Clock::time_point deadline)
+{
+   lanes = std::clamp<size_t>(lanes, 1, GetLanes());
+   if (nTasks > CountMask || lanes == 1 || nTasks == 1) {
+      // Not worth waking anyone
+      for (size_t iTask = 0; iTask < nTasks; ++iTask)
+         task(context, iTask, 0);
+   }
+   else if (nTasks > 0) {
+      mTask = task;
+      mContext = context;
+      mNumDone.store(0, std::memory_order_relaxed);
+      mFailed.store(false, std::memory_order_relaxed);
+      mpException = nullptr;
+      mGeneration = (mGeneration + 1) & ((1u << GenerationBits) - 1);
+      mCursor.store(
+         Pack(mGeneration, lanes, nTasks, 0), std::memory_order_seq_cst);
+      if (mNumSleeping.load(std::memory_order_seq_cst) > 0)
+         mCondition.notify_all();
+
+      DoTasks(0);
+      // Join
+      while (mNumDone.load(std::memory_order_acquire) < nTasks)
+         std::this_thread::yield();
+      if (mFailed.load(std::memory_order_relaxed))
+         std::rethrow_exception(mpException);
+   }
+
+   return Clock::now() <= deadline;
+}
+
+uint64_t RealtimeEffectWorkers::Pack(
+   uint32_t generation, size_t lanes, size_t nTasks, size_t iTask)
+{
+   return (uint64_t{ generation } << (LanesBits + 2 * CountBits)) |
+      (uint64_t{ lanes } << (2 * CountBits)) |
+      (uint64_t{ nTasks } << CountBits) |
+      iTask;
+}
+
+void RealtimeEffectWorkers::Work(size_t iLane)
+{
+   // Sequentially consistent, paired with Run() loading mNumSleeping
+   const auto generation = [this]{
+      return mCursor.load() >> (LanesBits + 2 * CountBits);
+   };
+   auto seen = generation();
+   while (!mStop.load(std::memory_order_relaxed)) {
+      // Look for the next buffer a while, then sleep
+      const auto spinEnd = Clock::now() + SpinDuration;
+      while (generation() == seen && Clock::now() < spinEnd &&
+         !mStop.load(std::memory_order_relaxed))
+         std::this_thread::yield();
+      while (generation() == seen && !mStop.load(std::memory_order_relaxed)) {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         ++mNumSleeping;
+         mCondition.wait_for(lock, SleepTimeout, [&]{
+            return generation() != seen || mStop.load();
+         });
+         --mNumSleeping;
+      }
+      seen = generation();
+      DoTasks(iLane);
+   }
+}
+
+void RealtimeEffectWorkers::DoTasks(size_t iLane)
+{
+   auto cursor = mCursor.load(std::memory_order_acquire);
+   while (true) {
+      const auto lanes = (cursor >> (2 * CountBits)) & ((1u << LanesBits) - 1);
+      const auto nTasks = (cursor >> CountBits) & CountMask;
+      const auto iTask = cursor & CountMask;
+      if (iLane >= lanes || iTask >= nTasks)
+         return;
+      // Fails, and reloads the cursor, if another thread claimed the task, or
+      // if this is a worker that woke up late and a new generation began
+      if (!mCursor.compare_exchange_weak(cursor, cursor + 1,
+         std::memory_order_acq_rel, std::memory_order_acquire))
+         continue;
+      try {
+         mTask(mContext, iTask, iLane);
+      }
+      catch (...) {
+         // Keep the first
+         if (!mFailed.exchange(true, std::memory_order_relaxed))
+            mpException = std::current_exception();
+      }
+      mNumDone.fetch_add(1, std::memory_order_release);
+      cursor = mCursor.load(std::memory_order_acquire);
+   }
+}
+
+BoolSetting RealtimeEffectWorkersEnabled{
+   L"/AudioIO/ParallelRealtimeEffects", false };
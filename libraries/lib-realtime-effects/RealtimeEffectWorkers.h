@@ -0,0 +1,115 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file RealtimeEffectWorkers.h
+  @brief Threads that apply the effect chains of channel groups in parallel
+
+**********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class BoolSetting;
+
+//! Opt-in pool of threads that run the tasks of one buffer of playback
+/*!
+ The threads are made when realtime processing is initialized, in the main
+ thread, and wait for Run().  Run() is called from the audio thread; it hands
+ out tasks through one atomic word, without locks or allocation, and does
+ tasks itself until none are left, then waits for the others to finish.
+
+ Workers spin for a short while after each buffer, then sleep.  The calling
+ thread never waits on a lock to wake them; a worker that misses the wake-up
+ notices the next buffer within a millisecond, while the calling thread
+ proceeds with the tasks anyway.
+ */
+class REALTIME_EFFECTS_API RealtimeEffectWorkers final
+{
+public:
+   using Clock = std::chrono::steady_clock;
+   //! Called with the index of the task, and the index of the thread, which
+   //! is less than the lanes passed to Run()
+   using Task = void (*)(void *context, size_t iTask, size_t iLane);
+
+   //! Most threads used, counting the one that calls Run()
+   static constexpr size_t MaxLanes = 8;
+
+   //! Parallel processing is off by default
+   static void SetEnabled(bool enabled);
+
+   //! How many threads process, counting the one that calls Run(); 1 when
+   //! disabled
+   static size_t Lanes();
+
+   //! Spawn lanes - 1 threads, but at most MaxLanes - 1
+   /*!
+    @param firstGeneration numbers the buffers, counting up from the one
+    after it and wrapping around
+    */
+   explicit RealtimeEffectWorkers(
+      size_t lanes = Lanes(), uint32_t firstGeneration = 0);
+   ~RealtimeEffectWorkers();
+
+   RealtimeEffectWorkers(const RealtimeEffectWorkers&) = delete;
+   RealtimeEffectWorkers &operator=(const RealtimeEffectWorkers&) = delete;
+
+   //! Threads that Run() may use, counting the one that calls it
+   size_t GetLanes() const { return mThreads.size() + 1; }
+
+   //! Do tasks 0 to nTasks - 1, then return
+   /*!
+    One thread calls this at a time.  The calling thread is lane 0.  An
+    exception from a task is rethrown here, after all tasks are done.
+    @param lanes limits the threads used, e.g. to the scratch buffers there are
+    @param deadline when the results are needed; work continues past it, as
+    effects must see every buffer
+    @return whether all tasks were done by the deadline
+    */
+   bool Run(Task task, void *context, size_t nTasks, size_t lanes,
+      Clock::time_point deadline);
+
+private:
+   void Work(size_t iLane);
+   //! Claim and do tasks of the current generation until none are left
+   void DoTasks(size_t iLane);
+
+   // The cursor packs the generation, the lanes, the number of tasks and the
+   // next task to claim, so that one compare-and-swap claims a task of the
+   // right generation
+   static constexpr unsigned GenerationBits = 24;
+   static constexpr unsigned LanesBits = 8;
+   static constexpr unsigned CountBits = 16;
+   static constexpr uint64_t CountMask = (uint64_t{ 1 } << CountBits) - 1;
+   static uint64_t Pack(
+      uint32_t generation, size_t lanes, size_t nTasks, size_t iTask);
+
+   std::vector<std::thread> mThreads;
+
+   //! Written by Run() before it publishes the cursor, read after a claim
+   Task mTask{};
+   void *mContext{};
+
+   uint32_t mGeneration;
+   std::atomic<uint64_t> mCursor;
+   std::atomic<size_t> mNumDone{ 0 };
+
+   std::atomic<bool> mFailed{ false };
+   std::exception_ptr mpException;
+
+   std::atomic<bool> mStop{ false };
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::atomic<size_t> mNumSleeping{ 0 };
+};
+
+//! Preference to enable RealtimeEffectWorkers, applied at startup
+extern REALTIME_EFFECTS_API BoolSetting RealtimeEffectWorkersEnabled;
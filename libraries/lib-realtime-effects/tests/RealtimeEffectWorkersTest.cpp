@@ -0,0 +1,166 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RealtimeEffectWorkersTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "RealtimeEffectWorkers.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+using Clock = RealtimeEffectWorkers::Clock;
+
+//! Records the calls of tasks
+struct Calls
+{
+   explicit Calls(size_t nTasks)
+      : counts(nTasks), lanes(nTasks), threads(nTasks)
+   {}
+
+   static void Task(void* context, size_t iTask, size_t iLane)
+   {
+      auto& calls = *static_cast<Calls*>(context);
+      ++calls.counts[iTask];
+      calls.lanes[iTask] = iLane;
+      calls.threads[iTask] = std::this_thread::get_id();
+      if (iTask == calls.throwing)
+         throw std::runtime_error{ "task failed" };
+   }
+
+   bool Run(RealtimeEffectWorkers& workers, size_t lanes,
+      Clock::time_point deadline = Clock::now() + std::chrono::hours{ 1 })
+   {
+      return workers.Run(Task, this, counts.size(), lanes, deadline);
+   }
+
+   //! Whether each task was done once, in a lane below maxLanes
+   bool Check(size_t maxLanes) const
+   {
+      for (size_t iTask = 0; iTask < counts.size(); ++iTask)
+         if (counts[iTask] != 1 || lanes[iTask] >= maxLanes)
+            return false;
+      return true;
+   }
+
+   std::vector<std::atomic<size_t>> counts;
+   std::vector<size_t> lanes;
+   std::vector<std::thread::id> threads;
+   size_t throwing = -1;
+};
+}
+
+TEST_CASE("RealtimeEffectWorkers lanes", "[RealtimeEffectWorkers]")
+{
+   RealtimeEffectWorkers::SetEnabled(false);
+   REQUIRE(RealtimeEffectWorkers::Lanes() == 1);
+   REQUIRE(RealtimeEffectWorkers{}.GetLanes() == 1);
+
+   RealtimeEffectWorkers::SetEnabled(true);
+   const auto lanes = RealtimeEffectWorkers::Lanes();
+   REQUIRE(lanes >= 1);
+   REQUIRE(lanes <= RealtimeEffectWorkers::MaxLanes);
+   REQUIRE(RealtimeEffectWorkers{}.GetLanes() == lanes);
+   RealtimeEffectWorkers::SetEnabled(false);
+
+   // Whatever the cores
+   REQUIRE(RealtimeEffectWorkers{ 3 }.GetLanes() == 3);
+   REQUIRE(RealtimeEffectWorkers{ 100 }.GetLanes() ==
+      RealtimeEffectWorkers::MaxLanes);
+}
+
+TEST_CASE("RealtimeEffectWorkers runs each task once",
+   "[RealtimeEffectWorkers]")
+{
+   RealtimeEffectWorkers workers{ 4 };
+
+   SECTION("Zero tasks")
+   {
+      Calls calls{ 0 };
+      REQUIRE(calls.Run(workers, 4));
+   }
+
+   SECTION("One task, in the calling thread")
+   {
+      Calls calls{ 1 };
+      REQUIRE(calls.Run(workers, 4));
+      REQUIRE(calls.Check(1));
+      REQUIRE(calls.threads[0] == std::this_thread::get_id());
+   }
+
+   SECTION("One lane, in the calling thread")
+   {
+      Calls calls{ 20 };
+      REQUIRE(calls.Run(workers, 1));
+      REQUIRE(calls.Check(1));
+      for (auto& thread : calls.threads)
+         REQUIRE(thread == std::this_thread::get_id());
+   }
+
+   SECTION("In no more lanes than asked for, or than there are")
+   {
+      // Many buffers, so that workers wake up late, and find the cursor
+      // of the next one
+      for (size_t ii = 0; ii < 2000; ++ii) {
+         const auto nTasks = ii % 23;
+         const auto lanes = 1 + ii % 6;
+         Calls calls{ nTasks };
+         REQUIRE(calls.Run(workers, lanes));
+         CAPTURE(ii, nTasks, lanes);
+         REQUIRE(calls.Check(std::min<size_t>(lanes, workers.GetLanes())));
+         for (size_t iTask = 0; iTask < nTasks; ++iTask)
+            if (calls.lanes[iTask] == 0)
+               REQUIRE(calls.threads[iTask] == std::this_thread::get_id());
+            else
+               REQUIRE(calls.threads[iTask] != std::this_thread::get_id());
+      }
+   }
+}
+
+TEST_CASE("RealtimeEffectWorkers reuses generations",
+   "[RealtimeEffectWorkers]")
+{
+   // The generation wraps to zero, which is also that of the cursor before
+   // the first buffer of other workers
+   const uint32_t lastGeneration = (1u << 24) - 1;
+   const auto firstGeneration = GENERATE_COPY(
+      lastGeneration - 3, lastGeneration, uint32_t{ 0 });
+   RealtimeEffectWorkers workers{ 4, firstGeneration };
+   for (size_t ii = 0; ii < 10; ++ii) {
+      Calls calls{ 50 };
+      REQUIRE(calls.Run(workers, 4));
+      CAPTURE(firstGeneration, ii);
+      REQUIRE(calls.Check(4));
+   }
+}
+
+TEST_CASE("RealtimeEffectWorkers rethrows after all tasks",
+   "[RealtimeEffectWorkers]")
+{
+   RealtimeEffectWorkers workers{ 4 };
+   Calls calls{ 30 };
+   calls.throwing = 7;
+   REQUIRE_THROWS_AS(calls.Run(workers, 4), std::runtime_error);
+   REQUIRE(calls.Check(4));
+
+   // And the next buffer is fine
+   Calls next{ 30 };
+   REQUIRE(next.Run(workers, 4));
+   REQUIRE(next.Check(4));
+}
+
+TEST_CASE("RealtimeEffectWorkers reports a missed deadline",
+   "[RealtimeEffectWorkers]")
+{
+   RealtimeEffectWorkers workers{ 4 };
+   Calls calls{ 10 };
+   REQUIRE(!calls.Run(workers, 4, Clock::now() - std::chrono::seconds{ 1 }));
+   REQUIRE(calls.Check(4));
+}
@@ -13,11 +13,27 @@
 #include "ClipInterface.h"
 #include "ClipSegment.h"
 #include "SilenceSegment.h"
+#include "StretchedClipCache.h"
+#include "TimeAndPitchInterface.h"
 
 #include <algorithm>
 
 using ClipConstHolder = std::shared_ptr<const ClipInterface>;
 
+namespace
+{
+std::shared_ptr<const StretchedClipCache::Rendering>
+FindRendering(const ClipConstHolder& clip)
+{
+   // Clips that are not stretched are only read
+   if (
+      !StretchedClipCache::IsEnabled() ||
+      TimeAndPitchInterface::IsPassThroughMode(clip->GetStretchRatio()))
+      return nullptr;
+   return StretchedClipCache::Get().Find(clip);
+}
+} // namespace
+
 AudioSegmentFactory::AudioSegmentFactory(
    int sampleRate, int numChannels, const ClipConstHolders& clips)
     : mClips { clips }
@@ -58,7 +74,8 @@ AudioSegmentFactory::CreateAudioSegmentSequenceForward(double t0) const
       else if (clip->GetPlayEndTime() <= t0)
          continue;
       segments.push_back(std::make_shared<ClipSegment>(
-         *clip, t0 - clip->GetPlayStartTime(), PlaybackDirection::forward));
+         *clip, t0 - clip->GetPlayStartTime(), PlaybackDirection::forward,
+         FindRendering(clip)));
       t0 = clip->GetPlayEndTime();
    }
    return segments;
@@ -87,7 +104,8 @@ AudioSegmentFactory::CreateAudioSegmentSequenceBackward(double t0) const
       else if (clip->GetPlayStartTime() >= t0)
          continue;
       segments.push_back(std::make_shared<ClipSegment>(
-         *clip, clip->GetPlayEndTime() - t0, PlaybackDirection::backward));
+         *clip, clip->GetPlayEndTime() - t0, PlaybackDirection::backward,
+         FindRendering(clip)));
       t0 = clip->GetPlayStartTime();
    }
    return segments;
@@ -1,5 +1,39 @@
 #include "ClipInterface.h"
 
+#include <algorithm>
+
 ClipTimes::~ClipTimes() = default;
 
 ClipInterface::~ClipInterface() = default;
+
+bool ClipContentKey::Empty() const
+{
+   return owners.empty() && values.empty();
+}
+
+bool ClipContentKey::IsAlive() const
+{
+   return std::none_of(owners.begin(), owners.end(),
+      [](const auto &owner){ return owner.expired(); });
+}
+
+bool ClipContentKey::operator ==(const ClipContentKey &other) const
+{
+   // Compare the owners by identity, without locking them
+   const auto sameOwner = [](const auto &a, const auto &b){
+      return !a.owner_before(b) && !b.owner_before(a);
+   };
+   return values == other.values &&
+      std::equal(owners.begin(), owners.end(),
+         other.owners.begin(), other.owners.end(), sameOwner);
+}
+
+ClipContentKey ClipInterface::GetContentKey() const
+{
+   return {};
+}
+
+std::shared_ptr<const ClipInterface> ClipInterface::GetSnapshot() const
+{
+   return nullptr;
+}
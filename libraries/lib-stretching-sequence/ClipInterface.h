@@ -14,6 +14,27 @@
 #include "SampleCount.h"
 #include "SampleFormat.h"
 
+#include <memory>
+#include <vector>
+
+//! Identifies the samples of a clip, apart from the clip object
+/*!
+ While the objects that two equal keys refer to are alive, the clips that
+ gave the keys have the same samples.  An empty key identifies nothing.
+ */
+struct STRETCHING_SEQUENCE_API ClipContentKey
+{
+   //! Immutable objects holding the samples, such as sample blocks
+   std::vector<std::weak_ptr<const void>> owners;
+   //! Whatever else selects the samples from the owners, such as offsets
+   std::vector<long long> values;
+
+   bool Empty() const;
+   //! Whether all of the owners still exist
+   bool IsAlive() const;
+   bool operator ==(const ClipContentKey &other) const;
+};
+
 class STRETCHING_SEQUENCE_API ClipTimes
 {
 public:
@@ -45,6 +66,17 @@ public:
       bool mayThrow = true) const = 0;
 
    virtual size_t GetWidth() const = 0;
+
+   //! Identifies the samples that GetSampleView() gives
+   /*! Default returns an empty key, so that stretched renderings of the clip
+    are never cached */
+   virtual ClipContentKey GetContentKey() const;
+
+   //! A copy of the samples and times, which another thread may read while
+   //! this clip changes
+   /*! Default returns null, so that the clip is never rendered in the
+    background */
+   virtual std::shared_ptr<const ClipInterface> GetSnapshot() const;
 };
 
 using ClipHolders = std::vector<std::shared_ptr<ClipInterface>>;
@@ -9,10 +9,12 @@
 
 **********************************************************************/
 #include "ClipSegment.h"
+#include "AudioContainer.h"
 #include "ClipInterface.h"
 #include "SampleFormat.h"
 #include "StaffPadTimeAndPitch.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace
@@ -32,29 +34,111 @@ GetTotalNumSamplesToProduce(const ClipInterface& clip, double durationToDiscard)
                            clip.GetStretchRatio() -
                         durationToDiscard * clip.GetRate() + .5 };
 }
+
+// About two analysis windows of the stretcher, which are near 93 ms at any
+// rate
+constexpr auto preRollDuration = 0.2;
+
+double GetPreRollDuration(const ClipInterface& clip, double durationToDiscard)
+{
+   if (TimeAndPitchInterface::IsPassThroughMode(clip.GetStretchRatio()))
+      return 0.;
+   return std::min(preRollDuration, durationToDiscard);
+}
 } // namespace
 
 ClipSegment::ClipSegment(
    const ClipInterface& clip, double durationToDiscard,
-   PlaybackDirection direction)
+   PlaybackDirection direction,
+   std::shared_ptr<const StretchedClipCache::Rendering> pRendering)
     : mTotalNumSamplesToProduce { GetTotalNumSamplesToProduce(
          clip, durationToDiscard) }
-    , mSource { clip, durationToDiscard, direction }
-    , mStretcher { std::make_unique<StaffPadTimeAndPitch>(
-         clip.GetRate(), clip.GetWidth(), mSource,
-         GetStretchingParameters(clip)) }
+    , mClip { clip }
+    , mDirection { direction }
+    , mpRendering { std::move(pRendering) }
+    , mNumPreRollSamples { mpRendering ?
+                              sampleCount { 0 } :
+                              GetTotalNumSamplesToProduce(
+                                 clip, durationToDiscard -
+                                          GetPreRollDuration(
+                                             clip, durationToDiscard)) -
+                                 mTotalNumSamplesToProduce }
+    , mSource { clip,
+                mpRendering ?
+                   durationToDiscard :
+                   durationToDiscard -
+                      GetPreRollDuration(clip, durationToDiscard),
+                direction }
 {
 }
 
+ClipSegment::~ClipSegment() = default;
+
+void ClipSegment::BootStretcher()
+{
+   mStretcher = std::make_unique<StaffPadTimeAndPitch>(
+      mClip.GetRate(), mClip.GetWidth(), mSource,
+      GetStretchingParameters(mClip));
+   // Discard what the stretcher makes of the audio before the start; it
+   // needed that audio so that the first samples come at full level, rather
+   // than fading in as at the start of the clip
+   constexpr size_t blockSize = 1024;
+   AudioContainer scratch(blockSize, mClip.GetWidth());
+   for (auto remaining = mNumPreRollSamples; remaining > 0;)
+   {
+      const auto numSamples = limitSampleBufferSize(blockSize, remaining);
+      mStretcher->GetSamples(scratch.Get(), numSamples);
+      remaining -= numSamples;
+   }
+}
+
 size_t ClipSegment::GetFloats(float *const *buffers, size_t numSamples)
 {
    const auto numSamplesToProduce = limitSampleBufferSize(
       numSamples, mTotalNumSamplesToProduce - mTotalNumSamplesProduced);
-   mStretcher->GetSamples(buffers, numSamplesToProduce);
+   if (mpRendering)
+      CopyFromRendering(buffers, numSamplesToProduce);
+   else
+   {
+      // Only now, so that a seek primes only the segment that plays first
+      if (!mStretcher)
+         BootStretcher();
+      mStretcher->GetSamples(buffers, numSamplesToProduce);
+   }
    mTotalNumSamplesProduced += numSamplesToProduce;
    return numSamplesToProduce;
 }
 
+void ClipSegment::CopyFromRendering(
+   float* const* buffers, size_t numSamples) const
+{
+   // The rendering starts at the play start of the clip, and this segment
+   // ends (forward) or starts (backward) at its play end
+   const auto& rendering = *mpRendering;
+   const auto length = rendering.empty() ?
+                          0ll :
+                          static_cast<long long>(rendering[0].size());
+   const auto forward = mDirection == PlaybackDirection::forward;
+   const auto first = forward ? length -
+                                   mTotalNumSamplesToProduce.as_long_long() +
+                                   mTotalNumSamplesProduced.as_long_long() :
+                                mTotalNumSamplesToProduce.as_long_long() -
+                                   mTotalNumSamplesProduced.as_long_long() - 1;
+   for (size_t iChannel = 0; iChannel < rendering.size(); ++iChannel)
+   {
+      const auto& samples = rendering[iChannel];
+      const auto buffer = buffers[iChannel];
+      for (size_t ii = 0; ii < numSamples; ++ii)
+      {
+         const auto index = forward ? first + static_cast<long long>(ii) :
+                                      first - static_cast<long long>(ii);
+         // Rounding may make the segment longer than the rendering by a
+         // sample
+         buffer[ii] = (index >= 0 && index < length) ? samples[index] : 0.f;
+      }
+   }
+}
+
 bool ClipSegment::Empty() const
 {
    return mTotalNumSamplesProduced == mTotalNumSamplesToProduce;
@@ -13,6 +13,7 @@
 #include "AudioSegment.h"
 #include "PlaybackDirection.h"
 #include "ClipTimeAndPitchSource.h"
+#include "StretchedClipCache.h"
 
 #include <memory>
 
@@ -22,8 +23,14 @@ class TimeAndPitchInterface;
 class STRETCHING_SEQUENCE_API ClipSegment final : public AudioSegment
 {
 public:
+   /*!
+    @param pRendering if not null, samples are copied from it instead of
+    running the stretcher
+    */
    ClipSegment(
-      const ClipInterface&, double durationToDiscard, PlaybackDirection);
+      const ClipInterface&, double durationToDiscard, PlaybackDirection,
+      std::shared_ptr<const StretchedClipCache::Rendering> pRendering = {});
+   ~ClipSegment() override;
 
    // AudioSegment
    size_t GetFloats(float *const *buffers, size_t numSamples) override;
@@ -31,10 +38,19 @@ public:
    size_t GetWidth() const override;
 
 private:
+   void BootStretcher();
+   void CopyFromRendering(float* const* buffers, size_t numSamples) const;
+
    const sampleCount mTotalNumSamplesToProduce;
    sampleCount mTotalNumSamplesProduced = 0;
+   const ClipInterface& mClip;
+   const PlaybackDirection mDirection;
+   const std::shared_ptr<const StretchedClipCache::Rendering> mpRendering;
+   //! Samples that the stretcher makes of the audio before the start of the
+   //! segment, then discarded
+   const sampleCount mNumPreRollSamples;
    ClipTimeAndPitchSource mSource;
-   // Careful that this guy is constructed last, as its ctor refers to *this.
-   // todo(mhodgkinson) make this safe.
+   //! Made at the first GetFloats(), unless there is a rendering; it refers
+   //! to mSource
    std::unique_ptr<TimeAndPitchInterface> mStretcher;
 };
@@ -0,0 +1,218 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file StretchedClipCache.cpp
+
+**********************************************************************/
+#include "StretchedClipCache.h"
+
+#include "BasicUI.h"
+#include "ClipTimeAndPitchSource.h"
+#include "Prefs.h"
+#include "StaffPadTimeAndPitch.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+
+namespace
+{
+sampleCount GetRenderingLength(const ClipInterface& clip)
+{
+   // As ClipSegment produces when nothing is discarded
+   return sampleCount { clip.GetVisibleSampleCount().as_double() *
+                           clip.GetStretchRatio() + .5 };
+}
+
+size_t GetBytes(const StretchedClipCache::Rendering& rendering)
+{
+   size_t result = 0;
+   for (const auto& channel : rendering)
+      result += channel.size() * sizeof(float);
+   return result;
+}
+
+StretchedClipCache::Rendering Render(const ClipInterface& clip, size_t length)
+{
+   const auto width = clip.GetWidth();
+   StretchedClipCache::Rendering rendering(width, std::vector<float>(length));
+   ClipTimeAndPitchSource source { clip, 0.0, PlaybackDirection::forward };
+   TimeAndPitchInterface::Parameters params;
+   params.timeRatio = clip.GetStretchRatio();
+   StaffPadTimeAndPitch stretcher { clip.GetRate(), width, source, params };
+
+   constexpr size_t blockSize = 1024;
+   std::vector<float*> buffers(width);
+   for (size_t pos = 0; pos < length; pos += blockSize)
+   {
+      const auto numSamples = std::min(blockSize, length - pos);
+      for (size_t ii = 0; ii < width; ++ii)
+         buffers[ii] = rendering[ii].data() + pos;
+      stretcher.GetSamples(buffers.data(), numSamples);
+   }
+   return rendering;
+}
+} // namespace
+
+std::atomic<bool> StretchedClipCache::sEnabled { false };
+
+StretchedClipCache& StretchedClipCache::Get()
+{
+   static StretchedClipCache instance;
+   return instance;
+}
+
+void StretchedClipCache::SetEnabled(bool enabled)
+{
+   sEnabled = enabled;
+   if (!enabled)
+      Get().Clear();
+}
+
+bool StretchedClipCache::IsEnabled()
+{
+   return sEnabled;
+}
+
+StretchedClipCache::StretchedClipCache() = default;
+
+void StretchedClipCache::SetMaxBytes(size_t bytes)
+{
+   mMaxBytes = bytes;
+   std::lock_guard<std::mutex> lock { mMutex };
+   Trim();
+}
+
+size_t StretchedClipCache::GetMaxBytes() const
+{
+   return mMaxBytes;
+}
+
+std::shared_ptr<const StretchedClipCache::Rendering>
+StretchedClipCache::Find(const std::shared_ptr<const ClipInterface>& pClip)
+{
+   auto key = pClip->GetContentKey();
+   if (key.Empty())
+      return nullptr;
+   const auto stretchRatio = pClip->GetStretchRatio();
+   const auto rate = pClip->GetRate();
+   std::shared_ptr<const ClipInterface> pSnapshot;
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      const auto iter = Lookup(key, stretchRatio, rate);
+      if (iter != mEntries.end())
+      {
+         // Most recently used goes first
+         mEntries.splice(mEntries.begin(), mEntries, iter);
+         return iter->pRendering;
+      }
+      if (!sEnabled)
+         return nullptr;
+
+      const auto length = GetRenderingLength(*pClip);
+      if (length.as_double() * pClip->GetWidth() * sizeof(float) > mMaxBytes)
+         return nullptr;
+      // The task must not read the clip, which may change meanwhile
+      pSnapshot = pClip->GetSnapshot();
+      if (!pSnapshot)
+         return nullptr;
+      Trim();
+      mEntries.push_front({ key, stretchRatio, rate, nullptr });
+   }
+
+   const auto length = GetRenderingLength(*pSnapshot).as_size_t();
+   TaskPool::Get().Post(
+      [this, pClip, pSnapshot, key = std::move(key), stretchRatio, rate,
+       length]() mutable {
+         std::shared_ptr<Rendering> pRendering;
+         try
+         {
+            pRendering =
+               std::make_shared<Rendering>(Render(*pSnapshot, length));
+         }
+         catch (...)
+         {
+            // Playback will read the clip itself, and report any error
+         }
+         // Move the clip and the snapshot, so that the last references to
+         // them and their samples are not released here
+         BasicUI::CallAfter([this, pClip = std::move(pClip),
+                             pSnapshot = std::move(pSnapshot),
+                             key = std::move(key), stretchRatio, rate,
+                             pRendering = std::move(pRendering)] {
+            Store(*pClip, key, stretchRatio, rate, pRendering);
+         });
+      },
+      TaskPriority::Low);
+   return nullptr;
+}
+
+void StretchedClipCache::Clear()
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   mEntries.clear();
+   mBytes = 0;
+}
+
+StretchedClipCache::Entries::iterator StretchedClipCache::Lookup(
+   const ClipContentKey& key, double stretchRatio, int rate)
+{
+   return std::find_if(
+      mEntries.begin(), mEntries.end(), [&](const Entry& entry) {
+         return entry.stretchRatio == stretchRatio && entry.rate == rate &&
+                entry.key == key;
+      });
+}
+
+void StretchedClipCache::Trim()
+{
+   for (auto iter = mEntries.begin(); iter != mEntries.end();)
+   {
+      if (iter->key.IsAlive())
+         ++iter;
+      else
+      {
+         if (iter->pRendering)
+            mBytes -= GetBytes(*iter->pRendering);
+         iter = mEntries.erase(iter);
+      }
+   }
+   // Renderings in progress stay
+   for (auto iter = mEntries.end();
+        mBytes > mMaxBytes && iter != mEntries.begin();)
+   {
+      --iter;
+      if (iter->pRendering)
+      {
+         mBytes -= GetBytes(*iter->pRendering);
+         iter = mEntries.erase(iter);
+      }
+   }
+}
+
+void StretchedClipCache::Store(
+   const ClipInterface& clip, const ClipContentKey& key, double stretchRatio,
+   int rate, const std::shared_ptr<Rendering>& pRendering)
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   const auto iter = Lookup(key, stretchRatio, rate);
+   // It is gone if the cache was cleared
+   if (iter == mEntries.end() || iter->pRendering)
+      return;
+   // This runs in the main thread, which is where clips change; discard the
+   // rendering if the clip did in the meantime, or if rendering failed
+   if (
+      !pRendering || clip.GetStretchRatio() != stretchRatio ||
+      clip.GetRate() != rate || !(clip.GetContentKey() == key))
+   {
+      mEntries.erase(iter);
+      return;
+   }
+   mBytes += GetBytes(*pRendering);
+   iter->pRendering = pRendering;
+   Trim();
+}
+
+BoolSetting StretchedClipCacheEnabled { L"/AudioIO/StretchedClipCache",
+                                        false };
@@ -0,0 +1,100 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file StretchedClipCache.h
+  @brief Whole stretched clips, rendered in the background
+
+**********************************************************************/
+#pragma once
+
+#include "ClipInterface.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class BoolSetting;
+
+//! Opt-in cache of clips as stretched by the phase vocoder
+/*!
+ Find() looks for the rendering of a clip by its content key, stretch ratio
+ and rate.  On a miss, it renders a snapshot of the clip once, in a low
+ priority task of the shared TaskPool, so that later playback, export and
+ drawing of the clip copy samples instead of running the vocoder.  Clips that
+ give no snapshot are not rendered.
+
+ Renderings stay in memory, within a budget, and the least recently used go
+ first.  Those of clips whose samples no longer exist go at the next miss.
+
+ The task releases its clip and snapshot in the main thread, so that the
+ deletion of sample blocks never happens in the worker; also there, it checks
+ that the clip did not change while rendering.
+ */
+class STRETCHING_SEQUENCE_API StretchedClipCache final
+{
+public:
+   //! Samples of each channel of a clip, forward from its play start
+   using Rendering = std::vector<std::vector<float>>;
+
+   static constexpr size_t DefaultMaxBytes = 256 * 1024 * 1024;
+
+   static StretchedClipCache &Get();
+
+   //! The cache is off by default
+   static void SetEnabled(bool enabled);
+   static bool IsEnabled();
+
+   //! Clips that would take more than this are never rendered
+   void SetMaxBytes(size_t bytes);
+   size_t GetMaxBytes() const;
+
+   //! The rendering of the clip, if it is ready
+   /*! If not, and the cache is enabled, queue the clip for rendering, unless
+    it is already */
+   std::shared_ptr<const Rendering>
+   Find(const std::shared_ptr<const ClipInterface> &pClip);
+
+   //! Discard all renderings; those in progress are discarded when done
+   void Clear();
+
+private:
+   struct Entry {
+      ClipContentKey key;
+      double stretchRatio;
+      int rate;
+      //! Null while rendering
+      std::shared_ptr<const Rendering> pRendering;
+   };
+   using Entries = std::list<Entry>;
+
+   StretchedClipCache();
+
+   //! @pre mMutex is locked
+   Entries::iterator Lookup(
+      const ClipContentKey &key, double stretchRatio, int rate);
+   //! Drop entries of dead clips, then the least recently used until within
+   //! the budget
+   /*! @pre mMutex is locked */
+   void Trim();
+   //! Fill the pending entry, or remove it if the rendering failed
+   void Store(const ClipInterface &clip, const ClipContentKey &key,
+      double stretchRatio, int rate,
+      const std::shared_ptr<Rendering> &pRendering);
+
+   static std::atomic<bool> sEnabled;
+
+   std::atomic<size_t> mMaxBytes{ DefaultMaxBytes };
+
+   std::mutex mMutex;
+   //! Most recently used first
+   Entries mEntries;
+   //! Sum of the sizes of the renderings in mEntries
+   size_t mBytes{ 0 };
+};
+
+//! Preference to enable StretchedClipCache, applied at startup
+extern STRETCHING_SEQUENCE_API BoolSetting StretchedClipCacheEnabled;
@@ -118,6 +118,11 @@ bool StretchingSequence::GetMute() const
    return mSequence.GetMute();
 }
 
+void StretchingSequence::Prefetch(double t, bool backwards) const
+{
+   mSequence.Prefetch(t, backwards);
+}
+
 double StretchingSequence::GetStartTime() const
 {
    return mSequence.GetStartTime();
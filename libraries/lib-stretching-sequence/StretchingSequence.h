@@ -58,6 +58,7 @@ public:
    const ChannelGroup *FindChannelGroup() const override;
    bool GetSolo() const override;
    bool GetMute() const override;
+   void Prefetch(double t, bool backwards) const override;
 
    // AudioGraph::Channel
    AudioGraph::ChannelType GetChannelType() const override;
@@ -0,0 +1,223 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCacheTest.cpp
+
+**********************************************************************/
+#include "StretchedClipCache.h"
+#include "AudioContainer.h"
+#include "BasicUI.h"
+#include "ClipSegment.h"
+#include "FloatVectorClip.h"
+#include "MockSampleBlockFactory.h"
+#include "TestWaveClipMaker.h"
+#include "TestWaveTrackMaker.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+namespace
+{
+constexpr auto sampleRate = 8000;
+
+class KeyedClip : public FloatVectorClip
+{
+public:
+   using FloatVectorClip::FloatVectorClip;
+
+   ClipContentKey GetContentKey() const override
+   {
+      return { { pSamples }, {} };
+   }
+
+   std::shared_ptr<const ClipInterface> GetSnapshot() const override
+   {
+      return std::make_shared<KeyedClip>(*this);
+   }
+
+   //! Replace to simulate an edit
+   std::shared_ptr<int> pSamples = std::make_shared<int>(0);
+};
+
+std::vector<float> MakeNoise(size_t length, unsigned seed = 42)
+{
+   std::mt19937 engine { seed };
+   std::uniform_real_distribution<float> distribution { -1.f, 1.f };
+   std::vector<float> result(length);
+   for (auto& sample : result)
+      sample = distribution(engine);
+   return result;
+}
+
+std::vector<std::vector<float>>
+ReadAll(ClipSegment& segment, size_t numChannels, size_t blockSize)
+{
+   std::vector<std::vector<float>> result(numChannels);
+   AudioContainer buffer(blockSize, numChannels);
+   while (!segment.Empty())
+   {
+      const auto numSamples =
+         segment.GetFloats(buffer.channelPointers.data(), blockSize);
+      for (size_t ii = 0; ii < numChannels; ++ii)
+         result[ii].insert(
+            result[ii].end(), buffer.channelVectors[ii].begin(),
+            buffer.channelVectors[ii].begin() + numSamples);
+   }
+   return result;
+}
+
+std::shared_ptr<const StretchedClipCache::Rendering>
+WaitForRendering(const std::shared_ptr<const ClipInterface>& pClip)
+{
+   auto& cache = StretchedClipCache::Get();
+   std::shared_ptr<const StretchedClipCache::Rendering> result;
+   for (auto ii = 0; !result && ii < 1000; ++ii)
+   {
+      // Renderings are stored in the main thread
+      BasicUI::Yield();
+      result = cache.Find(pClip);
+      if (!result)
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+   }
+   return result;
+}
+} // namespace
+
+TEST_CASE("StretchedClipCache")
+{
+   auto& cache = StretchedClipCache::Get();
+   const auto clip =
+      std::make_shared<KeyedClip>(sampleRate, MakeNoise(sampleRate), 2u);
+   clip->stretchRatio = 1.5;
+
+   // Off by default
+   REQUIRE(!StretchedClipCache::IsEnabled());
+   REQUIRE(cache.Find(clip) == nullptr);
+
+   StretchedClipCache::SetEnabled(true);
+   const auto waitForRendering = [&] { return WaitForRendering(clip); };
+   const auto pRendering = waitForRendering();
+   REQUIRE(pRendering != nullptr);
+   REQUIRE(pRendering->size() == 2u);
+   REQUIRE(pRendering->at(0).size() == sampleRate * 3 / 2);
+
+   SECTION("gives what the stretcher gives")
+   {
+      ClipSegment live { *clip, 0., PlaybackDirection::forward };
+      ClipSegment rendered { *clip, 0., PlaybackDirection::forward,
+                             pRendering };
+      const auto expected = ReadAll(live, 2u, 1024);
+      REQUIRE(ReadAll(rendered, 2u, 300) == expected);
+      REQUIRE(expected == *pRendering);
+   }
+
+   SECTION("serves segments that start within the clip")
+   {
+      // Half a second into the stretched clip
+      ClipSegment forward { *clip, .5, PlaybackDirection::forward,
+                            pRendering };
+      const auto forwardSamples = ReadAll(forward, 2u, 512);
+      REQUIRE(forwardSamples[0].size() == sampleRate);
+      REQUIRE(std::equal(
+         forwardSamples[1].begin(), forwardSamples[1].end(),
+         pRendering->at(1).begin() + sampleRate / 2));
+
+      ClipSegment backward { *clip, .5, PlaybackDirection::backward,
+                             pRendering };
+      const auto backwardSamples = ReadAll(backward, 2u, 512);
+      REQUIRE(backwardSamples[0].size() == sampleRate);
+      REQUIRE(std::equal(
+         backwardSamples[0].begin(), backwardSamples[0].end(),
+         std::make_reverse_iterator(pRendering->at(0).begin() + sampleRate)));
+   }
+
+   SECTION("misses when the samples change")
+   {
+      clip->pSamples = std::make_shared<int>(0);
+      REQUIRE(cache.Find(clip) == nullptr);
+      REQUIRE(waitForRendering() != nullptr);
+   }
+
+   SECTION("misses when the stretch ratio changes")
+   {
+      clip->stretchRatio = 2.;
+      REQUIRE(cache.Find(clip) == nullptr);
+   }
+
+   StretchedClipCache::SetEnabled(false);
+   REQUIRE(cache.Find(clip) == nullptr);
+   // Let pending renderings finish before the clip goes
+   BasicUI::Yield();
+}
+
+TEST_CASE("StretchedClipCache serves the clips of stereo wave tracks")
+{
+   auto& cache = StretchedClipCache::Get();
+   const auto factory = std::make_shared<MockSampleBlockFactory>();
+   const TestWaveClipMaker clipMaker { sampleRate, factory };
+   const TestWaveTrackMaker trackMaker { sampleRate, factory };
+   const auto stretch = [](WaveClip& clip) {
+      clip.StretchRightTo(clip.GetPlayStartTime() + 1.5 * clip.GetPlayDuration());
+   };
+   const auto leftClip =
+      clipMaker.ClipFilledWith(MakeNoise(sampleRate, 1), 1u, stretch);
+   const auto rightClip =
+      clipMaker.ClipFilledWith(MakeNoise(sampleRate, 2), 1u, stretch);
+   const auto left = trackMaker.Track(leftClip);
+   const auto right = trackMaker.Track(rightClip);
+   REQUIRE(left->GetOwner()->MakeMultiChannelTrack(*left, 2));
+
+   // What playback and the cache get: a WideClip of both channels
+   const auto getClip = [&] {
+      const auto clips = left->GetClipInterfaces();
+      REQUIRE(clips.size() == 1u);
+      return clips[0];
+   };
+   const auto clip = getClip();
+   REQUIRE(clip->GetWidth() == 2u);
+
+   SECTION("snapshots have the samples of both channels")
+   {
+      const auto snapshot = clip->GetSnapshot();
+      REQUIRE(snapshot != nullptr);
+      REQUIRE(snapshot->GetWidth() == 2u);
+      REQUIRE(snapshot->GetStretchRatio() == clip->GetStretchRatio());
+      ClipSegment live { *clip, 0., PlaybackDirection::forward };
+      ClipSegment snapped { *snapshot, 0., PlaybackDirection::forward };
+      REQUIRE(ReadAll(snapped, 2u, 512) == ReadAll(live, 2u, 512));
+   }
+
+   StretchedClipCache::SetEnabled(true);
+   const auto pRendering = WaitForRendering(clip);
+   REQUIRE(pRendering != nullptr);
+   REQUIRE(pRendering->size() == 2u);
+
+   SECTION("gives what the stretcher gives")
+   {
+      ClipSegment live { *clip, 0., PlaybackDirection::forward };
+      REQUIRE(ReadAll(live, 2u, 1024) == *pRendering);
+   }
+
+   SECTION("hits for the clips that later calls make")
+   {
+      REQUIRE(cache.Find(getClip()) == pRendering);
+   }
+
+   SECTION("misses when the right channel changes")
+   {
+      const std::vector<float> values(100, .5f);
+      rightClip->SetSamples(
+         0u, reinterpret_cast<constSamplePtr>(values.data()), floatSample, 0,
+         values.size(), floatSample);
+      REQUIRE(cache.Find(getClip()) == nullptr);
+   }
+
+   StretchedClipCache::SetEnabled(false);
+   // Let pending renderings finish before the clips go
+   BasicUI::Yield();
+}
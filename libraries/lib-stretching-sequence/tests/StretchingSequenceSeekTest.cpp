@@ -0,0 +1,120 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchingSequenceSeekTest.cpp
+
+**********************************************************************/
+#include "StretchingSequence.h"
+#include "AudioContainer.h"
+#include "AudioContainerHelper.h"
+#include "FloatVectorClip.h"
+#include "MockPlayableSequence.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+constexpr auto sampleRate = 44100;
+constexpr auto numChannels = 2u;
+
+//! Chords, so that the stretcher has something to lock phases to
+std::vector<float> MakeAudio(size_t length)
+{
+   std::vector<float> result(length);
+   for (size_t ii = 0; ii < length; ++ii)
+   {
+      const auto t = double(ii) / sampleRate;
+      result[ii] = .3 * std::sin(2 * M_PI * 220 * t) +
+                   .2 * std::sin(2 * M_PI * 277.18 * t) +
+                   .1 * std::sin(2 * M_PI * 329.63 * t);
+   }
+   return result;
+}
+
+std::vector<float> Read(
+   const StretchingSequence& sequence, sampleCount start, size_t length)
+{
+   AudioContainer output(length, numChannels);
+   constexpr auto backwards = false;
+   sequence.GetFloats(
+      AudioContainerHelper::GetData(output).data(), start, length, backwards);
+   return output.channelVectors[0];
+}
+
+double Rms(const std::vector<float>& samples, size_t length)
+{
+   double sum = 0;
+   for (size_t ii = 0; ii < length; ++ii)
+      sum += samples[ii] * samples[ii];
+   return std::sqrt(sum / length);
+}
+
+//! Ten stretched clips of two seconds each, back to back
+ClipConstHolders MakeClips()
+{
+   ClipConstHolders clips;
+   const auto audio = MakeAudio(2 * sampleRate);
+   for (auto ii = 0; ii < 10; ++ii)
+   {
+      const auto clip =
+         std::make_shared<FloatVectorClip>(sampleRate, audio, numChannels);
+      clip->stretchRatio = 1.5;
+      clip->playStartTime = ii * 3.0;
+      clips.push_back(clip);
+   }
+   return clips;
+}
+} // namespace
+
+TEST_CASE("StretchingSequence seeks into stretched clips")
+{
+   const auto clips = MakeClips();
+   const MockPlayableSequence mockSequence { sampleRate, numChannels };
+
+   // What an uninterrupted pass gives
+   const auto continuous = StretchingSequence::Create(mockSequence, clips);
+   constexpr size_t length = 4096;
+   const sampleCount seekPosition = sampleRate + 1234;
+   Read(*continuous, 0, seekPosition.as_size_t());
+   const auto expected = Read(*continuous, seekPosition, length);
+
+   // After a seek, the stretcher warms up on the audio before the seek
+   // position, so that there is no fade-in.  The phases of the vocoder depend
+   // on where it started, so compare levels rather than samples.
+   const auto seeking = StretchingSequence::Create(mockSequence, clips);
+   Read(*seeking, 5 * sampleRate, length);
+   const auto actual = Read(*seeking, seekPosition, length);
+   constexpr size_t head = 1024;
+   REQUIRE(Rms(actual, head) == Approx(Rms(expected, head)).epsilon(0.2));
+   REQUIRE(Rms(actual, length) == Approx(Rms(expected, length)).epsilon(0.1));
+}
+
+// Hidden by default; run with the tag to see timings
+TEST_CASE("StretchingSequence seek benchmark", "[.benchmark]")
+{
+   const auto clips = MakeClips();
+   const MockPlayableSequence mockSequence { sampleRate, numChannels };
+   const auto sequence = StretchingSequence::Create(mockSequence, clips);
+
+   constexpr auto numSeeks = 100;
+   constexpr size_t length = 512;
+   const auto totalLength = 30 * sampleRate;
+   const auto start = std::chrono::steady_clock::now();
+   for (auto ii = 0; ii < numSeeks; ++ii)
+   {
+      // Scattered positions, each a discontinuity
+      const sampleCount position = (ii * 7919 * 64) % totalLength;
+      Read(*sequence, position, length);
+   }
+   const auto seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+   std::cout << "Seek to first " << length
+             << " samples: " << 1000 * seconds / numSeeks << " ms\n";
+}
@@ -0,0 +1,166 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WaveTrackSharingTest.cpp
+
+**********************************************************************/
+#include "MockSampleBlockFactory.h"
+#include "TestWaveClipMaker.h"
+#include "TestWaveTrackMaker.h"
+#include "UndoManager.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+constexpr auto sampleRate = 8;
+
+const auto sampleBlockFactory = std::make_shared<MockSampleBlockFactory>();
+TestWaveClipMaker clipMaker { sampleRate, sampleBlockFactory };
+TestWaveTrackMaker trackMaker { sampleRate, sampleBlockFactory };
+
+WaveClipHolder MakeClip(float value, double start)
+{
+   return clipMaker.ClipFilledWith(
+      value, sampleRate, 1, [&](auto& clip) { clip.SetPlayStartTime(start); });
+}
+
+WaveClipHolder Copy(const WaveClip& clip)
+{
+   return std::make_shared<WaveClip>(clip, sampleBlockFactory, true);
+}
+
+SampleBlockID BlockID(const WaveClip& clip)
+{
+   return clip.GetSequenceBlockArray(0)->front().sb->GetBlockID();
+}
+
+const WaveTrack& Leader(const TrackListHolder& pList)
+{
+   return **pList->Any<const WaveTrack>().begin();
+}
+
+//! Records what a track reports
+struct Visitor final : UndoSpaceUsageVisitor
+{
+   bool BeginPart(const void* pPart) override
+   {
+      parts.push_back(pPart);
+      return true;
+   }
+   void AddUnit(long long id, std::function<unsigned long long()>) override
+   {
+      units.push_back(id);
+   }
+   std::vector<const void*> parts;
+   std::vector<long long> units;
+};
+} // namespace
+
+TEST_CASE("WaveClip::IsSameAs", "[UndoManager]")
+{
+   const auto clip = MakeClip(.5f, 1.0);
+
+   SECTION("A copy is the same, because it shares the blocks")
+   {
+      const auto copy = Copy(*clip);
+      REQUIRE(BlockID(*copy) == BlockID(*clip));
+      REQUIRE(copy->IsSameAs(*clip));
+      REQUIRE(clip->IsSameAs(*copy));
+   }
+
+   SECTION("Equal samples in other blocks are not the same")
+   {
+      const auto other = MakeClip(.5f, 1.0);
+      REQUIRE(!other->IsSameAs(*clip));
+   }
+
+   SECTION("A copy changed afterward is not the same")
+   {
+      const auto copy = Copy(*clip);
+      using Change = void (*)(WaveClip&);
+      const auto change = GENERATE(
+         as<Change> {},
+         [](WaveClip& target) { target.SetName("changed"); },
+         [](WaveClip& target) { target.ShiftBy(1.0); },
+         [](WaveClip& target) { target.SetTrimLeft(1.0 / sampleRate); },
+         [](WaveClip& target) {
+            target.GetEnvelope()->InsertOrReplace(1.5, 0.5);
+         },
+         [](WaveClip& target) { target.InsertSilence(1.5, 1.0); });
+      change(*copy);
+      REQUIRE(!copy->IsSameAs(*clip));
+      REQUIRE(!clip->IsSameAs(*copy));
+   }
+
+   SECTION("Un-flushed samples are never the same")
+   {
+      const auto copy = Copy(*clip);
+      const float sample = .25f;
+      constSamplePtr buffers[] { reinterpret_cast<constSamplePtr>(&sample) };
+      copy->Append(buffers, floatSample, 1, 1, floatSample);
+      REQUIRE(!copy->IsSameAs(*clip));
+      const auto other = Copy(*clip);
+      other->Append(buffers, floatSample, 1, 1, floatSample);
+      REQUIRE(!copy->IsSameAs(*other));
+      REQUIRE(!copy->IsSameAs(*copy));
+   }
+}
+
+TEST_CASE("WaveTrack::DuplicateSharing", "[UndoManager]")
+{
+   const auto track = trackMaker.Track({ MakeClip(.5f, 0), MakeClip(-.5f, 2) });
+
+   // Without an earlier copy, all clips are copied, though blocks are shared
+   const auto pFirst = track->DuplicateSharing(nullptr);
+   const auto& first = Leader(pFirst);
+   REQUIRE(first.GetClips().size() == 2);
+   for (size_t ii = 0; ii < 2; ++ii) {
+      REQUIRE(first.GetClips()[ii] != track->GetClips()[ii]);
+      REQUIRE(first.GetClips()[ii]->IsSameAs(*track->GetClips()[ii]));
+   }
+
+   SECTION("Shares the clips of the earlier copy that did not change")
+   {
+      track->GetClips()[1]->SetName("changed");
+      const auto pSecond = track->DuplicateSharing(&first);
+      const auto& second = Leader(pSecond);
+      REQUIRE(second.GetClips().size() == 2);
+      REQUIRE(second.GetClips()[0] == first.GetClips()[0]);
+      REQUIRE(second.GetClips()[1] != first.GetClips()[1]);
+      REQUIRE(second.GetClips()[1]->IsSameAs(*track->GetClips()[1]));
+      REQUIRE(second.GetClips()[1]->GetName() == "changed");
+
+      // The ledger of the undo manager counts the shared clip once, and the
+      // renamed clip still holds the same block
+      Visitor visitor;
+      second.VisitSpaceUsage(visitor);
+      REQUIRE(visitor.parts == std::vector<const void*> {
+         first.GetClips()[0].get(), second.GetClips()[1].get() });
+      REQUIRE(visitor.units == std::vector<long long> {
+         BlockID(*first.GetClips()[0]), BlockID(*first.GetClips()[1]) });
+   }
+
+   SECTION("Finds a clip that moved in the order")
+   {
+      track->GetClips()[0]->ShiftBy(4);
+      const auto pSecond = track->DuplicateSharing(&first);
+      const auto& second = Leader(pSecond);
+      const auto& clips = second.GetClips();
+      REQUIRE(std::find(clips.begin(), clips.end(), first.GetClips()[1]) !=
+              clips.end());
+      REQUIRE(std::find(clips.begin(), clips.end(), first.GetClips()[0]) ==
+              clips.end());
+   }
+
+   SECTION("Shares nothing with a copy of another track")
+   {
+      const auto other = trackMaker.Track({ MakeClip(.5f, 0) });
+      const auto pOther = other->DuplicateSharing(nullptr);
+      const auto pSecond = track->DuplicateSharing(&Leader(pOther));
+      for (auto& pClip : Leader(pSecond).GetClips())
+         REQUIRE(pClip != Leader(pOther).GetClips()[0]);
+   }
+}
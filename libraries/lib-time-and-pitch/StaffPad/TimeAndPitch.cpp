@@ -9,6 +9,7 @@
 #include "FourierTransform_pffft.h"
 #include "SamplesFloat.h"
 #include "SimdTypes.h"
+#include "VectorOps_avx2.h"
 
 using namespace staffpad::audio;
 
@@ -58,19 +59,25 @@ inline int getFftSize(int sampleRate)
 
 struct TimeAndPitch::impl
 {
-  impl(int fft_size) : fft(fft_size)
+  impl(int fft_size, int num_channels)
+      : fft(fft_size)
+      , inResampleInputBuffer(std::make_unique<CircularSampleBuffer<float>[]>(num_channels))
+      , inCircularBuffer(std::make_unique<CircularSampleBuffer<float>[]>(num_channels))
+      , outCircularBuffer(std::make_unique<CircularSampleBuffer<float>[]>(num_channels))
   {
   }
 
   FourierTransform fft;
-  CircularSampleBuffer<float> inResampleInputBuffer[2];
-  CircularSampleBuffer<float> inCircularBuffer[2];
-  CircularSampleBuffer<float> outCircularBuffer[2];
+  // one per channel
+  std::unique_ptr<CircularSampleBuffer<float>[]> inResampleInputBuffer;
+  std::unique_ptr<CircularSampleBuffer<float>[]> inCircularBuffer;
+  std::unique_ptr<CircularSampleBuffer<float>[]> outCircularBuffer;
   CircularSampleBuffer<float> normalizationBuffer;
 
   SamplesReal fft_timeseries;
   SamplesComplex spectrum;
   SamplesReal norm;
+  SamplesReal channel_norm; // for more than 2 channels
   SamplesReal phase;
   SamplesReal last_phase;
   SamplesReal phase_accum;
@@ -98,10 +105,10 @@ TimeAndPitch::~TimeAndPitch()
 
 void TimeAndPitch::setup(int numChannels, int maxBlockSize)
 {
-  assert(numChannels == 1 || numChannels == 2);
+  assert(numChannels >= 1);
   _numChannels = numChannels;
 
-  d = std::make_unique<impl>(fftSize);
+  d = std::make_unique<impl>(fftSize, _numChannels);
   _maxBlockSize = maxBlockSize;
   _numBins = fftSize / 2 + 1;
 
@@ -120,6 +127,8 @@ void TimeAndPitch::setup(int numChannels, int maxBlockSize)
   // fft coefficient buffers
   d->spectrum.setSize(_numChannels, _numBins);
   d->norm.setSize(1, _numBins);
+  if (_numChannels > 2)
+    d->channel_norm.setSize(1, _numBins);
   d->last_norm.setSize(1, _numBins);
   d->phase.setSize(_numChannels, _numBins);
   d->last_phase.setSize(_numChannels, _numBins);
@@ -224,34 +233,34 @@ void _ms_to_lr(float* ch1, float* ch2, int n)
   });
 }
 
-} // namespace
-
-// ----------------------------------------------------------------------------
-
-template <int num_channels>
-void TimeAndPitch::_time_stretch(float a_a, float a_s)
+/// local maxima of the last norms, each with the lowest bin since the one before
+void _findPeaks(const float* norms, const float* norms_last, int numBins, std::vector<int>& peak_index,
+                std::vector<int>& trough_index)
 {
-  auto alpha = a_s / a_a; // this is the real stretch factor based on integer hop sizes
-
-  // Create a norm array
-  auto* norms = d->norm.getPtr(0); // for stereo, just use the mid-channel
-  const auto* norms_last = d->last_norm.getPtr(0);
+  if (const auto* kernels = vo::getAvx2Kernels())
+  {
+    peak_index.resize(numBins);
+    trough_index.resize(numBins);
+    const auto numPeaks =
+        kernels->findPeaks(norms, norms_last, numBins, peak_index.data(), trough_index.data());
+    peak_index.resize(numPeaks);
+    trough_index.resize(numPeaks);
+    return;
+  }
 
-  d->peak_index.clear();
-  d->trough_index.clear();
   float lowest = norms[0];
   int trough = 0;
   if (norms_last[0] >= norms[1])
   {
-    d->peak_index.emplace_back(0);
-    d->trough_index.emplace_back(0);
+    peak_index.emplace_back(0);
+    trough_index.emplace_back(0);
   }
-  for (int i = 1; i < _numBins - 1; ++i)
+  for (int i = 1; i < numBins - 1; ++i)
   {
     if (norms_last[i] >= norms[i - 1] && norms_last[i] >= norms[i + 1])
     {
-      d->peak_index.emplace_back(i);
-      d->trough_index.emplace_back(trough);
+      peak_index.emplace_back(i);
+      trough_index.emplace_back(trough);
       trough = i;
       lowest = norms[i];
     }
@@ -261,11 +270,31 @@ void TimeAndPitch::_time_stretch(float a_a, float a_s)
       trough = i;
     }
   }
-  if (norms_last[_numBins - 1] > norms[_numBins - 2])
+  if (norms_last[numBins - 1] > norms[numBins - 2])
   {
-    d->peak_index.emplace_back(_numBins - 1);
-    d->trough_index.emplace_back(trough);
+    peak_index.emplace_back(numBins - 1);
+    trough_index.emplace_back(trough);
   }
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+// num_channels is 0 for more than 2 channels, and _numChannels applies
+template <int num_channels>
+void TimeAndPitch::_time_stretch(float a_a, float a_s)
+{
+  const int numChannels = num_channels > 0 ? num_channels : _numChannels;
+  auto alpha = a_s / a_a; // this is the real stretch factor based on integer hop sizes
+
+  // Create a norm array
+  auto* norms = d->norm.getPtr(0); // for stereo, just use the mid-channel
+  const auto* norms_last = d->last_norm.getPtr(0);
+
+  d->peak_index.clear();
+  d->trough_index.clear();
+  _findPeaks(norms, norms_last, _numBins, d->peak_index, d->trough_index);
 
   if (d->peak_index.size() == 0)
   {
@@ -294,14 +323,14 @@ void TimeAndPitch::_time_stretch(float a_a, float a_s)
     float fn_expChange_a = fn * expChange_a;
     float fn_expChange_s = fn * expChange_s;
 
-    for (int ch = 0; ch < num_channels; ++ch)
+    for (int ch = 0; ch < numChannels; ++ch)
       acc[ch][n] = acc[ch][n] + alpha * _unwrapPhase(p[ch][n] - p_l[ch][n] - fn_expChange_a) + fn_expChange_s;
   }
 
   // go from first peak to 0
   for (int n = d->peak_index[0]; n > 0; --n)
   {
-    for (int ch = 0; ch < num_channels; ++ch)
+    for (int ch = 0; ch < numChannels; ++ch)
       acc[ch][n - 1] = acc[ch][n] - alpha * _unwrapPhase(p[ch][n] - p[ch][n - 1]);
   }
 
@@ -311,12 +340,12 @@ void TimeAndPitch::_time_stretch(float a_a, float a_s)
     const int mid = d->trough_index[i + 1];
     for (int n = d->peak_index[i]; n < mid; ++n)
     {
-      for (int ch = 0; ch < num_channels; ++ch)
+      for (int ch = 0; ch < numChannels; ++ch)
         acc[ch][n + 1] = acc[ch][n] + alpha * _unwrapPhase(p[ch][n + 1] - p[ch][n]);
     }
     for (int n = d->peak_index[i + 1]; n > mid + 1; --n)
     {
-      for (int ch = 0; ch < num_channels; ++ch)
+      for (int ch = 0; ch < numChannels; ++ch)
         acc[ch][n - 1] = acc[ch][n] - alpha * _unwrapPhase(p[ch][n] - p[ch][n - 1]);
     }
   }
@@ -324,7 +353,7 @@ void TimeAndPitch::_time_stretch(float a_a, float a_s)
   // last peak to the end
   for (int n = d->peak_index[num_peaks - 1]; n < _numBins - 1; ++n)
   {
-    for (int ch = 0; ch < num_channels; ++ch)
+    for (int ch = 0; ch < numChannels; ++ch)
       acc[ch][n + 1] = acc[ch][n] + alpha * _unwrapPhase(p[ch][n + 1] - p[ch][n]);
   }
 
@@ -349,8 +378,17 @@ void TimeAndPitch::_process_hop(int hop_a, int hop_s)
     // determine norm/phase
     d->fft.forwardReal(d->fft_timeseries, d->spectrum);
     // norms of the mid channel only (or sole channel) are needed in
-    // _time_stretch
+    // _time_stretch. With more channels, all share the peaks of the sum of
+    // their norms, which keeps their phases linked.
     vo::calcNorms(d->spectrum.getPtr(0), d->norm.getPtr(0), d->spectrum.getNumSamples());
+    if (_numChannels > 2)
+    {
+      for (int ch = 1; ch < _numChannels; ++ch)
+      {
+        vo::calcNorms(d->spectrum.getPtr(ch), d->channel_norm.getPtr(0), d->spectrum.getNumSamples());
+        vo::add(d->norm.getPtr(0), d->channel_norm.getPtr(0), d->norm.getPtr(0), _numBins);
+      }
+    }
     for (int ch = 0; ch < _numChannels; ++ch)
       vo::calcPhases(d->spectrum.getPtr(ch), d->phase.getPtr(ch), d->spectrum.getNumSamples());
 
@@ -358,6 +396,8 @@ void TimeAndPitch::_process_hop(int hop_a, int hop_s)
       _time_stretch<1>((float)hop_a, (float)hop_s);
     else if (_numChannels == 2)
       _time_stretch<2>((float)hop_a, (float)hop_s);
+    else
+      _time_stretch<0>((float)hop_a, (float)hop_s);
 
     for (int ch = 0; ch < _numChannels; ++ch)
       _unwrapPhaseVec(d->phase_accum.getPtr(ch), _numBins);
@@ -16,7 +16,8 @@ public:
 
   /**
     Setup at least once before processing.
-    \param numChannels  Must be 1 or 2
+    \param numChannels  Any number. Stereo is processed as mid/side; other
+                        layouts share the phase locking of the summed spectrum
     \param maxBlockSize The caller's maximum block size, e.g. 1024 samples
   */
   void setup(int numChannels, int maxBlockSize);
@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: zlib */
+/*
+ * Run time choice of the AVX2 kernels of VectorOps_avx2.cpp. This file is
+ * compiled for the baseline CPU, as it runs on all of them.
+ */
+
+#include "VectorOps_avx2.h"
+
+#include <atomic>
+
+#if defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+namespace staffpad {
+namespace vo {
+
+namespace {
+
+bool cpuHasAvx2AndFma()
+{
+#if defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_X64))
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  const bool fma = (info[2] & (1 << 12)) != 0;
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  // The OS must save the AVX registers
+  if (!fma || !osxsave || (_xgetbv(0) & 6) != 6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+  return false;
+#endif
+}
+
+// Ask the CPU only if the build has the kernels
+const Kernels* const avx2Kernels = getAvx2KernelTable() && cpuHasAvx2AndFma() ? getAvx2KernelTable() : nullptr;
+std::atomic<bool> avx2Enabled{true};
+
+} // namespace
+
+const Kernels* getAvx2Kernels()
+{
+  return avx2Enabled.load(std::memory_order_relaxed) ? avx2Kernels : nullptr;
+}
+
+void setAvx2KernelsEnabled(bool enabled)
+{
+  avx2Enabled = enabled;
+}
+
+} // namespace vo
+} // namespace staffpad
@@ -23,6 +23,8 @@
 #   include "SimdComplexConversions_sse2.h"
 #endif
 
+#include "VectorOps_avx2.h"
+
 namespace staffpad {
 namespace vo {
 
@@ -103,6 +105,8 @@ inline void findMaxElement(const T* src, int32_t n, int32_t& maxIndex, T& maxVal
 
 inline void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
 {
+  if (const auto* kernels = getAvx2Kernels())
+    return kernels->calcPhases(reinterpret_cast<const float*>(src), dst, n);
   simd_complex_conversions::perform_parallel_simd_aligned(
      src, dst, n,
      [](const __m128 rp, const __m128 ip, __m128& out)
@@ -111,6 +115,8 @@ inline void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
 
 inline void calcNorms(const std::complex<float>* src, float* dst, int32_t n)
 {
+  if (const auto* kernels = getAvx2Kernels())
+    return kernels->calcNorms(reinterpret_cast<const float*>(src), dst, n);
   simd_complex_conversions::perform_parallel_simd_aligned(
      src, dst, n,
      [](const __m128 rp, const __m128 ip, __m128& out)
@@ -121,24 +127,32 @@ inline void rotate(
    const float* oldPhase, const float* newPhase, std::complex<float>* dst,
    int32_t n)
 {
+  if (const auto* kernels = getAvx2Kernels())
+    return kernels->rotate(oldPhase, newPhase, reinterpret_cast<float*>(dst), n);
   simd_complex_conversions::rotate_parallel_simd_aligned(
      oldPhase, newPhase, dst, n);
 }
 #else
 inline void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
 {
+  if (const auto* kernels = getAvx2Kernels())
+    return kernels->calcPhases(reinterpret_cast<const float*>(src), dst, n);
   for (int32_t i = 0; i < n; i++)
     dst[i] = std::arg(src[i]);
 }
 
 inline void calcNorms(const std::complex<float>* src, float* dst, int32_t n)
 {
+  if (const auto* kernels = getAvx2Kernels())
+    return kernels->calcNorms(reinterpret_cast<const float*>(src), dst, n);
   for (int32_t i = 0; i < n; i++)
     dst[i] = std::norm(src[i]);
 }
 
 inline void rotate(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
 {
+  if (const auto* kernels = getAvx2Kernels())
+    return kernels->rotate(oldPhase, newPhase, reinterpret_cast<float*>(dst), n);
   for (int32_t i = 0; i < n; i++) {
     auto theta = newPhase[i] - oldPhase[i];
     dst[i] *= std::complex<float>(cosf(theta), sinf(theta));
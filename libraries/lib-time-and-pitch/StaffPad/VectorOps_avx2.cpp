@@ -0,0 +1,338 @@
+/* SPDX-License-Identifier: zlib */
+/*
+ * AVX2/FMA port of the atan2 and sincos approximations of
+ * SimdComplexConversions_sse2.h, and the vector operations of TimeAndPitch
+ * built on them. This file is compiled with AVX2 and FMA code generation
+ * where the compiler allows it; nothing here runs unless the CPU has both.
+ *
+ * Use no library templates or inline functions here, not even in the scalar
+ * tails: their instantiations, compiled for AVX2, could be the ones the linker
+ * keeps for the whole program. Detection of the CPU is in VectorOps.cpp.
+ */
+
+#include "VectorOps_avx2.h"
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#define STAFFPAD_AVX2_KERNELS 1
+#endif
+
+#if STAFFPAD_AVX2_KERNELS
+
+#include <immintrin.h>
+
+#include <math.h>
+
+namespace staffpad {
+namespace vo {
+
+namespace {
+
+constexpr float PIF = 3.141592653589793238f;
+constexpr float PIO2F = 1.5707963267948966192f;
+constexpr float PIO4F = 0.7853981633974483096f;
+constexpr float FOPI = 1.27323954473516f; // 4 / M_PI
+constexpr float minus_DP1 = -0.78515625f;
+constexpr float minus_DP2 = -2.4187564849853515625e-4f;
+constexpr float minus_DP3 = -3.77489497744594108e-8f;
+constexpr float sincof_p0 = -1.9515295891e-4f;
+constexpr float sincof_p1 = 8.3321608736e-3f;
+constexpr float sincof_p2 = -1.6666654611e-1f;
+constexpr float coscof_p0 = 2.443315711809948e-005f;
+constexpr float coscof_p1 = -1.388731625493765e-003f;
+constexpr float coscof_p2 = 4.166664568298827e-002f;
+constexpr float atancof_p0 = 8.05374449538e-2f;
+constexpr float atancof_p1 = 1.38776856032e-1f;
+constexpr float atancof_p2 = 1.99777106478e-1f;
+constexpr float atancof_p3 = 3.33329491539e-1f;
+
+inline __m256 sign_mask()
+{
+  return _mm256_castsi256_ps(_mm256_set1_epi32(int(0x80000000u)));
+}
+
+inline __m256 inv_sign_mask()
+{
+  return _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+}
+
+inline __m256 atan_ps(__m256 x)
+{
+  const __m256 sign_bit = _mm256_and_ps(x, sign_mask());
+  x = _mm256_and_ps(x, inv_sign_mask());
+
+  // range reduction, init x and y depending on range
+  const __m256 cmp0 = _mm256_cmp_ps(x, _mm256_set1_ps(2.414213562373095f), _CMP_GT_OQ);
+  const __m256 cmp1 = _mm256_cmp_ps(x, _mm256_set1_ps(0.4142135623730950f), _CMP_GT_OQ);
+  const __m256 cmp2 = _mm256_andnot_ps(cmp0, cmp1);
+
+  // -(1.0/x)
+  const __m256 y0 = _mm256_and_ps(cmp0, _mm256_set1_ps(PIO2F));
+  __m256 x0 = _mm256_div_ps(_mm256_set1_ps(1.0f), x);
+  x0 = _mm256_xor_ps(x0, sign_mask());
+
+  // (x-1.0)/(x+1.0)
+  const __m256 y1 = _mm256_and_ps(cmp2, _mm256_set1_ps(PIO4F));
+  const __m256 x1 = _mm256_div_ps(_mm256_sub_ps(x, _mm256_set1_ps(1.0f)), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+
+  x = _mm256_blendv_ps(x, x1, cmp2);
+  x = _mm256_blendv_ps(x, x0, cmp0);
+  __m256 y = _mm256_or_ps(y0, y1);
+
+  const __m256 zz = _mm256_mul_ps(x, x);
+  __m256 acc = _mm256_fmsub_ps(_mm256_set1_ps(atancof_p0), zz, _mm256_set1_ps(atancof_p1));
+  acc = _mm256_fmadd_ps(acc, zz, _mm256_set1_ps(atancof_p2));
+  acc = _mm256_fmsub_ps(acc, zz, _mm256_set1_ps(atancof_p3));
+  acc = _mm256_mul_ps(acc, zz);
+  acc = _mm256_fmadd_ps(acc, x, x);
+  y = _mm256_add_ps(y, acc);
+
+  // update the sign
+  return _mm256_xor_ps(y, sign_bit);
+}
+
+inline __m256 atan2_ps(__m256 y, __m256 x)
+{
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 x_eq_0 = _mm256_cmp_ps(x, zero, _CMP_EQ_OQ);
+  const __m256 x_gt_0 = _mm256_cmp_ps(x, zero, _CMP_GT_OQ);
+  const __m256 y_eq_0 = _mm256_cmp_ps(y, zero, _CMP_EQ_OQ);
+  const __m256 x_lt_0 = _mm256_cmp_ps(x, zero, _CMP_LT_OQ);
+  const __m256 y_lt_0 = _mm256_cmp_ps(y, zero, _CMP_LT_OQ);
+
+  const __m256 zero_mask = _mm256_or_ps(_mm256_and_ps(x_eq_0, y_eq_0), _mm256_and_ps(y_eq_0, x_gt_0));
+
+  const __m256 pio2_mask = _mm256_andnot_ps(y_eq_0, x_eq_0);
+  const __m256 pio2_sign = _mm256_and_ps(y_lt_0, sign_mask());
+  const __m256 pio2_result = _mm256_and_ps(pio2_mask, _mm256_xor_ps(_mm256_set1_ps(PIO2F), pio2_sign));
+
+  const __m256 pi_result = _mm256_and_ps(_mm256_and_ps(y_eq_0, x_lt_0), _mm256_set1_ps(PIF));
+
+  const __m256 offset_sign = _mm256_and_ps(_mm256_and_ps(x_lt_0, y_lt_0), sign_mask());
+  const __m256 offset = _mm256_and_ps(x_lt_0, _mm256_xor_ps(_mm256_set1_ps(PIF), offset_sign));
+
+  __m256 atan_result = _mm256_add_ps(atan_ps(_mm256_div_ps(y, x)), offset);
+
+  // select between zero_result, pio2_result and atan_result
+  __m256 result = _mm256_andnot_ps(zero_mask, pio2_result);
+  atan_result = _mm256_andnot_ps(zero_mask, atan_result);
+  atan_result = _mm256_andnot_ps(pio2_mask, atan_result);
+  result = _mm256_or_ps(result, atan_result);
+  return _mm256_or_ps(result, pi_result);
+}
+
+inline void sincos_ps(__m256 x, __m256& s, __m256& c)
+{
+  __m256 sign_bit_sin = _mm256_and_ps(x, sign_mask());
+  x = _mm256_and_ps(x, inv_sign_mask());
+
+  // scale by 4/Pi, and j=(j+1) & (~1) (see the cephes sources)
+  __m256i emm2 = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(FOPI)));
+  emm2 = _mm256_add_epi32(emm2, _mm256_set1_epi32(1));
+  emm2 = _mm256_and_si256(emm2, _mm256_set1_epi32(~1));
+  __m256 y = _mm256_cvtepi32_ps(emm2);
+
+  // the swap sign flag for the sine, and the polynom selection mask
+  const __m256 swap_sign_bit_sin =
+      _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(emm2, _mm256_set1_epi32(4)), 29));
+  const __m256 poly_mask = _mm256_castsi256_ps(
+      _mm256_cmpeq_epi32(_mm256_and_si256(emm2, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+
+  // Extended precision modular arithmetic
+  x = _mm256_fmadd_ps(y, _mm256_set1_ps(minus_DP1), x);
+  x = _mm256_fmadd_ps(y, _mm256_set1_ps(minus_DP2), x);
+  x = _mm256_fmadd_ps(y, _mm256_set1_ps(minus_DP3), x);
+
+  __m256i emm4 = _mm256_sub_epi32(emm2, _mm256_set1_epi32(2));
+  emm4 = _mm256_andnot_si256(emm4, _mm256_set1_epi32(4));
+  const __m256 sign_bit_cos = _mm256_castsi256_ps(_mm256_slli_epi32(emm4, 29));
+
+  sign_bit_sin = _mm256_xor_ps(sign_bit_sin, swap_sign_bit_sin);
+
+  // the first polynom (0 <= x <= Pi/4)
+  const __m256 z = _mm256_mul_ps(x, x);
+  y = _mm256_fmadd_ps(_mm256_set1_ps(coscof_p0), z, _mm256_set1_ps(coscof_p1));
+  y = _mm256_fmadd_ps(y, z, _mm256_set1_ps(coscof_p2));
+  y = _mm256_mul_ps(y, z);
+  y = _mm256_mul_ps(y, z);
+  y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+  y = _mm256_add_ps(y, _mm256_set1_ps(1.f));
+
+  // the second polynom (Pi/4 <= x <= 0)
+  __m256 y2 = _mm256_fmadd_ps(_mm256_set1_ps(sincof_p0), z, _mm256_set1_ps(sincof_p1));
+  y2 = _mm256_fmadd_ps(y2, z, _mm256_set1_ps(sincof_p2));
+  y2 = _mm256_mul_ps(y2, z);
+  y2 = _mm256_fmadd_ps(y2, x, x);
+
+  // select the correct result from the two polynoms
+  const __m256 ysin = _mm256_blendv_ps(y, y2, poly_mask);
+  const __m256 ycos = _mm256_blendv_ps(y2, y, poly_mask);
+
+  s = _mm256_xor_ps(ysin, sign_bit_sin);
+  c = _mm256_xor_ps(ycos, sign_bit_cos);
+}
+
+/// 8 complex numbers, interleaved, to real and imaginary parts in order
+inline void load_complex(const float* p, __m256& re, __m256& im)
+{
+  const __m256 p1 = _mm256_loadu_ps(p);
+  const __m256 p2 = _mm256_loadu_ps(p + 8);
+  // shuffles work within 128-bit lanes, which the permutes undo
+  re = _mm256_castpd_ps(_mm256_permute4x64_pd(
+      _mm256_castps_pd(_mm256_shuffle_ps(p1, p2, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+  im = _mm256_castpd_ps(_mm256_permute4x64_pd(
+      _mm256_castps_pd(_mm256_shuffle_ps(p1, p2, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+inline void store_complex(__m256 re, __m256 im, float* p)
+{
+  const __m256 lo = _mm256_unpacklo_ps(re, im);
+  const __m256 hi = _mm256_unpackhi_ps(re, im);
+  _mm256_storeu_ps(p, _mm256_permute2f128_ps(lo, hi, 0x20));
+  _mm256_storeu_ps(p + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+}
+
+void calcPhases(const float* src, float* dst, int32_t n)
+{
+  int32_t i = 0;
+  for (; i <= n - 8; i += 8)
+  {
+    __m256 re, im;
+    load_complex(src + 2 * i, re, im);
+    _mm256_storeu_ps(dst + i, atan2_ps(im, re));
+  }
+  for (; i < n; ++i)
+    dst[i] = atan2f(src[2 * i + 1], src[2 * i]);
+}
+
+void calcNorms(const float* src, float* dst, int32_t n)
+{
+  int32_t i = 0;
+  for (; i <= n - 8; i += 8)
+  {
+    __m256 re, im;
+    load_complex(src + 2 * i, re, im);
+    _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(re, re, _mm256_mul_ps(im, im)));
+  }
+  for (; i < n; ++i)
+    dst[i] = src[2 * i] * src[2 * i] + src[2 * i + 1] * src[2 * i + 1];
+}
+
+void rotate(const float* oldPhase, const float* newPhase, float* dst, int32_t n)
+{
+  int32_t i = 0;
+  for (; i <= n - 8; i += 8)
+  {
+    __m256 s, c;
+    sincos_ps(_mm256_sub_ps(_mm256_loadu_ps(newPhase + i), _mm256_loadu_ps(oldPhase + i)), s, c);
+    __m256 re, im;
+    load_complex(dst + 2 * i, re, im);
+    // (re, im) * (cos, sin) -> (re*cos - im*sin, re*sin + im*cos)
+    const __m256 out_re = _mm256_fmsub_ps(re, c, _mm256_mul_ps(im, s));
+    const __m256 out_im = _mm256_fmadd_ps(re, s, _mm256_mul_ps(im, c));
+    store_complex(out_re, out_im, dst + 2 * i);
+  }
+  for (; i < n; ++i)
+  {
+    const float theta = newPhase[i] - oldPhase[i];
+    const float c = cosf(theta);
+    const float s = sinf(theta);
+    const float re = dst[2 * i];
+    const float im = dst[2 * i + 1];
+    dst[2 * i] = re * c - im * s;
+    dst[2 * i + 1] = re * s + im * c;
+  }
+}
+
+int32_t findPeaks(const float* norms, const float* lastNorms, int32_t n, int* peaks, int* troughs)
+{
+  int32_t count = 0;
+  float lowest = norms[0];
+  int trough = 0;
+  if (lastNorms[0] >= norms[1])
+  {
+    peaks[count] = 0;
+    troughs[count++] = 0;
+  }
+  const auto scalar = [&](int i, bool isPeak) {
+    if (isPeak)
+    {
+      peaks[count] = i;
+      troughs[count++] = trough;
+      trough = i;
+      lowest = norms[i];
+    }
+    else if (norms[i] < lowest)
+    {
+      lowest = norms[i];
+      trough = i;
+    }
+  };
+
+  int i = 1;
+  for (; i + 8 <= n - 1; i += 8)
+  {
+    const __m256 last = _mm256_loadu_ps(lastNorms + i);
+    const __m256 norm = _mm256_loadu_ps(norms + i);
+    const int mask = _mm256_movemask_ps(
+        _mm256_and_ps(_mm256_cmp_ps(last, _mm256_loadu_ps(norms + i - 1), _CMP_GE_OQ),
+                      _mm256_cmp_ps(last, _mm256_loadu_ps(norms + i + 1), _CMP_GE_OQ)));
+    if (mask == 0)
+    {
+      // No peak: only the first of the lowest bins can become the trough
+      __m256 m = _mm256_min_ps(norm, _mm256_permute_ps(norm, _MM_SHUFFLE(2, 3, 0, 1)));
+      m = _mm256_min_ps(m, _mm256_permute_ps(m, _MM_SHUFFLE(1, 0, 3, 2)));
+      m = _mm256_min_ps(m, _mm256_permute2f128_ps(m, m, 0x01));
+      const float chunkLowest = _mm256_cvtss_f32(m);
+      if (chunkLowest < lowest)
+      {
+        const int at = _mm256_movemask_ps(_mm256_cmp_ps(norm, m, _CMP_EQ_OQ));
+        int j = 0;
+        while (!(at & (1 << j)))
+          ++j;
+        lowest = chunkLowest;
+        trough = i + j;
+      }
+    }
+    else
+    {
+      for (int j = 0; j < 8; ++j)
+        scalar(i + j, (mask & (1 << j)) != 0);
+    }
+  }
+  for (; i < n - 1; ++i)
+    scalar(i, lastNorms[i] >= norms[i - 1] && lastNorms[i] >= norms[i + 1]);
+
+  if (lastNorms[n - 1] > norms[n - 2])
+  {
+    peaks[count] = n - 1;
+    troughs[count++] = trough;
+  }
+  return count;
+}
+
+const Kernels avx2Kernels{&calcPhases, &calcNorms, &rotate, &findPeaks};
+
+} // namespace
+
+const Kernels* getAvx2KernelTable()
+{
+  return &avx2Kernels;
+}
+
+} // namespace vo
+} // namespace staffpad
+
+#else
+
+namespace staffpad {
+namespace vo {
+
+const Kernels* getAvx2KernelTable()
+{
+  return nullptr;
+}
+
+} // namespace vo
+} // namespace staffpad
+
+#endif
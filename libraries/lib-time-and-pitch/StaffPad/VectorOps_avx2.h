@@ -0,0 +1,42 @@
+/*
+  AVX2/FMA versions of the vector operations that dominate TimeAndPitch,
+  compiled separately and chosen at run time, for the CPUs that have them.
+
+  Only raw pointers cross this interface: inline library templates
+  instantiated in the AVX2 file could be linked in place of the ordinary
+  ones, and then run on CPUs without AVX2.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace staffpad {
+namespace vo {
+
+struct Kernels
+{
+  /// Complex numbers are interleaved real and imaginary parts, as in arrays
+  /// of std::complex<float>
+  void (*calcPhases)(const float* src, float* dst, int32_t n);
+  void (*calcNorms)(const float* src, float* dst, int32_t n);
+  void (*rotate)(const float* oldPhase, const float* newPhase, float* dst, int32_t n);
+
+  /// local maxima of `lastNorms` against their neighbours in `norms`, each with
+  /// the lowest bin of `norms` since the peak before. Buffers must have room
+  /// for n elements. Returns the number of peaks.
+  int32_t (*findPeaks)(const float* norms, const float* lastNorms, int32_t n, int* peaks, int* troughs);
+};
+
+/// nullptr if the build lacks AVX2 and FMA, whatever the CPU. Defined in the
+/// AVX2 file, but runs no vector instructions.
+const Kernels* getAvx2KernelTable();
+
+/// nullptr if the build or the CPU lacks AVX2 and FMA, or if disabled
+const Kernels* getAvx2Kernels();
+
+/// AVX2 kernels are used when available, unless disabled here, e.g. to compare
+void setAvx2KernelsEnabled(bool enabled);
+
+} // namespace vo
+} // namespace staffpad
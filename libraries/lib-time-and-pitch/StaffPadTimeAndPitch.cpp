@@ -1,4 +1,5 @@
 #include "StaffPadTimeAndPitch.h"
+#include "StaffPad/VectorOps_avx2.h"
 
 #include <algorithm>
 #include <cassert>
@@ -43,6 +44,7 @@ StaffPadTimeAndPitch::StaffPadTimeAndPitch(
     : mAudioSource(audioSource)
     , mReadBuffer(maxBlockSize, numChannels)
     , mNumChannels(numChannels)
+    , mOffsetBuffers(numChannels)
     , mTimeRatio(parameters.timeRatio.value_or(1.))
     , mTimeAndPitch(
          MaybeCreateTimeAndPitch(sampleRate, numChannels, parameters))
@@ -79,17 +81,25 @@ void StaffPadTimeAndPitch::GetSamples(float* const* output, size_t outputLen)
          const auto numSamplesToGet =
             std::min({ maxBlockSize, numOutputSamplesAvailable,
                        static_cast<int>(outputLen - numOutputSamples) });
-         // More-than-stereo isn't supported
-         assert(mNumChannels <= 2);
-         float *buffer[2]{};
-         GetOffsetBuffer(buffer, output, mNumChannels, numOutputSamples);
-         mTimeAndPitch->retrieveAudio(buffer, numSamplesToGet);
+         GetOffsetBuffer(
+            mOffsetBuffers.data(), output, mNumChannels, numOutputSamples);
+         mTimeAndPitch->retrieveAudio(mOffsetBuffers.data(), numSamplesToGet);
          numOutputSamplesAvailable -= numSamplesToGet;
          numOutputSamples += numSamplesToGet;
       }
    }
 }
 
+bool StaffPadTimeAndPitch::UsesAvx2Kernels()
+{
+   return staffpad::vo::getAvx2Kernels() != nullptr;
+}
+
+void StaffPadTimeAndPitch::SetAvx2KernelsEnabled(bool enabled)
+{
+   staffpad::vo::setAvx2KernelsEnabled(enabled);
+}
+
 void StaffPadTimeAndPitch::BootStretcher()
 {
    if (!mTimeAndPitch)
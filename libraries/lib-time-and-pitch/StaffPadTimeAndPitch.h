@@ -4,6 +4,8 @@
 
 #include "StaffPad/TimeAndPitch.h"
 
+#include <vector>
+
 class TIME_AND_PITCH_API StaffPadTimeAndPitch final :
     public TimeAndPitchInterface
 {
@@ -13,11 +15,17 @@ public:
       const Parameters&);
    void GetSamples(float* const*, size_t) override;
 
+   //! Whether AVX2/FMA kernels are in use, as chosen at run time for the CPU
+   static bool UsesAvx2Kernels();
+   //! The baseline kernels are used instead when disabled, e.g. to compare
+   static void SetAvx2KernelsEnabled(bool enabled);
+
 private:
    void BootStretcher();
    const std::unique_ptr<staffpad::TimeAndPitch> mTimeAndPitch;
    TimeAndPitchSource& mAudioSource;
    AudioContainer mReadBuffer;
    const size_t mNumChannels;
+   std::vector<float*> mOffsetBuffers;
    const double mTimeRatio;
 };
@@ -16,9 +16,63 @@
 
 #include <catch2/catch.hpp>
 
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
 using namespace std::literals::string_literals;
 using namespace std::literals::chrono_literals;
 
+namespace
+{
+//! Chords in noise, so that there are peaks and troughs to find
+std::vector<float> MakeAudio(size_t numFrames, unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::uniform_real_distribution<float> distribution { -.05f, .05f };
+   std::vector<float> result(numFrames);
+   for (size_t i = 0; i < numFrames; ++i)
+   {
+      const auto t = i / 44100.;
+      result[i] = .3 * std::sin(2 * M_PI * 220 * t) +
+                  .2 * std::sin(2 * M_PI * 277.18 * t) +
+                  .1 * std::sin(2 * M_PI * 329.63 * t) +
+                  distribution(engine);
+   }
+   return result;
+}
+
+std::vector<std::vector<float>> Stretch(
+   const std::vector<std::vector<float>>& input, double timeRatio,
+   size_t numOutputFrames)
+{
+   AudioContainer container(numOutputFrames, input.size());
+   TimeAndPitchInterface::Parameters params;
+   params.timeRatio = timeRatio;
+   TimeAndPitchRealSource src(input);
+   StaffPadTimeAndPitch sut(44100, input.size(), src, std::move(params));
+   constexpr size_t blockSize = 1024u;
+   for (size_t offset = 0; offset < numOutputFrames; offset += blockSize)
+   {
+      std::vector<float*> offsetBuffers(input.size());
+      for (auto i = 0u; i < input.size(); ++i)
+         offsetBuffers[i] = container.channelPointers[i] + offset;
+      sut.GetSamples(
+         offsetBuffers.data(), std::min(blockSize, numOutputFrames - offset));
+   }
+   return container.channelVectors;
+}
+
+double Rms(const std::vector<float>& samples)
+{
+   double sum = 0;
+   for (const auto sample : samples)
+      sum += sample * sample;
+   return std::sqrt(sum / samples.size());
+}
+} // namespace
+
 TEST_CASE("StaffPadTimeAndPitch")
 {
    SECTION("Smoke test")
@@ -133,3 +187,97 @@ TEST_CASE("StaffPadTimeAndPitch")
          requestedNumSamples); // This is just not supposed to hang.
    }
 }
+
+TEST_CASE("StaffPadTimeAndPitch with more than two channels")
+{
+   constexpr auto numFrames = 44100u;
+   constexpr auto timeRatio = 1.5;
+   constexpr auto numOutputFrames = static_cast<size_t>(numFrames * timeRatio);
+
+   SECTION("Channels share their phase locking")
+   {
+      // Six copies of a channel come out as that channel alone does: peaks of
+      // the summed spectrum are those of each channel
+      const std::vector<std::vector<float>> mono { MakeAudio(numFrames, 1) };
+      const auto expected = Stretch(mono, timeRatio, numOutputFrames)[0];
+      const std::vector<std::vector<float>> surround(6, mono[0]);
+      const auto output = Stretch(surround, timeRatio, numOutputFrames);
+      REQUIRE(output.size() == 6u);
+      for (const auto& channel : output)
+         REQUIRE(channel == expected);
+   }
+
+   SECTION("Channels keep their own content")
+   {
+      std::vector<std::vector<float>> surround;
+      for (auto i = 0u; i < 8; ++i)
+      {
+         surround.push_back(MakeAudio(numFrames, i));
+         // Each at its own level
+         for (auto& sample : surround.back())
+            sample *= (i + 1) / 8.f;
+      }
+      const auto output = Stretch(surround, timeRatio, numOutputFrames);
+      for (auto i = 0u; i < 8; ++i)
+         REQUIRE(
+            Rms(output[i]) == Approx(Rms(surround[i])).epsilon(0.1));
+   }
+}
+
+TEST_CASE("StaffPadTimeAndPitch AVX2 kernels")
+{
+   if (!StaffPadTimeAndPitch::UsesAvx2Kernels())
+      return;
+
+   // Kernels differ in rounding and approximations, not in their peaks
+   const std::vector<std::vector<float>> input { MakeAudio(44100, 1),
+                                                 MakeAudio(44100, 2) };
+   for (const auto timeRatio : { .5, 1.5 })
+   {
+      const auto numOutputFrames = static_cast<size_t>(44100 * timeRatio);
+      const auto actual = Stretch(input, timeRatio, numOutputFrames);
+      StaffPadTimeAndPitch::SetAvx2KernelsEnabled(false);
+      const auto expected = Stretch(input, timeRatio, numOutputFrames);
+      StaffPadTimeAndPitch::SetAvx2KernelsEnabled(true);
+      for (auto ch = 0u; ch < input.size(); ++ch)
+      {
+         std::vector<float> difference(numOutputFrames);
+         for (size_t i = 0; i < numOutputFrames; ++i)
+            difference[i] = actual[ch][i] - expected[ch][i];
+         REQUIRE(Rms(difference) < 1e-3 * Rms(expected[ch]));
+      }
+   }
+}
+
+// Hidden by default; run with the tag to see throughput
+TEST_CASE("StaffPadTimeAndPitch benchmark", "[.benchmark]")
+{
+   constexpr auto numFrames = 10 * 44100u;
+   for (const auto numChannels : { 1u, 2u, 6u })
+   {
+      std::vector<std::vector<float>> input;
+      for (auto i = 0u; i < numChannels; ++i)
+         input.push_back(MakeAudio(numFrames, i));
+      const auto time = [&] {
+         const auto start = std::chrono::steady_clock::now();
+         Stretch(input, 1.5, static_cast<size_t>(numFrames * 1.5));
+         return std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+      };
+      const auto avx2 = StaffPadTimeAndPitch::UsesAvx2Kernels();
+      StaffPadTimeAndPitch::SetAvx2KernelsEnabled(false);
+      const auto baseline = time();
+      StaffPadTimeAndPitch::SetAvx2KernelsEnabled(true);
+      // Seconds of audio per second of processing
+      std::cout << numChannels << " channels, baseline: "
+                << numFrames / 44100. / baseline << "x realtime";
+      if (avx2)
+      {
+         const auto optimized = time();
+         std::cout << ", AVX2: " << numFrames / 44100. / optimized
+                   << "x realtime, speedup: " << baseline / optimized;
+      }
+      std::cout << "\n";
+   }
+}
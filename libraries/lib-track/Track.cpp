@@ -95,8 +95,27 @@ TrackListHolder Track::Duplicate() const
    assert(IsLeader());
    // invoke "virtual constructor" to copy track object proper:
    auto result = Clone();
+   CopyAttachments(*result);
+   return result;
+}
+
+TrackListHolder Track::DuplicateSharing(const Track *pPrevious) const
+{
+   assert(IsLeader());
+   assert(!pPrevious || pPrevious->IsLeader());
+   auto result = CloneSharing(pPrevious);
+   CopyAttachments(*result);
+   return result;
+}
 
-   auto iter = TrackList::Channels(*result->begin()).begin();
+TrackListHolder Track::CloneSharing(const Track *) const
+{
+   return Clone();
+}
+
+void Track::CopyAttachments(TrackList &copy) const
+{
+   auto iter = TrackList::Channels(*copy.begin()).begin();
    const auto copyOne = [&](const Track *pChannel){
       pChannel->AttachedTrackObjects::ForEach([&](auto &attachment){
          // Copy view state that might be important to undo/redo
@@ -110,8 +129,10 @@ TrackListHolder Track::Duplicate() const
          copyOne(pChannel);
    else
       copyOne(this);
+}
 
-   return result;
+void Track::VisitSpaceUsage(UndoSpaceUsageVisitor &) const
+{
 }
 
 Track::~Track()
@@ -1394,23 +1415,69 @@ struct TrackListRestorer final : UndoStateExtension {
    TrackListRestorer(AudacityProject &project)
       : mpTracks{ TrackList::Create(nullptr) }
    {
+      // Share what did not change with the state the project was in
+      const auto pPrevious = FindCurrent(project);
       for (auto pTrack : TrackList::Get(project)) {
-         if (pTrack->GetId() == TrackId{})
+         const auto id = pTrack->GetId();
+         if (id == TrackId{})
             // Don't copy a pending added track
             continue;
-         mpTracks->Append(std::move(*pTrack->Duplicate()));
+         const auto pCopy = pTrack->DuplicateSharing(
+            pPrevious ? pPrevious->FindCopy(id) : nullptr);
+         mpTracks->Append(std::move(*pCopy));
+         mIds.push_back(id);
       }
    }
    void RestoreUndoRedoState(AudacityProject &project) override {
       auto &dstTracks = TrackList::Get(project);
       dstTracks.Clear();
-      for (auto pTrack : *mpTracks)
-         dstTracks.Append(std::move(*pTrack->Duplicate()));
+      mIds.clear();
+      for (auto pTrack : *mpTracks) {
+         const auto pCopy = pTrack->Duplicate();
+         const auto pLeader = *pCopy->begin();
+         dstTracks.Append(std::move(*pCopy));
+         // The project's tracks get new ids; remember them, for sharing
+         // with a state pushed next
+         mIds.push_back(pLeader->GetId());
+      }
    }
    bool CanUndoOrRedo(const AudacityProject &project) override {
       return !TrackList::Get(project).HasPendingTracks();
    }
+   void VisitSpaceUsage(UndoSpaceUsageVisitor &visitor) const override {
+      for (auto pTrack : *mpTracks)
+         pTrack->VisitSpaceUsage(visitor);
+   }
+
+   static TrackListRestorer *FindCurrent(AudacityProject &project)
+   {
+      auto &manager = UndoManager::Get(project);
+      const auto current = manager.GetCurrentState();
+      if (current >= manager.GetNumStates())
+         return nullptr;
+      TrackListRestorer *result{};
+      manager.VisitStates([&](const UndoStackElem &elem){
+         for (auto &pExt : elem.state.extensions)
+            if (auto pRestorer = dynamic_cast<TrackListRestorer*>(pExt.get()))
+               result = pRestorer;
+      }, current, current + 1);
+      return result;
+   }
+
+   //! @return the copy of the project track with the given id, or null
+   const Track *FindCopy(TrackId id) const
+   {
+      auto iter = mIds.begin();
+      for (auto pTrack : *mpTracks)
+         if (*iter++ == id)
+            return pTrack;
+      return nullptr;
+   }
+
    const std::shared_ptr<TrackList> mpTracks;
+   //! Ids of the project's tracks that were copied, or that were restored,
+   //! corresponding to leaders of mpTracks
+   std::vector<TrackId> mIds;
 };
 
 UndoRedoExtensionRegistry::Entry sEntry {
@@ -42,6 +42,7 @@ using TrackArray = std::vector< Track* >;
 class TrackList;
 using TrackListHolder = std::shared_ptr<TrackList>;
 struct UndoStackElem;
+class UndoSpaceUsageVisitor;
 
 using ListOfTracks = std::list< std::shared_ptr< Track > >;
 
@@ -304,6 +305,25 @@ private:
     */
    virtual TrackListHolder Duplicate() const;
 
+   //! Like Duplicate(), but the copy may share data with an earlier copy
+   /*!
+    For undo history, so that successive states share what did not change.
+    Shared data are immutable:  neither copy may be modified afterward.
+    @param pPrevious null, or an earlier copy of this track, made by
+    Duplicate() or DuplicateSharing()
+    @pre `IsLeader()`
+    @pre `!pPrevious || pPrevious->IsLeader()`
+    @post result: `NChannels() == result->NChannels()`
+    */
+   TrackListHolder DuplicateSharing(const Track *pPrevious) const;
+
+   //! Report storage held by the track, when it is in undo history
+   /*!
+    Default reports nothing
+    @pre `IsLeader()`
+    */
+   virtual void VisitSpaceUsage(UndoSpaceUsageVisitor &visitor) const;
+
    //! Name is always the same for all channels of a group
    const wxString &GetName() const;
    void SetName( const wxString &n );
@@ -404,6 +424,12 @@ private:
     */
    virtual TrackListHolder Clone() const = 0;
 
+   //! Like Clone(), for DuplicateSharing(); default ignores pPrevious
+   virtual TrackListHolder CloneSharing(const Track *pPrevious) const;
+
+   //! Copy attachments of this track's channels to those of a copy
+   void CopyAttachments(TrackList &copy) const;
+
    template<typename T>
       friend std::enable_if_t< std::is_pointer_v<T>, T >
          track_cast(Track *track);
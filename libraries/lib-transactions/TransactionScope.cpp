@@ -47,7 +47,9 @@ TransactionScope::~TransactionScope()
 
 bool TransactionScope::Commit()
 {
-   if (mpImpl && !mInTrans) {
+   if (!mpImpl)
+      return true;
+   if (!mInTrans) {
       wxLogMessage("No active transaction to commit");
       // Misuse of this class
       THROW_INCONSISTENCY_EXCEPTION;
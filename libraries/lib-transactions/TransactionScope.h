@@ -46,7 +46,7 @@ public:
 
 private:
    std::unique_ptr<TransactionScopeImpl> mpImpl;
-   bool mInTrans;
+   bool mInTrans{ false };
    wxString mName;
 };
 
@@ -0,0 +1,217 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file TaskPool.cpp
+
+**********************************************************************/
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <deque>
+
+const char *TaskCancelled::what() const noexcept
+{
+   return "Task cancelled";
+}
+
+CancellationToken::CancellationToken()
+   : mpFlag{ std::make_shared<std::atomic<bool>>(false) }
+{
+}
+
+void CancellationToken::Cancel() const
+{
+   *mpFlag = true;
+}
+
+bool CancellationToken::IsCancelled() const
+{
+   return *mpFlag;
+}
+
+struct TaskPool::Queue {
+   std::mutex mutex;
+   std::deque<Task> tasks[NPriorities];
+};
+
+namespace {
+// Identify the worker running in this thread, so that it posts to its own
+// queue
+thread_local const TaskPool *tlPool = nullptr;
+thread_local size_t tlIndex = 0;
+}
+
+TaskPool &TaskPool::Get()
+{
+   static TaskPool instance{
+      std::max(2u, std::thread::hardware_concurrency()) - 1 };
+   return instance;
+}
+
+TaskPool::TaskPool(size_t nThreads)
+{
+   nThreads = std::max<size_t>(1, nThreads);
+   for (size_t ii = 0; ii < nThreads; ++ii)
+      mQueues.push_back(std::make_unique<Queue>());
+}
+
+TaskPool::~TaskPool()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mSleepMutex };
+      mStop = true;
+   }
+   mWake.notify_all();
+   for (auto &thread : mThreads)
+      thread.join();
+}
+
+size_t TaskPool::Concurrency() const
+{
+   return mQueues.size() + 1;
+}
+
+void TaskPool::Post(Task task, TaskPriority priority)
+{
+   std::call_once(mStarted, [this]{
+      for (size_t ii = 0; ii < mQueues.size(); ++ii)
+         mThreads.emplace_back([this, ii]{ Run(ii); });
+   });
+
+   const auto index = (tlPool == this)
+      ? tlIndex
+      : mNextQueue++ % mQueues.size();
+   // Count the task first:  a worker may take it as soon as it is queued.
+   // Until then, a woken worker finds nothing and looks again.
+   {
+      std::lock_guard<std::mutex> lock{ mSleepMutex };
+      ++mPending;
+   }
+   {
+      auto &queue = *mQueues[index];
+      std::lock_guard<std::mutex> lock{ queue.mutex };
+      queue.tasks[static_cast<size_t>(priority)].push_back(std::move(task));
+   }
+   mWake.notify_one();
+}
+
+bool TaskPool::Take(size_t index, Task &task)
+{
+   const auto nQueues = mQueues.size();
+   for (size_t priority = 0; priority < NPriorities; ++priority) {
+      // The newest task of the worker's own queue, likely still in cache
+      {
+         auto &queue = *mQueues[index];
+         std::lock_guard<std::mutex> lock{ queue.mutex };
+         auto &tasks = queue.tasks[priority];
+         if (!tasks.empty()) {
+            task = std::move(tasks.back());
+            tasks.pop_back();
+            return true;
+         }
+      }
+      // Else steal the oldest from another
+      for (size_t ii = 1; ii < nQueues; ++ii) {
+         auto &queue = *mQueues[(index + ii) % nQueues];
+         std::lock_guard<std::mutex> lock{ queue.mutex };
+         auto &tasks = queue.tasks[priority];
+         if (!tasks.empty()) {
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            return true;
+         }
+      }
+   }
+   return false;
+}
+
+void TaskPool::Run(size_t index)
+{
+   tlPool = this;
+   tlIndex = index;
+   // Stop without starting what remains queued
+   while (!mStop) {
+      Task task;
+      if (Take(index, task)) {
+         --mPending;
+         try {
+            task();
+         }
+         catch (...) {
+            // Tasks should not throw; don't let one end the worker
+         }
+         continue;
+      }
+      std::unique_lock<std::mutex> lock{ mSleepMutex };
+      mWake.wait(lock, [this]{ return mStop || mPending > 0; });
+   }
+}
+
+namespace {
+//! Shared by the caller of ForEach and the workers that help it, which may
+//! start after the caller returns
+struct ForEachState {
+   const std::function<void(size_t)> *pTask{};
+   size_t count{};
+   std::atomic<size_t> next{ 0 };
+
+   std::mutex mutex;
+   std::condition_variable done;
+   //! Helpers in the middle of items
+   size_t active{ 0 };
+   //! Set when the caller has run out of items; helpers that start later
+   //! must not touch *pTask
+   bool closed{ false };
+   std::exception_ptr pError;
+
+   void Drain()
+   {
+      for (size_t ii; (ii = next++) < count;) {
+         try {
+            (*pTask)(ii);
+         }
+         catch (...) {
+            std::lock_guard<std::mutex> lock{ mutex };
+            if (!pError)
+               pError = std::current_exception();
+         }
+      }
+   }
+};
+}
+
+void TaskPool::ForEach(size_t count, const std::function<void(size_t)> &task,
+   TaskPriority priority, size_t maxHelpers)
+{
+   if (count == 0)
+      return;
+
+   const auto pState = std::make_shared<ForEachState>();
+   pState->pTask = &task;
+   pState->count = count;
+
+   const auto nHelpers = std::min({ count - 1, mQueues.size(), maxHelpers });
+   for (size_t ii = 0; ii < nHelpers; ++ii)
+      Post([pState]{
+         {
+            std::lock_guard<std::mutex> lock{ pState->mutex };
+            if (pState->closed)
+               return;
+            ++pState->active;
+         }
+         pState->Drain();
+         std::lock_guard<std::mutex> lock{ pState->mutex };
+         if (--pState->active == 0)
+            pState->done.notify_one();
+      }, priority);
+
+   pState->Drain();
+
+   std::unique_lock<std::mutex> lock{ pState->mutex };
+   pState->closed = true;
+   pState->done.wait(lock, [&]{ return pState->active == 0; });
+   if (pState->pError)
+      std::rethrow_exception(pState->pError);
+}
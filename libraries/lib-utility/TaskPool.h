@@ -0,0 +1,161 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file TaskPool.h
+  @brief Worker threads shared by the whole program
+
+**********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//! Order in which queued tasks start; running tasks are never preempted
+enum class TaskPriority : unsigned char {
+   High, //!< Work that playback or a waiting user needs now
+   Normal,
+   Low, //!< Speculative work, such as caches for views
+};
+
+//! Exception stored in the future of a task cancelled before it started
+struct UTILITY_API TaskCancelled final : std::exception {
+   const char *what() const noexcept override;
+};
+
+//! Flag by which a submitter cancels tasks that have not started
+/*! Copies share one flag.  Running tasks may poll IsCancelled() to stop
+ early */
+class UTILITY_API CancellationToken final {
+public:
+   CancellationToken();
+
+   void Cancel() const;
+   bool IsCancelled() const;
+
+private:
+   std::shared_ptr<std::atomic<bool>> mpFlag;
+};
+
+//! Threads that take tasks from their own queues, and steal from each other's
+/*!
+ Use Get() for the pool shared by caches, effects, import, export and other
+ computations, rather than starting threads for each, which would
+ oversubscribe the cores.  The threads start at the first task.
+
+ Queued tasks start in order of priority.  A worker takes the newest task of
+ its own queue, which tasks posted from the worker go to, else the oldest of
+ another queue.
+
+ None of the functions is for the thread of the audio callback:  all of them
+ allocate and lock mutexes briefly.  A thread that must keep up with audio
+ but may allocate, such as the one that fills the playback buffers, may call
+ ForEach(), which never waits for queued work; but tasks must never wait for
+ such a thread.
+ */
+class UTILITY_API TaskPool final {
+public:
+   using Task = std::function<void()>;
+
+   //! The pool shared by the program, with one thread fewer than there are
+   //! cores, but at least one
+   static TaskPool &Get();
+
+   //! @param nThreads how many workers; at least one is made
+   explicit TaskPool(size_t nThreads);
+   TaskPool(const TaskPool&) = delete;
+   TaskPool &operator=(const TaskPool&) = delete;
+   //! Joins the threads; queued tasks that did not start are destroyed
+   ~TaskPool();
+
+   //! How many threads, including a caller of ForEach, may work at once
+   size_t Concurrency() const;
+
+   //! Queue a task, which must not throw
+   void Post(Task task, TaskPriority priority = TaskPriority::Normal);
+
+   //! Queue a function, getting a future of its result or exception
+   /*!
+    If the token is cancelled before the function starts, the future holds
+    TaskCancelled instead.  If the pool is destroyed first, it holds
+    std::future_error for a broken promise.
+    */
+   template<typename Function>
+   auto Submit(Function &&function,
+      TaskPriority priority = TaskPriority::Normal,
+      CancellationToken token = {})
+      -> std::future<std::invoke_result_t<std::decay_t<Function>&>>
+   {
+      using Result = std::invoke_result_t<std::decay_t<Function>&>;
+      auto pPromise = std::make_shared<std::promise<Result>>();
+      auto result = pPromise->get_future();
+      // Task must be copyable, but the function might not be
+      auto pFunction = std::make_shared<std::decay_t<Function>>(
+         std::forward<Function>(function));
+      Post([pPromise, pFunction, token = std::move(token)]{
+         try {
+            if (token.IsCancelled())
+               throw TaskCancelled{};
+            if constexpr (std::is_void_v<Result>) {
+               (*pFunction)();
+               pPromise->set_value();
+            }
+            else
+               pPromise->set_value((*pFunction)());
+         }
+         catch (...) {
+            pPromise->set_exception(std::current_exception());
+         }
+      }, priority);
+      return result;
+   }
+
+   //! Call task(ii) for each ii in [0, count), in the calling thread and in
+   //! workers that are free; return when all are done
+   /*!
+    The caller never waits for other queued work:  if no worker is free, it
+    does all the items itself, and waits only for items that workers already
+    started.  The first exception from an item is rethrown after all are
+    done.
+
+    Each call allocates state shared with the helpers and posts a task for
+    each, and the caller locks a mutex to wait for them, so this is not for
+    the thread of the audio callback.
+    @param maxHelpers how many workers may help the caller
+    */
+   void ForEach(size_t count, const std::function<void(size_t)> &task,
+      TaskPriority priority = TaskPriority::High,
+      size_t maxHelpers = std::numeric_limits<size_t>::max());
+
+private:
+   struct Queue;
+   static constexpr size_t NPriorities = 3;
+
+   void Run(size_t index);
+   bool Take(size_t index, Task &task);
+
+   std::vector<std::unique_ptr<Queue>> mQueues;
+   std::vector<std::thread> mThreads;
+   std::once_flag mStarted;
+
+   std::mutex mSleepMutex;
+   std::condition_variable mWake;
+   //! Tasks queued and not yet taken; incremented with mSleepMutex locked,
+   //! so that workers do not miss the wake-up, and before the task is queued,
+   //! so that taking it never makes the count wrap below zero
+   std::atomic<size_t> mPending{ 0 };
+   //! Which queue gets the next task posted from outside the workers
+   std::atomic<size_t> mNextQueue{ 0 };
+   std::atomic<bool> mStop{ false };
+};
@@ -0,0 +1,104 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  TaskPoolTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+#include "TaskPool.h"
+#include <numeric>
+#include <stdexcept>
+
+TEST_CASE("TaskPool futures")
+{
+   TaskPool pool{ 2 };
+   auto result = pool.Submit([]{ return 6 * 7; });
+   REQUIRE(result.get() == 42);
+
+   auto error = pool.Submit([]() -> int { throw std::runtime_error{ "" }; });
+   REQUIRE_THROWS_AS(error.get(), std::runtime_error);
+
+   // Functions need not be copyable
+   auto pValue = std::make_unique<int>(3);
+   auto moved = pool.Submit([pValue = std::move(pValue)]{ return *pValue; });
+   REQUIRE(moved.get() == 3);
+}
+
+TEST_CASE("TaskPool cancellation and priorities")
+{
+   // With one worker, hold it busy while queueing more
+   TaskPool pool{ 1 };
+   std::promise<void> started, release;
+   auto busy = pool.Submit([&, future = release.get_future().share()]{
+      started.set_value();
+      future.wait();
+   });
+   started.get_future().wait();
+
+   std::mutex mutex;
+   std::vector<int> order;
+   const auto record = [&](int value){
+      return [&, value]{
+         std::lock_guard<std::mutex> lock{ mutex };
+         order.push_back(value);
+      };
+   };
+
+   CancellationToken token;
+   auto cancelled = pool.Submit(record(0), TaskPriority::Normal, token);
+   auto low = pool.Submit(record(1), TaskPriority::Low);
+   auto normal = pool.Submit(record(2), TaskPriority::Normal);
+   auto high = pool.Submit(record(3), TaskPriority::High);
+   token.Cancel();
+   release.set_value();
+
+   busy.get();
+   low.get();
+   normal.get();
+   high.get();
+   REQUIRE_THROWS_AS(cancelled.get(), TaskCancelled);
+   REQUIRE(order == std::vector<int>{ 3, 2, 1 });
+}
+
+TEST_CASE("TaskPool::ForEach")
+{
+   TaskPool pool{ 3 };
+
+   std::vector<int> values(1000);
+   pool.ForEach(values.size(), [&](size_t ii){ values[ii] = ii; });
+   std::vector<int> expected(values.size());
+   std::iota(expected.begin(), expected.end(), 0);
+   REQUIRE(values == expected);
+
+   // The caller does all of the work if no worker is free
+   std::promise<void> release;
+   const auto released = release.get_future().share();
+   std::vector<std::future<void>> busy;
+   for (size_t ii = 0; ii < 3; ++ii)
+      busy.push_back(pool.Submit([released]{ released.wait(); }));
+   std::atomic<int> count{ 0 };
+   pool.ForEach(100, [&](size_t){ ++count; });
+   REQUIRE(count == 100);
+   release.set_value();
+   for (auto &future : busy)
+      future.get();
+
+   // Exceptions reach the caller, after all items are done
+   count = 0;
+   REQUIRE_THROWS_AS(pool.ForEach(10, [&](size_t ii){
+      ++count;
+      if (ii == 5)
+         throw std::runtime_error{ "" };
+   }), std::runtime_error);
+   REQUIRE(count == 10);
+
+   // Nested use from a worker does not deadlock
+   auto nested = pool.Submit([&]{
+      std::atomic<int> inner{ 0 };
+      pool.ForEach(50, [&](size_t){ ++inner; });
+      return inner.load();
+   });
+   REQUIRE(nested.get() == 50);
+}
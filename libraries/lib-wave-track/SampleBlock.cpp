@@ -12,6 +12,7 @@ SampleBlock.cpp
 #include "SampleFormat.h"
 
 #include <wx/defs.h>
+#include <wx/thread.h>
 
 SampleBlockFactoryPtr SampleBlockFactory::New( AudacityProject &project )
 {
@@ -23,6 +24,65 @@ SampleBlockFactoryPtr SampleBlockFactory::New( AudacityProject &project )
 
 SampleBlockFactory::~SampleBlockFactory() = default;
 
+SampleBlockCache *SampleBlockFactory::GetCache()
+{
+   return nullptr;
+}
+
+bool SampleBlockFactory::HasTiles()
+{
+   return false;
+}
+
+bool SampleBlockFactory::GetSamples(
+   const SampleBlockReadRequest *requests, size_t nRequests,
+   sampleFormat destformat, bool mayThrow)
+{
+   try {
+      DoGetSamples(requests, nRequests, destformat);
+      return true;
+   }
+   catch( ... ) {
+      if( mayThrow )
+         throw;
+      // One bad block should not silence the others read with it, so read
+      // each alone, zeroing only those that fail
+      bool result = true;
+      for (size_t ii = 0; ii < nRequests; ++ii) {
+         auto &request = requests[ii];
+         try {
+            request.pBlock->GetSamples(request.dest, destformat,
+               request.sampleoffset, request.numsamples);
+         }
+         catch( ... ) {
+            ClearSamples( request.dest, destformat, 0, request.numsamples );
+            result = false;
+         }
+      }
+      return result;
+   }
+}
+
+void SampleBlockFactory::DoGetSamples(
+   const SampleBlockReadRequest *requests, size_t nRequests,
+   sampleFormat destformat)
+{
+   for (size_t ii = 0; ii < nRequests; ++ii) {
+      auto &request = requests[ii];
+      request.pBlock->GetSamples(request.dest, destformat,
+         request.sampleoffset, request.numsamples);
+   }
+}
+
+void SampleBlockFactory::PublishCreation()
+{
+   // Subscribers update the user interface, and publishing is not thread
+   // safe, so blocks made by workers, as when decoding imports, are not
+   // announced
+   if (wxIsMainThread())
+      Publisher<SampleBlockCreateMessage>::Publish({});
+}
+
 SampleBlockPtr SampleBlockFactory::Create(constSamplePtr src,
    size_t numsamples,
    sampleFormat srcformat)
@@ -30,7 +90,7 @@ SampleBlockPtr SampleBlockFactory::Create(constSamplePtr src,
    auto result = DoCreate(src, numsamples, srcformat);
    if (!result)
       THROW_INCONSISTENCY_EXCEPTION;
-   Publisher<SampleBlockCreateMessage>::Publish({});
+   PublishCreation();
    return result;
 }
 
@@ -41,7 +101,7 @@ SampleBlockPtr SampleBlockFactory::CreateSilent(
    auto result = DoCreateSilent(numsamples, srcformat);
    if (!result)
       THROW_INCONSISTENCY_EXCEPTION;
-   Publisher<SampleBlockCreateMessage>::Publish({});
+   PublishCreation();
    return result;
 }
 
@@ -52,7 +112,7 @@ SampleBlockPtr SampleBlockFactory::CreateFromXML(
    auto result = DoCreateFromXML(srcformat, attrs);
    if (!result)
       THROW_INCONSISTENCY_EXCEPTION;
-   Publisher<SampleBlockCreateMessage>::Publish({});
+   PublishCreation();
    return result;
 }
 
@@ -93,3 +153,12 @@ size_t SampleBlock::GetSamples(samplePtr dest,
    }
 }
 
+
+bool SampleBlock::GetTile(const SampleBlockTileKey &, std::vector<float> &)
+{
+   return false;
+}
+
+void SampleBlock::PutTile(const SampleBlockTileKey &, const std::vector<float> &)
+{
+}
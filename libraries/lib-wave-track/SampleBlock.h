@@ -16,12 +16,14 @@ SampleBlock.h
 #include <functional>
 #include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include "Observer.h"
 #include "XMLTagHandler.h"
 
 class AudacityProject;
 class ProjectFileIO;
+class SampleBlockCache;
 class XMLWriter;
 
 class SampleBlock;
@@ -39,6 +41,17 @@ public:
    float RMS = 0;
 };
 
+//! Identifies data derived from the samples of a block, and stored with it
+struct SampleBlockTileKey
+{
+   //! What is derived, such as spectra
+   int kind;
+   //! Hash of the settings that the data depend on
+   unsigned long long settings;
+   //! Zoom level
+   int level;
+};
+
 ///\brief Abstract class allows access to contents of a block of sound samples,
 /// serialization as XML, and reference count management that can suppress
 /// reclamation of its storage
@@ -85,6 +98,15 @@ public:
    // That may be appropriate when only attempting to display samples, not edit.
    MinMaxRMS GetMinMaxRMS(bool mayThrow = true) const;
 
+   //! Retrieve data stored by PutTile; non-throwing
+   /*! Default implementation stores nothing and returns false */
+   virtual bool GetTile(const SampleBlockTileKey &key, std::vector<float> &data);
+   //! Store derived data, replacing any with the same key, to be discarded
+   //! when the block is deleted; non-throwing
+   /*! Default implementation does nothing */
+   virtual void PutTile(
+      const SampleBlockTileKey &key, const std::vector<float> &data);
+
    virtual size_t GetSpaceUsage() const = 0;
 
    virtual void SaveXML(XMLWriter &xmlFile) = 0;
@@ -109,8 +131,18 @@ BlockSpaceUsageAccumulator (unsigned long long &total)
    };
 };
 
+//! Published when a block is created in the main thread
 struct SampleBlockCreateMessage { };
 
+//! One destination of a batched read; see SampleBlockFactory::GetSamples
+struct SampleBlockReadRequest
+{
+   SampleBlock *pBlock;
+   samplePtr dest;
+   size_t sampleoffset;
+   size_t numsamples;
+};
+
 ///\brief abstract base class with methods to produce @ref SampleBlock objects
 class WAVE_TRACK_API SampleBlockFactory
    : public Observer::Publisher<SampleBlockCreateMessage>
@@ -145,7 +177,31 @@ public:
    /*! @return ids of all sample blocks created by this factory and still extant */
    virtual SampleBlockIDs GetActiveBlockIDs() = 0;
 
+   //! @return the cache of decoded samples shared by all blocks of this
+   //! factory, or null if the implementation keeps none
+   /*! Default implementation returns null */
+   virtual SampleBlockCache *GetCache();
+
+   //! @return whether blocks of this factory now store tiles; see
+   //! SampleBlock::PutTile
+   /*! Default implementation returns false */
+   virtual bool HasTiles();
+
+   //! Read from several blocks made by this factory, which may be
+   //! faster than SampleBlock::GetSamples for each in turn
+   /*!
+    If !mayThrow and there is an error, reads each block alone, fills the
+    destinations of the blocks that still fail with zeroes, and returns false.
+    */
+   bool GetSamples(const SampleBlockReadRequest *requests, size_t nRequests,
+      sampleFormat destformat, bool mayThrow = true);
+
 protected:
+   //! Default implementation calls SampleBlock::GetSamples for each request
+   virtual void DoGetSamples(
+      const SampleBlockReadRequest *requests, size_t nRequests,
+      sampleFormat destformat);
+
    // The override should throw more informative exceptions on error than the
    // default InconsistencyException thrown by Create
    virtual SampleBlockPtr DoCreate(constSamplePtr src,
@@ -163,6 +219,10 @@ protected:
    virtual SampleBlockPtr DoCreateFromXML(
       sampleFormat srcformat,
       const AttributesList &attrs) = 0;
+
+private:
+   //! Publish SampleBlockCreateMessage, but only in the main thread
+   void PublishCreation();
 };
 
 #endif
@@ -0,0 +1,144 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleBlockCache.cpp
+
+**********************************************************************/
+#include "SampleBlockCache.h"
+
+#include "Prefs.h"
+
+#include <algorithm>
+#include <cassert>
+
+SampleBlockCache::SampleBlockCache(size_t capacity)
+    : mCapacity { capacity }
+{
+}
+
+SampleBlockCache::~SampleBlockCache() = default;
+
+BlockSampleView SampleBlockCache::Find(SampleBlockID id)
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   const auto iter = mIndex.find(id);
+   if (iter == mIndex.end())
+   {
+      mMisses.fetch_add(1, std::memory_order_relaxed);
+      return {};
+   }
+   mHits.fetch_add(1, std::memory_order_relaxed);
+   // Move to the front without invalidating iterators
+   mList.splice(mList.begin(), mList, iter->second);
+   return iter->second->second;
+}
+
+void SampleBlockCache::Insert(SampleBlockID id, BlockSampleView data)
+{
+   assert(data);
+   if (!data || !IsEnabled())
+      return;
+   std::lock_guard<std::mutex> lock { mMutex };
+   if (const auto iter = mIndex.find(id); iter != mIndex.end())
+   {
+      mBytes -= SizeOf(iter->second->second);
+      iter->second->second = std::move(data);
+      mBytes += SizeOf(iter->second->second);
+      mList.splice(mList.begin(), mList, iter->second);
+   }
+   else
+   {
+      mBytes += SizeOf(data);
+      mList.emplace_front(id, std::move(data));
+      mIndex.emplace(id, mList.begin());
+   }
+   Trim();
+}
+
+void SampleBlockCache::Erase(SampleBlockID id)
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   if (const auto iter = mIndex.find(id); iter != mIndex.end())
+   {
+      mBytes -= SizeOf(iter->second->second);
+      mList.erase(iter->second);
+      mIndex.erase(iter);
+   }
+}
+
+void SampleBlockCache::Clear()
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   mList.clear();
+   mIndex.clear();
+   mBytes = 0;
+}
+
+void SampleBlockCache::SetCapacity(size_t capacity)
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   mCapacity = capacity;
+   Trim();
+}
+
+size_t SampleBlockCache::GetCapacity() const
+{
+   return mCapacity;
+}
+
+size_t SampleBlockCache::GetSize() const
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   return mBytes;
+}
+
+SampleBlockCacheStatistics SampleBlockCache::GetStatistics() const
+{
+   return { mHits.load(std::memory_order_relaxed),
+            mMisses.load(std::memory_order_relaxed),
+            mEvictions.load(std::memory_order_relaxed) };
+}
+
+void SampleBlockCache::ResetStatistics()
+{
+   mHits.store(0, std::memory_order_relaxed);
+   mMisses.store(0, std::memory_order_relaxed);
+   mEvictions.store(0, std::memory_order_relaxed);
+}
+
+size_t SampleBlockCache::CapacityFromPreference()
+{
+   return std::max(0, SampleBlockCacheSize.Read()) * size_t{ 1024 * 1024 };
+}
+
+bool SampleBlockCache::ShouldFill(size_t readLength, size_t blockLength)
+{
+   // Decoding all of a block for a small part of it would cost more than
+   // the read, and the entry might never be used again
+   return 2 * readLength > blockLength;
+}
+
+size_t SampleBlockCache::SizeOf(const BlockSampleView& data)
+{
+   return data->size() * sizeof(float);
+}
+
+void SampleBlockCache::Trim()
+{
+   // Views already handed out keep their data alive; eviction only drops
+   // the cache's own reference
+   while (mBytes > mCapacity && !mList.empty())
+   {
+      auto& entry = mList.back();
+      mBytes -= SizeOf(entry.second);
+      mIndex.erase(entry.first);
+      mList.pop_back();
+      mEvictions.fetch_add(1, std::memory_order_relaxed);
+   }
+}
+
+IntSetting SampleBlockCacheSize{
+   L"/Performance/SampleBlockCacheSize",
+   static_cast<int>(SampleBlockCache::DefaultCapacity / (1024 * 1024)) };
@@ -0,0 +1,106 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleBlockCache.h
+  @brief Memory-bounded, least-recently-used cache of decoded sample blocks
+
+**********************************************************************/
+#pragma once
+
+#include "AudioSegmentSampleView.h" // BlockSampleView
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+using SampleBlockID = long long;
+
+class IntSetting;
+
+//! Counters describing the effectiveness of a SampleBlockCache
+struct SampleBlockCacheStatistics
+{
+   size_t hits{ 0 };
+   size_t misses{ 0 };
+   //! Entries dropped to satisfy the capacity; erasures don't count
+   size_t evictions{ 0 };
+};
+
+//! Holds decoded float samples of recently used blocks, keyed by block id
+/*!
+ A SampleBlockFactory may own one of these, so that all blocks it makes share
+ one budget of memory, independently of how long any BlockSampleView lives.
+ All member functions are thread-safe.
+ */
+class WAVE_TRACK_API SampleBlockCache final
+{
+public:
+   //! 64 MB, which is 64 blocks of the default size
+   static constexpr size_t DefaultCapacity = 64 * 1024 * 1024;
+
+   //! SampleBlockCacheSize, converted to bytes
+   static size_t CapacityFromPreference();
+
+   //! Whether a read that misses should decode the whole block into the
+   //! cache, which it does only if it reads most of the block
+   static bool ShouldFill(size_t readLength, size_t blockLength);
+
+   explicit SampleBlockCache(size_t capacity = DefaultCapacity);
+   SampleBlockCache(const SampleBlockCache&) = delete;
+   SampleBlockCache& operator=(const SampleBlockCache&) = delete;
+   ~SampleBlockCache();
+
+   //! @return null if absent, counting a miss; otherwise, counts a hit and
+   //! marks the entry as most recently used
+   BlockSampleView Find(SampleBlockID id);
+
+   //! Add or replace an entry, then evict least recently used entries
+   //! to satisfy the capacity
+   /*! @pre `data != nullptr` */
+   void Insert(SampleBlockID id, BlockSampleView data);
+
+   //! Forget any entry for the id; does not count as an eviction
+   /*! Must be called when the block is deleted, because ids may be reused */
+   void Erase(SampleBlockID id);
+
+   void Clear();
+
+   //! Zero capacity disables caching
+   void SetCapacity(size_t capacity);
+   size_t GetCapacity() const;
+   bool IsEnabled() const { return GetCapacity() > 0; }
+   //! Bytes of decoded samples now held
+   size_t GetSize() const;
+
+   //! Counts since construction or the last reset
+   SampleBlockCacheStatistics GetStatistics() const;
+   void ResetStatistics();
+
+private:
+   using Entry = std::pair<SampleBlockID, BlockSampleView>;
+   using List = std::list<Entry>;
+
+   static size_t SizeOf(const BlockSampleView& data);
+   //! @pre mMutex is locked
+   void Trim();
+
+   mutable std::mutex mMutex;
+   //! Most recently used at the front
+   List mList;
+   std::unordered_map<SampleBlockID, List::iterator> mIndex;
+   size_t mBytes{ 0 };
+   std::atomic<size_t> mCapacity;
+
+   // Only statistics, so they need no ordering with other memory
+   std::atomic<size_t> mHits{ 0 };
+   std::atomic<size_t> mMisses{ 0 };
+   std::atomic<size_t> mEvictions{ 0 };
+};
+
+//! Megabytes of decoded samples to cache for each project; 0 disables the
+//! cache.  Takes effect when a project opens
+extern WAVE_TRACK_API IntSetting SampleBlockCacheSize;
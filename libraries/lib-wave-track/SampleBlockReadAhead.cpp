@@ -0,0 +1,90 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleBlockReadAhead.cpp
+
+**********************************************************************/
+#include "SampleBlockReadAhead.h"
+
+#include "BasicUI.h"
+#include "Prefs.h"
+#include "SampleBlock.h"
+#include "TaskPool.h"
+
+std::atomic<bool> SampleBlockReadAhead::sEnabled{ false };
+
+SampleBlockReadAhead &SampleBlockReadAhead::Get()
+{
+   // Shared with queued tasks, which may outlive static storage at exit
+   static const std::shared_ptr<SampleBlockReadAhead> pInstance{
+      new SampleBlockReadAhead };
+   return *pInstance;
+}
+
+void SampleBlockReadAhead::SetEnabled(bool enabled)
+{
+   sEnabled = enabled;
+}
+
+bool SampleBlockReadAhead::IsEnabled()
+{
+   return sEnabled;
+}
+
+SampleBlockReadAhead::SampleBlockReadAhead() = default;
+
+void SampleBlockReadAhead::SetDepth(size_t depth)
+{
+   mDepth = depth;
+}
+
+size_t SampleBlockReadAhead::GetDepth() const
+{
+   return mDepth;
+}
+
+void SampleBlockReadAhead::Prefetch(const std::shared_ptr<SampleBlock> &pBlock)
+{
+   const auto id = pBlock->GetBlockID();
+   // Silent blocks need no decoding
+   if (id <= 0)
+      return;
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      if (!mQueued.insert(id).second)
+         return;
+      // Don't let a reader that outruns the pool grow the queue without
+      // bound; drop the stalest request instead
+      if (mQueue.size() >= 4 * std::max<size_t>(mDepth, 1)) {
+         mQueued.erase(mQueue.front().first);
+         mQueue.pop_front();
+      }
+      mQueue.emplace_back(id, pBlock);
+   }
+   // One task for each request; those outnumbering the queue, after drops,
+   // find it empty
+   TaskPool::Get().Post([pThis = shared_from_this()]{ pThis->RunOne(); });
+}
+
+void SampleBlockReadAhead::RunOne()
+{
+   std::weak_ptr<SampleBlock> wBlock;
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      if (mQueue.empty())
+         return;
+      wBlock = std::move(mQueue.front().second);
+      mQueued.erase(mQueue.front().first);
+      mQueue.pop_front();
+   }
+   if (auto pBlock = wBlock.lock()) {
+      // Fills the factory's cache as a side effect; errors will be
+      // reported again when the reader really needs the samples
+      pBlock->GetFloatSampleView(false);
+      BasicUI::CallAfter([pBlock = std::move(pBlock)]{});
+   }
+}
+
+BoolSetting ReadAheadEnabled{ L"/AudioIO/ReadAhead", false };
@@ -0,0 +1,67 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleBlockReadAhead.h
+  @brief Decodes sample blocks in the TaskPool ahead of playback
+
+**********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+
+class BoolSetting;
+class SampleBlock;
+using SampleBlockID = long long;
+
+//! Opt-in service that fills the decoded-sample caches of block factories
+/*!
+ The thread that fills playback buffers asks this service, through
+ Sequence::Prefetch(), to decode the next few blocks, so that its reads find
+ them in memory instead of waiting for the database.  Reads themselves never
+ make requests.
+
+ Blocks are held only weakly while queued.  After decoding, the task's
+ reference is released in the main thread, so that the deletion of a block,
+ which writes the database, never happens in the worker.
+ */
+class WAVE_TRACK_API SampleBlockReadAhead final
+   : public std::enable_shared_from_this<SampleBlockReadAhead>
+{
+public:
+   static constexpr size_t DefaultDepth = 4;
+
+   static SampleBlockReadAhead &Get();
+
+   //! Read-ahead is off by default
+   static void SetEnabled(bool enabled);
+   static bool IsEnabled();
+
+   //! How many blocks to decode ahead of playback
+   void SetDepth(size_t depth);
+   size_t GetDepth() const;
+
+   //! Enqueue a block for decoding, unless it is already queued
+   void Prefetch(const std::shared_ptr<SampleBlock> &pBlock);
+
+private:
+   SampleBlockReadAhead();
+   //! Decode the oldest queued block, in a thread of the TaskPool
+   void RunOne();
+
+   static std::atomic<bool> sEnabled;
+
+   std::atomic<size_t> mDepth{ DefaultDepth };
+
+   std::mutex mMutex;
+   std::deque<std::pair<SampleBlockID, std::weak_ptr<SampleBlock>>> mQueue;
+   std::unordered_set<SampleBlockID> mQueued;
+};
+
+//! Preference to enable SampleBlockReadAhead, applied at startup
+extern WAVE_TRACK_API BoolSetting ReadAheadEnabled;
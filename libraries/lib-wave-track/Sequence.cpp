@@ -32,6 +32,7 @@
 #include "Sequence.h"
 
 #include <algorithm>
+#include <array>
 #include <optional>
 #include <float.h>
 #include <math.h>
@@ -43,6 +44,8 @@
 #include "BasicUI.h"
 #include "Dither.h"
 #include "SampleBlock.h"
+#include "SampleBlockCache.h"
+#include "SampleBlockReadAhead.h"
 #include "InconsistencyException.h"
 
 size_t Sequence::sMaxDiskBlockSize = 1048576;
@@ -74,6 +77,20 @@ Sequence::~Sequence()
 {
 }
 
+bool Sequence::IsSameAs(const Sequence &other) const
+{
+   if (mAppendBufferLen > 0 || other.mAppendBufferLen > 0)
+      return false;
+   return mpFactory == other.mpFactory &&
+      mSampleFormats == other.mSampleFormats &&
+      mNumSamples == other.mNumSamples &&
+      std::equal(mBlock.begin(), mBlock.end(),
+         other.mBlock.begin(), other.mBlock.end(),
+         [](const SeqBlock &a, const SeqBlock &b){
+            return a.sb == b.sb && a.start == b.start;
+         });
+}
+
 size_t Sequence::GetMaxBlockSize() const
 {
    return mMaxSamples;
@@ -1045,15 +1062,22 @@ void Sequence::WriteXML(XMLWriter &xmlFile) const
 
 int Sequence::FindBlock(sampleCount pos) const
 {
-   wxASSERT(pos >= 0 && pos < mNumSamples);
+   return FindBlock(mBlock, mNumSamples, pos);
+}
+
+//static
+int Sequence::FindBlock(
+   const BlockArray &blocks, sampleCount numSamples, sampleCount pos)
+{
+   wxASSERT(pos >= 0 && pos < numSamples);
 
    if (pos == 0)
       return 0;
 
-   int numBlocks = mBlock.size();
+   int numBlocks = blocks.size();
 
    size_t lo = 0, hi = numBlocks, guess;
-   sampleCount loSamples = 0, hiSamples = mNumSamples;
+   sampleCount loSamples = 0, hiSamples = numSamples;
 
    while (true) {
       //this is not a binary search, but a
@@ -1062,7 +1086,7 @@ int Sequence::FindBlock(sampleCount pos) const
       const double frac = (pos - loSamples).as_double() /
          (hiSamples - loSamples).as_double();
       guess = std::min(hi - 1, lo + size_t(frac * (hi - lo)));
-      const SeqBlock &block = mBlock[guess];
+      const SeqBlock &block = blocks[guess];
 
       wxASSERT(block.sb->GetSampleCount() > 0);
       wxASSERT(lo <= guess && guess < hi && lo < hi);
@@ -1086,8 +1110,8 @@ int Sequence::FindBlock(sampleCount pos) const
 
    const int rval = guess;
    wxASSERT(rval >= 0 && rval < numBlocks &&
-            pos >= mBlock[rval].start &&
-            pos < mBlock[rval].start + mBlock[rval].sb->GetSampleCount());
+            pos >= blocks[rval].start &&
+            pos < blocks[rval].start + blocks[rval].sb->GetSampleCount());
 
    return rval;
 }
@@ -1117,17 +1141,26 @@ bool Sequence::Read(samplePtr buffer, sampleFormat format,
 AudioSegmentSampleView Sequence::GetFloatSampleView(
    sampleCount start, size_t length, bool mayThrow) const
 {
-   assert(start < mNumSamples);
-   length = limitSampleBufferSize(length, mNumSamples - start);
+   return GetFloatSampleView(mBlock, mNumSamples, start, length, mayThrow);
+}
+
+//static
+AudioSegmentSampleView Sequence::GetFloatSampleView(
+   const BlockArray &blocks, sampleCount numSamples,
+   sampleCount start, size_t length, bool mayThrow)
+{
+   assert(start < numSamples);
+   length = limitSampleBufferSize(length, numSamples - start);
    std::vector<BlockSampleView> blockViews;
    // `sequenceOffset` cannot be larger than `GetMaxBlockSize()`, a `size_t` =>
    // no narrowing possible.
-   const auto sequenceOffset = (start - GetBlockStart(start)).as_size_t();
+   const auto sequenceOffset =
+      (start - blocks[FindBlock(blocks, numSamples, start)].start).as_size_t();
    auto cursor = start;
    while (cursor < start + length)
    {
-      const auto b = FindBlock(cursor);
-      const SeqBlock& block = mBlock[b];
+      const auto b = FindBlock(blocks, numSamples, cursor);
+      const SeqBlock& block = blocks[b];
       blockViews.push_back(block.sb->GetFloatSampleView(mayThrow));
       cursor = block.start + block.sb->GetSampleCount();
    }
@@ -1152,9 +1185,40 @@ bool Sequence::Get(samplePtr buffer, sampleFormat format,
    return Get(b, buffer, format, start, len, mayThrow);
 }
 
+void Sequence::Prefetch(sampleCount start, bool backwards) const
+{
+   if (mNumSamples == 0 || !SampleBlockReadAhead::IsEnabled())
+      return;
+   const auto pCache = mpFactory ? mpFactory->GetCache() : nullptr;
+   if (!pCache || !pCache->IsEnabled())
+      return;
+
+   // Make requests only as playback enters another block
+   const int b = FindBlock(std::clamp<sampleCount>(start, 0, mNumSamples - 1));
+   if (mReadAheadBlock.exchange(b) == b)
+      return;
+   auto &readAhead = SampleBlockReadAhead::Get();
+   const int depth = readAhead.GetDepth();
+   if (backwards)
+      for (int bb = b, bEnd = std::max(-1, b - 1 - depth); bb > bEnd; --bb)
+         readAhead.Prefetch(mBlock[bb].sb);
+   else
+      for (int bb = b, bEnd = std::min<int>(mBlock.size(), b + 1 + depth);
+         bb < bEnd; ++bb)
+         readAhead.Prefetch(mBlock[bb].sb);
+}
+
 bool Sequence::Get(int b, samplePtr buffer, sampleFormat format,
    sampleCount start, size_t len, bool mayThrow) const
 {
+   // Long reads, as for export, mixdown or analysis, let the factory fetch
+   // several blocks at once
+   if (len > 0 && mpFactory) {
+      const SeqBlock &block = mBlock[b];
+      if ((start - block.start).as_size_t() + len > block.sb->GetSampleCount())
+         return GetBatched(b, buffer, format, start, len, mayThrow);
+   }
+
    bool result = true;
    while (len) {
       const SeqBlock &block = mBlock[b];
@@ -1174,6 +1238,35 @@ bool Sequence::Get(int b, samplePtr buffer, sampleFormat format,
    return result;
 }
 
+bool Sequence::GetBatched(int b, samplePtr buffer, sampleFormat format,
+   sampleCount start, size_t len, bool mayThrow) const
+{
+   // Bounded on the stack, so that playback does not allocate
+   std::array<SampleBlockReadRequest, 16> requests;
+   bool result = true;
+   while (len) {
+      size_t nRequests = 0;
+      for (; len && nRequests < requests.size(); ++nRequests) {
+         const SeqBlock &block = mBlock[b];
+         // start is in block
+         const auto bstart = (start - block.start).as_size_t();
+         // bstart is not more than block length
+         const auto blen = std::min(len, block.sb->GetSampleCount() - bstart);
+
+         requests[nRequests] = { block.sb.get(), buffer, bstart, blen };
+
+         len -= blen;
+         buffer += (blen * SAMPLE_SIZE(format));
+         b++;
+         start += blen;
+      }
+      if (!mpFactory->GetSamples(
+         requests.data(), nRequests, format, mayThrow))
+         result = false;
+   }
+   return result;
+}
+
 // Pass nullptr to set silence
 /*! @excsafety{Strong} */
 void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
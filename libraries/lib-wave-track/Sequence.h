@@ -12,6 +12,7 @@
 #define __AUDACITY_SEQUENCE__
 
 
+#include <atomic>
 #include <vector>
 #include <functional>
 
@@ -77,6 +78,10 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
 
    ~Sequence();
 
+   //! Whether the sequences hold the same blocks, at the same positions
+   /*! False if either has un-flushed append buffer data */
+   bool IsSameAs(const Sequence &other) const;
+
    //
    // Editing
    //
@@ -93,6 +98,23 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    AudioSegmentSampleView
    GetFloatSampleView(sampleCount start, size_t len, bool mayThrow) const;
 
+   //! GetFloatSampleView() of a copy of the block array of a sequence
+   /*! Blocks are immutable, so this may read in another thread while the
+    sequence changes
+    @pre `start < numSamples` */
+   static AudioSegmentSampleView GetFloatSampleView(const BlockArray &blocks,
+      sampleCount numSamples, sampleCount start, size_t len, bool mayThrow);
+
+   //! Ask SampleBlockReadAhead to decode the block holding `start` and the
+   //! next few, without waiting
+   /*!
+    For the thread that fills playback buffers, ahead of its reads.  Does
+    nothing unless read-ahead is enabled and the factory caches decoded
+    samples, or if the last call was for the same block.
+    @param backwards whether to decode the blocks before, not after
+    */
+   void Prefetch(sampleCount start, bool backwards) const;
+
    //! Pass nullptr to set silence
    /*! Note that len is not size_t, because nullptr may be passed for buffer, in
       which case, silence is inserted, possibly a large amount. */
@@ -250,6 +272,9 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
 
    bool          mErrorOpening{ false };
 
+   //! Block holding the position of the last Prefetch()
+   mutable std::atomic<int> mReadAheadBlock{ -1 };
+
    //
    // Private methods
    //
@@ -285,6 +310,14 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
             size_t len,
             bool mayThrow) const;
 
+   //! Like Get, but the factory reads up to a few blocks per request
+   bool GetBatched(int b,
+            samplePtr buffer,
+            sampleFormat format,
+            sampleCount start,
+            size_t len,
+            bool mayThrow) const;
+
 public:
 
    //
@@ -292,6 +325,8 @@ public:
    //
 
    int FindBlock(sampleCount pos) const;
+   static int FindBlock(
+      const BlockArray &blocks, sampleCount numSamples, sampleCount pos);
 
    static bool Read(samplePtr buffer, sampleFormat format,
              const SeqBlock &b,
@@ -160,6 +160,86 @@ AudioSegmentSampleView WaveClip::GetSampleView(
    return GetSampleView(iChannel, start, length, mayThrow);
 }
 
+ClipContentKey WaveClip::GetContentKey() const
+{
+   // GetSampleView() reads the visible part of the sequences
+   const auto start = TimeToSamples(mTrimLeft);
+   const auto end = start + GetVisibleSampleCount();
+   ClipContentKey key;
+   key.values = { start.as_long_long(), end.as_long_long() };
+   for (const auto &pSequence : mSequences) {
+      // Appended samples not yet in blocks can't be identified
+      if (pSequence->GetAppendBufferLen() > 0)
+         return {};
+      const auto &blocks = pSequence->GetBlockArray();
+      key.values.push_back(blocks.size());
+      for (const auto &block : blocks) {
+         if (block.start >= end ||
+             block.start + block.sb->GetSampleCount() <= start)
+            continue;
+         key.owners.push_back(block.sb);
+         key.values.push_back(block.start.as_long_long());
+      }
+   }
+   return key;
+}
+
+namespace {
+//! The times of a WaveClip, and copies of its block arrays
+struct WaveClipSnapshot final : ClipInterface
+{
+   AudioSegmentSampleView GetSampleView(size_t iChannel, sampleCount start,
+      size_t length, bool mayThrow) const override
+   {
+      assert(iChannel < GetWidth());
+      return Sequence::GetFloatSampleView(blocks[iChannel], numSamples,
+         start + trimLeft, length, mayThrow);
+   }
+
+   size_t GetWidth() const override { return blocks.size(); }
+   sampleCount GetVisibleSampleCount() const override
+   {
+      return visibleSampleCount;
+   }
+   int GetRate() const override { return rate; }
+   double GetPlayStartTime() const override { return playStartTime; }
+   double GetPlayEndTime() const override { return playEndTime; }
+   sampleCount TimeToSamples(double time) const override
+   {
+      // As in WaveClip
+      return sampleCount(floor(time * rate / stretchRatio + 0.5));
+   }
+   double GetStretchRatio() const override { return stretchRatio; }
+
+   std::vector<BlockArray> blocks;
+   sampleCount numSamples;
+   sampleCount trimLeft;
+   sampleCount visibleSampleCount;
+   int rate{};
+   double playStartTime{};
+   double playEndTime{};
+   double stretchRatio{};
+};
+}
+
+std::shared_ptr<const ClipInterface> WaveClip::GetSnapshot() const
+{
+   if (GetAppendBufferLen() > 0)
+      return nullptr;
+   auto pSnapshot = std::make_shared<WaveClipSnapshot>();
+   // Copying shares the blocks, which are immutable, with the sequences
+   for (const auto &pSequence : mSequences)
+      pSnapshot->blocks.push_back(pSequence->GetBlockArray());
+   pSnapshot->numSamples = GetNumSamples();
+   pSnapshot->trimLeft = TimeToSamples(mTrimLeft);
+   pSnapshot->visibleSampleCount = GetVisibleSampleCount();
+   pSnapshot->rate = mRate;
+   pSnapshot->playStartTime = GetPlayStartTime();
+   pSnapshot->playEndTime = GetPlayEndTime();
+   pSnapshot->stretchRatio = GetStretchRatio();
+   return pSnapshot;
+}
+
 size_t WaveClip::GetWidth() const
 {
    return mSequences.size();
@@ -1451,6 +1531,28 @@ sampleCount WaveClip::TimeToSequenceSamples(double t) const
     return TimeToSamples(t - GetSequenceStartTime());
 }
 
+bool WaveClip::IsSameAs(const WaveClip &other) const
+{
+   // Compare what the copy constructor copies
+   return mSequenceOffset == other.mSequenceOffset &&
+      mTrimLeft == other.mTrimLeft &&
+      mTrimRight == other.mTrimRight &&
+      mClipStretchRatio == other.mClipStretchRatio &&
+      mRawAudioTempo == other.mRawAudioTempo &&
+      mProjectTempo == other.mProjectTempo &&
+      mRate == other.mRate &&
+      mColourIndex == other.mColourIndex &&
+      mIsPlaceholder == other.mIsPlaceholder &&
+      mName == other.mName &&
+      mEnvelope->IsSameAs(*other.mEnvelope) &&
+      std::equal(mSequences.begin(), mSequences.end(),
+         other.mSequences.begin(), other.mSequences.end(),
+         [](const auto &pA, const auto &pB){ return pA->IsSameAs(*pB); }) &&
+      std::equal(mCutLines.begin(), mCutLines.end(),
+         other.mCutLines.begin(), other.mCutLines.end(),
+         [](const auto &pA, const auto &pB){ return pA->IsSameAs(*pB); });
+}
+
 bool WaveClip::CheckInvariants() const
 {
    const auto width = GetWidth();
@@ -146,6 +146,10 @@ public:
    //! Check invariant conditions on mSequences and mCutlines
    bool CheckInvariants() const;
 
+   //! Whether a copy of this clip would equal a copy of the other
+   /*! Compares sample blocks by identity, not by contents */
+   bool IsSameAs(const WaveClip &other) const;
+
    //! How many Sequences the clip contains.
    //! Set at construction time; changes only if increased by deserialization
    size_t GetWidth() const override;
@@ -316,6 +320,13 @@ public:
    AudioSegmentSampleView GetSampleView(
       size_t iChannel, double t0, double t1, bool mayThrow = true) const;
 
+   //! Identifies the visible sample blocks, by identity
+   ClipContentKey GetContentKey() const override;
+
+   //! Shares the visible sample blocks, or null if samples are still being
+   //! appended
+   std::shared_ptr<const ClipInterface> GetSnapshot() const override;
+
    //! Get samples from one channel
    /*!
     @param ii identifies the channel
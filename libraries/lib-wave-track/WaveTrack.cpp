@@ -57,8 +57,10 @@ from the project that will own the track.
 #include "BasicUI.h"
 #include "Prefs.h"
 #include "QualitySettings.h"
+#include "SampleBlockReadAhead.h"
 #include "SyncLock.h"
 #include "TimeWarper.h"
+#include "UndoManager.h"
 
 
 #include "InconsistencyException.h"
@@ -784,6 +786,33 @@ WaveTrack::WaveTrack(const WaveTrack &orig, ProtectedCreationArg &&a)
       InsertClip(std::make_shared<WaveClip>(*clip, mpFactory, true));
 }
 
+WaveTrack::WaveTrack(const WaveTrack &orig, ProtectedCreationArg &&a,
+   const WaveTrack &previous)
+   : WritableSampleTrack(orig, std::move(a))
+   , mpFactory( orig.mpFactory )
+{
+   mLegacyProjectFileOffset = 0;
+   // Clips are usually in the same order as before, so search from the one
+   // after the last found
+   const auto begin = previous.mClips.begin(), end = previous.mClips.end();
+   auto hint = begin;
+   for (const auto &clip : orig.mClips) {
+      const auto same = [&](const WaveClipHolder &pClip){
+         return pClip->IsSameAs(*clip);
+      };
+      auto found = std::find_if(hint, end, same);
+      if (found == end)
+         found = std::find_if(begin, hint, same);
+      if (found != end) {
+         // Already adjusted for tempo when inserted in previous
+         mClips.push_back(*found);
+         hint = found + 1;
+      }
+      else
+         InsertClip(std::make_shared<WaveClip>(*clip, mpFactory, true));
+   }
+}
+
 size_t WaveTrack::GetWidth() const
 {
    return 1;
@@ -1029,6 +1058,25 @@ TrackListHolder WaveTrack::Clone() const
    return result;
 }
 
+TrackListHolder WaveTrack::CloneSharing(const Track *pPrevious) const
+{
+   assert(IsLeader());
+   const auto pPreviousTrack = dynamic_cast<const WaveTrack*>(pPrevious);
+   if (!pPreviousTrack || !GetOwner() || !pPreviousTrack->GetOwner() ||
+       NChannels() != pPreviousTrack->NChannels())
+      return Clone();
+   auto result = TrackList::Temporary(nullptr);
+   auto previousChannels = TrackList::Channels(pPreviousTrack);
+   auto iter = previousChannels.begin();
+   for (const auto pChannel : TrackList::Channels(this)) {
+      const auto pTrack = std::make_shared<WaveTrack>(
+         *pChannel, ProtectedCreationArg{}, **iter++);
+      pTrack->Init(*pChannel);
+      result->Add(pTrack);
+   }
+   return result;
+}
+
 wxString WaveTrack::MakeClipCopyName(const wxString& originalName) const
 {
    auto name = originalName;
@@ -2765,6 +2813,35 @@ bool WaveTrack::GetSolo() const
    return PlayableTrack::GetSolo();
 }
 
+void WaveTrack::Prefetch(double t, bool backwards) const
+{
+   assert(IsLeader());
+   if (!SampleBlockReadAhead::IsEnabled())
+      return;
+   for (const auto pChannel : TrackList::Channels(this)) {
+      // Clips are not necessarily sorted by time
+      const WaveClip *pClip{};
+      for (const auto &pCandidate : pChannel->mClips) {
+         const auto start = pCandidate->GetPlayStartTime();
+         const auto end = pCandidate->GetPlayEndTime();
+         if (backwards ? (start < t && t <= end) : (start <= t && t < end)) {
+            pClip = pCandidate.get();
+            break;
+         }
+         if (backwards
+            ? (end <= t && (!pClip || end > pClip->GetPlayEndTime()))
+            : (t < start && (!pClip || start < pClip->GetPlayStartTime())))
+            pClip = pCandidate.get();
+      }
+      if (!pClip)
+         continue;
+      const auto position = pClip->TimeToSequenceSamples(std::clamp(t,
+         pClip->GetPlayStartTime(), pClip->GetPlayEndTime()));
+      for (size_t ii = 0, width = pClip->GetWidth(); ii < width; ++ii)
+         pClip->GetSequence(ii)->Prefetch(position, backwards);
+   }
+}
+
 bool WaveTrack::HandleXMLTag(const std::string_view& tag, const AttributesList &attrs)
 {
    if (tag == "wavetrack") {
@@ -4438,6 +4515,28 @@ void InspectBlocks(const TrackList &tracks, BlockInspector inspector,
       const_cast<TrackList &>(tracks), std::move( inspector ), pIDs );
 }
 
+void WaveTrack::VisitSpaceUsage(UndoSpaceUsageVisitor &visitor) const
+{
+   assert(IsLeader());
+   const auto visitBlocks = [&](const WaveClip &clip, const auto &recurse)
+      -> void {
+      for (size_t ii = 0, width = clip.GetWidth(); ii < width; ++ii)
+         for (const auto &block : *clip.GetSequenceBlockArray(ii))
+            if (const auto &pBlock = block.sb)
+               visitor.AddUnit(pBlock->GetBlockID(),
+                  [wBlock = std::weak_ptr<SampleBlock>{ pBlock }]{
+                     const auto pLocked = wBlock.lock();
+                     return pLocked ? pLocked->GetSpaceUsage() : 0ull;
+                  });
+      for (const auto &pCutLine : clip.GetCutLines())
+         recurse(*pCutLine, recurse);
+   };
+   for (const auto pChannel : TrackList::Channels(this))
+      for (const auto &pClip : pChannel->mClips)
+         if (visitor.BeginPart(pClip.get()))
+            visitBlocks(*pClip, visitBlocks);
+}
+
 static auto TrackFactoryFactory = []( AudacityProject &project ) {
    return std::make_shared< WaveTrackFactory >(
       ProjectRate::Get( project ),
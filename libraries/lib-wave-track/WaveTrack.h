@@ -253,6 +253,10 @@ public:
       const SampleBlockFactoryPtr &pFactory, sampleFormat format, double rate);
    //! Copied only in WaveTrack::Clone() !
    WaveTrack(const WaveTrack &orig, ProtectedCreationArg&&);
+   //! Copied only in WaveTrack::CloneSharing(), which shares those clips of
+   //! previous that are the same as clips of orig
+   WaveTrack(const WaveTrack &orig, ProtectedCreationArg&&,
+      const WaveTrack &previous);
 
    //! The width of every WaveClip in this track; for now always 1
    size_t GetWidth() const;
@@ -284,6 +288,7 @@ public:
    void Init(const WaveTrack &orig);
 
    TrackListHolder Clone() const override;
+   TrackListHolder CloneSharing(const Track *pPrevious) const override;
 
    friend class WaveTrackFactory;
 
@@ -518,6 +523,9 @@ public:
    const ChannelGroup *FindChannelGroup() const override;
    bool GetMute() const override;
    bool GetSolo() const override;
+   //! Prefetch the sequences of the clip playing at t, or else of the next
+   /*! @pre `IsLeader()` */
+   void Prefetch(double t, bool backwards) const override;
    //! @}
 
    ///
@@ -667,6 +675,9 @@ public:
    XMLTagHandler *HandleXMLChild(const std::string_view& tag) override;
    void WriteXML(XMLWriter &xmlFile) const override;
 
+   //! Reports clips as parts, and sample blocks as units
+   void VisitSpaceUsage(UndoSpaceUsageVisitor &visitor) const override;
+
    // Returns true if an error occurred while reading from XML
    std::optional<TranslatableString> GetErrorOpening() const override;
 
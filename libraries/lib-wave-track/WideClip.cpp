@@ -11,7 +11,8 @@
 #include "WideClip.h"
 
 WideClip::WideClip(
-   std::shared_ptr<ClipInterface> left, std::shared_ptr<ClipInterface> right)
+   std::shared_ptr<const ClipInterface> left,
+   std::shared_ptr<const ClipInterface> right)
     : mChannels { std::move(left), std::move(right) }
 {
 }
@@ -56,3 +57,31 @@ double WideClip::GetStretchRatio() const
 {
    return mChannels[0u]->GetStretchRatio();
 }
+
+ClipContentKey WideClip::GetContentKey() const
+{
+   auto key = mChannels[0u]->GetContentKey();
+   if (mChannels[1u] == nullptr || key.Empty())
+      return key;
+   auto rightKey = mChannels[1u]->GetContentKey();
+   if (rightKey.Empty())
+      return {};
+   // Separate the channels
+   key.values.push_back(-1);
+   key.owners.insert(key.owners.end(),
+      rightKey.owners.begin(), rightKey.owners.end());
+   key.values.insert(key.values.end(),
+      rightKey.values.begin(), rightKey.values.end());
+   return key;
+}
+
+std::shared_ptr<const ClipInterface> WideClip::GetSnapshot() const
+{
+   auto left = mChannels[0u]->GetSnapshot();
+   if (!left)
+      return nullptr;
+   std::shared_ptr<const ClipInterface> right;
+   if (mChannels[1u] != nullptr && !(right = mChannels[1u]->GetSnapshot()))
+      return nullptr;
+   return std::make_shared<WideClip>(std::move(left), std::move(right));
+}
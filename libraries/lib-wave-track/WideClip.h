@@ -26,8 +26,8 @@ public:
     * sample rate, play start time, play end time and stretch ratio.
     */
    WideClip(
-      std::shared_ptr<ClipInterface> left,
-      std::shared_ptr<ClipInterface> right);
+      std::shared_ptr<const ClipInterface> left,
+      std::shared_ptr<const ClipInterface> right);
 
    AudioSegmentSampleView GetSampleView(
       size_t ii, sampleCount start, size_t len, bool mayThrow) const override;
@@ -46,6 +46,12 @@ public:
 
    double GetStretchRatio() const override;
 
+   ClipContentKey GetContentKey() const override;
+
+   //! A wide clip of the snapshots of the channel clips, or null if either
+   //! has none
+   std::shared_ptr<const ClipInterface> GetSnapshot() const override;
+
 private:
-   const std::array<std::shared_ptr<ClipInterface>, 2> mChannels;
+   const std::array<std::shared_ptr<const ClipInterface>, 2> mChannels;
 };
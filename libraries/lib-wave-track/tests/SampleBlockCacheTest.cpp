@@ -0,0 +1,148 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleBlockCacheTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "SampleBlockCache.h"
+
+namespace
+{
+constexpr size_t blockSize = 256;
+constexpr size_t blockBytes = blockSize * sizeof(float);
+
+BlockSampleView MakeView(float value)
+{
+   return std::make_shared<std::vector<float>>(blockSize, value);
+}
+} // namespace
+
+TEST_CASE("SampleBlockCache")
+{
+   SampleBlockCache cache { 3 * blockBytes };
+
+   SECTION("finds what was inserted")
+   {
+      cache.Insert(1, MakeView(1));
+      const auto view = cache.Find(1);
+      REQUIRE(view);
+      REQUIRE(view->front() == 1);
+      REQUIRE(!cache.Find(2));
+      REQUIRE(cache.GetSize() == blockBytes);
+   }
+
+   SECTION("evicts the least recently inserted")
+   {
+      for (SampleBlockID id = 1; id <= 4; ++id)
+         cache.Insert(id, MakeView(id));
+      REQUIRE(!cache.Find(1));
+      REQUIRE(cache.Find(2));
+      REQUIRE(cache.Find(3));
+      REQUIRE(cache.Find(4));
+      REQUIRE(cache.GetSize() == 3 * blockBytes);
+   }
+
+   SECTION("evicts the least recently found")
+   {
+      for (SampleBlockID id = 1; id <= 3; ++id)
+         cache.Insert(id, MakeView(id));
+      // 1 becomes the most recently used, so 2 goes first
+      REQUIRE(cache.Find(1));
+      cache.Insert(4, MakeView(4));
+      REQUIRE(cache.Find(1));
+      REQUIRE(!cache.Find(2));
+      REQUIRE(cache.Find(3));
+      REQUIRE(cache.Find(4));
+   }
+
+   SECTION("replaces an entry for the same id")
+   {
+      cache.Insert(1, MakeView(1));
+      cache.Insert(1, MakeView(2));
+      REQUIRE(cache.Find(1)->front() == 2);
+      REQUIRE(cache.GetSize() == blockBytes);
+   }
+
+   SECTION("forgets erased ids, which may be reused")
+   {
+      cache.Insert(1, MakeView(1));
+      cache.Insert(2, MakeView(2));
+      cache.Erase(1);
+      REQUIRE(!cache.Find(1));
+      REQUIRE(cache.Find(2));
+      REQUIRE(cache.GetSize() == blockBytes);
+      cache.Erase(3);
+      REQUIRE(cache.GetSize() == blockBytes);
+      cache.Clear();
+      REQUIRE(!cache.Find(2));
+      REQUIRE(cache.GetSize() == 0);
+   }
+
+   SECTION("keeps views that were handed out alive after eviction")
+   {
+      cache.Insert(1, MakeView(1));
+      const auto view = cache.Find(1);
+      cache.Erase(1);
+      REQUIRE(view->size() == blockSize);
+      REQUIRE(view->back() == 1);
+   }
+
+   SECTION("shrinks to a smaller capacity, and zero disables it")
+   {
+      for (SampleBlockID id = 1; id <= 3; ++id)
+         cache.Insert(id, MakeView(id));
+      cache.SetCapacity(blockBytes);
+      REQUIRE(!cache.Find(1));
+      REQUIRE(!cache.Find(2));
+      REQUIRE(cache.Find(3));
+
+      cache.SetCapacity(0);
+      REQUIRE(!cache.IsEnabled());
+      REQUIRE(cache.GetSize() == 0);
+      cache.Insert(4, MakeView(4));
+      REQUIRE(!cache.Find(4));
+   }
+
+   SECTION("counts hits, misses and evictions")
+   {
+      for (SampleBlockID id = 1; id <= 4; ++id)
+         cache.Insert(id, MakeView(id));
+      // Inserting counts neither hits nor misses
+      auto statistics = cache.GetStatistics();
+      REQUIRE(statistics.hits == 0);
+      REQUIRE(statistics.misses == 0);
+      REQUIRE(statistics.evictions == 1);
+
+      REQUIRE(!cache.Find(1));
+      REQUIRE(cache.Find(2));
+      REQUIRE(cache.Find(4));
+      statistics = cache.GetStatistics();
+      REQUIRE(statistics.hits == 2);
+      REQUIRE(statistics.misses == 1);
+
+      // Replacement and erasure are not evictions, but shrinking is
+      cache.Insert(2, MakeView(5));
+      cache.Erase(3);
+      REQUIRE(cache.GetStatistics().evictions == 1);
+      cache.SetCapacity(blockBytes);
+      REQUIRE(cache.GetStatistics().evictions == 2);
+
+      cache.ResetStatistics();
+      statistics = cache.GetStatistics();
+      REQUIRE(statistics.hits == 0);
+      REQUIRE(statistics.misses == 0);
+      REQUIRE(statistics.evictions == 0);
+   }
+}
+
+TEST_CASE("SampleBlockCache fills only for reads of most of a block")
+{
+   REQUIRE(SampleBlockCache::ShouldFill(blockSize, blockSize));
+   REQUIRE(SampleBlockCache::ShouldFill(blockSize / 2 + 1, blockSize));
+   REQUIRE(!SampleBlockCache::ShouldFill(blockSize / 2, blockSize));
+   REQUIRE(!SampleBlockCache::ShouldFill(1, blockSize));
+}
@@ -0,0 +1,280 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleBlockReadAheadTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "SampleBlock.h"
+#include "SampleBlockCache.h"
+#include "SampleBlockReadAhead.h"
+#include "Sequence.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace
+{
+constexpr size_t blockSize = 256;
+
+class Factory;
+
+//! Float samples in memory; "decoding" them fills the factory's cache
+class Block final : public SampleBlock
+{
+public:
+   Block(Factory& factory, SampleBlockID id, std::vector<float> samples)
+       : mFactory { factory }
+       , mId { id }
+       , mSamples { std::move(samples) }
+   {
+   }
+
+   void CloseLock() noexcept override
+   {
+   }
+   SampleBlockID GetBlockID() const override
+   {
+      return mId;
+   }
+   BlockSampleView GetFloatSampleView(bool mayThrow) override;
+   size_t GetSampleCount() const override
+   {
+      return mSamples.size();
+   }
+   bool GetSummary256(float*, size_t, size_t) override
+   {
+      return false;
+   }
+   bool GetSummary64k(float*, size_t, size_t) override
+   {
+      return false;
+   }
+   size_t GetSpaceUsage() const override
+   {
+      return mSamples.size() * sizeof(float);
+   }
+   void SaveXML(XMLWriter&) override
+   {
+   }
+
+protected:
+   //! Copies from the cache if it has the block, as SqliteSampleBlock does
+   size_t DoGetSamples(
+      samplePtr dest, sampleFormat destformat, size_t sampleoffset,
+      size_t numsamples) override;
+   MinMaxRMS DoGetMinMaxRMS(size_t, size_t) override
+   {
+      return {};
+   }
+   MinMaxRMS DoGetMinMaxRMS() const override
+   {
+      return {};
+   }
+
+private:
+   Factory& mFactory;
+   const SampleBlockID mId;
+   const std::vector<float> mSamples;
+};
+
+class Factory final : public SampleBlockFactory
+{
+public:
+   SampleBlockIDs GetActiveBlockIDs() override
+   {
+      return {};
+   }
+   SampleBlockCache* GetCache() override
+   {
+      return &cache;
+   }
+
+   SampleBlockCache cache { 1 << 20 };
+   //! Blocks put in the cache
+   std::atomic<size_t> decodes { 0 };
+   //! Reads that missed the cache
+   std::atomic<size_t> directReads { 0 };
+
+protected:
+   SampleBlockPtr DoCreate(
+      constSamplePtr src, size_t numsamples, sampleFormat srcformat) override
+   {
+      std::vector<float> samples(numsamples);
+      CopySamples(
+         src, srcformat, reinterpret_cast<samplePtr>(samples.data()),
+         floatSample, numsamples, DitherType::none);
+      // Ids are unique among factories, because the read-ahead service is
+      // shared
+      static std::atomic<SampleBlockID> lastId { 0 };
+      return std::make_shared<Block>(*this, ++lastId, std::move(samples));
+   }
+   SampleBlockPtr
+   DoCreateSilent(size_t numsamples, sampleFormat srcformat) override
+   {
+      std::vector<float> silence(numsamples);
+      return DoCreate(
+         reinterpret_cast<constSamplePtr>(silence.data()), numsamples,
+         floatSample);
+   }
+   SampleBlockPtr
+   DoCreateFromXML(sampleFormat, const AttributesList&) override
+   {
+      return nullptr;
+   }
+};
+
+BlockSampleView Block::GetFloatSampleView(bool)
+{
+   if (auto view = mFactory.cache.Find(mId))
+      return view;
+   auto view = std::make_shared<std::vector<float>>(mSamples);
+   mFactory.cache.Insert(mId, view);
+   ++mFactory.decodes;
+   return view;
+}
+
+size_t Block::DoGetSamples(
+   samplePtr dest, sampleFormat destformat, size_t sampleoffset,
+   size_t numsamples)
+{
+   auto view = mFactory.cache.Find(mId);
+   if (!view)
+      ++mFactory.directReads;
+   const auto& samples = view ? *view : mSamples;
+   CopySamples(
+      reinterpret_cast<constSamplePtr>(samples.data() + sampleoffset),
+      floatSample, dest, destformat, numsamples, DitherType::none);
+   return numsamples;
+}
+
+bool WaitFor(const std::function<bool()>& condition)
+{
+   using namespace std::chrono;
+   const auto deadline = steady_clock::now() + seconds(10);
+   while (!condition())
+   {
+      if (steady_clock::now() > deadline)
+         return false;
+      std::this_thread::sleep_for(milliseconds(1));
+   }
+   return true;
+}
+
+//! A sequence of nBlocks blocks of blockSize samples, each sample different
+struct Fixture
+{
+   explicit Fixture(size_t nBlocks, bool enabled, size_t depth)
+       : samples(nBlocks * blockSize)
+   {
+      wasEnabled = SampleBlockReadAhead::IsEnabled();
+      wasDepth = SampleBlockReadAhead::Get().GetDepth();
+      SampleBlockReadAhead::SetEnabled(enabled);
+      SampleBlockReadAhead::Get().SetDepth(depth);
+
+      // Blocks of at most blockSize float samples
+      maxDiskBlockSize = Sequence::GetMaxDiskBlockSize();
+      Sequence::SetMaxDiskBlockSize(blockSize * sizeof(float));
+      pSequence = std::make_unique<Sequence>(
+         pFactory, SampleFormats { floatSample, floatSample });
+      for (size_t ii = 0; ii < samples.size(); ++ii)
+         samples[ii] = ii / float(samples.size());
+      pSequence->Append(
+         reinterpret_cast<constSamplePtr>(samples.data()), floatSample,
+         samples.size(), 1, floatSample);
+      pSequence->Flush();
+      REQUIRE(pSequence->GetBlockArray().size() == nBlocks);
+   }
+
+   ~Fixture()
+   {
+      Sequence::SetMaxDiskBlockSize(maxDiskBlockSize);
+      SampleBlockReadAhead::SetEnabled(wasEnabled);
+      SampleBlockReadAhead::Get().SetDepth(wasDepth);
+   }
+
+   bool IsCached(size_t b)
+   {
+      const auto id = pSequence->GetBlockArray()[b].sb->GetBlockID();
+      return pFactory->cache.Find(id) != nullptr;
+   }
+
+   bool WaitForDecodes(size_t count)
+   {
+      return WaitFor([&] { return pFactory->decodes == count; });
+   }
+
+   const std::shared_ptr<Factory> pFactory = std::make_shared<Factory>();
+   std::vector<float> samples;
+   std::unique_ptr<Sequence> pSequence;
+   size_t maxDiskBlockSize;
+   bool wasEnabled;
+   size_t wasDepth;
+};
+} // namespace
+
+TEST_CASE("SampleBlockReadAhead fills the cache ahead of playback")
+{
+   Fixture fixture { 6, true, 2 };
+   auto& sequence = *fixture.pSequence;
+
+   // The block holding the position, and two more
+   sequence.Prefetch(0, false);
+   REQUIRE(fixture.WaitForDecodes(3));
+   REQUIRE(fixture.IsCached(0));
+   REQUIRE(fixture.IsCached(1));
+   REQUIRE(fixture.IsCached(2));
+   REQUIRE(!fixture.IsCached(3));
+
+   // Entering the next block asks for one more block to be decoded
+   sequence.Prefetch(blockSize + 10, false);
+   REQUIRE(fixture.WaitForDecodes(4));
+   REQUIRE(fixture.IsCached(3));
+   REQUIRE(!fixture.IsCached(4));
+
+   // Backwards from the end
+   sequence.Prefetch(sequence.GetNumSamples(), true);
+   REQUIRE(fixture.WaitForDecodes(6));
+   REQUIRE(fixture.IsCached(4));
+   REQUIRE(fixture.IsCached(5));
+}
+
+TEST_CASE("Sequence::Get returns the same samples with read-ahead on and off")
+{
+   const bool enabled = GENERATE(true, false);
+   CAPTURE(enabled);
+   Fixture fixture { 6, enabled, 8 };
+   auto& sequence = *fixture.pSequence;
+
+   sequence.Prefetch(0, false);
+   if (enabled)
+      REQUIRE(fixture.WaitForDecodes(6));
+
+   // Reads of less than a block, as in playback
+   std::vector<float> result(fixture.samples.size());
+   constexpr size_t chunk = 100;
+   for (size_t start = 0; start < result.size(); start += chunk)
+   {
+      const auto len = std::min(chunk, result.size() - start);
+      REQUIRE(sequence.Get(
+         reinterpret_cast<samplePtr>(result.data() + start), floatSample,
+         start, len, true));
+   }
+   REQUIRE(result == fixture.samples);
+
+   if (enabled)
+      // All were read from the cache
+      REQUIRE(fixture.pFactory->directReads == 0);
+   else
+   {
+      REQUIRE(fixture.pFactory->decodes == 0);
+      REQUIRE(fixture.pFactory->directReads > 0);
+   }
+}
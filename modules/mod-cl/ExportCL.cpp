@@ -23,6 +23,7 @@
 #include <wx/process.h>
 #include <wx/sizer.h>
 #include <wx/textctrl.h>
+#include <wx/thread.h>
 #if defined(__WXMSW__)
 #include <wx/msw/registry.h> // for wxRegKey
 #endif
@@ -710,7 +711,9 @@ ExportResult CLExportProcessor::Process(ExportProcessorDelegate& delegate)
    while (process.IsActive()) {
       using namespace std::chrono;
       std::this_thread::sleep_for(10ms);
-      BasicUI::Yield();
+      // Split exports run this in a worker, while the main thread polls
+      if (wxIsMainThread())
+         BasicUI::Yield();
    }
 
    // Display output on error or if the user wants to see it
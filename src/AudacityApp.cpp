@@ -94,8 +94,11 @@ It handles initialization and termination by subclassing wxApp.
 #include "ProjectSettings.h"
 #include "ProjectWindow.h"
 #include "ProjectWindows.h"
+#include "RealtimeEffectWorkers.h"
+#include "SampleBlockReadAhead.h"
 #include "Sequence.h"
 #include "SelectFile.h"
+#include "StretchedClipCache.h"
 #include "TempDirectory.h"
 #include "LoadThemeResources.h"
 #include "Track.h"
@@ -1479,6 +1482,10 @@ bool AudacityApp::InitPart2()
       Sequence::SetMaxDiskBlockSize(lval);
    }
 
+   SampleBlockReadAhead::SetEnabled(ReadAheadEnabled.Read());
+   StretchedClipCache::SetEnabled(StretchedClipCacheEnabled.Read());
+   RealtimeEffectWorkers::SetEnabled(RealtimeEffectWorkersEnabled.Read());
+
    if (playingJournal)
       Journal::SetInputFileName( journalFileName );
 
@@ -1571,7 +1578,7 @@ bool AudacityApp::InitPart2()
       auto newPlugins = PluginManager::Get().CheckPluginUpdates();
       if(!newPlugins.empty())
       {
-         PluginStartupRegistration reg(newPlugins);
+         PluginStartupRegistration reg(newPlugins, true);
          reg.Run();
          failedPlugins = reg.GetFailedPluginsPaths();
       }
@@ -167,14 +167,21 @@ public:
             ProjectWindow::Get( *mProject ).HandleResize(); // Adjust scrollers for NEW track sizes.
          } );
 
+         // Decode runs of files between MIDI files at once
+         auto &manager = ProjectFileManager::Get( *mProject );
+         FilePaths batch;
          for (const auto &name : sortednames) {
 #ifdef USE_MIDI
-            if (FileNames::IsMidi(name))
+            if (FileNames::IsMidi(name)) {
+               manager.Import(batch);
+               batch.clear();
                DoImportMIDI( *mProject, name );
+            }
             else
 #endif
-               ProjectFileManager::Get( *mProject ).Import(name);
+               batch.push_back(name);
          }
+         manager.Import(batch);
 
          auto &window = ProjectWindow::Get( *mProject );
          window.ZoomAfterImport(nullptr);
@@ -45,6 +45,8 @@ public:
             AddSection(S, FrameStatistics::SectionID::WaveBitmapCachePreprocess);
             S.AddFixedText(Verbatim("WaveBitmapCache Lookups"));
             AddSection(S, FrameStatistics::SectionID::WaveBitmapCache);
+            S.AddFixedText(Verbatim("Waveform Cache Columns"));
+            AddCache(S, FrameStatistics::CacheID::WaveformCache);
          }
          S.EndVerticalLay();
       }
@@ -68,6 +70,10 @@ public:
                if (mSections[i].Dirty)
                   SectionUpdated(FrameStatistics::SectionID(i));
             }
+            // Counters change without notification, so poll them
+            for (size_t i = 0; i < size_t(FrameStatistics::CacheID::Count);
+                 ++i)
+               CacheUpdated(FrameStatistics::CacheID(i));
          });
    }
 
@@ -96,6 +102,24 @@ private:
       SectionUpdated(sectionID);
    }
 
+   void AddCache(ShuttleGui& S, FrameStatistics::CacheID cacheID)
+   {
+      S.StartMultiColumn(2, wxEXPAND);
+      {
+         S.AddFixedText(Verbatim("Hits:"));
+         mCaches[size_t(cacheID)].Hits = S.AddVariableText({});
+
+         S.AddFixedText(Verbatim("Misses:"));
+         mCaches[size_t(cacheID)].Misses = S.AddVariableText({});
+
+         S.AddFixedText(Verbatim("Hit rate:"));
+         mCaches[size_t(cacheID)].HitRate = S.AddVariableText({});
+      }
+      S.EndMultiColumn();
+
+      CacheUpdated(cacheID);
+   }
+
    wxString FormatTime (FrameStatistics::Duration duration)
    {
       using namespace std::chrono;
@@ -130,6 +154,26 @@ private:
       section.Dirty = false;
    }
 
+   void CacheUpdated(FrameStatistics::CacheID cacheID)
+   {
+      Cache& cache = mCaches[size_t(cacheID)];
+      const auto& counter = FrameStatistics::GetCacheCounter(cacheID);
+
+      const auto hits = counter.GetHits();
+      const auto misses = counter.GetMisses();
+      if (hits == cache.LastHits && misses == cache.LastMisses)
+         return;
+
+      cache.Hits->SetLabel(std::to_string(hits));
+      cache.Misses->SetLabel(std::to_string(misses));
+      cache.HitRate->SetLabel(hits + misses > 0
+         ? wxString(std::to_string(100.0 * counter.GetHitRate()) + " %")
+         : wxString(L"n/a"));
+
+      cache.LastHits = hits;
+      cache.LastMisses = misses;
+   }
+
    struct Section final
    {
       wxStaticText* Last;
@@ -143,6 +187,18 @@ private:
 
    Section mSections[size_t(FrameStatistics::SectionID::Count)];
 
+   struct Cache final
+   {
+      wxStaticText* Hits;
+      wxStaticText* Misses;
+      wxStaticText* HitRate;
+
+      size_t LastHits { size_t(-1) };
+      size_t LastMisses { size_t(-1) };
+   };
+
+   Cache mCaches[size_t(FrameStatistics::CacheID::Count)];
+
    Observer::Subscription mStatisticsUpdated;
 };
 
@@ -70,35 +70,13 @@ struct SpaceUsageCalculator {
 
    void Calculate( UndoManager &manager )
    {
-      SampleBlockIDSet seen;
-
-      // After copies and pastes, a block file may be used in more than
-      // one place in one undo history state, and it may be used in more than
-      // one undo history state.  It might even be used in two states, but not
-      // in another state that is between them -- as when you have state A,
-      // then make a cut to get state B, but then paste it back into state C.
-
-      // So be sure to count each block file once only, in the last undo item that
-      // contains it.
-
-      // Why the last and not the first? Because the user of the History dialog
-      // may DELETE undo states, oldest first.  To reclaim disk space you must
-      // DELETE all states containing the block file.  So the block file's
-      // contribution to space usage should be counted only in that latest
-      // state.
-
-      manager.VisitStates(
-         [this, &seen](const UndoStackElem &elem) {
-            // Scan all tracks at current level
-            if (auto pTracks = TrackList::FindUndoTracks(elem))
-               space.push_back(CalculateUsage(*pTracks, seen));
-         },
-         true // newest state first
-      );
+      // The manager counts each block once, in the last undo item that
+      // contains it, and keeps those counts as states come and go
+      space = manager.GetStateSpaceUsages();
 
-      // Count the usage of the clipboard separately, using another set.  Do not
-      // multiple-count any block occurring multiple times within the clipboard.
-      seen.clear();
+      // Count the usage of the clipboard separately.  Do not multiple-count
+      // any block occurring multiple times within the clipboard.
+      SampleBlockIDSet seen;
       clipboardSpaceUsage = CalculateUsage(
          Clipboard::Get().GetTracks(), seen);
 
@@ -286,7 +264,7 @@ void HistoryDialog::DoUpdate()
    calculator.Calculate( *mManager );
 
    // point to size for oldest state
-   auto iter = calculator.space.rbegin();
+   auto iter = calculator.space.begin();
 
    mList->DeleteAllItems();
 
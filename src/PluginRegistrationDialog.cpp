@@ -897,7 +897,9 @@ void PluginRegistrationDialog::OnRescan(wxCommandEvent& WXUNUSED(evt))
       auto newPlugins = PluginManager::Get().CheckPluginUpdates();
       if (!newPlugins.empty())
       {
-         PluginStartupRegistration reg(newPlugins);
+         //The user asks for a rescan to see what the hosts find now, so do
+         //not answer from the validation cache; results still refresh it
+         PluginStartupRegistration reg(newPlugins, false);
          reg.Run();
 
          failedPlugins = reg.GetFailedPluginsPaths();
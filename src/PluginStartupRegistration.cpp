@@ -10,6 +10,7 @@
 
 #include "PluginStartupRegistration.h"
 
+#include <algorithm>
 #include <thread>
 
 #include <wx/log.h>
@@ -22,6 +23,8 @@
 
 #include "PluginManager.h"
 #include "PluginDescriptor.h"
+#include "PluginValidationCache.h"
+#include "Prefs.h"
 #include "wxPanelWrapper.h"
 
 namespace
@@ -30,6 +33,15 @@ namespace
       OnPluginScanTimeout = wxID_HIGHEST + 1,
    };
 
+   //How often the requests of all hosts are checked for timeout
+   constexpr auto TimeoutCheckInterval = std::chrono::milliseconds(500);
+
+   constexpr size_t MaxPluginValidationHosts = 8;
+
+   //Number of plugin host processes to validate with at once, 0 to use
+   //one for each processor, up to MaxPluginValidationHosts
+   IntSetting PluginValidationHosts{ L"/Plugins/ValidationHosts", 0 };
+
    class PluginScanDialog : public wxDialogWrapper
    {
       wxStaticText* mText{nullptr};
@@ -127,18 +139,17 @@ namespace
    };
 }
 
-PluginStartupRegistration::PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess)
+PluginStartupRegistration::Slot::Slot(PluginStartupRegistration& owner)
+   : mOwner(owner)
 {
-   for(auto& p : pluginsToProcess)
-      mPluginsToProcess.push_back(p);
 }
 
-void PluginStartupRegistration::OnInternalError(const wxString& error)
+void PluginStartupRegistration::Slot::OnInternalError(const wxString& error)
 {
-   StopWithError(error);
+   mOwner.StopWithError(error);
 }
 
-void PluginStartupRegistration::OnPluginFound(const PluginDescriptor& desc)
+void PluginStartupRegistration::Slot::OnPluginFound(const PluginDescriptor& desc)
 {
    if(!mValidProviderFound)
       mFailedPluginsCache.clear();
@@ -149,7 +160,7 @@ void PluginStartupRegistration::OnPluginFound(const PluginDescriptor& desc)
    PluginManager::Get().RegisterPlugin(PluginDescriptor { desc });
 }
 
-void PluginStartupRegistration::OnPluginValidationFailed(const wxString& providerId, const wxString& path)
+void PluginStartupRegistration::Slot::OnPluginValidationFailed(const wxString& providerId, const wxString& path)
 {
    PluginID ID = providerId + wxT("_") + path;
    PluginDescriptor pluginDescriptor;
@@ -165,41 +176,55 @@ void PluginStartupRegistration::OnPluginValidationFailed(const wxString& provide
    mFailedPluginsCache.push_back(std::move(pluginDescriptor));
 }
 
+void PluginStartupRegistration::Slot::OnValidationFinished()
+{
+   mOwner.OnValidationFinished(*this);
+}
+
+PluginStartupRegistration::PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess,
+                                                     bool useValidationCache)
+   : mUseValidationCache(useValidationCache)
+{
+   for(auto& p : pluginsToProcess)
+      mPluginsToProcess.push_back(p);
+}
 
-void PluginStartupRegistration::OnValidationFinished()
+void PluginStartupRegistration::OnValidationFinished(Slot& slot)
 {
-   ++mCurrentPluginProviderIndex;
-   if(mValidProviderFound ||
-      mPluginsToProcess[mCurrentPluginIndex].second.size() == mCurrentPluginProviderIndex)
+   const auto& providers = mPluginsToProcess[*slot.mPluginIndex].second;
+   ++slot.mPluginProviderIndex;
+   if(slot.mValidProviderFound ||
+      providers.size() == slot.mPluginProviderIndex)
    {
-      if(!mFailedPluginsCache.empty())
+      if(!slot.mFailedPluginsCache.empty())
       {
          //we've tried all providers associated with same module path...
-         if(!mValidProviderFound)
+         if(!slot.mValidProviderFound)
          {
             //...but none of them succeeded
-            mFailedPluginsPaths.push_back(mFailedPluginsCache[0].GetPath());
+            mFailedPluginsPaths.push_back(slot.mFailedPluginsCache[0].GetPath());
 
             //Same plugin path, but different providers, we need to register all of them
-            for(auto& desc : mFailedPluginsCache)
+            for(auto& desc : slot.mFailedPluginsCache)
                PluginManager::Get().RegisterPlugin(std::move(desc));
          }
          //plugin type was detected, but plugin instance validation has failed
          else
          {
-            for(auto& desc : mFailedPluginsCache)
+            for(auto& desc : slot.mFailedPluginsCache)
             {
                if(desc.GetPluginType() != PluginTypeStub)
                   mFailedPluginsPaths.push_back(desc.GetPath());
             }
          }
       }
-      ++mCurrentPluginIndex;
-      mCurrentPluginProviderIndex = 0;
-      mValidProviderFound = false;
-      mFailedPluginsCache.clear();
+      ++mNumPluginsProcessed;
+      slot.mPluginIndex.reset();
+      slot.mPluginProviderIndex = 0;
+      slot.mValidProviderFound = false;
+      slot.mFailedPluginsCache.clear();
    }
-   ProcessNext();
+   ProcessNext(slot);
 }
 
 const std::vector<wxString>& PluginStartupRegistration::GetFailedPluginsPaths() const noexcept
@@ -207,8 +232,14 @@ const std::vector<wxString>& PluginStartupRegistration::GetFailedPluginsPaths()
    return mFailedPluginsPaths;
 }
 
-void PluginStartupRegistration::Run(std::chrono::seconds timeout)
+void PluginStartupRegistration::Run(std::chrono::seconds timeout, size_t hosts)
 {
+   if(const auto preferred = PluginValidationHosts.Read(); hosts == 0 && preferred > 0)
+      hosts = std::min<size_t>(preferred, MaxPluginValidationHosts);
+   if(hosts == 0)
+      hosts = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MaxPluginValidationHosts);
+   hosts = std::clamp<size_t>(hosts, 1, std::max<size_t>(1, mPluginsToProcess.size()));
+
    PluginScanDialog dialog(nullptr, wxID_ANY, XO("Searching for plugins"));
    wxTimer timeoutTimer(&dialog, OnPluginScanTimeout);
    mScanDialog = &dialog;
@@ -218,28 +249,35 @@ void PluginStartupRegistration::Run(std::chrono::seconds timeout)
    dialog.Bind(wxEVT_BUTTON, [this](wxCommandEvent& evt) {
       evt.Skip();
       if(evt.GetId() == wxID_IGNORE)
-         Skip();
+      {
+         if(auto slot = GetOldestSlot())
+            Skip(*slot);
+      }
    });
    dialog.Bind(wxEVT_TIMER, [this](wxTimerEvent& evt) {
       if(evt.GetId() == OnPluginScanTimeout)
-      {
-         if(mValidator && mValidator->InactiveSince() < mRequestStartTime)
-            Skip();
-         //else
-         //   wxMessageBox("Please check for plugin popups!");
-      }
+         OnTimer();
       else
          evt.Skip();
    });
    dialog.Bind(wxEVT_CLOSE_WINDOW, [this](wxCloseEvent& evt) {
       evt.Skip();
-      mValidator.reset();
+      if(auto timer = mTimeoutTimer.get())
+         timer->Stop();
+      mSlots.clear();
       PluginManager::Get().Save();
+      PluginValidationCache::Get().Save();
       PluginManager::Get().NotifyPluginsChanged();
    });
 
    dialog.CenterOnScreen();
-   ProcessNext();
+   for(size_t i = 0; i < hosts; ++i)
+      mSlots.push_back(std::make_unique<Slot>(*this));
+   //Slots are cleared if the dialog closes on error
+   for(size_t i = 0; i < mSlots.size(); ++i)
+      ProcessNext(*mSlots[i]);
+   if(mTimeout > std::chrono::system_clock::duration::zero())
+      timeoutTimer.Start(TimeoutCheckInterval.count());
    dialog.ShowModal();
 }
 
@@ -249,34 +287,33 @@ void PluginStartupRegistration::Stop()
       dialog->Close();
 }
 
-void PluginStartupRegistration::Skip()
+void PluginStartupRegistration::Skip(Slot& slot)
 {
    //Drop current validator, no more callbacks will be received from now
-   mValidator->SetDelegate(nullptr);
+   slot.mValidator->SetDelegate(nullptr);
    //While on Linux and MacOS socket `shutdown()` wakes up `select()` almost
    //immediately, on Windows it sometimes get delayed on unspecified amount
    //of time. As we do not expect any data we can safely move remaining
    //operations to another thread.
-   std::thread([validator = std::shared_ptr<AsyncPluginValidator>(std::move(mValidator))]{ }).detach();
+   std::thread([validator = std::shared_ptr<AsyncPluginValidator>(std::move(slot.mValidator))]{ }).detach();
 
-   if(!mValidProviderFound)
+   const auto& [path, providers] = mPluginsToProcess[*slot.mPluginIndex];
+   if(!slot.mValidProviderFound)
    {
       // Validator didn't report anything yet or it tried
       // one or more providers that didn't recognize the plugin.
       // In that case we assume that none of the remaining providers
       // can recognize that plugin.
       // Note: create stub `PluginDescriptors` for each associated provider
-      for(;mCurrentPluginProviderIndex < mPluginsToProcess[mCurrentPluginIndex].second.size(); ++mCurrentPluginProviderIndex)
-         OnPluginValidationFailed(
-            mPluginsToProcess[mCurrentPluginIndex].second[mCurrentPluginProviderIndex],
-            mPluginsToProcess[mCurrentPluginIndex].first);
-      mCurrentPluginProviderIndex = mPluginsToProcess[mCurrentPluginIndex].second.size() - 1;
+      for(;slot.mPluginProviderIndex < providers.size(); ++slot.mPluginProviderIndex)
+         slot.OnPluginValidationFailed(providers[slot.mPluginProviderIndex], path);
+      slot.mPluginProviderIndex = providers.size() - 1;
    }
    //else
    //    Don't assume that `OnValidationFinished()` and `OnPluginFound()`
    //    aren't deferred within run loop
 
-   OnValidationFinished();
+   OnValidationFinished(slot);
 }
 
 void PluginStartupRegistration::StopWithError(const wxString& msg)
@@ -286,33 +323,79 @@ void PluginStartupRegistration::StopWithError(const wxString& msg)
    Stop();
 }
 
-void PluginStartupRegistration::ProcessNext()
+void PluginStartupRegistration::OnTimer()
 {
-   if(mCurrentPluginIndex == mPluginsToProcess.size())
+   using namespace std::chrono;
+
+   const auto now = system_clock::now();
+   //Slots are cleared if the dialog closes
+   for(size_t i = 0; i < mSlots.size(); ++i)
    {
-      Stop();
-      return;
+      auto& slot = mSlots[i];
+      if(!slot->mPluginIndex || !slot->mValidator)
+         continue;
+      //The host reports when it takes a request, so this measures
+      //the time spent on the plugin, and not the time to start the host
+      const auto since = std::max(slot->mRequestStartTime, slot->mValidator->InactiveSince());
+      if(now - since >= mTimeout)
+         Skip(*slot);
+      //else
+      //   wxMessageBox("Please check for plugin popups!");
    }
+}
 
-   try
+PluginStartupRegistration::Slot* PluginStartupRegistration::GetOldestSlot() const
+{
+   Slot* result = nullptr;
+   for(auto& slot : mSlots)
+   {
+      if(slot->mPluginIndex &&
+         (result == nullptr || slot->mRequestStartTime < result->mRequestStartTime))
+         result = slot.get();
+   }
+   return result;
+}
+
+void PluginStartupRegistration::UpdateProgress()
+{
+   if(auto dialog = static_cast<PluginScanDialog*>(mScanDialog.get()))
+   {
+      const auto progress = static_cast<float>(mNumPluginsProcessed) / static_cast<float>(mPluginsToProcess.size());
+      const auto slot = GetOldestSlot();
+      dialog->UpdateProgress(
+         slot ? mPluginsToProcess[*slot->mPluginIndex].first : wxString{},
+         progress);
+   }
+}
+
+void PluginStartupRegistration::ProcessNext(Slot& slot)
+{
+   if(!slot.mPluginIndex)
    {
-      if(auto dialog = static_cast<PluginScanDialog*>(mScanDialog.get()))
+      if(mNextPluginIndex == mPluginsToProcess.size())
       {
-         const auto progress = static_cast<float>(mCurrentPluginIndex) / static_cast<float>(mPluginsToProcess.size());
-         dialog->UpdateProgress(
-            mPluginsToProcess[mCurrentPluginIndex].first,
-            progress);
+         //Idle until the others are done
+         if(mNumPluginsProcessed == mPluginsToProcess.size())
+            Stop();
+         else
+            UpdateProgress();
+         return;
       }
-      if(!mValidator)
-         mValidator = std::make_unique<AsyncPluginValidator>(*this);
+      slot.mPluginIndex = mNextPluginIndex++;
+   }
 
-      mValidator->Validate(
-         mPluginsToProcess[mCurrentPluginIndex].second[mCurrentPluginProviderIndex],
-         mPluginsToProcess[mCurrentPluginIndex].first
+   try
+   {
+      if(!slot.mValidator)
+         slot.mValidator = std::make_unique<AsyncPluginValidator>(slot);
+
+      slot.mRequestStartTime = std::chrono::system_clock::now();
+      UpdateProgress();
+      slot.mValidator->Validate(
+         mPluginsToProcess[*slot.mPluginIndex].second[slot.mPluginProviderIndex],
+         mPluginsToProcess[*slot.mPluginIndex].first,
+         mUseValidationCache
       );
-      mRequestStartTime = std::chrono::system_clock::now();
-      if(auto timer = mTimeoutTimer.get())
-         timer->StartOnce(std::chrono::duration_cast<std::chrono::milliseconds>(mTimeout).count());
    }
    catch(std::exception& e)
    {
@@ -323,4 +406,3 @@ void PluginStartupRegistration::ProcessNext()
       StopWithError("unknown error");
    }
 }
-
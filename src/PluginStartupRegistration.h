@@ -14,50 +14,78 @@
 #include <map>
 #include <memory>
 #include <chrono>
+#include <optional>
 #include <wx/string.h>
 #include <wx/timer.h>
 #include "AsyncPluginValidator.h"
 #include "wxPanelWrapper.h"
 
 ///Helper class that passes plugins provided in constructor
-///to plugin validator, then "good" plugins are registered in
-///PluginManager. 
-class PluginStartupRegistration final :
-   public AsyncPluginValidator::Delegate
+///to plugin validators, then "good" plugins are registered in
+///PluginManager. Several validators, each with its own host process,
+///may process different modules at the same time.
+class PluginStartupRegistration final
 {
-   std::unique_ptr<AsyncPluginValidator> mValidator;
+   ///Validates one module at a time, trying the providers
+   ///associated with it in turn
+   class Slot final : public AsyncPluginValidator::Delegate
+   {
+      PluginStartupRegistration& mOwner;
+   public:
+      explicit Slot(PluginStartupRegistration& owner);
+
+      std::unique_ptr<AsyncPluginValidator> mValidator;
+      ///Index of the module in progress, if any
+      std::optional<size_t> mPluginIndex;
+      size_t mPluginProviderIndex{0};
+      bool mValidProviderFound{false};
+      std::vector<PluginDescriptor> mFailedPluginsCache;
+      std::chrono::system_clock::time_point mRequestStartTime{};
+
+      void OnInternalError(const wxString& error) override;
+      void OnPluginFound(const PluginDescriptor& desc) override;
+      void OnPluginValidationFailed(const wxString& providerId, const wxString& path) override;
+      void OnValidationFinished() override;
+   };
+
+   std::vector<std::unique_ptr<Slot>> mSlots;
    std::vector<std::pair<wxString, std::vector<wxString>>> mPluginsToProcess;
-   size_t mCurrentPluginIndex{0};
-   size_t mCurrentPluginProviderIndex{0};
-   bool mValidProviderFound{false};
+   size_t mNextPluginIndex{0};
+   size_t mNumPluginsProcessed{0};
    std::vector<wxString> mFailedPluginsPaths;
-   std::vector<PluginDescriptor> mFailedPluginsCache;
    wxWeakRef<wxDialogWrapper> mScanDialog;
    wxWeakRef<wxTimer> mTimeoutTimer;
    std::chrono::system_clock::duration mTimeout{};
-   std::chrono::system_clock::time_point mRequestStartTime{};
+   const bool mUseValidationCache;
 public:
 
-   PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess);
+   ///@param useValidationCache Whether modules that did not change since their
+   ///last validation are answered from PluginValidationCache, without a host.
+   ///Meant for the scan at startup; a rescan requested by the user passes false.
+   PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess,
+                             bool useValidationCache);
 
    ///Starts validation, showing dialog that blocks execution until
    ///process is complete or canceled
    ///@param timeout Time allowed to spend on a single plugin validation.
    ///Pass 0 to disable timeout.
-   void Run(std::chrono::seconds timeout = std::chrono::seconds(30));
+   ///@param hosts Number of plugin host processes to use.
+   ///Pass 0 to use the preference.
+   void Run(std::chrono::seconds timeout = std::chrono::seconds(30), size_t hosts = 0);
 
    ///Returns list of paths of plugins that didn't pass validation for some reason
    const std::vector<wxString>& GetFailedPluginsPaths() const noexcept;
 
-   void OnInternalError(const wxString& error) override;
-   void OnPluginFound(const PluginDescriptor& desc) override;
-   void OnPluginValidationFailed(const wxString& providerId, const wxString& path) override;
-   void OnValidationFinished() override;
-
 private:
-   
+
    void Stop();
-   void Skip();
+   void Skip(Slot& slot);
    void StopWithError(const wxString& msg);
-   void ProcessNext();
+   ///Sends the next request of the slot, taking the next module if it has none
+   void ProcessNext(Slot& slot);
+   void OnValidationFinished(Slot& slot);
+   void OnTimer();
+   ///The busy slot that has waited the longest, if any
+   Slot* GetOldestSlot() const;
+   void UpdateProgress();
 };
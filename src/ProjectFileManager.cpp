@@ -36,6 +36,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "SelectUtilities.h"
 #include "SelectionState.h"
 #include "Tags.h"
+#include "TaskPool.h"
 #include "TempDirectory.h"
 #include "TrackPanelAx.h"
 #include "TrackPanel.h"
@@ -46,6 +47,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "Import.h"
 #include "ImportProgressListener.h"
 #include "ImportPlugin.h"
+#include "ImportUtils.h"
 #include "import/ImportMIDI.h"
 #include "import/ImportStreamDialog.h"
 #include "toolbars/SelectionBar.h"
@@ -58,7 +60,11 @@ Paul Licameli split from AudacityProject.cpp
 
 #include "HelpText.h"
 
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <optional>
+#include <thread>
 
 #include "RealtimeEffectList.h"
 #include "tracks/playabletrack/wavetrack/WaveTrackUtils.h"
@@ -1448,6 +1454,192 @@ bool ProjectFileManager::Import(
    return true;
 }
 
+namespace {
+//! One file of a batch import, which a worker thread decodes
+struct BatchImportItem final : ImportProgressListener
+{
+   explicit BatchImportItem(const FilePath &fileName)
+      : fileName{ fileName }
+   {}
+
+   bool OnImportFileOpened(ImportFileHandle &) override { return true; }
+
+   // The main thread, not this one, forwards the request to cancel or stop
+   // to the handle
+   void OnImportProgress(double value) override { progress = value; }
+
+   void OnImportResult(ImportResult value) override { result = value; }
+
+   const FilePath fileName;
+   //! Null if the file must be imported in turn
+   std::unique_ptr<ImportFileHandle> pHandle;
+   std::shared_ptr<Tags> pTags;
+   TrackHolders tracks;
+   std::future<void> done;
+   std::atomic<double> progress{ 0 };
+   ImportResult result{ ImportResult::Error };
+};
+
+bool MustImportInTurn(const FilePath &fileName)
+{
+   // These recur into Import, or show their own dialogs while importing
+   const auto extension = fileName.AfterLast('.');
+   return extension.IsSameAs(wxT("lof"), false)
+      || extension.IsSameAs(wxT("aup"), false)
+      || extension.IsSameAs(wxT("aup3"), false)
+#ifdef USE_MIDI
+      || FileNames::IsMidi(fileName)
+#endif
+   ;
+}
+}
+
+void ProjectFileManager::Import(
+   const FilePaths &fileNames, bool addToHistory /* = true */)
+{
+   if (fileNames.size() < 2) {
+      for (const auto &fileName : fileNames)
+         Import(fileName, addToHistory);
+      return;
+   }
+
+   auto &project = mProject;
+   auto busy = valueRestorer( project.mbBusyImporting, true );
+
+   auto request = BasicUI::ProgressResult::Success;
+   std::vector<std::unique_ptr<BatchImportItem>> items;
+   {
+      // Open the files and choose their streams in turn, in this thread
+      ImportProgress importProgress(project);
+      for (const auto &fileName : fileNames) {
+         auto pItem = std::make_unique<BatchImportItem>(fileName);
+         if (!MustImportInTurn(fileName)) {
+            bool declined = false;
+            pItem->pHandle =
+               Importer::Get().Open(project, fileName, importProgress, declined);
+            if (declined)
+               continue;
+         }
+         items.push_back(std::move(pItem));
+      }
+   }
+
+   // Decode in worker threads; each file gets its own copy of the tags
+   const auto oldTags = Tags::Get( project ).shared_from_this();
+   auto &trackFactory = WaveTrackFactory::Get( project );
+   ImportUtils::FormatPreferenceScope formatScope;
+   CancellationToken token;
+   // Forward the choice made in this thread to the files still decoding,
+   // whose import loops check it.  Repeat it at each poll, in case an import
+   // had not yet begun and then cleared it.
+   const auto forwardRequest = [&](BatchImportItem &item){
+      if (request == BasicUI::ProgressResult::Cancelled)
+         item.pHandle->Cancel();
+      else if (request == BasicUI::ProgressResult::Stopped)
+         item.pHandle->Stop();
+   };
+   auto wait = finally([&]{
+      // Don't leave workers using the items, even if this thread throws
+      token.Cancel();
+      request = BasicUI::ProgressResult::Cancelled;
+      for (auto &pItem : items)
+         if (pItem->done.valid())
+            while (pItem->done.wait_for(std::chrono::milliseconds(50)) !=
+               std::future_status::ready)
+               forwardRequest(*pItem);
+   });
+   size_t nDecoding = 0;
+   for (auto &pItem : items) {
+      if (!pItem->pHandle)
+         continue;
+      ++nDecoding;
+      pItem->pTags = oldTags->Duplicate();
+      pItem->done = TaskPool::Get().Submit([&item = *pItem, &trackFactory]{
+         item.pHandle->Import(
+            item, &trackFactory, item.tracks, item.pTags.get());
+      }, TaskPriority::High, token);
+   }
+
+   if (nDecoding > 0) {
+      constexpr double ProgressSteps { 1000.0 };
+      auto pDialog = BasicUI::MakeProgress(
+         XP("Importing %d file", "Importing %d files", 0)(nDecoding), {});
+      while (true) {
+         size_t nDone = 0;
+         double total = 0;
+         for (auto &pItem : items) {
+            if (!pItem->pHandle)
+               continue;
+            if (pItem->done.wait_for(std::chrono::seconds(0)) ==
+                std::future_status::ready) {
+               ++nDone;
+               total += 1.0;
+            }
+            else {
+               total += pItem->progress;
+               forwardRequest(*pItem);
+            }
+         }
+         if (nDone == nDecoding)
+            break;
+         if (pDialog) {
+            const auto result = pDialog->Poll(total * ProgressSteps,
+               nDecoding * ProgressSteps,
+               XO("%d of %d files imported").Format(nDone, nDecoding));
+            if (request == BasicUI::ProgressResult::Success &&
+                (result == BasicUI::ProgressResult::Cancelled ||
+                 result == BasicUI::ProgressResult::Stopped)) {
+               // Files not yet started are skipped, in either case
+               request = result;
+               token.Cancel();
+            }
+         }
+         std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      }
+   }
+
+   // Add the results in the given order, as if imported one by one
+   for (auto &pItem : items) {
+      auto &item = *pItem;
+      if (!item.pHandle) {
+         // Import does what is special for this file, or explains why it
+         // could not be opened
+         Import(item.fileName, addToHistory);
+         continue;
+      }
+      try {
+         item.done.get();
+      }
+      catch (const TaskCancelled &) {
+         continue;
+      }
+      if (item.result == ImportProgressListener::ImportResult::Cancelled)
+         continue;
+
+      auto &tracks = item.tracks;
+      tracks.erase(std::remove_if(tracks.begin(), tracks.end(),
+         [](auto &pList){ return pList->empty(); }), tracks.end());
+      if ((item.result == ImportProgressListener::ImportResult::Success ||
+           item.result == ImportProgressListener::ImportResult::Stopped) &&
+          !tracks.empty()) {
+         // Keep what this file changed in the tags that all files started
+         // from, over the changes of files before it
+         auto newTags = Tags::Get( project ).Duplicate();
+         for (const auto &[name, value] : item.pTags->GetRange())
+            if (oldTags->GetTag(name) != value)
+               newTags->SetTag(name, value);
+         Tags::Set( project, newTags );
+
+         if (addToHistory)
+            FileHistory::Global().Append(item.fileName);
+         AddImportedTracks(item.fileName, std::move(tracks));
+      }
+      else if (request == BasicUI::ProgressResult::Success)
+         // Another plug-in may succeed, or else Import explains the failure
+         Import(item.fileName, addToHistory);
+   }
+}
+
 #include "Clipboard.h"
 #include "ShuttleGui.h"
 #include "HelpSystem.h"
@@ -97,6 +97,15 @@ public:
    bool Import(const FilePath &fileName,
                bool addToHistory = true);
 
+   //! Import files as if one by one in the given order, but decode them at
+   //! once in worker threads, with one progress dialog
+   /*!
+    Files that need the main thread, such as lists of files, projects, and
+    MIDI, and files that fail to decode, are imported in turn with the
+    overload for one file
+    */
+   void Import(const FilePaths &fileNames, bool addToHistory = true);
+
    void Compact();
 
    void AddImportedTracks(const FilePath &fileName,
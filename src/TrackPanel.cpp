@@ -86,6 +86,8 @@ is time to refresh some aspect of the screen.
 #include "tracks/ui/TrackControls.h"
 #include "tracks/ui/ChannelView.h"
 #include "tracks/ui/ChannelVRulerControls.h"
+#include "tracks/playabletrack/wavetrack/ui/SpectrumCache.h"
+#include "tracks/playabletrack/wavetrack/ui/WaveformCache.h"
 
 //This loads the appropriate set of cursors, depending on platform.
 #include "../images/Cursors.h"
@@ -338,6 +340,24 @@ TrackPanel::TrackPanel(wxWindow * parent, wxWindowID id,
    mProjectRulerInvalidatedSubscription =
       ProjectTimeRuler::Get(*theProject).GetRuler().Subscribe([this](auto mode) { Refresh(); });
 
+   // Repaint the track whose waveform columns computed in the background are
+   // ready, if it is in this project
+   mWaveformCacheSubscription = WaveClipWaveformCache::Updates()
+      .Subscribe([this](const WaveformCacheUpdateMessage &message) {
+         for (auto pTrack : GetTracks()->Any<WaveTrack>()) {
+            const auto &clips = pTrack->GetClips();
+            if (std::any_of(clips.begin(), clips.end(),
+               [&](const auto &pClip){ return pClip.get() == message.pClip; }))
+            {
+               RefreshTrack(pTrack);
+               break;
+            }
+         }
+      });
+   // Repaint to continue spectrograms left partly computed
+   mSpectrumCacheSubscription = WaveClipSpectrumCache::Updates()
+      .Subscribe([this](const SpectrumCacheUpdateMessage&) { Refresh(false); });
+
    UpdatePrefs();
 }
 
@@ -195,6 +195,8 @@ protected:
       , mRealtimeEffectManagerSubscription
       , mSyncLockSubscription
       , mProjectRulerInvalidatedSubscription
+      , mWaveformCacheSubscription
+      , mSpectrumCacheSubscription
    ;
 
    TrackPanelListener *mListener;
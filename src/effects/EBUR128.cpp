@@ -9,16 +9,18 @@ Max Maisel
 ***********************************************************************/
 
 #include "EBUR128.h"
+#include <algorithm>
 #include <cstring>
 
 EBUR128::EBUR128(double rate, size_t channels)
    : mChannelCount{ channels }
    , mRate{ rate }
-   , mBlockSize( ceil(0.4 * mRate) ) // 400 ms blocks
+   , mBlockSize( BlockSize(mRate) ) // 400 ms blocks
    , mBlockOverlap( ceil(0.1 * mRate) ) // 100 ms overlap
 {
    mLoudnessHist.reinit(HIST_BIN_COUNT, false);
    mBlockRingBuffer.reinit(mBlockSize);
+   mFilterBuffer.reinit(mBlockOverlap);
    mWeightingFilter.reinit(mChannelCount, false);
    for(size_t channel = 0; channel < mChannelCount; ++channel)
       mWeightingFilter[channel] = CalcWeightingFilter(mRate);
@@ -112,6 +114,66 @@ void EBUR128::NextSample()
    ++mSampleCount;
 }
 
+void EBUR128::ProcessSamples(const float *const buffers[], size_t len)
+{
+   ProcessSamples(buffers, len, true);
+}
+
+void EBUR128::WarmUp(const float *const buffers[], size_t len)
+{
+   ProcessSamples(buffers, len, false);
+}
+
+void EBUR128::ProcessSamples(const float *const buffers[], size_t len,
+   bool addBlocks)
+{
+   for (size_t done = 0; done < len;)
+   {
+      // Stop where NextSample() would check for a new block, or close the
+      // ring
+      const auto count = std::min({ len - done,
+         mBlockOverlap - mBlockRingPos % mBlockOverlap,
+         mBlockSize - mBlockRingPos });
+      const auto filtered = mFilterBuffer.get();
+      const auto powers = &mBlockRingBuffer[mBlockRingPos];
+      for (size_t channel = 0; channel < mChannelCount; ++channel)
+      {
+         // The filters depend on previous outputs, so they go sample by
+         // sample, but in a tight loop for each; the squares can then go
+         // several at once
+         mWeightingFilter[channel][0].Process(
+            buffers[channel] + done, filtered, count);
+         mWeightingFilter[channel][1].Process(filtered, filtered, count);
+         if (channel == 0)
+            for (size_t i = 0; i < count; ++i)
+               powers[i] = double(filtered[i]) * filtered[i];
+         else
+            for (size_t i = 0; i < count; ++i)
+               powers[i] += double(filtered[i]) * filtered[i];
+      }
+
+      done += count;
+      mBlockRingPos += count;
+      mBlockRingSize += count;
+      mSampleCount += count;
+      if (mBlockRingPos % mBlockOverlap == 0 && mBlockRingSize >= mBlockSize)
+      {
+         if (addBlocks)
+            AddBlockToHistogram(mBlockSize);
+         else
+            mBlockRingSize = mBlockSize;
+      }
+      if (mBlockRingPos == mBlockSize)
+         mBlockRingPos = 0;
+   }
+}
+
+void EBUR128::Merge(const EBUR128 &other)
+{
+   for (size_t i = 0; i < HIST_BIN_COUNT; ++i)
+      mLoudnessHist[i] += other.mLoudnessHist[i];
+}
+
 double EBUR128::IntegrativeLoudness()
 {
    // EBU R128: z_i = mean square without root
@@ -27,8 +27,27 @@ public:
    ~EBUR128() = default;
 
    static ArrayOf<Biquad> CalcWeightingFilter(double fs);
+   //! Length in samples of the blocks that are measured
+   static size_t BlockSize(double rate) { return ceil(0.4 * rate); }
+
    void ProcessSampleFromChannel(float x_in, size_t channel) const;
    void NextSample();
+
+   //! Process len samples of each channel at once
+   /*! Same as ProcessSampleFromChannel() for each channel, then NextSample(),
+    for each sample */
+   void ProcessSamples(const float *const buffers[], size_t len);
+   //! Process samples only to fill the filters and the block ring
+   /*!
+    So that a processor can continue where another stops.  Give it at least
+    two blocks of the preceding audio, starting at a multiple of BlockSize()
+    samples from where the other processor started, then the same blocks
+    that follow are added to the histogram.
+    */
+   void WarmUp(const float *const buffers[], size_t len);
+   //! Add the blocks of another processor, with the same rate, to the
+   //! histogram
+   void Merge(const EBUR128 &other);
    double IntegrativeLoudness();
    inline double IntegrativeLoudnessToLUFS(double loudness)
       { return 10 * log10(loudness); }
@@ -36,12 +55,16 @@ public:
 private:
    void HistogramSums(size_t start_idx, double& sum_v, long int& sum_c) const;
    void AddBlockToHistogram(size_t validLen);
+   void ProcessSamples(const float *const buffers[], size_t len,
+      bool addBlocks);
 
    static constexpr size_t HIST_BIN_COUNT = 65536;
    /// EBU R128 absolute threshold
    static constexpr double GAMMA_A = (-70.0 + 0.691) / 10.0;
    ArrayOf<long int> mLoudnessHist;
    Doubles mBlockRingBuffer;
+   //! Filtered samples of one channel, up to the next block overlap
+   Floats mFilterBuffer;
    size_t mSampleCount{ 0 };
    size_t mBlockRingPos{ 0 };
    size_t mBlockRingSize{ 0 };
@@ -23,6 +23,7 @@
 #include "EffectOutputTracks.h"
 #include "LoadEffects.h"
 
+#include <algorithm>
 #include <math.h>
 
 
@@ -163,6 +164,20 @@ bool EffectFindClipping::ProcessOne(LabelTrack &lt,
             break;
          }
          block = limitSampleBufferSize( blockSize, len - s );
+         // Unless a run might be ending, skip reading samples where the
+         // summaries of the sample blocks show nothing clipped; widen the
+         // range by a sample each way against rounding of the times
+         if (startrun < mStart) {
+            const auto range = wt.GetMinMax(
+               wt.LongSamplesToTime(start + s - 1),
+               wt.LongSamplesToTime(start + s + block + 1)); // may throw
+            if (std::max(-range.first, range.second) < MAX_AUDIO) {
+               startrun = 0;
+               s += block;
+               block = 0;
+               continue;
+            }
+         }
          wt.GetFloats(buffer.get(), start + s, block);
          ptr = buffer.get();
       }
@@ -18,6 +18,8 @@
 #include "EffectOutputTracks.h"
 
 #include <math.h>
+#include <atomic>
+#include <future>
 
 #include <wx/simplebook.h>
 #include <wx/valgen.h>
@@ -29,6 +31,7 @@
 #include "WaveTrack.h"
 #include "../widgets/valnum.h"
 #include "ProgressDialog.h"
+#include "TaskPool.h"
 
 #include "LoadEffects.h"
 
@@ -111,7 +114,10 @@ bool EffectLoudness::Process(EffectInstance &, EffectSettings &)
 
    AllocBuffers(outputs.Get());
    mProgressVal = 0;
+   // This affects only the progress indicator update during ProcessOne
+   mSteps = (mNormalizeTo == kLoudness) ? 2 : 1;
 
+   std::vector<Target> targets;
    for (auto pTrack : outputs.Get().Selected<WaveTrack>()) {
       // Get start and end times from track
       double trackStart = pTrack->GetStartTime();
@@ -122,98 +128,90 @@ bool EffectLoudness::Process(EffectInstance &, EffectSettings &)
       const double curT0 = std::max(trackStart, mT0);
       const double curT1 = std::min(trackEnd, mT1);
 
-      // Get the track rate
-      mCurRate = pTrack->GetRate();
+      // Abort if the right marker is not to the right of the left marker
+      if (curT1 <= curT0) {
+         FreeBuffers();
+         return false;
+      }
 
-      wxString msg;
-      auto trackName = pTrack->GetName();
-      // This affects only the progress indicator update during ProcessOne
-      mSteps = (mNormalizeTo == kLoudness) ? 2 : 1;
+      const auto rate = pTrack->GetRate();
+      const auto trackName = pTrack->GetName();
+      if (mStereoInd) {
+         for (const auto pChannel : pTrack->Channels())
+            targets.push_back({ *pChannel, 1, curT0, curT1, rate, trackName });
+      }
+      else
+         targets.push_back({ *pTrack, pTrack->NChannels(),
+            curT0, curT1, rate, trackName });
+   }
 
-      mProgressMsg =
-         topMsg + XO("Analyzing: %s").Format(trackName);
+   // Analyse all tracks at once, before changing any
+   if (mNormalizeTo == kLoudness && !AnalyseLoudness(targets)) {
+      FreeBuffers();
+      return false;
+   }
 
-      const auto channels = pTrack->Channels();
-      auto nChannels = mStereoInd ? 1 : channels.size();
+   for (auto &target : targets) {
+      auto &track = target.track;
+      const auto nChannels = target.nChannels;
       mProcStereo = nChannels > 1;
 
-      const auto processOne = [&](WaveChannel &track){
-         std::optional<EBUR128> loudnessProcessor;
+      // Calculate normalization values the analysis results
+      float extent;
+      if (mNormalizeTo == kLoudness)
+         extent = target.loudness;
+      else {
+         // RMS
          float RMS[2];
-
-         if (mNormalizeTo == kLoudness) {
-            loudnessProcessor.emplace(mCurRate, nChannels);
-            if (!ProcessOne(track, nChannels,
-               curT0, curT1, 0, &*loudnessProcessor))
-               // Processing failed -> abort
-               return false;
-         }
-         else {
-            // RMS
-            if (mProcStereo) {
-               size_t idx = 0;
-               for (const auto pChannel : channels) {
-                  if (!GetTrackRMS(*pChannel, curT0, curT1, RMS[idx]))
-                     return false;
-                  ++idx;
+         if (mProcStereo) {
+            size_t idx = 0;
+            for (const auto pChannel : track.GetTrack().Channels()) {
+               if (!GetTrackRMS(*pChannel, target.curT0, target.curT1,
+                  RMS[idx])) {
+                  bGoodResult = false;
+                  break;
                }
+               ++idx;
             }
-            else {
-               if (!GetTrackRMS(track, curT0, curT1, RMS[0]))
-                  return false;
-            }
-         }
-
-         // Calculate normalization values the analysis results
-         float extent;
-         if (mNormalizeTo == kLoudness)
-            extent = loudnessProcessor->IntegrativeLoudness();
-         else {
-            // RMS
-            extent = RMS[0];
-            if (mProcStereo)
-               // RMS: use average RMS, average must be calculated in quadratic
-               // domain.
-               extent = sqrt((RMS[0] * RMS[0] + RMS[1] * RMS[1]) / 2.0);
-         }
-
-         if (extent == 0.0) {
-            FreeBuffers();
-            return false;
-         }
-         float mult = ratio / extent;
-
-         if (mNormalizeTo == kLoudness) {
-            // Target half the LUFS value if mono (or independent processed
-            // stereo) shall be treated as dual mono.
-            if (nChannels == 1 &&
-               (mDualMono || !IsMono(track)))
-               mult /= 2.0;
-
-            // LUFS are related to square values so the multiplier must be the
-            // xroot.
-            mult = sqrt(mult);
+            if (!bGoodResult)
+               break;
          }
-
-         mProgressMsg = topMsg + XO("Processing: %s").Format( trackName );
-         if (!ProcessOne(track, nChannels, curT0, curT1, mult, nullptr)) {
-            // Processing failed -> abort
-            return false;
+         else if (!GetTrackRMS(track, target.curT0, target.curT1, RMS[0])) {
+            bGoodResult = false;
+            break;
          }
-         return true;
-      };
+         extent = RMS[0];
+         if (mProcStereo)
+            // RMS: use average RMS, average must be calculated in quadratic
+            // domain.
+            extent = sqrt((RMS[0] * RMS[0] + RMS[1] * RMS[1]) / 2.0);
+      }
 
-      if (mStereoInd) {
-         for (const auto pChannel : channels)
-            if (!(bGoodResult = processOne(*pChannel)))
-               goto done;
+      if (extent == 0.0) {
+         bGoodResult = false;
+         break;
       }
-      else {
-         if (!(bGoodResult = processOne(*pTrack)))
-            break;
+      float mult = ratio / extent;
+
+      if (mNormalizeTo == kLoudness) {
+         // Target half the LUFS value if mono (or independent processed
+         // stereo) shall be treated as dual mono.
+         if (nChannels == 1 &&
+            (mDualMono || !IsMono(track)))
+            mult /= 2.0;
+
+         // LUFS are related to square values so the multiplier must be the
+         // xroot.
+         mult = sqrt(mult);
+      }
+
+      mProgressMsg = topMsg + XO("Processing: %s").Format( target.name );
+      if (!ProcessOne(track, nChannels, target.curT0, target.curT1, mult)) {
+         // Processing failed -> abort
+         bGoodResult = false;
+         break;
       }
    }
-done:
 
    if (bGoodResult)
       outputs.Commit();
@@ -387,15 +385,134 @@ bool EffectLoudness::GetTrackRMS(WaveChannel &track,
    return true;
 }
 
+bool EffectLoudness::AnalyseLoudness(std::vector<Target> &targets)
+{
+   if (targets.empty())
+      return true;
+
+   // Long tracks are also cut into segments, each measured by a processor
+   // of its own.  A segment starts at a multiple of the block size, and its
+   // processor warms up on the blocks before it, so it adds the same blocks
+   // to its histogram as one pass would; then the histograms are merged.
+   auto &pool = TaskPool::Get();
+   const auto maxSegments = std::max<size_t>(1,
+      (2 * pool.Concurrency() + targets.size() - 1) / targets.size());
+
+   struct Segment {
+      Target *pTarget;
+      sampleCount start;
+      //! Relative to start
+      sampleCount begin, end;
+      size_t blockSize;
+      std::unique_ptr<EBUR128> pProcessor;
+   };
+   std::vector<Segment> segments;
+   double totalLen = 0;
+   for (auto &target : targets) {
+      auto &track = target.track;
+      const auto start = track.TimeToLongSamples(target.curT0);
+      const auto len = track.TimeToLongSamples(target.curT1) - start;
+      const auto blockSize = EBUR128::BlockSize(target.rate);
+      // Keep the overhead of the warm-up blocks small
+      const sampleCount minSegmentLen = 64 * blockSize;
+      const auto nSegments = std::clamp<sampleCount>(
+         len / minSegmentLen, 1, maxSegments).as_size_t();
+      const sampleCount nBlocks = (len + blockSize - 1) / blockSize;
+      const auto segmentLen =
+         ((nBlocks + nSegments - 1) / nSegments) * blockSize;
+      for (size_t ii = 0; ii < nSegments; ++ii) {
+         const auto begin = segmentLen * ii;
+         if (begin >= len)
+            break;
+         segments.push_back({ &target, start, begin,
+            std::min(len, begin + segmentLen), blockSize,
+            std::make_unique<EBUR128>(target.rate, target.nChannels) });
+      }
+      totalLen += len.as_double() * target.nChannels;
+   }
+
+   std::atomic<long long> samplesDone{ 0 };
+   std::atomic<bool> cancelled{ false };
+   std::vector<std::future<bool>> results;
+   auto wait = finally([&]{
+      // Don't leave workers using the segments, even if this thread throws
+      cancelled = true;
+      for (auto &result : results)
+         if (result.valid())
+            result.wait();
+   });
+   for (auto &segment : segments)
+      results.push_back(pool.Submit([&, &segment = segment]{
+         auto &track = segment.pTarget->track;
+         const auto nChannels = segment.pTarget->nChannels;
+         std::vector<Floats> buffers(nChannels);
+         std::vector<float *> pointers(nChannels);
+         for (size_t ii = 0; ii < nChannels; ++ii) {
+            buffers[ii].reinit(mTrackBufferCapacity);
+            pointers[ii] = buffers[ii].get();
+         }
+
+         auto pos = (segment.begin == 0)
+            ? sampleCount{ 0 } : segment.begin - 2 * segment.blockSize;
+         while (pos < segment.end) {
+            if (cancelled)
+               return false;
+            const auto stop =
+               (pos < segment.begin) ? segment.begin : segment.end;
+            const auto blockLen = limitSampleBufferSize(
+               std::min(mTrackBufferCapacity,
+                  track.GetBestBlockSize(segment.start + pos)),
+               stop - pos);
+            LoadBufferBlock(track, nChannels,
+               segment.start + pos, blockLen, pointers.data());
+            if (pos < segment.begin)
+               segment.pProcessor->WarmUp(pointers.data(), blockLen);
+            else
+               segment.pProcessor->ProcessSamples(pointers.data(), blockLen);
+            samplesDone += blockLen * nChannels;
+            pos += blockLen;
+         }
+         return true;
+      }, TaskPriority::High));
+
+   const auto topMsg = XO("Normalizing Loudness...\n");
+   for (size_t ii = 0; ii < results.size(); ++ii) {
+      auto &result = results[ii];
+      mProgressMsg = topMsg +
+         XO("Analyzing: %s").Format(segments[ii].pTarget->name);
+      while (result.wait_for(std::chrono::milliseconds(50)) !=
+         std::future_status::ready) {
+         mProgressVal = std::min(1.0, samplesDone / totalLen) / mSteps;
+         if (TotalProgress(mProgressVal, mProgressMsg))
+            cancelled = true;
+      }
+   }
+   bool success = !cancelled;
+   for (auto &result : results)
+      // Rethrow any exception
+      success = result.get() && success;
+   if (!success)
+      return false;
+
+   // Merge into the last segment of each target, which holds the end of the
+   // track, for IntegrativeLoudness() to use if there is no full block
+   for (size_t ii = 0; ii < segments.size(); ++ii) {
+      auto &segment = segments[ii];
+      if (ii + 1 < segments.size() &&
+         segments[ii + 1].pTarget == segment.pTarget)
+         segments[ii + 1].pProcessor->Merge(*segment.pProcessor);
+      else
+         segment.pTarget->loudness =
+            segment.pProcessor->IntegrativeLoudness();
+   }
+   mProgressVal = 1.0 / mSteps;
+   return true;
+}
+
 /// ProcessOne() takes a track, transforms it to bunch of buffer-blocks,
-/// and executes ProcessData, on it...
-///  uses mMult to normalize a track.
-///  mMult must be set before this is called
-/// In analyse mode, it executes the selected analyse operation on it...
-///  mMult does not have to be set before this is called
+/// and normalizes it, by mult
 bool EffectLoudness::ProcessOne(WaveChannel &track, size_t nChannels,
-   const double curT0, const double curT1, const float mult,
-   EBUR128 *pLoudnessProcessor)
+   const double curT0, const double curT1, const float mult)
 {
    // Transform the marker timepoints to samples
    auto start = track.TimeToLongSamples(curT0);
@@ -410,6 +527,8 @@ bool EffectLoudness::ProcessOne(WaveChannel &track, size_t nChannels,
    if (curT1 <= curT0)
       return false;
 
+   float *const buffers[] = { mTrackBuffer[0].get(), mTrackBuffer[1].get() };
+
    // Go through the track one buffer at a time. s counts which
    // sample the current buffer starts at.
    auto s = start;
@@ -422,19 +541,14 @@ bool EffectLoudness::ProcessOne(WaveChannel &track, size_t nChannels,
 
       const size_t remainingLen = (end - s).as_size_t();
       blockLen = blockLen > remainingLen ? remainingLen : blockLen;
-      LoadBufferBlock(track, nChannels, s, blockLen);
+      LoadBufferBlock(track, nChannels, s, blockLen, buffers);
+      mTrackBufferLen = blockLen;
 
       // Process the buffer.
-      if (pLoudnessProcessor) {
-         if (!AnalyseBufferBlock(*pLoudnessProcessor))
-            return false;
-      }
-      else {
-         if (!ProcessBufferBlock(mult))
-            return false;
-         if (!StoreBufferBlock(track, nChannels, s, blockLen))
-            return false;
-      }
+      if (!ProcessBufferBlock(mult))
+         return false;
+      if (!StoreBufferBlock(track, nChannels, s, blockLen))
+         return false;
 
       // Increment s one blockfull of samples
       s += blockLen;
@@ -445,12 +559,12 @@ bool EffectLoudness::ProcessOne(WaveChannel &track, size_t nChannels,
 }
 
 void EffectLoudness::LoadBufferBlock(WaveChannel &track, size_t nChannels,
-   sampleCount pos, size_t len)
+   sampleCount pos, size_t len, float *const buffers[])
 {
    size_t idx = 0;
    const auto getOne = [&](WaveChannel &channel) {
       // Get the samples from the track and put them in the buffer
-      channel.GetFloats(mTrackBuffer[idx].get(), pos, len);
+      channel.GetFloats(buffers[idx], pos, len);
    };
 
    if (nChannels == 1)
@@ -460,24 +574,6 @@ void EffectLoudness::LoadBufferBlock(WaveChannel &track, size_t nChannels,
          getOne(*channel);
          ++idx;
       }
-   mTrackBufferLen = len;
-}
-
-/// Calculates sample sum (for DC) and EBU R128 weighted square sum
-/// (for loudness).
-bool EffectLoudness::AnalyseBufferBlock(EBUR128 &loudnessProcessor)
-{
-   for(size_t i = 0; i < mTrackBufferLen; i++)
-   {
-      loudnessProcessor.ProcessSampleFromChannel(mTrackBuffer[0][i], 0);
-      if (mProcStereo)
-         loudnessProcessor.ProcessSampleFromChannel(mTrackBuffer[1][i], 1);
-      loudnessProcessor.NextSample();
-   }
-
-   if (!UpdateProgress())
-      return false;
-   return true;
 }
 
 bool EffectLoudness::ProcessBufferBlock(const float mult)
@@ -22,9 +22,10 @@
 #include "ShuttleAutomation.h"
 #include "Track.h"
 
+#include <vector>
+
 class wxChoice;
 class wxSimplebook;
-class EBUR128;
 class ShuttleGui;
 class WaveChannel;
 using Floats = ArrayOf<float>;
@@ -70,13 +71,24 @@ private:
 
    void AllocBuffers(TrackList &outputs);
    void FreeBuffers();
+   //! A track, or one channel of it if channels are independent
+   struct Target {
+      WaveChannel &track;
+      size_t nChannels;
+      double curT0, curT1;
+      double rate;
+      wxString name;
+      //! Result of AnalyseLoudness()
+      double loudness{};
+   };
+
    static bool GetTrackRMS(WaveChannel &track,
       double curT0, double curT1, float &rms);
+   [[nodiscard]] bool AnalyseLoudness(std::vector<Target> &targets);
    [[nodiscard]] bool ProcessOne(WaveChannel &track, size_t nChannels,
-      double curT0, double curT1, float mult, EBUR128 *pLoudnessProcessor);
-   void LoadBufferBlock(WaveChannel &track, size_t nChannels,
-      sampleCount pos, size_t len);
-   bool AnalyseBufferBlock(EBUR128 &loudnessProcessor);
+      double curT0, double curT1, float mult);
+   static void LoadBufferBlock(WaveChannel &track, size_t nChannels,
+      sampleCount pos, size_t len, float *const buffers[]);
    bool ProcessBufferBlock(float mult);
    [[nodiscard]] bool StoreBufferBlock(WaveChannel &track, size_t nChannels,
       sampleCount pos, size_t len);
@@ -99,7 +111,6 @@ private:
    int    mSteps;
    TranslatableString mProgressMsg;
    double mTrackLen;
-   double mCurRate;
 
    wxSimplebook *mBook;
    wxChoice *mChoice;
@@ -50,7 +50,8 @@
 #include "FFT.h"
 #include "Prefs.h"
 #include "RealFFTf.h"
-#include "../SpectrumTransformer.h"
+#include "NoiseReducer.h"
+#include "../TrackSpectrumTransformer.h"
 
 #include "WaveTrack.h"
 #include "AudacityMessageBox.h"
@@ -72,10 +73,6 @@
 #include <wx/valtext.h>
 #include <wx/textctrl.h>
 
-// SPECTRAL_SELECTION not to affect this effect for now, as there might be no indication that it does.
-// [Discussed and agreed for v2.1 by Steve, Paul, Bill].
-#undef EXPERIMENTAL_SPECTRAL_EDITING
-
 typedef std::vector<float> FloatVector;
 
 // Define both of these to make the radio button three-way
@@ -93,15 +90,6 @@ typedef std::vector<float> FloatVector;
 
 namespace {
 
-enum DiscriminationMethod : size_t {
-   DM_MEDIAN,
-   DM_SECOND_GREATEST,
-   DM_OLD_METHOD,
-
-   DM_N_METHODS,
-   DM_DEFAULT_METHOD = DM_SECOND_GREATEST,
-};
-
 const struct DiscriminationMethodInfo {
    const TranslatableString name;
 } discriminationMethodInfo[DM_N_METHODS] = {
@@ -111,10 +99,6 @@ const struct DiscriminationMethodInfo {
       { XO("Old") },
 };
 
-// magic number used only in the old statistics
-// and the old discrimination
-const float minSignalTime = 0.05f;
-
 enum WindowTypes : unsigned {
    WT_RECTANGULAR_HANN = 0, // 2.0.6 behavior, requires 1/2 step
    WT_HANN_RECTANGULAR, // requires 1/2 step
@@ -154,49 +138,21 @@ enum {
    DEFAULT_STEPS_PER_WINDOW_CHOICE = 1 // corresponds to 4, minimum for WT_HANN_HANN
 };
 
-enum  NoiseReductionChoice {
-   NRC_REDUCE_NOISE,
-   NRC_ISOLATE_NOISE,
-   NRC_LEAVE_RESIDUE,
-};
-
 } // namespace
 
 //----------------------------------------------------------------------------
 // EffectNoiseReduction::Statistics
 //----------------------------------------------------------------------------
 
-class EffectNoiseReduction::Statistics
+class EffectNoiseReduction::Statistics : public NoiseReducer::Statistics
 {
 public:
    Statistics(size_t spectrumSize, double rate, int windowTypes)
-      : mRate{ rate }
-      , mWindowSize{ (spectrumSize - 1) * 2 }
+      : NoiseReducer::Statistics{ spectrumSize, rate }
       , mWindowTypes{ windowTypes }
-      , mTotalWindows{ 0 }
-      , mTrackWindows{ 0 }
-      , mSums( spectrumSize )
-      , mMeans (spectrumSize )
-#ifdef OLD_METHOD_AVAILABLE
-      , mNoiseThreshold( spectrumSize )
-#endif
    {}
 
-   // Noise profile statistics follow
-
-   double mRate; // Rate of profile track(s) -- processed tracks must match
-   size_t mWindowSize;
    int mWindowTypes;
-
-   unsigned mTotalWindows;
-   unsigned mTrackWindows;
-   FloatVector mSums;
-   FloatVector mMeans;
-
-#ifdef OLD_METHOD_AVAILABLE
-   // Old statistics:
-   FloatVector mNoiseThreshold;
-#endif
 };
 
 //----------------------------------------------------------------------------
@@ -205,7 +161,7 @@ public:
 
 // This object is the memory of the effect between uses
 // (other than noise profile statistics)
-class EffectNoiseReduction::Settings
+class EffectNoiseReduction::Settings : public NoiseReducer::Settings
 {
 public:
    Settings();
@@ -216,33 +172,13 @@ public:
    bool PrefsIO(bool read);
    bool Validate(EffectNoiseReduction *effect) const;
 
-   size_t WindowSize() const { return 1u << (3 + mWindowSizeChoice); }
-   unsigned StepsPerWindow() const { return 1u << (1 + mStepsPerWindowChoice); }
-   size_t SpectrumSize() const { return 1 + WindowSize() / 2; }
-   size_t StepSize() const { return WindowSize() / StepsPerWindow(); }
-
    bool      mDoProfile;
 
-   // Stored in preferences:
-
-   // Basic:
-   double     mNewSensitivity;   // - log10 of a probability... yeah.
-   double     mFreqSmoothingBands; // really an integer
-   double     mNoiseGain;         // in dB, positive
-   double     mAttackTime;        // in secs
-   double     mReleaseTime;       // in secs
+   // Stored in preferences, with those of the base class:
 
    // Advanced:
    double     mOldSensitivity;    // in dB, plus or minus
-
-   // Basic:
-   int        mNoiseReductionChoice;
-
-   // Advanced:
    int        mWindowTypes;
-   int        mWindowSizeChoice;
-   int        mStepsPerWindowChoice;
-   int        mMethod;
 };
 
 EffectNoiseReduction::Settings::Settings()
@@ -251,40 +187,6 @@ EffectNoiseReduction::Settings::Settings()
    PrefsIO(true);
 }
 
-struct MyTransformer : TrackSpectrumTransformer {
-   MyTransformer(EffectNoiseReduction::Worker &worker,
-      WaveChannel *pOutputTrack,
-      bool needsOutput, eWindowFunctions inWindowType,
-      eWindowFunctions outWindowType, size_t windowSize,
-      unsigned stepsPerWindow, bool leadingPadding, bool trailingPadding
-   )  : TrackSpectrumTransformer{ pOutputTrack,
-         needsOutput, inWindowType, outWindowType,
-         windowSize, stepsPerWindow, leadingPadding, trailingPadding
-      }
-      , mWorker{ worker }
-   {
-   }
-   struct MyWindow : public Window
-   {
-      explicit MyWindow(size_t windowSize)
-         : Window{ windowSize }
-         , mSpectrums(windowSize / 2 + 1)
-         , mGains(windowSize / 2 + 1)
-      {}
-      ~MyWindow() override;
-
-      FloatVector mSpectrums;
-      FloatVector mGains;
-   };
-
-   MyWindow &NthWindow(int nn) { return static_cast<MyWindow&>(Nth(nn)); }
-   std::unique_ptr<Window> NewWindow(size_t windowSize) override;
-   bool DoStart() override;
-   bool DoFinish() override;
-
-   EffectNoiseReduction::Worker &mWorker;
-};
-
 //----------------------------------------------------------------------------
 // EffectNoiseReduction::Worker
 //----------------------------------------------------------------------------
@@ -293,58 +195,26 @@ struct MyTransformer : TrackSpectrumTransformer {
 class EffectNoiseReduction::Worker final
 {
 public:
-   typedef EffectNoiseReduction::Settings Settings;
-   typedef  EffectNoiseReduction::Statistics Statistics;
-
    Worker(EffectNoiseReduction &effect, const Settings &settings,
-      Statistics &statistics
-#ifdef EXPERIMENTAL_SPECTRAL_EDITING
-      , double f0, double f1
-#endif
-      );
-   ~Worker();
+      Statistics &statistics,
+      eWindowFunctions inWindowType, eWindowFunctions outWindowType);
 
-   bool Process(eWindowFunctions inWindowType, eWindowFunctions outWindowType,
-      TrackList &tracks, double mT0, double mT1);
+   bool Process(TrackList &tracks, double mT0, double mT1);
 
-   static bool Processor(SpectrumTransformer &transformer);
-
-   void ApplyFreqSmoothing(FloatVector &gains);
-   void GatherStatistics(MyTransformer &transformer);
-   inline bool Classify(
-      MyTransformer &transformer, unsigned nWindows, int band);
-   void ReduceNoise(MyTransformer &transformer);
-   void FinishTrackStatistics();
+private:
+   //! Reduce noise in the channels of a track, in segments of the selection
+   //! processed in parallel, and append the segments to the output
+   bool ReduceNoise(const WaveTrack &track, WaveTrack &outputTrack,
+      sampleCount start, sampleCount len);
 
    const bool mDoProfile;
 
    EffectNoiseReduction &mEffect;
-   const Settings &mSettings;
    Statistics &mStatistics;
-
-   FloatVector mFreqSmoothingScratch;
-   const size_t mFreqSmoothingBins;
-   // When spectral selection limits the affected band:
-   size_t mBinLow;  // inclusive lower bound
-   size_t mBinHigh; // exclusive upper bound
-
-   const int mNoiseReductionChoice;
-   const int mMethod;
-   const double mNewSensitivity;
-
-   float     mOneBlockAttack;
-   float     mOneBlockRelease;
-   float     mNoiseAttenFactor;
-   float     mOldSensitivityFactor;
-
-   unsigned  mNWindowsToExamine;
-   unsigned  mCenter;
-   unsigned  mHistoryLen;
+   NoiseReducer mReducer;
 
    // Following are for progress indicator only:
    unsigned  mProgressTrackCount = 0;
-   sampleCount mLen = 0;
-   sampleCount mProgressWindowCount = 0;
 };
 
 /****************************************************************//**
@@ -623,16 +493,6 @@ bool EffectNoiseReduction::Settings::Validate(EffectNoiseReduction *effect) cons
    return true;
 }
 
-auto MyTransformer::NewWindow(size_t windowSize)
-   -> std::unique_ptr<Window>
-{
-   return std::make_unique<MyWindow>(windowSize);
-}
-
-MyTransformer::MyWindow::~MyWindow()
-{
-}
-
 bool EffectNoiseReduction::Process(EffectInstance &, EffectSettings &)
 {
    // This same code will either reduce noise or profile it
@@ -694,13 +554,9 @@ bool EffectNoiseReduction::Process(EffectInstance &, EffectSettings &)
       inWindowType = outWindowType = eWinFuncHann;
       break;
    }
-   Worker worker{ *this, *mSettings, *mStatistics
-#ifdef EXPERIMENTAL_SPECTRAL_EDITING
-      , mF0, mF1
-#endif
-   };
-   bool bGoodResult = worker.Process(inWindowType, outWindowType,
-      outputs.Get(), mT0, mT1);
+   Worker worker{ *this, *mSettings, *mStatistics,
+      inWindowType, outWindowType };
+   bool bGoodResult = worker.Process(outputs.Get(), mT0, mT1);
    const auto wasProfile = mSettings->mDoProfile;
    if (mSettings->mDoProfile) {
       if (bGoodResult)
@@ -714,17 +570,22 @@ bool EffectNoiseReduction::Process(EffectInstance &, EffectSettings &)
    return bGoodResult;
 }
 
-EffectNoiseReduction::Worker::~Worker()
+EffectNoiseReduction::Worker::Worker(EffectNoiseReduction &effect,
+   const Settings &settings, Statistics &statistics,
+   eWindowFunctions inWindowType, eWindowFunctions outWindowType)
+: mDoProfile{ settings.mDoProfile }
+
+, mEffect{ effect }
+, mStatistics{ statistics }
+, mReducer{ settings, statistics, inWindowType, outWindowType }
 {
 }
 
 bool EffectNoiseReduction::Worker::Process(
-   eWindowFunctions inWindowType, eWindowFunctions outWindowType,
    TrackList &tracks, double inT0, double inT1)
 {
    mProgressTrackCount = 0;
    for (auto track : tracks.Selected<WaveTrack>()) {
-      mProgressWindowCount = 0;
       if (track->GetRate() != mStatistics.mRate) {
          if (mDoProfile)
             EffectUIServices::DoMessageBox(mEffect,
@@ -745,42 +606,31 @@ bool EffectNoiseReduction::Worker::Process(
          auto start = track->TimeToLongSamples(t0);
          auto end = track->TimeToLongSamples(t1);
          const auto len = end - start;
-         mLen = len;
-         const auto extra =
-            (mSettings.StepsPerWindow() - 1) * mSettings.SpectrumSize();
-         // Adjust denominator for presence or absence of padding,
-         // which makes the number of windows visited either more or less
-         // than the number of window steps in the data.
-         if (mDoProfile)
-            mLen -= extra;
-         else
-            mLen += extra;
 
          auto t0 = track->LongSamplesToTime(start);
          auto tLen = track->LongSamplesToTime(len);
-         std::optional<TrackListHolder> ppTempList;
-         std::optional<ChannelGroup::ChannelIterator<WaveChannel>> pIter;
-         WaveTrack *pFirstTrack{};
-         if (!mSettings.mDoProfile) {
-            ppTempList.emplace(track->WideEmptyCopy());
-            pFirstTrack = *(*ppTempList)->Any<WaveTrack>().begin();
-            pIter.emplace(pFirstTrack->Channels().begin());
+         if (mDoProfile) {
+            for (const auto pChannel : track->Channels()) {
+               const auto reader = [&channel = *pChannel, start](
+                  float *buffer, sampleCount pos, size_t len) {
+                  channel.GetFloats(buffer, start + pos, len);
+               };
+               // Update the Progress meter, let user cancel
+               if (!mReducer.Profile(reader, len, [&](double fraction) {
+                  return !mEffect.TrackProgress(mProgressTrackCount, fraction);
+               }))
+                  return false;
+               ++mProgressTrackCount;
+            }
          }
-         for (const auto pChannel : track->Channels()) {
-            auto pOutputTrack = pIter ? *(*pIter)++ : nullptr;
-            MyTransformer transformer{ *this, pOutputTrack.get(),
-               !mSettings.mDoProfile, inWindowType, outWindowType,
-               mSettings.WindowSize(), mSettings.StepsPerWindow(),
-               !mSettings.mDoProfile, !mSettings.mDoProfile
-            };
-            if (!transformer
-               .Process(Processor, *pChannel, mHistoryLen, start, len))
+         else {
+            auto pTempList = track->WideEmptyCopy();
+            auto &outputTrack = **pTempList->Any<WaveTrack>().begin();
+            if (!ReduceNoise(*track, outputTrack, start, len))
                return false;
-            ++mProgressTrackCount;
-         }
-         if (ppTempList) {
-            TrackSpectrumTransformer::PostProcess(*pFirstTrack, len);
-            track->ClearAndPaste(t0, t0 + tLen, **ppTempList, true, false);
+            mProgressTrackCount += track->NChannels();
+            TrackSpectrumTransformer::PostProcess(outputTrack, len);
+            track->ClearAndPaste(t0, t0 + tLen, *pTempList, true, false);
          }
       }
    }
@@ -796,415 +646,69 @@ bool EffectNoiseReduction::Worker::Process(
    return true;
 }
 
-void EffectNoiseReduction::Worker::ApplyFreqSmoothing(FloatVector &gains)
-{
-   // Given an array of gain mutipliers, average them
-   // GEOMETRICALLY.  Don't multiply and take nth root --
-   // that may quickly cause underflows.  Instead, average the logs.
-
-   if (mFreqSmoothingBins == 0)
-      return;
-
-   const auto spectrumSize = mSettings.SpectrumSize();
-
-   {
-      auto pScratch = mFreqSmoothingScratch.data();
-      std::fill(pScratch, pScratch + spectrumSize, 0.0f);
-   }
-
-   for (size_t ii = 0; ii < spectrumSize; ++ii)
-      gains[ii] = log(gains[ii]);
-
-   // ii must be signed
-   for (int ii = 0; ii < (int)spectrumSize; ++ii) {
-      const int j0 = std::max(0, ii - (int)mFreqSmoothingBins);
-      const int j1 = std::min(spectrumSize - 1, ii + mFreqSmoothingBins);
-      for(int jj = j0; jj <= j1; ++jj) {
-         mFreqSmoothingScratch[ii] += gains[jj];
-      }
-      mFreqSmoothingScratch[ii] /= (j1 - j0 + 1);
-   }
-
-   for (size_t ii = 0; ii < spectrumSize; ++ii)
-      gains[ii] = exp(mFreqSmoothingScratch[ii]);
-}
-
-EffectNoiseReduction::Worker::Worker(EffectNoiseReduction &effect,
-   const Settings &settings, Statistics &statistics
-#ifdef EXPERIMENTAL_SPECTRAL_EDITING
-   , double f0, double f1
-#endif
-)
-: mDoProfile{ settings.mDoProfile }
-
-, mEffect{ effect }
-, mSettings{ settings }
-, mStatistics{ statistics }
-
-, mFreqSmoothingScratch(mSettings.SpectrumSize())
-, mFreqSmoothingBins{ size_t(std::max(0.0, settings.mFreqSmoothingBands)) }
-, mBinLow{ 0 }
-, mBinHigh{ mSettings.SpectrumSize() }
-
-, mNoiseReductionChoice{ settings.mNoiseReductionChoice }
-, mMethod{ settings.mMethod }
-
-// Sensitivity setting is a base 10 log, turn it into a natural log
-, mNewSensitivity{ settings.mNewSensitivity * log(10.0) }
-{
-   const auto sampleRate = mStatistics.mRate;
-
-#ifdef EXPERIMENTAL_SPECTRAL_EDITING
-   {
-      // mBinLow is inclusive, mBinHigh is exclusive, of
-      // the range of frequencies to affect.  Include any
-      // bin that partly overlaps the selected range of frequencies.
-      const double bin = sampleRate / mWindowSize;
-      if (f0 >= 0.0 )
-         mBinLow = floor(f0 / bin);
-      if (f1 >= 0.0)
-         mBinHigh = ceil(f1 / bin);
-   }
-#endif
-
-   const double noiseGain = -settings.mNoiseGain;
-   const unsigned nAttackBlocks =
-      1 + (int)(settings.mAttackTime * sampleRate / mSettings.StepSize());
-   const unsigned nReleaseBlocks =
-      1 + (int)(settings.mReleaseTime * sampleRate / mSettings.StepSize());
-   // Applies to amplitudes, divide by 20:
-   mNoiseAttenFactor = DB_TO_LINEAR(noiseGain);
-   // Apply to gain factors which apply to amplitudes, divide by 20:
-   mOneBlockAttack = DB_TO_LINEAR(noiseGain / nAttackBlocks);
-   mOneBlockRelease = DB_TO_LINEAR(noiseGain / nReleaseBlocks);
-   // Applies to power, divide by 10:
-   mOldSensitivityFactor = pow(10.0, settings.mOldSensitivity / 10.0);
-
-   mNWindowsToExamine = (mMethod == DM_OLD_METHOD)
-      ? std::max(2, (int)(minSignalTime * sampleRate / mSettings.StepSize()))
-      : 1 + mSettings.StepsPerWindow();
-
-   mCenter = mNWindowsToExamine / 2;
-   wxASSERT(mCenter >= 1); // release depends on this assumption
-
-   if (mDoProfile)
-#ifdef OLD_METHOD_AVAILABLE
-      mHistoryLen = mNWindowsToExamine;
-#else
-      mHistoryLen = 1;
-#endif
-   else {
-      // Allow long enough queue for sufficient inspection of the middle
-      // and for attack processing
-      // See ReduceNoise()
-      mHistoryLen = std::max(mNWindowsToExamine, mCenter + nAttackBlocks);
-   }
-}
-
-bool MyTransformer::DoStart()
-{
-   for (size_t ii = 0, nn = TotalQueueSize(); ii < nn; ++ii) {
-      MyWindow &record = NthWindow(ii);
-      std::fill(record.mSpectrums.begin(), record.mSpectrums.end(), 0.0);
-      std::fill(record.mGains.begin(), record.mGains.end(),
-         mWorker.mNoiseAttenFactor);
-   }
-   return TrackSpectrumTransformer::DoStart();
-}
-
-bool EffectNoiseReduction::Worker::Processor(SpectrumTransformer &trans)
-{
-   auto &transformer = static_cast<MyTransformer &>(trans);
-   auto &worker = transformer.mWorker;
-   // Compute power spectrum in the newest window
-   {
-      auto &record = transformer.NthWindow(0);
-      float *pSpectrum = &record.mSpectrums[0];
-      const double dc = record.mRealFFTs[0];
-      *pSpectrum++ = dc * dc;
-      float *pReal = &record.mRealFFTs[1], *pImag = &record.mImagFFTs[1];
-      for (size_t nn = worker.mSettings.SpectrumSize() - 2; nn--;) {
-         const double re = *pReal++, im = *pImag++;
-         *pSpectrum++ = re * re + im * im;
-      }
-      const double nyquist = record.mImagFFTs[0];
-      *pSpectrum = nyquist * nyquist;
-   }
-
-   if (worker.mDoProfile)
-      worker.GatherStatistics(transformer);
-   else
-      worker.ReduceNoise(transformer);
-
-   // Update the Progress meter, let user cancel
-   return !worker.mEffect.TrackProgress(worker.mProgressTrackCount,
-      std::min(1.0,
-         ((++worker.mProgressWindowCount).as_double() *
-          worker.mSettings.StepSize()) / worker.mLen.as_double()));
-}
-
-void EffectNoiseReduction::Worker::FinishTrackStatistics()
+bool EffectNoiseReduction::Worker::ReduceNoise(
+   const WaveTrack &track, WaveTrack &outputTrack,
+   sampleCount start, sampleCount len)
 {
-   const auto windows = mStatistics.mTrackWindows;
-
-   // Combine averages in case of multiple profile tracks.
-   if (windows) {
-      const auto multiplier = mStatistics.mTotalWindows;
-      const auto denom = windows + multiplier;
-      for (size_t ii = 0, nn = mStatistics.mMeans.size(); ii < nn; ++ii) {
-         auto &mean = mStatistics.mMeans[ii];
-         auto &sum = mStatistics.mSums[ii];
-         mean = (mean * multiplier + sum) / denom;
-         // Reset for next track
-         sum = 0;
-      }
-      // Reset for next track
-      mStatistics.mTrackWindows = 0;
-      mStatistics.mTotalWindows = denom;
-   }
-}
-
-void EffectNoiseReduction::Worker::GatherStatistics(MyTransformer &transformer)
-{
-   ++mStatistics.mTrackWindows;
-
-   {
-      // NEW statistics
-      auto pPower = transformer.NthWindow(0).mSpectrums.data();
-      auto pSum = mStatistics.mSums.data();
-      for (size_t jj = 0; jj < mSettings.SpectrumSize(); ++jj) {
-         *pSum++ += *pPower++;
-      }
-   }
-
-#ifdef OLD_METHOD_AVAILABLE
-   // The noise threshold for each frequency is the maximum
-   // level achieved at that frequency for a minimum of
-   // mMinSignalBlocks blocks in a row - the max of a min.
-
-   auto finish = mHistoryLen;
-
-   {
-      // old statistics
-      auto pPower = NthWindow(0).mSpectrums.data();
-      auto pThreshold = mStatistics.mNoiseThreshold.data();
-      for (size_t jj = 0; jj < mSpectrumSize; ++jj) {
-         float min = *pPower++;
-         for (unsigned ii = 1; ii < finish; ++ii)
-            min = std::min(min, NthWindow(ii).mSpectrums[jj]);
-         *pThreshold = std::max(*pThreshold, min);
-         ++pThreshold;
-      }
-   }
-#endif
-}
-
-// Return true iff the given band of the "center" window looks like noise.
-// Examine the band in a few neighboring windows to decide.
-inline
-bool EffectNoiseReduction::Worker::Classify(
-   MyTransformer &transformer, unsigned nWindows, int band)
-{
-   switch (mMethod) {
-#ifdef OLD_METHOD_AVAILABLE
-   case DM_OLD_METHOD:
-      {
-         float min = NthWindow(0).mSpectrums[band];
-         for (unsigned ii = 1; ii < nWindows; ++ii)
-            min = std::min(min, NthWindow(ii).mSpectrums[band]);
-         return
-            min <= mOldSensitivityFactor * mStatistics.mNoiseThreshold[band];
-      }
-#endif
-   // New methods suppose an exponential distribution of power values
-   // in the noise; NEW sensitivity (which is nonnegative) is meant to be
-   // the negative of a log of probability (so the log is nonpositive)
-   // that noise strays above the threshold.  Call that probability
-   // 1 - F.  The quantile function of an exponential distribution is
-   // - log (1 - F) * mean.  Thus simply multiply mean by sensitivity
-   // to get the threshold.
-   case DM_MEDIAN:
-      // This method examines the window and all other windows
-      // whose centers lie on or between its boundaries, and takes a median, to
-      // avoid being fooled by up and down excursions into
-      // either the mistake of classifying noise as not noise
-      // (leaving a musical noise chime), or the opposite
-      // (distorting the signal with a drop out).
-      if (nWindows <= 3)
-         // No different from second greatest.
-         goto secondGreatest;
-      else if (nWindows <= 5)
-      {
-         float greatest = 0.0, second = 0.0, third = 0.0;
-         for (unsigned ii = 0; ii < nWindows; ++ii) {
-            const float power = transformer.NthWindow(ii).mSpectrums[band];
-            if (power >= greatest)
-               third = second, second = greatest, greatest = power;
-            else if (power >= second)
-               third = second, second = power;
-            else if (power >= third)
-               third = power;
-         }
-         return third <= mNewSensitivity * mStatistics.mMeans[band];
-      }
-      else {
-         // not implemented
-         wxASSERT(false);
-         return true;
-      }
-   secondGreatest:
-   case DM_SECOND_GREATEST:
-      {
-         // This method just throws out the high outlier.  It
-         // should be less prone to distortions and more prone to
-         // chimes.
-         float greatest = 0.0, second = 0.0;
-         for (unsigned ii = 0; ii < nWindows; ++ii) {
-            const float power = transformer.NthWindow(ii).mSpectrums[band];
-            if (power >= greatest)
-               second = greatest, greatest = power;
-            else if (power >= second)
-               second = power;
-         }
-         return second <= mNewSensitivity * mStatistics.mMeans[band];
-      }
-   default:
-      wxASSERT(false);
-      return true;
-   }
-}
-
-void EffectNoiseReduction::Worker::ReduceNoise(MyTransformer &transformer)
-{
-   auto historyLen = transformer.CurrentQueueSize();
-   auto nWindows = std::min<unsigned>(mNWindowsToExamine, historyLen);
-
-   const auto spectrumSize = mSettings.SpectrumSize();
-
-   if (mNoiseReductionChoice != NRC_ISOLATE_NOISE)
-   {
-      auto &record = transformer.NthWindow(0);
-      // Default all gains to the reduction factor,
-      // until we decide to raise some of them later
-      float *pGain = &record.mGains[0];
-      std::fill(pGain, pGain + spectrumSize, mNoiseAttenFactor);
-   }
-
-   // Raise the gain for elements in the center of the sliding history
-   // or, if isolating noise, zero out the non-noise
-   if (nWindows > mCenter)
-   {
-      auto pGain = transformer.NthWindow(mCenter).mGains.data();
-      if (mNoiseReductionChoice == NRC_ISOLATE_NOISE) {
-         // All above or below the selected frequency range is non-noise
-         std::fill(pGain, pGain + mBinLow, 0.0f);
-         std::fill(pGain + mBinHigh, pGain + spectrumSize, 0.0f);
-         pGain += mBinLow;
-         for (size_t jj = mBinLow; jj < mBinHigh; ++jj) {
-               const bool isNoise = Classify(transformer, nWindows, jj);
-            *pGain++ = isNoise ? 1.0 : 0.0;
-         }
-      }
-      else {
-         // All above or below the selected frequency range is non-noise
-         std::fill(pGain, pGain + mBinLow, 1.0f);
-         std::fill(pGain + mBinHigh, pGain + spectrumSize, 1.0f);
-         pGain += mBinLow;
-         for (size_t jj = mBinLow; jj < mBinHigh; ++jj) {
-            const bool isNoise = Classify(transformer, nWindows, jj);
-            if (!isNoise)
-               *pGain = 1.0;
-            ++pGain;
-         }
-      }
-   }
-
-   if (mNoiseReductionChoice != NRC_ISOLATE_NOISE)
-   {
-      // In each direction, define an exponential decay of gain from the
-      // center; make actual gains the maximum of mNoiseAttenFactor, and
-      // the decay curve, and their prior values.
-
-      // First, the attack, which goes backward in time, which is,
-      // toward higher indices in the queue.
-      for (size_t jj = 0; jj < spectrumSize; ++jj) {
-         for (unsigned ii = mCenter + 1; ii < historyLen; ++ii) {
-            const float minimum =
-               std::max(mNoiseAttenFactor,
-                  transformer.NthWindow(ii - 1).mGains[jj] * mOneBlockAttack);
-            float &gain = transformer.NthWindow(ii).mGains[jj];
-            if (gain < minimum)
-               gain = minimum;
-            else
-               // We can stop now, our attack curve is intersecting
-               // the release curve of some window previously processed.
-               break;
-         }
-      }
-
-      // Now, release.  We need only look one window ahead.  This part will
-      // be visited again when we examine the next window, and
-      // carry the decay further.
-      {
-         auto pNextGain = transformer.NthWindow(mCenter - 1).mGains.data();
-         auto pThisGain = transformer.NthWindow(mCenter).mGains.data();
-         for (auto nn = mSettings.SpectrumSize(); nn--;) {
-            *pNextGain =
-               std::max(*pNextGain,
-                        std::max(mNoiseAttenFactor,
-                                 *pThisGain++ * mOneBlockRelease));
-            ++pNextGain;
-         }
+   std::vector<NoiseReducer::Reader> readers;
+   for (const auto pChannel : track.Channels())
+      readers.push_back([&channel = *pChannel, start](
+         float *buffer, sampleCount pos, size_t len) {
+         channel.GetFloats(buffer, start + pos, len);
+      });
+   std::vector<WaveChannel *> outputChannels;
+   for (const auto pChannel : outputTrack.Channels())
+      outputChannels.push_back(pChannel.get());
+
+   struct Segment {
+      WaveChannel *pOutputChannel;
+      //! Output of a segment after the first of its channel, appended to
+      //! the output channel after all are done
+      WaveTrack::Holder pTrack;
+   };
+   std::vector<Segment> segments;
+   const auto makeWriter = [&](size_t iChannel, size_t iSegment) {
+      WaveChannel *pChannel = outputChannels[iChannel];
+      if (iSegment > 0) {
+         // Stored as float so that the final Append converts as if
+         // there were one pass
+         auto pTrack = outputTrack.EmptyCopy({}, false);
+         pTrack->ConvertToSampleFormat(floatSample);
+         pChannel = pTrack.get();
+         segments.push_back({ outputChannels[iChannel], std::move(pTrack) });
       }
-   }
-
-
-   if (transformer.QueueIsFull()) {
-      auto &record = transformer.NthWindow(historyLen - 1);  // end of the queue
-      const auto last = mSettings.SpectrumSize() - 1;
+      return [pChannel](const float *buffer, size_t len) {
+         pChannel->Append((constSamplePtr)buffer, floatSample, len);
+      };
+   };
 
-      if (mNoiseReductionChoice != NRC_ISOLATE_NOISE)
-         // Apply frequency smoothing to output gain
-         // Gains are not less than mNoiseAttenFactor
-         ApplyFreqSmoothing(record.mGains);
+   const auto nChannels = track.NChannels();
+   if (!mReducer.Reduce(readers, len, makeWriter, [&](double fraction) {
+      return !mEffect.TotalProgress(
+         (mProgressTrackCount + fraction * nChannels)
+            / mEffect.GetNumWaveTracks());
+   }))
+      return false;
 
-      // Apply gain to FFT
-      {
-         const float *pGain = &record.mGains[1];
-         float *pReal = &record.mRealFFTs[1];
-         float *pImag = &record.mImagFFTs[1];
-         auto nn = mSettings.SpectrumSize() - 2;
-         if (mNoiseReductionChoice == NRC_LEAVE_RESIDUE) {
-            for (; nn--;) {
-               // Subtract the gain we would otherwise apply from 1, and
-               // negate that to flip the phase.
-               const double gain = *pGain++ - 1.0;
-               *pReal++ *= gain;
-               *pImag++ *= gain;
-            }
-            record.mRealFFTs[0] *= (record.mGains[0] - 1.0);
-            // The Fs/2 component is stored as the imaginary part of the DC component
-            record.mImagFFTs[0] *= (record.mGains[last] - 1.0);
-         }
-         else {
-            for (; nn--;) {
-               const double gain = *pGain++;
-               *pReal++ *= gain;
-               *pImag++ *= gain;
-            }
-            record.mRealFFTs[0] *= record.mGains[0];
-            // The Fs/2 component is stored as the imaginary part of the DC component
-            record.mImagFFTs[0] *= record.mGains[last];
-         }
+   // Stitch the segments in order
+   const auto bufferSize = outputTrack.GetMaxBlockSize();
+   FloatVector buffer(bufferSize);
+   for (auto &segment : segments) {
+      auto &source = *segment.pTrack;
+      source.Flush();
+      const auto sourceLen =
+         source.TimeToLongSamples(source.GetEndTime());
+      for (sampleCount pos = 0; pos < sourceLen;) {
+         const auto blockSize = limitSampleBufferSize(
+            std::min(bufferSize, source.GetBestBlockSize(pos)),
+            sourceLen - pos);
+         source.GetFloats(buffer.data(), pos, blockSize);
+         segment.pOutputChannel->Append(
+            (constSamplePtr)buffer.data(), floatSample, blockSize);
+         pos += blockSize;
       }
    }
-}
-
-bool MyTransformer::DoFinish()
-{
-   if (mWorker.mDoProfile)
-      mWorker.FinishTrackStatistics();
-   return TrackSpectrumTransformer::DoFinish();
+   return true;
 }
 
 //----------------------------------------------------------------------------
@@ -12,7 +12,9 @@
 
 #include "ExportAudioDialog.h"
 
+#include <algorithm>
 #include <numeric>
+#include <optional>
 
 #include "Export.h"
 #include "ExportUtils.h"
@@ -89,6 +91,8 @@ StringSetting ExportAudioDefaultFormat{ L"/ExportAudioDialog/Format", L"WAV" };
 
 StringSetting ExportAudioDefaultPath{ L"ExportAudioDialog/DefaultPath", L"" };
 
+IntSetting ExportAudioMaxConcurrentFiles { L"/ExportAudioDialog/MaxConcurrentFiles", 0 }; // as many as there are cores if 0
+
 enum {
    ExportFilePanelID = 10000,//to avoid IDs collision with ExportFilePanel items
 
@@ -869,9 +873,7 @@ ExportResult ExportAudioDialog::DoExportSplitByLabels(const ExportPlugin& plugin
                                                       const ExportProcessor::Parameters& parameters,
                                                       FilePaths& exporterFiles)
 {
-   auto ok = ExportResult::Success;   // did it work?
-   /* Go round again and do the exporting (so this run is slow but
-    * non-interactive) */
+   std::vector<SplitExport> exports;
    for(auto& activeSetting : mExportSettings)
    {
       /* get the settings to use for the export from the array */
@@ -879,27 +881,11 @@ ExportResult ExportAudioDialog::DoExportSplitByLabels(const ExportPlugin& plugin
       if( activeSetting.filename.GetName().empty() )
          continue;
 
-      // Export it
-      ok = DoExport(plugin, formatIndex, parameters, activeSetting.filename, activeSetting.channels,
-         activeSetting.t0, activeSetting.t1, false, activeSetting.tags, exporterFiles);
-      
-      if (ok == ExportResult::Stopped) {
-         AudacityMessageDialog dlgMessage(
-            nullptr,
-            XO("Continue to export remaining files?"),
-            XO("Export"),
-            wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
-         if (dlgMessage.ShowModal() != wxID_YES ) {
-            // User decided not to continue - bail out!
-            break;
-         }
-      }
-      else if (ok != ExportResult::Success) {
-         break;
-      }
+      PrepareExport(activeSetting.filename, activeSetting.channels,
+         activeSetting.t0, activeSetting.t1, activeSetting.tags, nullptr, exports);
    }
 
-   return ok;
+   return DoExports(plugin, formatIndex, parameters, exports, exporterFiles);
 }
 
 ExportResult ExportAudioDialog::DoExportSplitByTracks(const ExportPlugin& plugin,
@@ -922,7 +908,7 @@ ExportResult ExportAudioDialog::DoExportSplitByTracks(const ExportPlugin& plugin
    for (auto tr : tracks.Selected<WaveTrack>())
       tr->SetSelected(false);
 
-   auto ok = ExportResult::Success;
+   std::vector<SplitExport> exports;
 
    int count = 0;
    for (auto tr : waveTracks) {
@@ -935,57 +921,44 @@ ExportResult ExportAudioDialog::DoExportSplitByTracks(const ExportPlugin& plugin
          continue;
       }
 
-      /* Select the track */
-      SelectionStateChanger changer2{ selectionState, tracks };
-      tr->SetSelected(true);
+      // Prepare the export of the data. "channels" are per track.
+      PrepareExport(activeSetting.filename, activeSetting.channels,
+         activeSetting.t0, activeSetting.t1, activeSetting.tags, tr, exports);
 
-      // Export the data. "channels" are per track.
-      ok = DoExport(plugin, formatIndex, parameters, activeSetting.filename, activeSetting.channels,
-         activeSetting.t0, activeSetting.t1, true, activeSetting.tags, exporterFiles);
-      
-      if (ok == ExportResult::Stopped) {
-         AudacityMessageDialog dlgMessage(
-            nullptr,
-            XO("Continue to export remaining files?"),
-            XO("Export"),
-            wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
-         if (dlgMessage.ShowModal() != wxID_YES ) {
-            // User decided not to continue - bail out!
-            break;
-         }
-      }
-      
-      else if (ok != ExportResult::Success) {
-         break;
-      }
       // increment export counter
       count++;
    }
-   
-   
-   return ok ;
+
+   // All tracks stay deselected until the tasks are built
+   return DoExports(plugin, formatIndex, parameters, exports, exporterFiles);
 }
 
-ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
-                                         int formatIndex,
-                                         const ExportProcessor::Parameters& parameters,
-                                         const wxFileName& filename,
-                                         int channels,
-                                         double t0, double t1, bool selectedOnly,
-                                         const Tags& tags,
-                                         FilePaths& exportedFiles)
+void ExportAudioDialog::PrepareExport(const wxFileName& filename,
+                                      int channels,
+                                      double t0, double t1,
+                                      const Tags& tags,
+                                      WaveTrack* track,
+                                      std::vector<SplitExport>& exports)
 {
    wxFileName name;
 
    wxLogDebug(wxT("Doing multiple Export: File name \"%s\""), (filename.GetFullName()));
    wxLogDebug(wxT("Channels: %i, Start: %lf, End: %lf "), channels, t0, t1);
-   if (selectedOnly)
+   if (track)
       wxLogDebug(wxT("Selected Region Only"));
    else
       wxLogDebug(wxT("Whole Project"));
 
+   // Files of this export do not exist yet, so compare names with them too
+   const auto isTaken = [&](const wxFileName& candidate) {
+      return std::any_of(exports.begin(), exports.end(),
+         [path = candidate.GetFullPath()](const SplitExport& other) {
+            return other.fullPath == path;
+         });
+   };
+
    wxFileName backup;
-   if (mOverwriteExisting->GetValue()) {
+   if (mOverwriteExisting->GetValue() && !isTaken(filename)) {
       name = filename;
       backup.Assign(name);
 
@@ -1002,50 +975,118 @@ ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
       name = filename;
       int i = 2;
       wxString base(name.GetName());
-      while (name.FileExists()) {
+      while (name.FileExists() || isTaken(name)) {
          name.SetName(wxString::Format(wxT("%s-%d"), base, i++));
       }
    }
 
-   bool success{false};
-   const wxString fullPath{name.GetFullPath()};
-
-   auto cleanup = finally( [&] {
-      if (backup.IsOk()) {
-         if ( success )
-            // Remove backup
-            ::wxRemoveFile(backup.GetFullPath());
-         else {
-            // Restore original
-            ::wxRemoveFile(fullPath);
-            ::wxRenameFile(backup.GetFullPath(), fullPath);
+   SplitExport splitExport;
+   splitExport.fullPath = name.GetFullPath();
+   splitExport.backup = backup;
+   splitExport.channels = channels;
+   splitExport.t0 = t0;
+   splitExport.t1 = t1;
+   splitExport.tags = &tags;
+   splitExport.track = track;
+   exports.push_back(std::move(splitExport));
+}
+
+ExportResult ExportAudioDialog::DoExports(const ExportPlugin& plugin,
+                                          int formatIndex,
+                                          const ExportProcessor::Parameters& parameters,
+                                          std::vector<SplitExport>& exports,
+                                          FilePaths& exportedFiles)
+{
+   auto& tracks = TrackList::Get(mProject);
+   auto& selectionState = SelectionState::Get(mProject);
+
+   auto ok = ExportResult::Success;
+   size_t first = 0;
+   while(first < exports.size())
+   {
+      // Build each task only when it can start, so that only as many
+      // processors, with their files or encoders, exist as run at once
+      const auto makeTask = [&](size_t index)
+      {
+         const auto& splitExport = exports[first + index];
+         // The mixer of the export takes the selected tracks now
+         std::optional<SelectionStateChanger> changer;
+         if(splitExport.track)
+         {
+            changer.emplace(selectionState, tracks);
+            splitExport.track->SetSelected(true);
          }
+         return ExportTaskBuilder{}.SetPlugin(&plugin, formatIndex)
+                                   .SetParameters(parameters)
+                                   .SetRange(splitExport.t0, splitExport.t1,
+                                             splitExport.track != nullptr)
+                                   .SetTags(splitExport.tags)
+                                   .SetNumChannels(splitExport.channels)
+                                   .SetFileName(splitExport.fullPath)
+                                   .Build(mProject);
+      };
+      const auto results = ExportProgressUI::Show(exports.size() - first,
+         makeTask, std::max(0, ExportAudioMaxConcurrentFiles.Read()));
+
+      // Tasks start in order, so those that ran come first
+      size_t nStarted = 0;
+      for(; nStarted < results.size() && results[nStarted]; ++nStarted)
+         exports[first + nStarted].result = *results[nStarted];
+
+      const auto anyResult = [&](ExportResult value) {
+         return std::any_of(exports.begin() + first,
+            exports.begin() + first + nStarted,
+            [&](const SplitExport& e) { return e.result == value; });
+      };
+      ok = anyResult(ExportResult::Error) ? ExportResult::Error
+         : anyResult(ExportResult::Cancelled) ? ExportResult::Cancelled
+         : anyResult(ExportResult::Stopped) ? ExportResult::Stopped
+         : ExportResult::Success;
+      first += nStarted;
+
+      if (ok == ExportResult::Stopped && first < exports.size()) {
+         AudacityMessageDialog dlgMessage(
+            nullptr,
+            XO("Continue to export remaining files?"),
+            XO("Export"),
+            wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
+         if (dlgMessage.ShowModal() == wxID_YES )
+            continue;
       }
+      break;
+   }
+
+   for(auto& splitExport : exports)
+   {
+      const auto success = splitExport.result == ExportResult::Success ||
+         splitExport.result == ExportResult::Stopped;
+      FinishExport(splitExport, success);
+      if(success)
+         exportedFiles.push_back(splitExport.fullPath);
+   }
+
+   return ok;
+}
+
+void ExportAudioDialog::FinishExport(const SplitExport& splitExport, bool success)
+{
+   const auto& backup = splitExport.backup;
+   const auto& fullPath = splitExport.fullPath;
+   if (backup.IsOk()) {
+      if ( success )
+         // Remove backup
+         ::wxRemoveFile(backup.GetFullPath());
       else {
-         if ( ! success )
-            // Remove any new, and only partially written, file.
-            ::wxRemoveFile(fullPath);
+         // Restore original
+         ::wxRemoveFile(fullPath);
+         ::wxRenameFile(backup.GetFullPath(), fullPath);
       }
-   } );
-   
-   auto result = ExportResult::Error;
-   ExportProgressUI::ExceptionWrappedCall([&]
-   {
-      result = ExportProgressUI::Show(ExportTaskBuilder{}.SetPlugin(&plugin, formatIndex)
-                                    .SetParameters(parameters)
-                                    .SetRange(t0, t1, selectedOnly)
-                                    .SetTags(&tags)
-                                    .SetNumChannels(channels)
-                                    .SetFileName(fullPath)
-                                    .Build(mProject));
-   });
-
-   success = result == ExportResult::Success || result == ExportResult::Stopped;
-
-   if(success)
-      exportedFiles.push_back(fullPath);
-   
-   return result;
+   }
+   else {
+      if ( ! success )
+         // Remove any new, and only partially written, file.
+         ::wxRemoveFile(fullPath);
+   }
 }
 
 
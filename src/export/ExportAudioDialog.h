@@ -24,6 +24,7 @@ class ShuttleGui;
 class Exporter;
 class ExportPlugin;
 class ExportTaskBuilder;
+class WaveTrack;
 
 class ExportOptionsHandler;
 class ExportOptionsHandlerEvent;
@@ -51,6 +52,20 @@ class ExportAudioDialog final : public wxDialogWrapper
       Tags tags; /**< The set of metadata to use for the export */
    };
 
+   ///\brief A file of a split export, from its preparation until it is kept or removed.
+   ///Its task is built only when it can start.
+   struct SplitExport
+   {
+      wxString fullPath; /**< The file to export to */
+      wxFileName backup; /**< The overwritten file, renamed, if any */
+      int channels{};
+      double t0{};
+      double t1{};
+      const Tags* tags{};
+      WaveTrack* track{}; /**< The only track to export, or null for the whole project */
+      ExportResult result { ExportResult::Cancelled }; /**< Cancelled if the task never ran */
+   };
+
 public:
    ExportAudioDialog(wxWindow* parent,
                      AudacityProject& project,
@@ -95,14 +110,23 @@ private:
                                       const ExportProcessor::Parameters& parameters,
                                       FilePaths& exporterFiles);
    
-   ExportResult DoExport(const ExportPlugin& plugin,
-                         int formatIndex,
-                         const ExportProcessor::Parameters& parameters,
-                         const wxFileName& filename,
-                         int channels,
-                         double t0, double t1, bool selectedOnly,
-                         const Tags& tags,
-                         FilePaths& exportedFiles);
+   //! Choose a file name and back up a file to overwrite
+   void PrepareExport(const wxFileName& filename,
+                      int channels,
+                      double t0, double t1,
+                      const Tags& tags,
+                      WaveTrack* track,
+                      std::vector<SplitExport>& exports);
+
+   //! Build and run the tasks concurrently, then keep or remove the files
+   ExportResult DoExports(const ExportPlugin& plugin,
+                          int formatIndex,
+                          const ExportProcessor::Parameters& parameters,
+                          std::vector<SplitExport>& exports,
+                          FilePaths& exportedFiles);
+
+   //! Remove the backup of the overwritten file, or restore it
+   static void FinishExport(const SplitExport& splitExport, bool success);
    
    AudacityProject& mProject;
 
@@ -17,6 +17,8 @@
 #include "AudacityMessageBox.h"
 #include "FileException.h"
 
+#include <algorithm>
+
 namespace
 {
    class DialogExportProgressDelegate : public ExportProcessorDelegate
@@ -76,6 +78,46 @@ namespace
       
    };
 
+   //! Progress of one of several concurrent exports, which are cancelled or
+   //! stopped together
+   class ConcurrentExportProgressDelegate final : public ExportProcessorDelegate
+   {
+      const std::atomic<bool>& mCancelled;
+      const std::atomic<bool>& mStopped;
+      std::atomic<double> mProgress {};
+   public:
+      ConcurrentExportProgressDelegate(
+         const std::atomic<bool>& cancelled, const std::atomic<bool>& stopped)
+         : mCancelled { cancelled }, mStopped { stopped }
+      {
+      }
+
+      bool IsCancelled() const override
+      {
+         return mCancelled;
+      }
+
+      bool IsStopped() const override
+      {
+         return mStopped;
+      }
+
+      void SetStatusString(const TranslatableString&) override
+      {
+         // The dialog counts the files instead
+      }
+
+      void OnProgress(double progress) override
+      {
+         mProgress = progress;
+      }
+
+      double GetProgress() const
+      {
+         return mProgress;
+      }
+   };
+
 }
 
 ExportResult ExportProgressUI::Show(ExportTask exportTask)
@@ -101,3 +143,78 @@ ExportResult ExportProgressUI::Show(ExportTask exportTask)
 
    return result;
 }
+
+std::vector<std::optional<ExportResult>>
+ExportProgressUI::Show(size_t count,
+                       const ConcurrentExport::TaskFactory& makeTask,
+                       size_t maxConcurrent)
+{
+   std::vector<std::optional<ExportResult>> results(count);
+   if(count == 0)
+      return results;
+
+   std::atomic<bool> cancelled {false};
+   std::atomic<bool> stopped {false};
+   std::vector<std::unique_ptr<ConcurrentExportProgressDelegate>> delegates;
+   for(size_t i = 0; i < count; ++i)
+      delegates.push_back(
+         std::make_unique<ConcurrentExportProgressDelegate>(cancelled, stopped));
+   std::vector<std::exception_ptr> errors;
+
+   {
+      constexpr long long ProgressSteps = 1000ul;
+      auto progressDialog = BasicUI::MakeProgress(XO("Export"), {});
+      results = ConcurrentExport::Run(count, maxConcurrent, makeTask,
+         [&](size_t index) -> ExportProcessorDelegate& {
+            return *delegates[index];
+         },
+         [&](const std::vector<std::optional<ExportResult>>& resultsSoFar)
+         {
+            if(!progressDialog)
+               return true;
+            double progress = 0;
+            long long finished = 0;
+            for(size_t i = 0; i < count; ++i)
+            {
+               if(resultsSoFar[i])
+               {
+                  ++finished;
+                  progress += 1.0;
+               }
+               else
+                  progress += delegates[i]->GetProgress();
+            }
+            const auto result = progressDialog->Poll(
+               progress * ProgressSteps, count * ProgressSteps,
+               XO("Exported %lld of %lld files")
+                  .Format(finished, (long long) count));
+            if(result == BasicUI::ProgressResult::Cancelled)
+            {
+               if(!stopped)
+                  cancelled = true;
+            }
+            else if(result == BasicUI::ProgressResult::Stopped)
+            {
+               if(!cancelled)
+                  stopped = true;
+            }
+            return !cancelled && !stopped;
+         }, errors);
+   }
+
+   for(auto& error : errors)
+      if(error)
+         ExceptionWrappedCall([&] { std::rethrow_exception(error); });
+
+   if(std::any_of(results.begin(), results.end(), [](const auto& result) {
+      return result == ExportResult::Error;
+   }))
+   {
+      BasicUI::ShowErrorDialog(
+         {}, XO("Export error"),
+         XO("Export completed with error."), {},
+         BasicUI::ErrorDialogOptions { BasicUI::ErrorDialogType::ModalError });
+   }
+
+   return results;
+}
@@ -11,10 +11,13 @@
 #pragma once
 
 #include <future>
+#include <optional>
+#include <vector>
 
 #include "Export.h"
 #include "ExportTypes.h"
 #include "BasicUI.h"
+#include "ConcurrentExport.h"
 #include "ExportPlugin.h"
 #include "wxFileNameWrapper.h"
 
@@ -25,6 +28,20 @@ namespace ExportProgressUI
 {
    ExportResult Show(ExportTask exportTask);
 
+   //! Run independent tasks concurrently in worker threads, with one progress
+   //! dialog for all
+   /*!
+    Tasks are made in this thread, in order, only as they can start, at most
+    maxConcurrent at once, or as many as there are cores if zero; see
+    ConcurrentExport::Run().  Cancel and stop apply to the tasks running; the
+    rest are not made.  Errors are reported as by the overload for one task.
+    @return the result of each task, which is empty for tasks that did not
+    start
+    */
+   std::vector<std::optional<ExportResult>>
+   Show(size_t count, const ConcurrentExport::TaskFactory& makeTask,
+        size_t maxConcurrent);
+
    template<typename Callable>
    void ExceptionWrappedCall(Callable callable)
    {
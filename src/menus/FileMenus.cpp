@@ -178,10 +178,11 @@ void DoImport(const CommandContext &context, bool isRaw)
                .AddImportedTracks(fileName, std::move(newTracks));
          }
       }
-      else {
-         ProjectFileManager::Get( project ).Import(fileName);
-      }
    }
+
+   if (!isRaw)
+      // Decodes the files at once
+      ProjectFileManager::Get( project ).Import(std::move(selectedFiles));
 }
 
 // Menu handler functions
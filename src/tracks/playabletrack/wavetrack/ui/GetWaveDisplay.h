@@ -12,6 +12,7 @@
 #define __AUDACITY_GET_WAVE_DISPLAY__
 
 #include <cstddef>
+class BlockArray;
 class Sequence;
 class sampleCount;
 
@@ -25,4 +26,11 @@ bool GetWaveDisplay(const Sequence &sequence,
    float *min, float *max, float *rms,
    size_t len, const sampleCount *where);
 
+// The same, given a copy of the blocks and the other needed properties of a
+// sequence, so that it can run on another thread while the sequence changes
+bool GetWaveDisplay(const BlockArray &blocks,
+   sampleCount numSamples, size_t maxBlockSize,
+   float *min, float *max, float *rms,
+   size_t len, const sampleCount *where);
+
 #endif
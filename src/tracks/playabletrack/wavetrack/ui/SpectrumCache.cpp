@@ -11,16 +11,156 @@
 #include "SpectrumCache.h"
 
 #include "../../../../prefs/SpectrogramSettings.h"
+#include "BasicUI.h"
 #include "RealFFTf.h"
+#include "SampleBlock.h"
 #include "Sequence.h"
 #include "Spectrum.h"
+#include "TaskPool.h"
 #include "WaveClipUtilities.h"
 #include "WaveTrack.h"
 #include "WideSampleSequence.h"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <limits>
 
 namespace {
 
+//! Columns computed by one worker before it checks the time again
+constexpr int ColumnsPerChunk = 8;
+
+//! Time spent computing a spectrogram in one paint, after which the rest is
+//! left for later paints
+constexpr auto PaintBudget = std::chrono::milliseconds{ 30 };
+
+//! How many caches of other zoom levels to keep for each channel
+constexpr size_t MaxOtherZoomCaches = 2;
+
+//! Value of columns not yet computed, drawn like silence
+constexpr float NoPower = -160.0f;
+
+using Clock = std::chrono::steady_clock;
+
+//! Kinds of data in the tiles of sample blocks
+enum : int { SpectrumTile = 1 };
+
+//! Tiles are not made at closer zooms, which would make them too large
+constexpr long long MaxTileColumns = 64;
+
+unsigned long long TileSettingsHash(
+   const SpectrogramSettings &settings, double rate)
+{
+   // FNV-1a
+   unsigned long long hash = 14695981039346656037ull;
+   const auto mix = [&](long long value) {
+      for (int ii = 0; ii < 8; ++ii) {
+         hash ^= (value >> (8 * ii)) & 0xff;
+         hash *= 1099511628211ull;
+      }
+   };
+   mix(settings.algorithm);
+   mix(settings.windowType);
+   mix(settings.WindowSize());
+   mix(settings.ZeroPaddingFactor());
+   mix(settings.frequencyGain);
+   mix(llrint(rate));
+   return hash;
+}
+
+//! Compute the spectra of a block at regular intervals, marking with NaN
+//! the columns whose windows reach beyond the block, or are padded at the
+//! ends of the clip, because those do not depend on the block alone
+std::vector<float> MakeTile(SpectrogramSettings &settings,
+   const WaveChannelInterval &clip, const SeqBlock &block,
+   sampleCount hop, sampleCount offset, double pixelsPerSecond)
+{
+   const auto count = block.sb->GetSampleCount();
+   const auto nColumns = ((count + hop - 1) / hop).as_size_t();
+   const auto center = [&](size_t column) {
+      return block.start + hop * column + hop / 2;
+   };
+
+   SpecCache tile;
+   tile.Grow(nColumns, settings, hop.as_double(), 0);
+   // Positions relative to the start of the clip after trimming
+   for (size_t column = 0; column <= nColumns; ++column)
+      tile.where[column] = center(column) - offset;
+   tile.Populate(settings, clip, 0, 0, nColumns, pixelsPerSecond);
+
+   const auto windowSize = settings.WindowSize();
+   const auto numSamples = clip.GetSequence().GetNumSamples();
+   const auto nBins = settings.NBins();
+   for (size_t column = 0; column < nColumns; ++column) {
+      const auto from = center(column) - (windowSize >> 1);
+      if (from < block.start || from + windowSize > block.start + count ||
+          from < offset || from - offset + windowSize >= numSamples)
+         tile.freq[nBins * column] = std::numeric_limits<float>::quiet_NaN();
+   }
+   return std::move(tile.freq);
+}
+
+//! Fill columns of the cache that are not yet valid from the tiles of
+//! sample blocks, making missing tiles until the deadline
+/*!
+ Tile columns are at multiples of a power of two samples, not more than the
+ zoom, so each display column takes the nearest one, which is off by less
+ than half a pixel
+ */
+void FillFromTiles(SpecCache &cache, SpectrogramSettings &settings,
+   const WaveChannelInterval &clip, size_t numPixels, double pixelsPerSecond,
+   Clock::time_point deadline)
+{
+   const auto &sequence = clip.GetSequence();
+   // Decided when the project was opened
+   if (!sequence.GetFactory()->HasTiles())
+      return;
+   if (cache.spp < 1 ||
+       settings.algorithm == SpectrogramSettings::algReassignment)
+      return;
+   const int level = static_cast<int>(floor(log2(cache.spp)));
+   const sampleCount hop{ 1LL << level };
+   if (hop * MaxTileColumns < sequence.GetMaxBlockSize())
+      return;
+
+   const SampleBlockTileKey key{
+      SpectrumTile, TileSettingsHash(settings, clip.GetRate()), level };
+   const auto nBins = settings.NBins();
+   // Sequence position of where[0] == 0
+   const auto offset = clip.TimeToSamples(clip.GetTrimLeft());
+   const auto numSamples = sequence.GetNumSamples();
+   const auto &blocks = sequence.GetBlockArray();
+
+   const SeqBlock *pTileBlock = nullptr;
+   std::vector<float> tile;
+   bool haveTile = false;
+   for (size_t xx = 0; xx < numPixels; ++xx) {
+      if (cache.valid[xx])
+         continue;
+      const auto pos = cache.where[xx] + offset;
+      if (pos < 0 || pos >= numSamples)
+         continue;
+      const auto &block = blocks[sequence.FindBlock(pos)];
+      if (&block != pTileBlock) {
+         pTileBlock = &block;
+         haveTile = block.sb->GetTile(key, tile);
+         if (!haveTile && Clock::now() < deadline) {
+            tile = MakeTile(settings, clip, block, hop, offset, pixelsPerSecond);
+            block.sb->PutTile(key, tile);
+            haveTile = true;
+         }
+      }
+      if (!haveTile)
+         continue;
+      const auto column = ((pos - block.start) / hop).as_size_t();
+      if ((column + 1) * nBins > tile.size() || std::isnan(tile[column * nBins]))
+         continue;
+      std::copy(&tile[column * nBins], &tile[(column + 1) * nBins],
+         &cache.freq[xx * nBins]);
+      cache.valid[xx] = 1;
+   }
+}
+
 static void ComputeSpectrumUsingRealFFTf
    (float * __restrict buffer, const FFTParam *hFFT,
     const float * __restrict window, size_t len, float * __restrict out)
@@ -95,7 +235,8 @@ bool SpecCache::CalculateOneSpectrum(
    const SpectrogramSettings& settings, const WaveChannelInterval& clip,
    const int xx, double pixelsPerSecond, int lowerBoundX, int upperBoundX,
    const std::vector<float>& gainFactors, float* __restrict scratch,
-   float* __restrict out) const
+   float* __restrict out,
+   std::optional<AudioSegmentSampleView> &sampleCacheHolder) const
 {
    bool result = false;
    const bool reassignment =
@@ -169,10 +310,12 @@ bool SpecCache::CalculateOneSpectrum(
          if (myLen > 0) {
             constexpr auto iChannel = 0u;
             constexpr auto mayThrow = false; // Don't throw just for display
-            mSampleCacheHolder.emplace(
+            // Holding the view keeps the samples of the block in memory for
+            // the next column
+            sampleCacheHolder.emplace(
                clip.GetSampleView(from, myLen, mayThrow));
             floats.resize(myLen);
-            mSampleCacheHolder->Copy(floats.data(), myLen);
+            sampleCacheHolder->Copy(floats.data(), myLen);
             useBuffer = floats.data();
             if (copy) {
                if (useBuffer)
@@ -329,6 +472,8 @@ void SpecCache::Grow(
    // Sample counts corresponding to the columns, and to one past the end.
    where.resize(len_ + 1);
 
+   valid.resize(len_);
+
    len = len_;
    algorithm = settings.algorithm;
    spp = samplesPerPixel;
@@ -339,9 +484,16 @@ void SpecCache::Grow(
    frequencyGain = settings.frequencyGain;
 }
 
-void SpecCache::Populate(
+bool SpecCache::IsComplete() const
+{
+   return std::all_of(valid.begin(), valid.end(),
+      [](unsigned char v){ return v != 0; });
+}
+
+bool SpecCache::Populate(
    const SpectrogramSettings& settings, const WaveChannelInterval& clip,
-   int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond)
+   int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond,
+   std::optional<std::chrono::steady_clock::duration> budget)
 {
    const auto sampleRate = clip.GetRate();
    const int &frequencyGainSetting = settings.frequencyGain;
@@ -359,103 +511,123 @@ void SpecCache::Populate(
 
    const size_t bufferSize = fftLen;
    const size_t scratchSize = reassignment ? 3 * bufferSize : bufferSize;
-   std::vector<float> scratch(scratchSize);
 
    std::vector<float> gainFactors;
    if (!autocorrelation)
       ComputeSpectrogramGainFactors(
          fftLen, sampleRate, frequencyGainSetting, gainFactors);
 
+   if (!reassignment) {
+      // Columns are independent, so workers may take chunks of them in any
+      // order, each with its own scratch space
+      std::vector<std::pair<int, int>> chunks;
+      for (int xx = 0; xx < (int)numPixels;) {
+         if (valid[xx]) {
+            ++xx;
+            continue;
+         }
+         const int first = xx;
+         while (xx < (int)numPixels && !valid[xx] &&
+            xx - first < ColumnsPerChunk)
+            ++xx;
+         chunks.emplace_back(first, xx);
+      }
+
+      const auto deadline =
+         budget ? Clock::now() + *budget : Clock::time_point::max();
+      std::atomic<size_t> nextChunk{ 0 };
+      auto &pool = TaskPool::Get();
+      const auto nTasks = std::min(chunks.size(), pool.Concurrency());
+      if (nTasks > 0)
+         pool.ForEach(nTasks, [&](size_t) {
+            std::vector<float> scratch(scratchSize);
+            std::optional<AudioSegmentSampleView> sampleCacheHolder;
+            for (size_t ii; (ii = nextChunk++) < chunks.size();) {
+               // Always make some progress, even when over budget
+               if (ii > 0 && Clock::now() > deadline)
+                  break;
+               const auto [first, last] = chunks[ii];
+               for (auto xx = first; xx < last; ++xx) {
+                  CalculateOneSpectrum(
+                     settings, clip, xx, pixelsPerSecond, 0, numPixels,
+                     gainFactors, scratch.data(), &freq[0], sampleCacheHolder);
+                  valid[xx] = 1;
+               }
+            }
+         });
+
+      // Columns left for later are drawn as silence meanwhile
+      bool complete = true;
+      for (size_t xx = 0; xx < numPixels; ++xx)
+         if (!valid[xx]) {
+            complete = false;
+            std::fill(&freq[nBins * xx], &freq[nBins * (xx + 1)], NoPower);
+         }
+      return complete;
+   }
+
+   std::vector<float> scratch(scratchSize);
+
    // Loop over the ranges before and after the copied portion and compute anew.
    // One of the ranges may be empty.
    for (int jj = 0; jj < 2; ++jj) {
       const int lowerBoundX = jj == 0 ? 0 : copyEnd;
       const int upperBoundX = jj == 0 ? copyBegin : numPixels;
 
-// todo(mhodgkinson): I don't find an option to define _OPENMP anywhere. Is this
-// still of interest?
-#ifdef _OPENMP
-      // Storage for mutable per-thread data.
-      // private clause ensures one copy per thread
-      struct ThreadLocalStorage {
-         ThreadLocalStorage()  { }
-         ~ThreadLocalStorage() { }
-
-         void init(SampleTrackCache &waveTrackCache, size_t scratchSize) {
-            if (!cache) {
-               cache = std::make_unique<SampleTrackCache>(waveTrackCache.GetTrack());
-               scratch.resize(scratchSize);
-            }
-         }
-         std::unique_ptr<SampleTrackCache> cache;
-         std::vector<float> scratch;
-      } tls;
-
-      #pragma omp parallel for private(tls)
-#endif
+      // Reassignment accumulates into neighboring columns, so it is done in
+      // one thread
       for (auto xx = lowerBoundX; xx < upperBoundX; ++xx)
-      {
-#ifdef _OPENMP
-         tls.init(waveTrackCache, scratchSize);
-         SampleTrackCache& cache = *tls.cache;
-         float* buffer = &tls.scratch[0];
-#else
-         float* buffer = &scratch[0];
-#endif
          CalculateOneSpectrum(
             settings, clip, xx, pixelsPerSecond, lowerBoundX, upperBoundX,
-            gainFactors, buffer, &freq[0]);
+            gainFactors, &scratch[0], &freq[0], mSampleCacheHolder);
+
+      // Need to look beyond the edges of the range to accumulate more
+      // time reassignments.
+      // I'm not sure what's a good stopping criterion?
+      auto xx = lowerBoundX;
+      const double pixelsPerSample =
+         pixelsPerSecond * clip.GetStretchRatio() / sampleRate;
+      const int limit = std::min((int)(0.5 + fftLen * pixelsPerSample), 100);
+      for (int ii = 0; ii < limit; ++ii)
+      {
+         const bool result = CalculateOneSpectrum(
+            settings, clip, --xx, pixelsPerSecond, lowerBoundX, upperBoundX,
+            gainFactors, &scratch[0], &freq[0], mSampleCacheHolder);
+         if (!result)
+            break;
       }
 
-      if (reassignment) {
-         // Need to look beyond the edges of the range to accumulate more
-         // time reassignments.
-         // I'm not sure what's a good stopping criterion?
-         auto xx = lowerBoundX;
-         const double pixelsPerSample =
-            pixelsPerSecond * clip.GetStretchRatio() / sampleRate;
-         const int limit = std::min((int)(0.5 + fftLen * pixelsPerSample), 100);
-         for (int ii = 0; ii < limit; ++ii)
-         {
-            const bool result = CalculateOneSpectrum(
-               settings, clip, --xx, pixelsPerSecond, lowerBoundX, upperBoundX,
-               gainFactors, &scratch[0], &freq[0]);
-            if (!result)
-               break;
-         }
+      xx = upperBoundX;
+      for (int ii = 0; ii < limit; ++ii)
+      {
+         const bool result = CalculateOneSpectrum(
+            settings, clip, xx++, pixelsPerSecond, lowerBoundX, upperBoundX,
+            gainFactors, &scratch[0], &freq[0], mSampleCacheHolder);
+         if (!result)
+            break;
+      }
 
-         xx = upperBoundX;
-         for (int ii = 0; ii < limit; ++ii)
-         {
-            const bool result = CalculateOneSpectrum(
-               settings, clip, xx++, pixelsPerSecond, lowerBoundX, upperBoundX,
-               gainFactors, &scratch[0], &freq[0]);
-            if (!result)
-               break;
+      // Now Convert to dB terms.  Do this only after accumulating
+      // power values, which may cross columns with the time correction.
+      for (xx = lowerBoundX; xx < upperBoundX; ++xx) {
+         float *const results = &freq[nBins * xx];
+         for (size_t ii = 0; ii < nBins; ++ii) {
+            float &power = results[ii];
+            if (power <= 0)
+               power = -160.0;
+            else
+               power = 10.0*log10f(power);
          }
-
-         // Now Convert to dB terms.  Do this only after accumulating
-         // power values, which may cross columns with the time correction.
-#ifdef _OPENMP
-         #pragma omp parallel for
-#endif
-         for (xx = lowerBoundX; xx < upperBoundX; ++xx) {
-            float *const results = &freq[nBins * xx];
-            for (size_t ii = 0; ii < nBins; ++ii) {
-               float &power = results[ii];
-               if (power <= 0)
-                  power = -160.0;
-               else
-                  power = 10.0*log10f(power);
-            }
-            if (!gainFactors.empty()) {
-               // Apply a frequency-dependent gain factor
-               for (size_t ii = 0; ii < nBins; ++ii)
-                  results[ii] += gainFactors[ii];
-            }
+         if (!gainFactors.empty()) {
+            // Apply a frequency-dependent gain factor
+            for (size_t ii = 0; ii < nBins; ++ii)
+               results[ii] += gainFactors[ii];
          }
       }
    }
+
+   std::fill(valid.begin(), valid.end(), 1);
+   return true;
 }
 
 bool WaveClipSpectrumCache::GetSpectrogram(
@@ -465,7 +637,8 @@ bool WaveClipSpectrumCache::GetSpectrogram(
    double pixelsPerSecond)
 
 {
-   auto &mSpecCache = mSpecCaches[clip.GetChannelIndex()];
+   const auto iChannel = clip.GetChannelIndex();
+   auto &mSpecCache = mSpecCaches[iChannel];
 
    const auto sampleRate = clip.GetRate();
    const auto stretchRatio = clip.GetStretchRatio();
@@ -473,17 +646,57 @@ bool WaveClipSpectrumCache::GetSpectrogram(
 
    //Trim offset comparison failure forces spectrogram cache rebuild
    //and skip copying "unchanged" data after clip border was trimmed.
-   bool match = mSpecCache && mSpecCache->leftTrim == clip.GetTrimLeft() &&
-                mSpecCache->rightTrim == clip.GetTrimRight() &&
-                mSpecCache->len > 0 &&
-                mSpecCache->Matches(mDirty, samplesPerPixel, settings);
+   const auto matches = [&](const SpecCache &cache) {
+      return cache.leftTrim == clip.GetTrimLeft() &&
+         cache.rightTrim == clip.GetTrimRight() &&
+         cache.len > 0 &&
+         cache.Matches(mDirty, samplesPerPixel, settings);
+   };
+
+   if (SpectrumKeepZoomLevels.Read() && !(mSpecCache && matches(*mSpecCache)))
+   {
+      // Swap in a cache kept from an earlier visit to this zoom level, and
+      // keep the one displaced, unless it is out of date
+      auto &others = mOtherZoomCaches[iChannel];
+      others.erase(std::remove_if(others.begin(), others.end(),
+         [this](const std::unique_ptr<SpecCache> &pCache){
+            return pCache->dirty != mDirty; }), others.end());
+      auto iter = std::find_if(others.begin(), others.end(),
+         [&](const std::unique_ptr<SpecCache> &pCache){
+            return matches(*pCache); });
+      auto pOld = std::move(mSpecCache);
+      if (iter != others.end()) {
+         mSpecCache = std::move(*iter);
+         others.erase(iter);
+      }
+      else
+         mSpecCache = std::make_unique<SpecCache>();
+      if (pOld && pOld->len > 0 && pOld->dirty == mDirty) {
+         if (others.size() >= MaxOtherZoomCaches)
+            others.erase(others.begin());
+         others.push_back(std::move(pOld));
+      }
+   }
+
+   bool match = mSpecCache && matches(*mSpecCache);
 
    if (match && mSpecCache->start == t0 && mSpecCache->len >= numPixels)
    {
       spectrogram = &mSpecCache->freq[0];
       where = &mSpecCache->where[0];
 
-      return false;  //hit cache completely
+      if (mSpecCache->IsComplete())
+         return false;  //hit cache completely
+
+      // Compute more of what an earlier paint left undone
+      settings.CacheWindows();
+      const auto deadline = Clock::now() + PaintBudget;
+      FillFromTiles(*mSpecCache, settings, clip, mSpecCache->len,
+         pixelsPerSecond, deadline);
+      if (!mSpecCache->Populate(settings, clip, 0, 0, mSpecCache->len,
+         pixelsPerSecond, deadline - Clock::now()))
+         BasicUI::CallAfter([]{ Updates().Publish({}); });
+      return true;
    }
 
    // Caching is not implemented for reassignment, unless for
@@ -507,6 +720,8 @@ bool WaveClipSpectrumCache::GetSpectrogram(
    double correction = 0.0;
 
    int copyBegin = 0, copyEnd = 0;
+   // Which of the copied columns were already computed
+   std::vector<unsigned char> valid(numPixels, 0);
    if (match) {
       findCorrection(
          mSpecCache->where, mSpecCache->len, numPixels, t0, sampleRate,
@@ -518,12 +733,17 @@ bool WaveClipSpectrumCache::GetSpectrogram(
       copyEnd = std::min((int)numPixels, std::max(0,
          (int)mSpecCache->len - oldX0
       ));
+      if (copyEnd > copyBegin)
+         std::copy(mSpecCache->valid.begin() + (copyBegin + oldX0),
+            mSpecCache->valid.begin() + (copyEnd + oldX0),
+            valid.begin() + copyBegin);
    }
 
    // Resize the cache, keep the contents unchanged.
    mSpecCache->Grow(numPixels, settings, samplesPerPixel, t0);
    mSpecCache->leftTrim = clip.GetTrimLeft();
    mSpecCache->rightTrim = clip.GetTrimRight();
+   mSpecCache->valid = std::move(valid);
    auto nBins = settings.NBins();
 
    // Optimization: if the old cache is good and overlaps
@@ -562,8 +782,13 @@ bool WaveClipSpectrumCache::GetSpectrogram(
       mSpecCache->where, numPixels, addBias, correction, t0, sampleRate,
       stretchRatio, samplesPerPixel);
 
-   mSpecCache->Populate(
-      settings, clip, copyBegin, copyEnd, numPixels, pixelsPerSecond);
+   // Leave what takes too long for later paints
+   const auto deadline = Clock::now() + PaintBudget;
+   FillFromTiles(*mSpecCache, settings, clip, numPixels, pixelsPerSecond,
+      deadline);
+   if (!mSpecCache->Populate(settings, clip, copyBegin, copyEnd, numPixels,
+      pixelsPerSecond, deadline - Clock::now()))
+      BasicUI::CallAfter([]{ Updates().Publish({}); });
 
    mSpecCache->dirty = mDirty;
    spectrogram = &mSpecCache->freq[0];
@@ -576,6 +801,7 @@ WaveClipSpectrumCache::WaveClipSpectrumCache(size_t nChannels)
    // TODO wide wave tracks -- won't need std::max here
    : mSpecCaches(std::max<size_t>(2, nChannels))
    , mSpecPxCaches(std::max<size_t>(2, nChannels))
+   , mOtherZoomCaches(std::max<size_t>(2, nChannels))
 {
    for (auto &pCache : mSpecCaches)
       pCache = std::make_unique<SpecCache>();
@@ -605,4 +831,15 @@ void WaveClipSpectrumCache::Invalidate()
    // Invalidate the spectrum display cache
    for (auto &pCache : mSpecCaches)
       pCache = std::make_unique<SpecCache>();
+   for (auto &caches : mOtherZoomCaches)
+      caches.clear();
 }
+
+Observer::Publisher<SpectrumCacheUpdateMessage> &
+WaveClipSpectrumCache::Updates()
+{
+   static Observer::Publisher<SpectrumCacheUpdateMessage> publisher;
+   return publisher;
+}
+
+BoolSetting SpectrumKeepZoomLevels{ L"/Spectrum/KeepZoomLevels", true };
@@ -11,13 +11,16 @@
 #ifndef __AUDACITY_WAVECLIP_SPECTRUM_CACHE__
 #define __AUDACITY_WAVECLIP_SPECTRUM_CACHE__
 
+class BoolSetting;
 class sampleCount;
 class SpectrogramSettings;
 class WaveChannelInterval;
 class WideSampleSequence;
 
+#include <chrono>
 #include <vector>
 #include "MemoryX.h"
+#include "Observer.h"
 #include "WaveClip.h" // to inherit WaveClipListener
 
 using Floats = ArrayOf<float>;
@@ -49,10 +52,20 @@ public:
       size_t len_, SpectrogramSettings& settings, double samplesPerPixel,
       double start /*relative to clip play start time*/);
 
-   // Calculate the dirty columns at the begin and end of the cache
-   void Populate(
+   //! Calculate the columns not yet valid, on worker threads
+   /*!
+    For reassignment, which is computed on one thread, the columns before
+    copyBegin and from copyEnd are calculated, and they all become valid.
+    @param budget if given, stop starting new columns after this much time
+    @return whether all columns are valid
+    */
+   bool Populate(
       const SpectrogramSettings& settings, const WaveChannelInterval& clip,
-      int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond);
+      int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond,
+      std::optional<std::chrono::steady_clock::duration> budget = {});
+
+   //! Whether all columns are valid
+   bool IsComplete() const;
 
    size_t       len { 0 }; // counts pixels, not samples
    int          algorithm;
@@ -66,6 +79,9 @@ public:
    int          frequencyGain;
    std::vector<float> freq;
    std::vector<sampleCount> where;
+   //! For each column, nonzero if freq holds its results; not vector<bool>,
+   //! so that threads may set distinct columns
+   std::vector<unsigned char> valid;
 
    int          dirty;
 
@@ -75,7 +91,8 @@ private:
       const SpectrogramSettings& settings, const WaveChannelInterval &clip,
       const int xx, double pixelsPerSecond, int lowerBoundX, int upperBoundX,
       const std::vector<float>& gainFactors, float* __restrict scratch,
-      float* __restrict out) const;
+      float* __restrict out,
+      std::optional<AudioSegmentSampleView> &sampleCacheHolder) const;
 
    mutable std::optional<AudioSegmentSampleView> mSampleCacheHolder;
 };
@@ -101,6 +118,10 @@ public:
    int maxFreq;
 };
 
+//! Published in the main thread after a spectrogram was left partly
+//! computed, so that views may repaint and compute more
+struct SpectrumCacheUpdateMessage {};
+
 struct WaveClipSpectrumCache final : WaveClipListener
 {
    explicit WaveClipSpectrumCache(size_t nChannels);
@@ -109,6 +130,8 @@ struct WaveClipSpectrumCache final : WaveClipListener
    // Cache of values to colour pixels of Spectrogram - used by TrackArtist
    std::vector<std::unique_ptr<SpecPxCache>> mSpecPxCaches;
    std::vector<std::unique_ptr<SpecCache>> mSpecCaches;
+   //! For each channel, caches at zoom levels recently left
+   std::vector<std::vector<std::unique_ptr<SpecCache>>> mOtherZoomCaches;
    int mDirty { 0 };
 
    static WaveClipSpectrumCache &Get( const WaveClip &clip );
@@ -126,6 +149,12 @@ struct WaveClipSpectrumCache final : WaveClipListener
       SpectrogramSettings &spectrogramSettings,
       const sampleCount *&where, size_t numPixels,
       double t0 /*absolute time*/, double pixelsPerSecond);
+
+   static Observer::Publisher<SpectrumCacheUpdateMessage> &Updates();
 };
 
+//! Whether to keep spectrograms computed at other zoom levels, so that
+//! zooming back to them is immediate
+extern AUDACITY_DLL_API BoolSetting SpectrumKeepZoomLevels;
+
 #endif
@@ -10,9 +10,16 @@
 
 #include "WaveformCache.h"
 
+#include <algorithm>
 #include <cmath>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include "BasicUI.h"
+#include "FrameStatistics.h"
 #include "Sequence.h"
 #include "GetWaveDisplay.h"
+#include "TaskPool.h"
 #include "WaveClipUtilities.h"
 #include "WaveTrack.h"
 
@@ -58,6 +65,255 @@ public:
    std::vector<float> rms;
 };
 
+namespace {
+
+// Make a tolerant comparison of the samples-per-pixel values in this wise:
+// accumulated difference of times over the number of pixels is less than
+// a sample period.
+bool SameZoom(double samplesPerPixel1, double samplesPerPixel2, size_t len)
+{
+   return fabs(samplesPerPixel1 - samplesPerPixel2) * len < 1.0;
+}
+
+//! How many caches of other zoom levels or positions to keep for a channel
+constexpr size_t MaxPreparedCaches = 4;
+
+//! Misses spanning more blocks than this are computed in the background
+constexpr size_t MaxForegroundBlocks = 16;
+
+//! Zoom levels, in samples per pixel, at and above which neighboring levels
+//! are prepared; closer zooms read few samples and are fast enough
+constexpr double MinNeighborSamplesPerPixel = 256;
+
+//! Computes some columns of a WaveCache from a snapshot of the sequence
+struct WaveformJob {
+   std::weak_ptr<WaveClipWaveformCache::Background> wBackground;
+   //! Valid while wBackground is, because the clip owns the background
+   const WaveClip *pClip;
+   size_t iChannel;
+   BlockArray blocks;
+   sampleCount numSamples;
+   size_t maxBlockSize;
+   std::unique_ptr<WaveCache> pCache;
+   size_t p0, p1;
+   bool ok{ false };
+};
+
+//! Jobs shared by all clips, run on a few threads of the TaskPool at low
+//! priority, taking the most recent jobs first, because they are for what the
+//! user is looking at now
+class WaveformWorkers final
+   : public std::enable_shared_from_this<WaveformWorkers> {
+public:
+   static WaveformWorkers &Get()
+   {
+      // Shared with queued tasks, which may outlive static storage at exit
+      static const auto pInstance = std::make_shared<WaveformWorkers>();
+      return *pInstance;
+   }
+
+   void Submit(std::shared_ptr<WaveformJob> pJob);
+
+private:
+   void Run();
+
+   static void Finish(std::shared_ptr<WaveformJob> pJob);
+
+   static constexpr size_t MaxQueued = 16;
+
+   std::mutex mMutex;
+   std::deque<std::shared_ptr<WaveformJob>> mJobs;
+   //! How many tasks of the pool are taking jobs
+   size_t mRunning{ 0 };
+};
+}
+
+struct WaveClipWaveformCache::Background {
+   explicit Background(WaveClipWaveformCache &owner) : owner{ owner } {}
+
+   //! Identifies a job, so that the same one is not started twice
+   struct Key {
+      size_t iChannel;
+      double start;
+      double samplesPerPixel;
+      size_t len;
+      int dirty;
+
+      bool operator ==(const Key &other) const
+      {
+         return iChannel == other.iChannel && start == other.start &&
+            samplesPerPixel == other.samplesPerPixel && len == other.len &&
+            dirty == other.dirty;
+      }
+   };
+
+   static Key MakeKey(size_t iChannel, const WaveCache &cache)
+   {
+      return { iChannel, cache.start, cache.samplesPerPixel, cache.len,
+         cache.dirty };
+   }
+
+   //! Called in the main thread when a job is done or dropped
+   void Finish(WaveformJob &job);
+
+   WaveClipWaveformCache &owner;
+   std::vector<Key> pending;
+};
+
+void WaveformWorkers::Submit(std::shared_ptr<WaveformJob> pJob)
+{
+   std::shared_ptr<WaveformJob> pDropped;
+   bool start = false;
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      // Drop the stalest job, which is likely for a view the user has left
+      if (mJobs.size() >= MaxQueued) {
+         pDropped = std::move(mJobs.front());
+         mJobs.pop_front();
+      }
+      mJobs.push_back(std::move(pJob));
+      // Leave most of the pool for work that is not speculative
+      const auto maxRunning = std::clamp<size_t>(
+         TaskPool::Get().Concurrency() / 2, 1, 4);
+      if (mRunning < maxRunning) {
+         ++mRunning;
+         start = true;
+      }
+   }
+   if (start)
+      TaskPool::Get().Post([pThis = shared_from_this()]{ pThis->Run(); },
+         TaskPriority::Low);
+   if (pDropped)
+      Finish(std::move(pDropped));
+}
+
+void WaveformWorkers::Run()
+{
+   while (true) {
+      std::shared_ptr<WaveformJob> pJob;
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         if (mJobs.empty()) {
+            --mRunning;
+            return;
+         }
+         pJob = std::move(mJobs.back());
+         mJobs.pop_back();
+      }
+      if (!pJob->wBackground.expired()) {
+         auto &cache = *pJob->pCache;
+         const auto p0 = pJob->p0;
+         pJob->ok = ::GetWaveDisplay(pJob->blocks,
+            pJob->numSamples, pJob->maxBlockSize,
+            &cache.min[p0], &cache.max[p0], &cache.rms[p0],
+            pJob->p1 - p0, &cache.where[p0]);
+      }
+      Finish(std::move(pJob));
+   }
+}
+
+void WaveformWorkers::Finish(std::shared_ptr<WaveformJob> pJob)
+{
+   // The job also releases its sample blocks in the main thread, so that the
+   // deletion of a block, which writes the database, never happens in a worker
+   BasicUI::CallAfter([pJob = std::move(pJob)]{
+      if (auto pBackground = pJob->wBackground.lock())
+         pBackground->Finish(*pJob);
+   });
+}
+
+void WaveClipWaveformCache::Background::Finish(WaveformJob &job)
+{
+   const auto key = MakeKey(job.iChannel, *job.pCache);
+   pending.erase(std::remove(pending.begin(), pending.end(), key),
+      pending.end());
+   if (!job.ok || job.pCache->dirty != owner.mDirty)
+      return;
+
+   // Replace any cache of the same zoom level
+   auto &prepared = owner.mPreparedCaches[job.iChannel];
+   const auto &pCache = job.pCache;
+   prepared.erase(std::remove_if(prepared.begin(), prepared.end(),
+      [&](const std::unique_ptr<WaveCache> &pOther){
+         return SameZoom(pOther->samplesPerPixel, pCache->samplesPerPixel,
+            pCache->len);
+      }), prepared.end());
+   if (prepared.size() >= MaxPreparedCaches)
+      prepared.erase(prepared.begin());
+   prepared.push_back(std::move(job.pCache));
+
+   Updates().Publish({ job.pClip });
+}
+
+Observer::Publisher<WaveformCacheUpdateMessage> &
+WaveClipWaveformCache::Updates()
+{
+   static Observer::Publisher<WaveformCacheUpdateMessage> publisher;
+   return publisher;
+}
+
+void WaveClipWaveformCache::Schedule(const WaveChannelInterval &clip,
+   std::unique_ptr<WaveCache> pCache, size_t p0, size_t p1)
+{
+   const auto iChannel = clip.GetChannelIndex();
+   const auto key = Background::MakeKey(iChannel, *pCache);
+   auto &pending = mpBackground->pending;
+   if (std::find(pending.begin(), pending.end(), key) != pending.end())
+      return;
+   pending.push_back(key);
+
+   const auto &sequence = clip.GetSequence();
+   auto pJob = std::make_shared<WaveformJob>();
+   pJob->wBackground = mpBackground;
+   pJob->pClip = &clip.GetClip();
+   pJob->iChannel = iChannel;
+   // Copying shares the blocks, which are immutable, with the sequence
+   pJob->blocks = sequence.GetBlockArray();
+   pJob->numSamples = sequence.GetNumSamples();
+   pJob->maxBlockSize = sequence.GetMaxBlockSize();
+   pJob->pCache = std::move(pCache);
+   pJob->p0 = p0;
+   pJob->p1 = p1;
+   WaveformWorkers::Get().Submit(std::move(pJob));
+}
+
+void WaveClipWaveformCache::PrepareNeighbors(const WaveChannelInterval &clip,
+   double t0, double samplesPerPixel, size_t numPixels)
+{
+   if (samplesPerPixel < MinNeighborSamplesPerPixel ||
+       clip.GetAppendBufferLen() > 0)
+      return;
+
+   const auto iChannel = clip.GetChannelIndex();
+   const auto &prepared = mPreparedCaches[iChannel];
+   const auto &pending = mpBackground->pending;
+   const auto sampleRate = clip.GetRate();
+   const auto stretchRatio = clip.GetStretchRatio();
+   // Duration of the screen
+   const auto width = numPixels * samplesPerPixel * stretchRatio / sampleRate;
+
+   const auto prepare = [&](double spp, double start, size_t len) {
+      for (const auto &pCache : prepared)
+         if (SameZoom(pCache->samplesPerPixel, spp, len))
+            return;
+      for (const auto &key : pending)
+         if (key.iChannel == iChannel && SameZoom(key.samplesPerPixel, spp, len))
+            return;
+      auto pCache =
+         std::make_unique<WaveCache>(len, spp, sampleRate, start, mDirty);
+      constexpr auto addBias = false;
+      fillWhere(pCache->where, len, addBias, 0.0, start, sampleRate,
+         stretchRatio, spp);
+      Schedule(clip, std::move(pCache), 0, len);
+   };
+
+   // Zooming in by two keeps the same time span with twice the columns.
+   // Zooming out by two may be centered anywhere on the screen, so cover one
+   // more screen on each side.
+   prepare(samplesPerPixel / 2, t0, 2 * numPixels);
+   prepare(samplesPerPixel * 2, t0 - width, 3 * numPixels / 2);
+}
+
 //
 // Getting high-level data from the track for screen display and
 // clipping calculations
@@ -67,7 +323,8 @@ bool WaveClipWaveformCache::GetWaveDisplay(
    const WaveChannelInterval &clip, WaveDisplay &display,
    double t0, double pixelsPerSecond)
 {
-   auto &waveCache = mWaveCaches[clip.GetChannelIndex()];
+   const auto iChannel = clip.GetChannelIndex();
+   auto &waveCache = mWaveCaches[iChannel];
 
    t0 += clip.GetTrimLeft();
 
@@ -96,20 +353,48 @@ bool WaveClipWaveformCache::GetWaveDisplay(
       const double samplesPerPixel =
          sampleRate / pixelsPerSecond / stretchRatio;
 
-      // Make a tolerant comparison of the samples-per-pixel values in this wise:
-      // accumulated difference of times over the number of pixels is less than
-      // a sample period.
-      const bool samplesPerPixelMatch =
-         waveCache &&
-         (fabs(samplesPerPixel - waveCache->samplesPerPixel) * numPixels < 1.0);
+      const auto matches = [&](const WaveCache *pCache) {
+         return pCache &&
+            SameZoom(samplesPerPixel, pCache->samplesPerPixel, numPixels) &&
+            pCache->len > 0 && pCache->dirty == mDirty;
+      };
+      const auto covers = [&](const WaveCache *pCache) {
+         return matches(pCache) &&
+            pCache->start == t0 && pCache->len >= numPixels;
+      };
+
+      auto &prepared = mPreparedCaches[iChannel];
+      if (!covers(waveCache.get())) {
+         // Look among the caches prepared in the background, first for one
+         // that satisfies the request, else for one at the same zoom level
+         // that might overlap it
+         auto iter = std::find_if(prepared.begin(), prepared.end(),
+            [&](const std::unique_ptr<WaveCache> &pCache){
+               return covers(pCache.get()); });
+         if (iter == prepared.end() && !matches(waveCache.get()))
+            iter = std::find_if(prepared.begin(), prepared.end(),
+               [&](const std::unique_ptr<WaveCache> &pCache){
+                  return matches(pCache.get()); });
+         if (iter != prepared.end()) {
+            // Keep the displaced cache too, in case the user zooms back
+            std::swap(waveCache, *iter);
+            prepared.erase(std::remove_if(prepared.begin(), prepared.end(),
+               [this](const std::unique_ptr<WaveCache> &pCache){
+                  return pCache->len == 0 || pCache->dirty != mDirty; }),
+               prepared.end());
+         }
+      }
 
-      const bool match = waveCache && samplesPerPixelMatch &&
-                         waveCache->len > 0 && waveCache->dirty == mDirty;
+      const bool match = matches(waveCache.get());
 
       if (match &&
          waveCache->start == t0 &&
          waveCache->len >= numPixels) {
 
+         FrameStatistics::AddCacheLookups(
+            FrameStatistics::CacheID::WaveformCache, numPixels, 0);
+         PrepareNeighbors(clip, t0, samplesPerPixel, numPixels);
+
          // Satisfy the request completely from the cache
          display.min = &waveCache->min[0];
          display.max = &waveCache->max[0];
@@ -168,6 +453,37 @@ bool WaveClipWaveformCache::GetWaveDisplay(
          memcpy(&max[copyBegin], &oldCache->max[srcIdx], sizeFloats);
          memcpy(&rms[copyBegin], &oldCache->rms[srcIdx], sizeFloats);
       }
+
+      const size_t misses = (p1 > p0) ? p1 - p0 : 0;
+      FrameStatistics::AddCacheLookups(
+         FrameStatistics::CacheID::WaveformCache, numPixels - misses, misses);
+      PrepareNeighbors(clip, t0, samplesPerPixel, numPixels);
+
+      // If the miss would read many blocks, compute it in the background,
+      // unless it involves the append buffer, which is changing
+      const auto &sequence = clip.GetSequence();
+      if (misses > 0 && clip.GetAppendBufferLen() == 0 &&
+         ((*pWhere)[p1] - (*pWhere)[p0]).as_double() >
+            double(MaxForegroundBlocks * sequence.GetMaxBlockSize())) {
+         // Meanwhile mark the missing columns as pending
+         auto &pPlaceholder = mPlaceholders[iChannel];
+         pPlaceholder = std::make_unique<WaveCache>(*waveCache);
+         for (auto pValues : { &pPlaceholder->min, &pPlaceholder->max,
+            &pPlaceholder->rms })
+            std::fill(pValues->begin() + p0, pValues->begin() + p1,
+               PendingValue);
+
+         Schedule(clip, std::move(waveCache), p0, p1);
+         // Keep the old cache for the next request
+         waveCache = oldCache ? std::move(oldCache)
+            : std::make_unique<WaveCache>();
+
+         display.min = &pPlaceholder->min[0];
+         display.max = &pPlaceholder->max[0];
+         display.rms = &pPlaceholder->rms[0];
+         display.where = &pPlaceholder->where[0];
+         return true;
+      }
    }
 
    if (p1 > p0) {
@@ -268,9 +584,15 @@ bool WaveClipWaveformCache::GetWaveDisplay(
    return true;
 }
 
+const float WaveClipWaveformCache::PendingValue =
+   std::numeric_limits<float>::quiet_NaN();
+
 WaveClipWaveformCache::WaveClipWaveformCache(size_t nChannels)
    // TODO wide wave tracks -- won't need std::max here
    : mWaveCaches(std::max<size_t>(2, nChannels))
+   , mPreparedCaches(mWaveCaches.size())
+   , mPlaceholders(mWaveCaches.size())
+   , mpBackground{ std::make_shared<Background>(*this) }
 {
    for (auto &pCache : mWaveCaches)
       pCache = std::make_unique<WaveCache>();
@@ -300,4 +622,8 @@ void WaveClipWaveformCache::Invalidate()
    // Invalidate wave display caches
    for (auto &pCache : mWaveCaches)
       pCache = std::make_unique<WaveCache>();
+   for (auto &caches : mPreparedCaches)
+      caches.clear();
+   // Ignore the results of jobs already started
+   mpBackground = std::make_shared<Background>(*this);
 }
@@ -11,11 +11,18 @@
 #ifndef __AUDACITY_WAVEFORM_CACHE__
 #define __AUDACITY_WAVEFORM_CACHE__
 
+#include "Observer.h"
 #include "WaveClip.h"
 
 class WaveCache;
 class WaveChannelInterval;
 
+//! Published in the main thread when columns computed in the background
+//! become available, so that views of the clip may repaint
+struct WaveformCacheUpdateMessage {
+   const WaveClip *pClip;
+};
+
 struct WaveClipWaveformCache final : WaveClipListener
 {
    explicit WaveClipWaveformCache(size_t nChannels);
@@ -34,8 +41,33 @@ struct WaveClipWaveformCache final : WaveClipListener
    void Clear();
 
    /** Getting high-level data for screen display */
+   /*!
+    Costly misses are computed on worker threads, and meanwhile min, max and
+    rms of the missing columns are PendingValue
+    */
    bool GetWaveDisplay(const WaveChannelInterval &clip,
       WaveDisplay &display, double t0, double pixelsPerSecond);
+
+   //! Marks columns not yet computed; NaN, so never mistaken for samples
+   static const float PendingValue;
+
+   static Observer::Publisher<WaveformCacheUpdateMessage> &Updates();
+
+   struct Background;
+private:
+   void Schedule(const WaveChannelInterval &clip,
+      std::unique_ptr<WaveCache> pCache, size_t p0, size_t p1);
+   void PrepareNeighbors(const WaveChannelInterval &clip,
+      double t0, double samplesPerPixel, size_t numPixels);
+
+   //! Caches finished in the background, or displaced from mWaveCaches,
+   //! for each channel, at zoom levels the user may visit next
+   std::vector<std::vector<std::unique_ptr<WaveCache>>> mPreparedCaches;
+   //! For each channel, what is displayed while columns are pending
+   std::vector<std::unique_ptr<WaveCache>> mPlaceholders;
+   //! Replaced when the cache is invalidated, so that results of jobs
+   //! started earlier are ignored
+   std::shared_ptr<Background> mpBackground;
 };
 
 #endif
@@ -40,6 +40,8 @@ Paul Licameli split from WaveChannelView.cpp
 #include <wx/graphics.h>
 #include <wx/dc.h>
 
+#include <cmath>
+
 static WaveChannelSubView::Type sType{
    WaveChannelViewConstants::Waveform,
    { wxT("Waveform"), XXO("Wa&veform") }
@@ -365,6 +367,14 @@ void DrawMinMaxRMS(
    dc.SetPen(muted ? muteSamplePen : samplePen);
    for (int x0 = 0; x0 < rect.width; ++x0) {
       int xx = rect.x + x0;
+      // Leave columns still being computed blank, unlike silence, and do not
+      // join the columns on either side
+      if (std::isnan(min[x0])) {
+         lasth1 = std::numeric_limits<int>::max();
+         lasth2 = std::numeric_limits<int>::min();
+         r1[x0] = r2[x0] = 0;
+         continue;
+      }
       double v;
       v = min[x0] * env[x0];
       if (clipped && bShowClipping && (v <= -MAX_AUDIO))